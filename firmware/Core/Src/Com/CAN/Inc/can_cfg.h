@@ -17,6 +17,20 @@
 
 /* Defines */
 #define CAN_DATA_SIZE ((uint8_t) 8)
+/* Set in a frame ID to send / mark a 29-bit identifier (same bit as CANTP_ID_EXT) */
+#define CAN_ID_EXT_FLAG ((uint32_t) 0x80000000)
+/* CAN1 filter banks handed out by CanIf_SetFilter(); bank 0 is set up in
+ * MX_CAN_Init(), banks 14-27 belong to CAN2 */
+#define CAN_FILTER_FIRST_BANK ((uint8_t) 1)
+#define CAN_FILTER_LAST_BANK  ((uint8_t) 13)
+/* Bank 0 in 16-bit mask mode (STID bits 15-5, IDE bit 3). It accepts every
+ * frame until an ID is registered with CanIf_SetFilter(); while IDs are
+ * registered it only passes 11-bit IDs 0x700-0x7FF and 29-bit frames, the
+ * registered IDs come in through their own banks */
+#define CAN_FILTER_DIAG_ID   ((uint16_t) (0x700 << 5))
+#define CAN_FILTER_DIAG_MASK ((uint16_t) ((0x700 << 5) | 0x0008))
+#define CAN_FILTER_EXT_ID    ((uint16_t) 0x0008)
+#define CAN_FILTER_EXT_MASK  ((uint16_t) 0x0008)
 
 #define CAN_TX_ENABLE_MULTITASKING 0
 #define CAN_RX_ENABLE_MULTITASKING 0
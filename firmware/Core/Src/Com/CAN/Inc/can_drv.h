@@ -11,7 +11,7 @@
 #include "can_if.h"
 
 /* Variables */
-TaskHandle_t canTxTaskHandle;
-TaskHandle_t canRxTaskHandle;
+extern TaskHandle_t canTxTaskHandle;
+extern TaskHandle_t canRxTaskHandle;
 
 #endif /* SRC_COM_CAN_INC_CAN_DRV_H_ */
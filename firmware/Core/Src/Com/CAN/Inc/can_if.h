@@ -28,5 +28,13 @@ extern CAN_RxCBuffer_t rxBuffer;
 extern bool CanIf_Init(void);
 extern CANIF_StatusTypeDef CanIf_AddTxMessage(CAN_TxHeaderTypeDef *txHeader, uint8_t data[]);
 extern CANIF_StatusTypeDef CanIf_Transmit(void);
+extern void CanIf_TransmitPending(void);
+extern CANIF_StatusTypeDef CanIf_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc);
+extern CANIF_StatusTypeDef CanIf_SendFrameFromIsr(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t* mailbox);
+extern CANIF_StatusTypeDef CanIf_Receive(CAN_RxMessage_t* msg);
+extern uint32_t CanIf_RxPending(void);
+extern void CanIf_GetRxMessage(CAN_HandleTypeDef *hcan);
+extern uint32_t CanIf_GetId(const CAN_RxHeaderTypeDef* header);
+extern CANIF_StatusTypeDef CanIf_SetFilter(uint32_t id, bool enable);
 
 #endif /* SRC_COM_CAN_INC_CAN_IF_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include <can_cbuffer.h>
+#include <string.h>
 
 
 /* Functions prototype */
@@ -18,6 +19,12 @@ CBuffer_StatusTypeDef CAN_RxBuff_Get(void* cbuff, void* data);
 CAN_TxMessage_t txData[CAN_TX_BUFFER_SIZE];
 CAN_RxMessage_t rxData[CAN_RX_BUFFER_SIZE];
 
+/* Backing storage for the buffered headers and payloads */
+static CAN_TxHeaderTypeDef txHeaders[CAN_TX_BUFFER_SIZE];
+static uint8_t txPayload[CAN_TX_BUFFER_SIZE][CAN_DATA_SIZE];
+static CAN_RxHeaderTypeDef rxHeaders[CAN_RX_BUFFER_SIZE];
+static uint8_t rxPayload[CAN_RX_BUFFER_SIZE][CAN_DATA_SIZE];
+
 
 /* Init Tx Buffer */
 bool CAN_TxBuff_Init(CAN_TxCBuffer_t* can_cbuff){
@@ -81,6 +88,8 @@ bool CAN_RxBuff_Init(CAN_RxCBuffer_t* can_cbuff){
  *
  * @param[in] cbuff Pointer to the CAN transmission buffer structure (CAN_TxCBuffer_t).
  * @param[in] data  Pointer to the CAN message to be added (CAN_TxMessage_t).
+ *                  The header and payload are copied into the buffer slot, so
+ *                  the caller may reuse its storage as soon as this returns.
  *
  * @return CBuffer_State
  * - NULL_PARAM: If either cbuff or data is NULL.
@@ -117,7 +126,11 @@ CBuffer_StatusTypeDef CAN_TxBuff_Add(void* cbuff, void* data){
 		return CBUFFER_NULL_PARAM;
 	}
 	CAN_TxMessage_t* const d = (CAN_TxMessage_t*)data;
-	b[can_cbuff->cbuff.tail] = *d;
+	const uint32_t slot = can_cbuff->cbuff.tail;
+	txHeaders[slot] = *d->header;
+	memcpy(txPayload[slot], d->data, CAN_DATA_SIZE);
+	b[slot].header = &txHeaders[slot];
+	b[slot].data = txPayload[slot];
 
 	/* Update tail and count */
 	can_cbuff->cbuff.tail = (can_cbuff->cbuff.tail + 1) % can_cbuff->cbuff.size;
@@ -141,6 +154,8 @@ CBuffer_StatusTypeDef CAN_TxBuff_Add(void* cbuff, void* data){
  *
  * @param[in] cbuff Pointer to the CAN transmission buffer structure (CAN_TxCBuffer_t).
  * @param[out] data  Pointer to store the retrieved CAN message (CAN_TxMessage_t).
+ *                   Its header and data pointers must reference caller storage;
+ *                   the buffered message is copied into them.
  *
  * @return CBuffer_State
  * - NULL_PARAM: If either cbuff or data is NULL.
@@ -174,7 +189,8 @@ CBuffer_StatusTypeDef CAN_TxBuff_Get(void* cbuff, void* data){
 		return CBUFFER_NULL_PARAM;
 	}
 	CAN_TxMessage_t* const d = (CAN_TxMessage_t*)data;
-	*d = b[can_cbuff->cbuff.head];
+	*d->header = *b[can_cbuff->cbuff.head].header;
+	memcpy(d->data, b[can_cbuff->cbuff.head].data, CAN_DATA_SIZE);
 
 	can_cbuff->cbuff.head = (can_cbuff->cbuff.head + 1) % can_cbuff->cbuff.size;
 	can_cbuff->cbuff.count -= 1;
@@ -228,8 +244,12 @@ CBuffer_StatusTypeDef CAN_RxBuff_Add(void* cbuff, void* data){
 		return CBUFFER_NULL_PARAM;
 	}
 	CAN_RxMessage_t* const d = (CAN_RxMessage_t*)data;
+	const uint32_t slot = can_cbuff->cbuff.tail;
 
-	b[can_cbuff->cbuff.tail] = *d;
+	rxHeaders[slot] = *d->header;
+	memcpy(rxPayload[slot], d->data, CAN_DATA_SIZE);
+	b[slot].header = &rxHeaders[slot];
+	b[slot].data = rxPayload[slot];
 	can_cbuff->cbuff.tail = (can_cbuff->cbuff.tail + 1) % can_cbuff->cbuff.size;
 	can_cbuff->cbuff.count += 1;
 
@@ -259,6 +279,8 @@ CBuffer_StatusTypeDef CAN_RxBuff_Add(void* cbuff, void* data){
  * - If multitasking is enabled (CAN_RX_ENABLE_MULTITASKING == 1), mutex acquisition and release
  *   are handled to ensure thread safety.
  * - The message is copied into the user-provided data buffer; the caller owns the data.
+ * - Called from task context only: the Rx FIFO 0 interrupt is masked while
+ *   the head index and count are updated, as CAN_RxBuff_Add() runs in it.
  */
 CBuffer_StatusTypeDef CAN_RxBuff_Get(void* cbuff, void* data){
 	if(cbuff == NULL || data == NULL) return CBUFFER_NULL_PARAM;
@@ -283,9 +305,14 @@ CBuffer_StatusTypeDef CAN_RxBuff_Get(void* cbuff, void* data){
 	}
 	CAN_RxMessage_t* const d = (CAN_RxMessage_t*)data;
 
-	*d = b[can_cbuff->cbuff.head];
+	*d->header = *b[can_cbuff->cbuff.head].header;
+	memcpy(d->data, b[can_cbuff->cbuff.head].data, CAN_DATA_SIZE);
+
+	/* The Rx FIFO 0 ISR adds frames (count += 1); it must not split this update */
+	HAL_NVIC_DisableIRQ(CAN1_RX0_IRQn);
 	can_cbuff->cbuff.head = (can_cbuff->cbuff.head + 1) % can_cbuff->cbuff.size;
 	can_cbuff->cbuff.count -= 1;
+	HAL_NVIC_EnableIRQ(CAN1_RX0_IRQn);
 
 #if CAN_RX_ENABLE_MULTITASKING == 1
 	osMutexRelease(can_cbuff->mutex);
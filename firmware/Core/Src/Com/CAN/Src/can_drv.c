@@ -11,24 +11,29 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "can_drv.h"
+#include "../../CanTp/Inc/cantp_hw.h"
 
+/* Tasks notified by the CAN ISRs, set when the tasks are created */
+TaskHandle_t canTxTaskHandle = NULL;
+TaskHandle_t canRxTaskHandle = NULL;
 
-static void CAN_TxMailBoxCompleteCallback(CAN_HandleTypeDef *hcan);
+
+static void CAN_TxMailBoxCompleteCallback(CAN_HandleTypeDef *hcan, uint32_t mailbox);
 
 
 void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-	CAN_TxMailBoxCompleteCallback(hcan);
+	CAN_TxMailBoxCompleteCallback(hcan, CAN_TX_MAILBOX0);
 }
 
 void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-	CAN_TxMailBoxCompleteCallback(hcan);
+	CAN_TxMailBoxCompleteCallback(hcan, CAN_TX_MAILBOX1);
 }
 
 void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-	CAN_TxMailBoxCompleteCallback(hcan);
+	CAN_TxMailBoxCompleteCallback(hcan, CAN_TX_MAILBOX2);
 }
 
 
@@ -39,8 +44,10 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
 	/* Add Rx Message to Rx Buffer */
 	CanIf_GetRxMessage(hcan);
 
-	/* Notify the task */
-	vTaskNotifyGiveFromISR(canRxTaskHandle, &xHigherPriorityTaskWoken);
+	/* Notify the task, once it exists */
+	if(canRxTaskHandle != NULL){
+		vTaskNotifyGiveFromISR(canRxTaskHandle, &xHigherPriorityTaskWoken);
+	}
 
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 
@@ -50,17 +57,24 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
  * @brief  Called when a CAN transmission mailbox completes.
  *         Notifies the task responsible for CAN transmission.
  *
+ *         A hardware paced ISO-TP sender gets the freed mailbox first.
+ *
  * @param  hcan pointer to a CAN_HandleTypeDef structure that contains
  *         the configuration information for the specified CAN.
+ * @param  mailbox the mailbox that completed (CAN_TX_MAILBOXx).
  */
 
-static void CAN_TxMailBoxCompleteCallback(CAN_HandleTypeDef *hcan)
+static void CAN_TxMailBoxCompleteCallback(CAN_HandleTypeDef *hcan, uint32_t mailbox)
 {
 	(void)hcan;
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-	/* Notify the task */
-	vTaskNotifyGiveFromISR(canTxTaskHandle, &xHigherPriorityTaskWoken);
+	CanTpHw_TxMailboxComplete(mailbox);
+
+	/* Notify the task, once it exists */
+	if(canTxTaskHandle != NULL){
+		vTaskNotifyGiveFromISR(canTxTaskHandle, &xHigherPriorityTaskWoken);
+	}
 
 	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
@@ -7,6 +7,7 @@
  */
 #include <can_cbuffer.h>
 #include <stdbool.h>
+#include <string.h>
 #include "can_if.h"
 #include "can_cfg.h"
 
@@ -15,8 +16,21 @@ extern CAN_HandleTypeDef hcan1;
 CAN_TxCBuffer_t txBuffer;
 CAN_RxCBuffer_t rxBuffer;
 
+/* ID held by each filter bank of CanIf_SetFilter() and its users, 0 users marks a free bank */
+static uint32_t filterIds[CAN_FILTER_LAST_BANK - CAN_FILTER_FIRST_BANK + 1];
+static uint8_t filterUsers[CAN_FILTER_LAST_BANK - CAN_FILTER_FIRST_BANK + 1];
+
+static void CanIf_SetId(CAN_TxHeaderTypeDef* header, uint32_t id);
+static CANIF_StatusTypeDef CanIf_ConfigFilter(uint8_t bank, uint32_t id, bool enable);
+static CANIF_StatusTypeDef CanIf_ConfigDefaultFilter(bool narrow);
+static bool CanIf_FiltersInUse(void);
+
 
 bool CanIf_Init(void){
+	for(uint8_t i = 0; i <= CAN_FILTER_LAST_BANK - CAN_FILTER_FIRST_BANK; i++){
+		filterUsers[i] = 0;
+	}
+
 	return CAN_TxBuff_Init(&txBuffer) && CAN_RxBuff_Init(&rxBuffer);
 }
 
@@ -24,7 +38,7 @@ bool CanIf_Init(void){
 CANIF_StatusTypeDef CanIf_AddTxMessage(CAN_TxHeaderTypeDef *txHeader, uint8_t data[]){
 	CAN_TxMessage_t msg;
 
-	if(txHeader == NULL || data == NULL) return false;
+	if(txHeader == NULL || data == NULL) return CANIF_NOT_OK;
 
 	/* Prepare CAN message */
 	msg.data = data;
@@ -38,12 +52,75 @@ CANIF_StatusTypeDef CanIf_AddTxMessage(CAN_TxHeaderTypeDef *txHeader, uint8_t da
 	return CANIF_OK;
 }
 
+/**
+ * @brief Queues one data frame; id carries CAN_ID_EXT_FLAG for a 29-bit identifier.
+ */
+CANIF_StatusTypeDef CanIf_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc){
+	CAN_TxHeaderTypeDef header;
+	uint8_t payload[CAN_DATA_SIZE] = {0};
+
+	if(data == NULL || dlc > CAN_DATA_SIZE) return CANIF_NOT_OK;
+
+	/* Prepare CAN header */
+	CanIf_SetId(&header, id);
+	header.RTR = CAN_RTR_DATA;
+	header.DLC = dlc;
+	header.TransmitGlobalTime = DISABLE;
+	memcpy(payload, data, dlc);
+
+	if(CanIf_AddTxMessage(&header, payload) != CANIF_OK){
+		return CANIF_NOT_OK;
+	}
+
+	/* Start transmission right away if a mailbox is free */
+	if(HAL_CAN_GetTxMailboxesFreeLevel(&hcan1) > 0){
+		(void)CanIf_Transmit();
+	}
+
+	return CANIF_OK;
+}
+
+/**
+ * @brief Writes a frame straight into a free Tx mailbox, bypassing the Tx buffer.
+ *
+ * Intended for ISR context (CAN Tx / pacing timer ISRs). The mailbox used is
+ * returned so the caller can match its Tx complete callback.
+ */
+CANIF_StatusTypeDef CanIf_SendFrameFromIsr(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t* mailbox){
+	CAN_TxHeaderTypeDef header;
+	uint8_t payload[CAN_DATA_SIZE] = {0};
+
+	if(data == NULL || mailbox == NULL || dlc > CAN_DATA_SIZE) return CANIF_NOT_OK;
+	if(HAL_CAN_GetTxMailboxesFreeLevel(&hcan1) == 0) return CANIF_NOT_OK;
+
+	CanIf_SetId(&header, id);
+	header.RTR = CAN_RTR_DATA;
+	header.DLC = dlc;
+	header.TransmitGlobalTime = DISABLE;
+	memcpy(payload, data, dlc);
+
+	if(HAL_CAN_AddTxMessage(&hcan1, &header, payload, mailbox) != HAL_OK){
+		return CANIF_NOT_OK;
+	}
+
+	return CANIF_OK;
+}
+
 CANIF_StatusTypeDef CanIf_Transmit(void){
-	CAN_TxMessage_t msg;
+	CAN_TxHeaderTypeDef header;
+	uint8_t data[CAN_DATA_SIZE];
+	CAN_TxMessage_t msg = { .header = &header, .data = data };
 	uint32_t txMailbox;
 
+	HAL_StatusTypeDef status;
+
 	if(txBuffer.cbuff.Get(&txBuffer, &msg) == CBUFFER_OK){
-		if(HAL_CAN_AddTxMessage(&hcan1, msg.header, msg.data, &txMailbox) == HAL_OK){
+		/* Mailboxes are also filled from ISR context (CanIf_SendFrameFromIsr) */
+		taskENTER_CRITICAL();
+		status = HAL_CAN_AddTxMessage(&hcan1, msg.header, msg.data, &txMailbox);
+		taskEXIT_CRITICAL();
+
+		if(status == HAL_OK){
 			return CANIF_OK;
 		}
 	}
@@ -51,6 +128,26 @@ CANIF_StatusTypeDef CanIf_Transmit(void){
 	return CANIF_NOT_OK;
 }
 
+/**
+ * @brief Moves queued frames to the Tx mailboxes while mailboxes are free.
+ *
+ * Called by the CAN task when a mailbox completes.
+ */
+void CanIf_TransmitPending(void){
+	while(!CBuffer_IsEmpty(&txBuffer.cbuff) && HAL_CAN_GetTxMailboxesFreeLevel(&hcan1) > 0){
+		if(CanIf_Transmit() != CANIF_OK) return;
+	}
+}
+
+/**
+ * @brief Frames waiting in the Rx buffer.
+ *
+ * One aligned word read, so it is consistent even while the Rx ISR adds a frame.
+ */
+uint32_t CanIf_RxPending(void){
+	return ((volatile CBuffer_t*)&rxBuffer.cbuff)->count;
+}
+
 CANIF_StatusTypeDef CanIf_Receive(CAN_RxMessage_t* msg){
 	if(msg == NULL) return CANIF_NOT_OK;
 
@@ -70,7 +167,7 @@ void CanIf_GetRxMessage(CAN_HandleTypeDef *hcan){
     if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &header, data) != HAL_OK)
         return;
 
-    if (header.IDE != CAN_ID_STD || header.RTR != CAN_RTR_DATA)
+    if (header.RTR != CAN_RTR_DATA)
         return;
 
     /* Prepare CAN message */
@@ -82,4 +179,125 @@ void CanIf_GetRxMessage(CAN_HandleTypeDef *hcan){
     rxBuffer.cbuff.Add(&rxBuffer, &msg);
 }
 
+/**
+ * @brief Returns the ID of a received frame, with CAN_ID_EXT_FLAG for a 29-bit identifier.
+ */
+uint32_t CanIf_GetId(const CAN_RxHeaderTypeDef* header){
+	if(header->IDE == CAN_ID_EXT){
+		return header->ExtId | CAN_ID_EXT_FLAG;
+	}
+
+	return header->StdId;
+}
+
+/**
+ * @brief Lets frames with this ID (CAN_ID_EXT_FLAG for 29-bit) pass the
+ *        acceptance filter, or releases it again.
+ *
+ * Each ID gets a bank in 32-bit list mode; IDs registered more than once are
+ * counted and the bank is released by the last user. While any ID is
+ * registered, bank 0 is narrowed from accept-all to the diagnostic IDs
+ * (CAN_FILTER_DIAG_ID / CAN_FILTER_EXT_ID), so other 11-bit traffic no
+ * longer reaches the Rx FIFO; releasing the last ID opens it again.
+ */
+CANIF_StatusTypeDef CanIf_SetFilter(uint32_t id, bool enable){
+	int16_t free = -1;
+
+	for(uint8_t i = 0; i <= CAN_FILTER_LAST_BANK - CAN_FILTER_FIRST_BANK; i++){
+		if(filterUsers[i] == 0){
+			if(free < 0) free = i;
+			continue;
+		}
+		if(filterIds[i] != id) continue;
+
+		if(enable){
+			if(filterUsers[i] == UINT8_MAX) return CANIF_NOT_OK;
+			filterUsers[i]++;
+			return CANIF_OK;
+		}
+		if(--filterUsers[i] == 0){
+			if(CanIf_ConfigFilter((uint8_t)(CAN_FILTER_FIRST_BANK + i), id, false) != CANIF_OK) return CANIF_NOT_OK;
+			if(!CanIf_FiltersInUse()) return CanIf_ConfigDefaultFilter(false);
+		}
+		return CANIF_OK;
+	}
+
+	if(!enable || free < 0) return CANIF_NOT_OK;
+	if(CanIf_ConfigFilter((uint8_t)(CAN_FILTER_FIRST_BANK + free), id, true) != CANIF_OK) return CANIF_NOT_OK;
+
+	/* The ID has its bank before bank 0 stops passing it */
+	if(!CanIf_FiltersInUse() && CanIf_ConfigDefaultFilter(true) != CANIF_OK){
+		(void)CanIf_ConfigFilter((uint8_t)(CAN_FILTER_FIRST_BANK + free), id, false);
+		return CANIF_NOT_OK;
+	}
+	filterIds[free] = id;
+	filterUsers[free] = 1;
+
+	return CANIF_OK;
+}
 
+
+/* Both list entries of the bank hold the ID (STID / EXID, IDE in the 32-bit register layout) */
+static CANIF_StatusTypeDef CanIf_ConfigFilter(uint8_t bank, uint32_t id, bool enable){
+	CAN_FilterTypeDef filter;
+	uint32_t reg;
+
+	if((id & CAN_ID_EXT_FLAG) != 0){
+		reg = ((id & ~CAN_ID_EXT_FLAG) << 3) | CAN_ID_EXT;
+	}
+	else{
+		reg = id << 21;
+	}
+
+	filter.FilterBank = bank;
+	filter.FilterMode = CAN_FILTERMODE_IDLIST;
+	filter.FilterScale = CAN_FILTERSCALE_32BIT;
+	filter.FilterIdHigh = reg >> 16;
+	filter.FilterIdLow = reg & 0xFFFF;
+	filter.FilterMaskIdHigh = reg >> 16;
+	filter.FilterMaskIdLow = reg & 0xFFFF;
+	filter.FilterFIFOAssignment = CAN_RX_FIFO0;
+	filter.FilterActivation = enable ? ENABLE : DISABLE;
+	filter.SlaveStartFilterBank = CAN_FILTER_LAST_BANK + 1;
+
+	return (HAL_CAN_ConfigFilter(&hcan1, &filter) == HAL_OK) ? CANIF_OK : CANIF_NOT_OK;
+}
+
+/* Bank 0: accept-all as set up by MX_CAN_Init(), or the diagnostic IDs only */
+static CANIF_StatusTypeDef CanIf_ConfigDefaultFilter(bool narrow){
+	CAN_FilterTypeDef filter;
+
+	filter.FilterBank = 0;
+	filter.FilterMode = CAN_FILTERMODE_IDMASK;
+	filter.FilterScale = CAN_FILTERSCALE_16BIT;
+	filter.FilterIdLow = narrow ? CAN_FILTER_DIAG_ID : 0x0700;
+	filter.FilterMaskIdLow = narrow ? CAN_FILTER_DIAG_MASK : 0x0700;
+	filter.FilterIdHigh = narrow ? CAN_FILTER_EXT_ID : 0;
+	filter.FilterMaskIdHigh = narrow ? CAN_FILTER_EXT_MASK : 0;
+	filter.FilterFIFOAssignment = CAN_RX_FIFO0;
+	filter.FilterActivation = ENABLE;
+	filter.SlaveStartFilterBank = CAN_FILTER_LAST_BANK + 1;
+
+	return (HAL_CAN_ConfigFilter(&hcan1, &filter) == HAL_OK) ? CANIF_OK : CANIF_NOT_OK;
+}
+
+static bool CanIf_FiltersInUse(void){
+	for(uint8_t i = 0; i <= CAN_FILTER_LAST_BANK - CAN_FILTER_FIRST_BANK; i++){
+		if(filterUsers[i] != 0) return true;
+	}
+
+	return false;
+}
+
+static void CanIf_SetId(CAN_TxHeaderTypeDef* header, uint32_t id){
+	if((id & CAN_ID_EXT_FLAG) != 0){
+		header->StdId = 0;
+		header->ExtId = id & ~CAN_ID_EXT_FLAG;
+		header->IDE = CAN_ID_EXT;
+	}
+	else{
+		header->StdId = id;
+		header->ExtId = 0;
+		header->IDE = CAN_ID_STD;
+	}
+}
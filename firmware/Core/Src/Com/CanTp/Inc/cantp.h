@@ -0,0 +1,185 @@
+/*
+ * cantp.h
+ *
+ *  Created on: Jul 21, 2025
+ *      Author: Josu Alexandru
+ *
+ * @file cantp.h
+ * @brief ISO 15765-2 (ISO-TP) transport layer.
+ *
+ * The module is independent of the HAL: frames leave through the SendFrame
+ * callback of the link and enter through CanTp_RxFrame(). Time is passed in
+ * by the caller (ms), so the same code runs on target and on a host.
+ */
+
+#ifndef SRC_COM_CANTP_INC_CANTP_H_
+#define SRC_COM_CANTP_INC_CANTP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cantp_cfg.h"
+
+/* Enums */
+typedef enum{
+	CANTP_OK,
+	CANTP_NOT_OK,
+	CANTP_BUSY
+}CANTP_StatusTypeDef;
+
+/* N_Result values (ISO 15765-2) */
+typedef enum{
+	CANTP_N_OK,
+	CANTP_N_TIMEOUT_A,
+	CANTP_N_TIMEOUT_BS,
+	CANTP_N_TIMEOUT_CR,
+	CANTP_N_WRONG_SN,
+	CANTP_N_INVALID_FS,
+	CANTP_N_UNEXP_PDU,
+	CANTP_N_WFT_OVRN,
+	CANTP_N_BUFFER_OVFLW,
+	CANTP_N_ERROR
+}CanTp_ResultTypeDef;
+
+/* Protocol control information types */
+typedef enum{
+	CANTP_PCI_SF = 0x00,
+	CANTP_PCI_FF = 0x10,
+	CANTP_PCI_CF = 0x20,
+	CANTP_PCI_FC = 0x30
+}CanTp_PciTypeDef;
+
+/* Flow status values */
+typedef enum{
+	CANTP_FS_CTS   = 0x00,
+	CANTP_FS_WAIT  = 0x01,
+	CANTP_FS_OVFLW = 0x02
+}CanTp_FlowStatusTypeDef;
+
+typedef enum{
+	CANTP_TX_IDLE,
+	/* Next SF / FF / CF is due */
+	CANTP_TX_SEND,
+	/* Waiting for a flow control frame */
+	CANTP_TX_WAIT_FC,
+	/* Finished in ISR context, confirmed by CanTp_MainFunction() */
+	CANTP_TX_DONE
+}CanTp_TxStateTypeDef;
+
+typedef enum{
+	CANTP_RX_IDLE,
+	/* Waiting for a consecutive frame */
+	CANTP_RX_WAIT_CF
+}CanTp_RxStateTypeDef;
+
+
+/* Structures */
+typedef struct CanTp_Link CanTp_Link_t;
+
+/* Queues one CAN frame for transmission; returns false if it could not be queued */
+typedef bool (*CanTp_SendFrame_t)(uint32_t id, const uint8_t* data, uint8_t dlc);
+/* Reception finished (successfully or not); data is the buffer given to the link */
+typedef void (*CanTp_RxIndication_t)(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length);
+/* Transmission finished (successfully or not) */
+typedef void (*CanTp_TxConfirmation_t)(CanTp_Link_t* link, CanTp_ResultTypeDef result);
+/* Provides a reassembly buffer of length bytes for a new message, NULL if none is available */
+typedef uint8_t* (*CanTp_RxBufferRequest_t)(CanTp_Link_t* link, uint32_t length);
+/* Consumes len payload bytes at offset of the message being received; false aborts the reception */
+typedef bool (*CanTp_RxStream_t)(CanTp_Link_t* link, uint32_t offset, const uint8_t* data, uint32_t len);
+/* Arms the hardware pacing timer; CanTp_TxIsr() is expected after us microseconds */
+typedef void (*CanTp_StartTimer_t)(CanTp_Link_t* link, uint32_t us);
+
+typedef struct{
+	/* Shared with CanTp_TxIsr() on hardware paced links */
+	volatile CanTp_TxStateTypeDef state;
+	/* Result parked by CanTp_TxIsr() in CANTP_TX_DONE */
+	CanTp_ResultTypeDef result;
+	/* Message being sent, owned by the caller until confirmation */
+	const uint8_t* data;
+	uint32_t length;
+	uint32_t offset;
+	/* Next sequence number */
+	uint8_t sn;
+	/* Block size received in the last FC.CTS and frames left in the block */
+	uint8_t bs;
+	uint8_t bsLeft;
+	/* Consecutive FC.WAIT frames received */
+	uint8_t wftCount;
+	/* Separation time requested by the receiver in us */
+	uint32_t stMinUs;
+	/* Time the last CF was sent and whether STmin applies to the next one */
+	uint32_t lastCf;
+	bool paced;
+	/* N_As is running while a frame could not be queued */
+	bool asPending;
+	/* Deadline of the running timer (N_As or N_Bs) */
+	uint32_t deadline;
+}CanTp_TxState_t;
+
+typedef struct{
+	CanTp_RxStateTypeDef state;
+	/* Reassembly buffer, owned by the caller */
+	uint8_t* buff;
+	uint32_t size;
+	/* Message length announced by the sender */
+	uint32_t length;
+	uint32_t offset;
+	/* Expected sequence number */
+	uint8_t sn;
+	/* Block size advertised in the last FC.CTS and frames left before the next FC */
+	uint8_t bs;
+	uint8_t bsLeft;
+	/* FC.WAIT frames sent in a row */
+	uint8_t wftCount;
+	/* Receiver is not ready, answer with FC.WAIT */
+	bool hold;
+	/* The last FC sent was a FC.WAIT */
+	bool waitSent;
+	/* No buffer (or stream) was available at the FF, its payload is parked in ffData */
+	bool deferred;
+	uint8_t ffData[CANTP_CAN_DL];
+	uint8_t ffLen;
+	/* A flow control frame still has to be sent */
+	bool fcPending;
+	/* Deadline of the running timer (N_Cr, N_Ar or N_Br) */
+	uint32_t deadline;
+	/* Arrival of the SF / FF of the latest message */
+	uint32_t startTime;
+}CanTp_RxState_t;
+
+struct CanTp_Link{
+	/* Physical / response IDs, CANTP_ID_EXT marks 29-bit IDs */
+	uint32_t txId;
+	uint32_t rxId;
+	/* Flow control parameters advertised to the sender */
+	uint8_t blockSize;
+	uint8_t stMin;
+	/* Callbacks */
+	CanTp_SendFrame_t SendFrame;
+	CanTp_RxIndication_t RxIndication;
+	CanTp_TxConfirmation_t TxConfirmation;
+	/* Optional per message buffer allocation, replaces CanTp_SetRxBuffer() */
+	CanTp_RxBufferRequest_t RxBufferRequest;
+	/* Optional streaming sink; payload is passed on frame by frame, no buffer is used */
+	CanTp_RxStream_t RxStream;
+	/* Optional hardware pacing of consecutive frames (ISR context) */
+	CanTp_SendFrame_t SendFrameIsr;
+	CanTp_StartTimer_t StartTimer;
+	/* User data */
+	void* context;
+	CanTp_TxState_t tx;
+	CanTp_RxState_t rx;
+};
+
+
+/* Functions */
+extern bool CanTp_Init(CanTp_Link_t* link, uint32_t txId, uint32_t rxId, CanTp_SendFrame_t sendFrame);
+extern CANTP_StatusTypeDef CanTp_SetRxBuffer(CanTp_Link_t* link, uint8_t* buff, uint32_t size);
+extern void CanTp_SetRxHold(CanTp_Link_t* link, bool hold);
+extern CANTP_StatusTypeDef CanTp_Transmit(CanTp_Link_t* link, const uint8_t* data, uint32_t length, uint32_t now);
+extern void CanTp_RxFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now);
+extern void CanTp_MainFunction(CanTp_Link_t* link, uint32_t now);
+extern uint32_t CanTp_StMinToUs(uint8_t stMin);
+extern void CanTp_TxIsr(CanTp_Link_t* link, uint32_t now);
+extern bool CanTp_CheckLink(const CanTp_Link_t* link);
+
+#endif /* SRC_COM_CANTP_INC_CANTP_H_ */
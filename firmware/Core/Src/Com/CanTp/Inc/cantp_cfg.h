@@ -0,0 +1,60 @@
+/*
+ * cantp_cfg.h
+ *
+ *  Created on: Jul 21, 2025
+ *      Author: Josu Alexandru
+ */
+
+#ifndef SRC_COM_CANTP_INC_CANTP_CFG_H_
+#define SRC_COM_CANTP_INC_CANTP_CFG_H_
+
+#include <stdint.h>
+
+/* Defines */
+
+/* Classic CAN frame payload size */
+#define CANTP_CAN_DL ((uint8_t) 8)
+
+/* Frame padding (ISO 15765-2 recommends padding for OBD / UDS) */
+#define CANTP_PADDING_ENABLE 1
+#define CANTP_PADDING_BYTE   ((uint8_t) 0xCC)
+
+/* Flag marking a 29-bit identifier in a CanTp ID */
+#define CANTP_ID_EXT ((uint32_t) 0x80000000)
+
+/* Network layer timeouts in ms (ISO 15765-2 defaults) */
+#define CANTP_N_AS_TIMEOUT ((uint32_t) 1000)
+#define CANTP_N_AR_TIMEOUT ((uint32_t) 1000)
+#define CANTP_N_BS_TIMEOUT ((uint32_t) 1000)
+#define CANTP_N_CR_TIMEOUT ((uint32_t) 1000)
+
+/* Interval between FC.WAIT frames sent while the receiver is on hold */
+#define CANTP_N_BR_WAIT ((uint32_t) 500)
+
+/* Maximum number of FC.WAIT frames accepted / sent in a row */
+#define CANTP_WFT_MAX ((uint8_t) 8)
+
+/* Flow control parameters advertised by default to the sender */
+#define CANTP_RX_BLOCK_SIZE ((uint8_t) 0)
+#define CANTP_RX_STMIN      ((uint8_t) 0)
+
+/* Concurrent channels (8 OBD ECUs 0x7E8-0x7EF, functional and spare) */
+#define CANTP_CH_MAX ((uint8_t) 12)
+
+/* Receive ID of a channel that only transmits (functional requests) */
+#define CANTP_ID_NONE ((uint32_t) 0xFFFFFFFF)
+
+/* Reassembly buffer pool shared by all channels (16 KB) */
+#define CANTP_POOL_BLOCK_SIZE  ((uint32_t) 64)
+#define CANTP_POOL_BLOCK_COUNT ((uint32_t) 256)
+
+/* Adaptive flow control: pressure (percent of the CAN Rx ring or USB Tx
+ * ring in use) at which each back-off level is entered */
+#define CANTP_FC_LEVEL1_PCT ((uint8_t) 25)
+#define CANTP_FC_LEVEL2_PCT ((uint8_t) 40)
+#define CANTP_FC_LEVEL3_PCT ((uint8_t) 60)
+#define CANTP_FC_LEVEL4_PCT ((uint8_t) 80)
+/* Time the pressure must stay below a level before relaxing one step (ms) */
+#define CANTP_FC_RELAX_MS ((uint32_t) 200)
+
+#endif /* SRC_COM_CANTP_INC_CANTP_CFG_H_ */
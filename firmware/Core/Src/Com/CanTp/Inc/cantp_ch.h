@@ -0,0 +1,44 @@
+/*
+ * cantp_ch.h
+ *
+ *  Created on: Jul 28, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Concurrent ISO-TP channels keyed by (Tx ID, Rx ID).
+ *
+ * Each channel is a CanTp link; reassembly buffers are drawn from a shared
+ * block pool when a SF / FF arrives and returned right after the
+ * RxIndication callback, so the indication must consume (or copy) the data
+ * before returning. All functions are called from the CAN task.
+ *
+ * With a pacer installed (CanTpCh_SetPacer()), a channel sending a
+ * segmented message is handed to it when its flow control arrives, if the
+ * pacer is free, so its consecutive frames are timed by hardware; it is
+ * released once the transmission is over or the channel is closed.
+ */
+
+#ifndef SRC_COM_CANTP_INC_CANTP_CH_H_
+#define SRC_COM_CANTP_INC_CANTP_CH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cantp.h"
+
+/* Hardware pacing of a link's consecutive frames; attach fails while another link is attached */
+typedef bool (*CanTpCh_PacerAttach_t)(CanTp_Link_t* link);
+typedef void (*CanTpCh_PacerDetach_t)(CanTp_Link_t* link);
+
+/* Functions */
+extern bool CanTpCh_Init(CanTp_SendFrame_t sendFrame);
+extern CanTp_Link_t* CanTpCh_Open(uint32_t txId, uint32_t rxId, CanTp_RxIndication_t rxIndication,
+		CanTp_TxConfirmation_t txConfirmation, void* context);
+extern void CanTpCh_Close(CanTp_Link_t* link);
+extern CanTp_Link_t* CanTpCh_Find(uint32_t txId, uint32_t rxId);
+extern bool CanTpCh_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now);
+extern void CanTpCh_MainFunction(uint32_t now);
+extern void CanTpCh_SetFlowControl(uint8_t blockSize, uint8_t stMin);
+extern void CanTpCh_SetPacer(CanTpCh_PacerAttach_t attach, CanTpCh_PacerDetach_t detach);
+extern uint32_t CanTpCh_PoolFreeBytes(void);
+extern bool CanTpCh_Check(void);
+
+#endif /* SRC_COM_CANTP_INC_CANTP_CH_H_ */
@@ -0,0 +1,59 @@
+/*
+ * cantp_fc.h
+ *
+ *  Created on: Jul 31, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Adaptive flow control parameters for inbound ISO-TP messages.
+ *
+ * The receiver starts with BS = 0 / STmin = 0, the fastest a sender can go.
+ * When the CAN Rx ring or the USB Tx ring fills up, the block size and
+ * separation time advertised in the next FC.CTS frames are tightened step
+ * by step; once the pressure has stayed low for CANTP_FC_RELAX_MS they are
+ * relaxed again, one step at a time. Every change is reported through the
+ * log callback with its reason.
+ *
+ * New values apply from the next FC sent: a sender that got BS = 0 keeps
+ * its pace until the end of that message, which is why every back-off
+ * level uses a non zero block size.
+ */
+
+#ifndef SRC_COM_CANTP_INC_CANTP_FC_H_
+#define SRC_COM_CANTP_INC_CANTP_FC_H_
+
+#include <stdint.h>
+#include "cantp_cfg.h"
+
+/* Enums */
+typedef enum{
+	/* CAN Rx ring occupancy went up */
+	CANTP_FC_REASON_RX_RING,
+	/* USB Tx ring occupancy (host backpressure) went up */
+	CANTP_FC_REASON_USB,
+	/* Pressure stayed low for CANTP_FC_RELAX_MS */
+	CANTP_FC_REASON_RELAX
+}CanTpFc_ReasonTypeDef;
+
+/* Structures */
+typedef struct{
+	uint8_t level;
+	uint8_t blockSize;
+	uint8_t stMin;
+	CanTpFc_ReasonTypeDef reason;
+	/* Occupancy that caused the change, in percent */
+	uint8_t rxRingPct;
+	uint8_t usbPct;
+	uint32_t time;
+}CanTpFc_Change_t;
+
+/* Applies new parameters to the receivers */
+typedef void (*CanTpFc_Apply_t)(uint8_t blockSize, uint8_t stMin);
+/* Reports a change */
+typedef void (*CanTpFc_Log_t)(const CanTpFc_Change_t* change);
+
+/* Functions */
+extern void CanTpFc_Init(CanTpFc_Apply_t apply, CanTpFc_Log_t log);
+extern void CanTpFc_Update(uint32_t rxUsed, uint32_t rxSize, uint32_t usbUsed, uint32_t usbSize, uint32_t now);
+extern uint8_t CanTpFc_GetLevel(void);
+
+#endif /* SRC_COM_CANTP_INC_CANTP_FC_H_ */
@@ -0,0 +1,26 @@
+/*
+ * cantp_hw.h
+ *
+ *  Created on: Jul 24, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Hardware pacing of ISO-TP consecutive frames.
+ *
+ * One link at a time can be attached. Its CFs are then sent from ISR
+ * context: after STmin measured by the TIM5 microsecond timer from the end
+ * of the previous CF, or straight into every free mailbox when STmin is 0.
+ */
+
+#ifndef SRC_COM_CANTP_INC_CANTP_HW_H_
+#define SRC_COM_CANTP_INC_CANTP_HW_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cantp.h"
+
+/* Functions */
+extern bool CanTpHw_Attach(CanTp_Link_t* link);
+extern void CanTpHw_Detach(CanTp_Link_t* link);
+extern void CanTpHw_TxMailboxComplete(uint32_t mailbox);
+
+#endif /* SRC_COM_CANTP_INC_CANTP_HW_H_ */
@@ -0,0 +1,699 @@
+/*
+ * cantp.c
+ *
+ *  Created on: Jul 21, 2025
+ *      Author: Josu Alexandru
+ *
+ * @file cantp.c
+ * @brief ISO 15765-2 segmentation, reassembly and flow control.
+ *
+ * Sender side:   SF / FF + CF, honoring BS and STmin from FC.CTS, FC.WAIT
+ *                up to CANTP_WFT_MAX, N_As and N_Bs timeouts.
+ * Receiver side: SF / FF + CF reassembled straight into the caller buffer,
+ *                FC.CTS / FC.WAIT / FC.OVFLW, N_Ar and N_Cr timeouts.
+ */
+
+#include <string.h>
+#include "../Inc/cantp.h"
+
+/* Defines */
+#define CANTP_SF_MAX_DL    ((uint32_t) 7)
+#define CANTP_FF_MAX_DL_12 ((uint32_t) 4095)
+#define CANTP_CF_MAX_DL    ((uint32_t) 7)
+
+/* Functions prototype */
+static bool CanTp_TimeReached(uint32_t now, uint32_t deadline);
+static bool CanTp_Send(CanTp_Link_t* link, uint8_t frame[], uint8_t len);
+static bool CanTp_StMinElapsed(const CanTp_TxState_t* tx, uint32_t now);
+static bool CanTp_SendIsr(CanTp_Link_t* link, uint8_t frame[], uint8_t len);
+static bool CanTp_HwPaced(const CanTp_Link_t* link);
+static void CanTp_TxProcess(CanTp_Link_t* link, uint32_t now);
+static bool CanTp_TxNextFrame(CanTp_Link_t* link, uint32_t now, bool fromIsr);
+static void CanTp_TxComplete(CanTp_Link_t* link, CanTp_ResultTypeDef result, bool fromIsr);
+static void CanTp_TxFinish(CanTp_Link_t* link, CanTp_ResultTypeDef result);
+static void CanTp_RxFinish(CanTp_Link_t* link, CanTp_ResultTypeDef result);
+static void CanTp_RxSendFlowControl(CanTp_Link_t* link, uint32_t now);
+static bool CanTp_RxGetBuffer(CanTp_Link_t* link, uint32_t length);
+static bool CanTp_RxStore(CanTp_Link_t* link, const uint8_t* data, uint32_t len);
+static void CanTp_RxSingleFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc);
+static void CanTp_RxFirstFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now);
+static void CanTp_RxConsecutiveFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now);
+static void CanTp_RxFlowControl(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now);
+
+
+bool CanTp_Init(CanTp_Link_t* link, uint32_t txId, uint32_t rxId, CanTp_SendFrame_t sendFrame){
+	if(link == NULL || sendFrame == NULL) return false;
+
+	memset(link, 0, sizeof(*link));
+	link->txId = txId;
+	link->rxId = rxId;
+	link->blockSize = CANTP_RX_BLOCK_SIZE;
+	link->stMin = CANTP_RX_STMIN;
+	link->SendFrame = sendFrame;
+	link->tx.state = CANTP_TX_IDLE;
+	link->rx.state = CANTP_RX_IDLE;
+
+	return true;
+}
+
+CANTP_StatusTypeDef CanTp_SetRxBuffer(CanTp_Link_t* link, uint8_t* buff, uint32_t size){
+	if(link == NULL) return CANTP_NOT_OK;
+	if(link->rx.state != CANTP_RX_IDLE) return CANTP_BUSY;
+
+	link->rx.buff = buff;
+	link->rx.size = (buff != NULL) ? size : 0;
+
+	return CANTP_OK;
+}
+
+/**
+ * @brief Puts the receiver on hold.
+ *
+ * While on hold the receiver answers a FF, or the end of a block, with
+ * FC.WAIT every CANTP_N_BR_WAIT ms. Releasing the hold sends FC.CTS on the
+ * next CanTp_MainFunction() call. After CANTP_WFT_MAX FC.WAIT frames the
+ * reception is aborted with CANTP_N_WFT_OVRN.
+ */
+void CanTp_SetRxHold(CanTp_Link_t* link, bool hold){
+	if(link == NULL) return;
+
+	link->rx.hold = hold;
+}
+
+/**
+ * @brief Starts the transmission of a message.
+ *
+ * @param link   Link to send on.
+ * @param data   Message; it is read in place and must stay valid until
+ *               TxConfirmation is called.
+ * @param length Message length (1 .. 2^32-1, FF_DL escape above 4095).
+ * @param now    Current time in ms.
+ *
+ * @return CANTP_OK when started, CANTP_BUSY if a transmission is running,
+ *         CANTP_NOT_OK on invalid parameters.
+ *
+ * @note A SF that can be queued right away is confirmed before this returns.
+ */
+CANTP_StatusTypeDef CanTp_Transmit(CanTp_Link_t* link, const uint8_t* data, uint32_t length, uint32_t now){
+	if(link == NULL || data == NULL || length == 0) return CANTP_NOT_OK;
+	if(link->tx.state != CANTP_TX_IDLE) return CANTP_BUSY;
+
+	CanTp_TxState_t* const tx = &link->tx;
+
+	tx->data = data;
+	tx->length = length;
+	tx->offset = 0;
+	tx->sn = 0;
+	tx->bs = 0;
+	tx->bsLeft = 0;
+	tx->wftCount = 0;
+	tx->stMinUs = 0;
+	tx->lastCf = now;
+	tx->paced = false;
+	tx->asPending = false;
+	tx->state = CANTP_TX_SEND;
+
+	CanTp_TxProcess(link, now);
+
+	return CANTP_OK;
+}
+
+/**
+ * @brief Processes one received CAN frame addressed to this link.
+ *
+ * The caller filters on link->rxId before calling this function.
+ */
+void CanTp_RxFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now){
+	if(link == NULL || data == NULL || dlc == 0 || dlc > CANTP_CAN_DL) return;
+
+	switch(data[0] & 0xF0){
+	case CANTP_PCI_SF:
+		link->rx.startTime = now;
+		CanTp_RxSingleFrame(link, data, dlc);
+		break;
+	case CANTP_PCI_FF:
+		link->rx.startTime = now;
+		CanTp_RxFirstFrame(link, data, dlc, now);
+		break;
+	case CANTP_PCI_CF:
+		CanTp_RxConsecutiveFrame(link, data, dlc, now);
+		break;
+	case CANTP_PCI_FC:
+		CanTp_RxFlowControl(link, data, dlc, now);
+		break;
+	default:
+		/* Unknown PCI, ignored */
+		break;
+	}
+}
+
+/**
+ * @brief Runs the timers and sends pending frames.
+ *
+ * Must be called periodically (every tick or faster). Unless the link is
+ * hardware paced, STmin between consecutive frames is paced by the calls to
+ * this function and rounded up to whole ticks.
+ */
+void CanTp_MainFunction(CanTp_Link_t* link, uint32_t now){
+	if(link == NULL) return;
+
+	CanTp_TxState_t* const tx = &link->tx;
+	CanTp_RxState_t* const rx = &link->rx;
+
+	/* Sender */
+	if(tx->state == CANTP_TX_SEND){
+		if(tx->offset > 0 && CanTp_HwPaced(link)){
+			/* Owned by the ISR; wake it up if it stalled on a full mailbox */
+			if(tx->asPending && CanTp_TimeReached(now, tx->deadline)){
+				link->StartTimer(link, 0);
+			}
+		}
+		else{
+			CanTp_TxProcess(link, now);
+		}
+	}
+	else if(tx->state == CANTP_TX_WAIT_FC && CanTp_TimeReached(now, tx->deadline)){
+		CanTp_TxFinish(link, CANTP_N_TIMEOUT_BS);
+	}
+	else if(tx->state == CANTP_TX_DONE){
+		CanTp_TxFinish(link, tx->result);
+	}
+
+	/* Receiver */
+	if(rx->state == CANTP_RX_WAIT_CF){
+		/* Retry the buffer allocation refused at the FF */
+		if(rx->deferred && CanTp_RxGetBuffer(link, rx->length)){
+			rx->offset = 0;
+			if(CanTp_RxStore(link, rx->ffData, rx->ffLen)){
+				rx->deferred = false;
+			}
+			else{
+				rx->offset = rx->ffLen;
+			}
+		}
+
+		if(rx->fcPending || (rx->waitSent && ((!rx->hold && !rx->deferred) || CanTp_TimeReached(now, rx->deadline)))){
+			CanTp_RxSendFlowControl(link, now);
+		}
+		else if(!rx->waitSent && CanTp_TimeReached(now, rx->deadline)){
+			CanTp_RxFinish(link, CANTP_N_TIMEOUT_CR);
+		}
+	}
+}
+
+/**
+ * @brief Converts a STmin parameter to microseconds.
+ *
+ * 0x00-0x7F are milliseconds, 0xF1-0xF9 are 100-900 us. Reserved values
+ * are treated as the longest valid STmin (127 ms), as ISO 15765-2 requires.
+ */
+uint32_t CanTp_StMinToUs(uint8_t stMin){
+	if(stMin <= 0x7F) return (uint32_t)stMin * 1000;
+	if(stMin >= 0xF1 && stMin <= 0xF9) return (uint32_t)(stMin - 0xF0) * 100;
+
+	return 127000;
+}
+
+/**
+ * @brief Sends the next consecutive frame(s) of a hardware paced link.
+ *
+ * Called from the pacing timer ISR once STmin has elapsed, and from the CAN
+ * Tx mailbox ISR when STmin is 0 or a previous attempt found no free
+ * mailbox. With STmin = 0 as many CFs as there are free mailboxes are
+ * pushed; otherwise one CF is sent and the caller re-arms the timer once it
+ * has left the mailbox.
+ *
+ * While the sender is in CANTP_TX_SEND past the FF the CFs are owned by the
+ * ISR; end of block and end of message are handed back to the task through
+ * the state field, so both ISRs must run at the same preemption priority.
+ */
+void CanTp_TxIsr(CanTp_Link_t* link, uint32_t now){
+	if(link == NULL || !CanTp_HwPaced(link)) return;
+
+	while(link->tx.state == CANTP_TX_SEND && link->tx.offset > 0){
+		if(!CanTp_TxNextFrame(link, now, true)) return;
+		if(link->tx.stMinUs != 0) return;
+	}
+}
+
+/**
+ * @brief Checks the link state for inconsistencies (debug / test builds).
+ *
+ * Meant to be called between two CanTp calls, e.g. by a fuzzing harness
+ * after every frame; a false return means the state machine went wrong.
+ */
+bool CanTp_CheckLink(const CanTp_Link_t* link){
+	if(link == NULL) return false;
+
+	const CanTp_TxState_t* const tx = &link->tx;
+	const CanTp_RxState_t* const rx = &link->rx;
+
+	/* Sender */
+	if(tx->state > CANTP_TX_DONE || tx->sn > 0x0F || tx->bsLeft > tx->bs) return false;
+	if(tx->state != CANTP_TX_IDLE){
+		if(tx->data == NULL || tx->length == 0 || tx->offset > tx->length) return false;
+		if(tx->wftCount > CANTP_WFT_MAX) return false;
+	}
+	else if(tx->asPending){
+		return false;
+	}
+
+	/* Receiver */
+	if(rx->state > CANTP_RX_WAIT_CF || rx->sn > 0x0F || rx->bsLeft > rx->bs) return false;
+	if(rx->state == CANTP_RX_IDLE){
+		return !rx->fcPending && !rx->waitSent && !rx->deferred;
+	}
+	if(rx->offset >= rx->length || rx->wftCount > CANTP_WFT_MAX) return false;
+	if(rx->deferred){
+		return rx->ffLen <= CANTP_CAN_DL && rx->offset == rx->ffLen;
+	}
+	if(link->RxStream == NULL && (rx->buff == NULL || rx->length > rx->size)) return false;
+
+	return true;
+}
+
+
+/* Private functions */
+
+static bool CanTp_TimeReached(uint32_t now, uint32_t deadline){
+	return (int32_t)(now - deadline) >= 0;
+}
+
+static bool CanTp_Send(CanTp_Link_t* link, uint8_t frame[], uint8_t len){
+#if CANTP_PADDING_ENABLE == 1
+	memset(&frame[len], CANTP_PADDING_BYTE, CANTP_CAN_DL - len);
+	len = CANTP_CAN_DL;
+#endif
+
+	return link->SendFrame(link->txId, frame, len);
+}
+
+static bool CanTp_SendIsr(CanTp_Link_t* link, uint8_t frame[], uint8_t len){
+#if CANTP_PADDING_ENABLE == 1
+	memset(&frame[len], CANTP_PADDING_BYTE, CANTP_CAN_DL - len);
+	len = CANTP_CAN_DL;
+#endif
+
+	return link->SendFrameIsr(link->txId, frame, len);
+}
+
+static bool CanTp_HwPaced(const CanTp_Link_t* link){
+	return link->SendFrameIsr != NULL && link->StartTimer != NULL;
+}
+
+/*
+ * STmin is rounded up to whole ticks, plus one tick because the last CF
+ * may have been sent at the very end of its tick.
+ */
+static bool CanTp_StMinElapsed(const CanTp_TxState_t* tx, uint32_t now){
+	if(!tx->paced || tx->stMinUs == 0) return true;
+
+	const uint32_t ticks = (tx->stMinUs + 999) / 1000;
+
+	return (now - tx->lastCf) > ticks;
+}
+
+static void CanTp_TxProcess(CanTp_Link_t* link, uint32_t now){
+	CanTp_TxState_t* const tx = &link->tx;
+
+	while(tx->state == CANTP_TX_SEND){
+		/* CFs of a hardware paced link are sent by CanTp_TxIsr() */
+		if(tx->offset > 0 && CanTp_HwPaced(link)) return;
+		if(!CanTp_StMinElapsed(tx, now)) return;
+		if(!CanTp_TxNextFrame(link, now, false)) return;
+	}
+}
+
+/*
+ * Builds and queues the next SF / FF / CF and advances the sender state.
+ * Returns true if the frame went out and the sender is still in CANTP_TX_SEND.
+ */
+static bool CanTp_TxNextFrame(CanTp_Link_t* link, uint32_t now, bool fromIsr){
+	CanTp_TxState_t* const tx = &link->tx;
+	uint8_t frame[CANTP_CAN_DL];
+	uint8_t len;
+	uint32_t chunk;
+	bool sent;
+
+	/* Build the next frame */
+	if(tx->offset == 0 && tx->length <= CANTP_SF_MAX_DL){
+		chunk = tx->length;
+		frame[0] = CANTP_PCI_SF | (uint8_t)chunk;
+		memcpy(&frame[1], tx->data, chunk);
+		len = (uint8_t)(1 + chunk);
+	}
+	else if(tx->offset == 0 && tx->length <= CANTP_FF_MAX_DL_12){
+		chunk = CANTP_CAN_DL - 2;
+		frame[0] = CANTP_PCI_FF | (uint8_t)((tx->length >> 8) & 0x0F);
+		frame[1] = (uint8_t)tx->length;
+		memcpy(&frame[2], tx->data, chunk);
+		len = CANTP_CAN_DL;
+	}
+	else if(tx->offset == 0){
+		/* FF_DL escape sequence, 32-bit length */
+		chunk = CANTP_CAN_DL - 6;
+		frame[0] = CANTP_PCI_FF;
+		frame[1] = 0;
+		frame[2] = (uint8_t)(tx->length >> 24);
+		frame[3] = (uint8_t)(tx->length >> 16);
+		frame[4] = (uint8_t)(tx->length >> 8);
+		frame[5] = (uint8_t)tx->length;
+		memcpy(&frame[6], tx->data, chunk);
+		len = CANTP_CAN_DL;
+	}
+	else{
+		chunk = tx->length - tx->offset;
+		if(chunk > CANTP_CF_MAX_DL) chunk = CANTP_CF_MAX_DL;
+		frame[0] = CANTP_PCI_CF | tx->sn;
+		memcpy(&frame[1], &tx->data[tx->offset], chunk);
+		len = (uint8_t)(1 + chunk);
+	}
+
+	/* Queue it, N_As runs while no frame can be queued */
+	sent = fromIsr ? CanTp_SendIsr(link, frame, len) : CanTp_Send(link, frame, len);
+	if(!sent){
+		if(!tx->asPending){
+			tx->asPending = true;
+			tx->deadline = now + CANTP_N_AS_TIMEOUT;
+		}
+		else if(CanTp_TimeReached(now, tx->deadline)){
+			CanTp_TxComplete(link, CANTP_N_TIMEOUT_A, fromIsr);
+		}
+		return false;
+	}
+	tx->asPending = false;
+
+	/* Single frame, done */
+	if(tx->offset == 0 && tx->length <= CANTP_SF_MAX_DL){
+		tx->offset = tx->length;
+		CanTp_TxComplete(link, CANTP_N_OK, fromIsr);
+		return false;
+	}
+
+	/* First frame, wait for the receiver */
+	if(tx->offset == 0){
+		tx->offset = chunk;
+		tx->sn = 1;
+		tx->deadline = now + CANTP_N_BS_TIMEOUT;
+		tx->state = CANTP_TX_WAIT_FC;
+		return false;
+	}
+
+	/* Consecutive frame */
+	tx->offset += chunk;
+	tx->sn = (tx->sn + 1) & 0x0F;
+	tx->lastCf = now;
+	tx->paced = true;
+
+	if(tx->offset >= tx->length){
+		CanTp_TxComplete(link, CANTP_N_OK, fromIsr);
+		return false;
+	}
+
+	if(tx->bs != 0 && --tx->bsLeft == 0){
+		tx->deadline = now + CANTP_N_BS_TIMEOUT;
+		tx->state = CANTP_TX_WAIT_FC;
+		return false;
+	}
+
+	return true;
+}
+
+/* In ISR context the result is parked in CANTP_TX_DONE for CanTp_MainFunction() */
+static void CanTp_TxComplete(CanTp_Link_t* link, CanTp_ResultTypeDef result, bool fromIsr){
+	if(fromIsr){
+		link->tx.result = result;
+		link->tx.state = CANTP_TX_DONE;
+	}
+	else{
+		CanTp_TxFinish(link, result);
+	}
+}
+
+static void CanTp_TxFinish(CanTp_Link_t* link, CanTp_ResultTypeDef result){
+	link->tx.state = CANTP_TX_IDLE;
+	link->tx.asPending = false;
+
+	if(link->TxConfirmation != NULL){
+		link->TxConfirmation(link, result);
+	}
+}
+
+static void CanTp_RxFinish(CanTp_Link_t* link, CanTp_ResultTypeDef result){
+	CanTp_RxState_t* const rx = &link->rx;
+
+	rx->state = CANTP_RX_IDLE;
+	rx->fcPending = false;
+	rx->waitSent = false;
+
+	if(link->RxIndication != NULL){
+		link->RxIndication(link, result, (link->RxStream != NULL) ? NULL : rx->buff,
+				(result == CANTP_N_OK) ? rx->length : rx->offset);
+	}
+
+	/* A requested buffer belongs to the indication from here on */
+	if(link->RxBufferRequest != NULL){
+		rx->buff = NULL;
+		rx->size = 0;
+	}
+	rx->deferred = false;
+}
+
+/*
+ * Obtains a buffer from RxBufferRequest, or checks the one set by
+ * CanTp_SetRxBuffer(). A streaming link needs no buffer.
+ */
+static bool CanTp_RxGetBuffer(CanTp_Link_t* link, uint32_t length){
+	CanTp_RxState_t* const rx = &link->rx;
+
+	if(link->RxStream != NULL) return true;
+
+	if(link->RxBufferRequest != NULL){
+		rx->buff = link->RxBufferRequest(link, length);
+		rx->size = (rx->buff != NULL) ? length : 0;
+	}
+
+	return rx->buff != NULL && length <= rx->size;
+}
+
+/* Appends payload at rx->offset, to the buffer or to the stream */
+static bool CanTp_RxStore(CanTp_Link_t* link, const uint8_t* data, uint32_t len){
+	CanTp_RxState_t* const rx = &link->rx;
+
+	if(link->RxStream != NULL){
+		if(!link->RxStream(link, rx->offset, data, len)) return false;
+	}
+	else{
+		memcpy(&rx->buff[rx->offset], data, len);
+	}
+	rx->offset += len;
+
+	return true;
+}
+
+static void CanTp_RxSendFlowControl(CanTp_Link_t* link, uint32_t now){
+	CanTp_RxState_t* const rx = &link->rx;
+	uint8_t frame[CANTP_CAN_DL];
+	const CanTp_FlowStatusTypeDef fs = (rx->hold || rx->deferred) ? CANTP_FS_WAIT : CANTP_FS_CTS;
+
+	if(fs == CANTP_FS_WAIT && rx->wftCount >= CANTP_WFT_MAX){
+		/* Still no buffer, give up with FC.OVFLW */
+		if(rx->deferred){
+			frame[0] = CANTP_PCI_FC | CANTP_FS_OVFLW;
+			frame[1] = 0;
+			frame[2] = 0;
+			(void)CanTp_Send(link, frame, 3);
+			CanTp_RxFinish(link, CANTP_N_BUFFER_OVFLW);
+			return;
+		}
+		CanTp_RxFinish(link, CANTP_N_WFT_OVRN);
+		return;
+	}
+
+	frame[0] = CANTP_PCI_FC | fs;
+	frame[1] = link->blockSize;
+	frame[2] = link->stMin;
+
+	/* N_Ar runs while the CAN queue is full */
+	if(!CanTp_Send(link, frame, 3)){
+		if(!rx->fcPending){
+			rx->fcPending = true;
+			rx->deadline = now + CANTP_N_AR_TIMEOUT;
+		}
+		else if(CanTp_TimeReached(now, rx->deadline)){
+			CanTp_RxFinish(link, CANTP_N_TIMEOUT_A);
+		}
+		return;
+	}
+	rx->fcPending = false;
+
+	if(fs == CANTP_FS_WAIT){
+		rx->wftCount++;
+		rx->waitSent = true;
+		rx->deadline = now + CANTP_N_BR_WAIT;
+	}
+	else{
+		rx->wftCount = 0;
+		rx->waitSent = false;
+		rx->bs = link->blockSize;
+		rx->bsLeft = rx->bs;
+		rx->deadline = now + CANTP_N_CR_TIMEOUT;
+	}
+}
+
+static void CanTp_RxSingleFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc){
+	CanTp_RxState_t* const rx = &link->rx;
+	const uint32_t sfDl = data[0] & 0x0F;
+
+	if(sfDl == 0 || sfDl > CANTP_SF_MAX_DL || sfDl > (uint32_t)(dlc - 1)) return;
+
+	/* A new SF terminates a reception in progress */
+	if(rx->state != CANTP_RX_IDLE){
+		CanTp_RxFinish(link, CANTP_N_UNEXP_PDU);
+	}
+
+	rx->offset = 0;
+	rx->length = sfDl;
+
+	if(!CanTp_RxGetBuffer(link, sfDl)){
+		CanTp_RxFinish(link, CANTP_N_BUFFER_OVFLW);
+		return;
+	}
+
+	CanTp_RxFinish(link, CanTp_RxStore(link, &data[1], sfDl) ? CANTP_N_OK : CANTP_N_BUFFER_OVFLW);
+}
+
+static void CanTp_RxFirstFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now){
+	CanTp_RxState_t* const rx = &link->rx;
+	uint32_t ffDl;
+	uint8_t pci;
+	uint8_t frame[CANTP_CAN_DL];
+
+	/* A FF always uses the full frame */
+	if(dlc != CANTP_CAN_DL) return;
+
+	ffDl = ((uint32_t)(data[0] & 0x0F) << 8) | data[1];
+	pci = 2;
+	if(ffDl == 0){
+		ffDl = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) | ((uint32_t)data[4] << 8) | data[5];
+		pci = 6;
+		if(ffDl <= CANTP_FF_MAX_DL_12) return;
+	}
+	else if(ffDl <= CANTP_SF_MAX_DL){
+		return;
+	}
+
+	/* A new FF terminates a reception in progress */
+	if(rx->state != CANTP_RX_IDLE){
+		CanTp_RxFinish(link, CANTP_N_UNEXP_PDU);
+	}
+
+	rx->length = ffDl;
+	rx->offset = 0;
+	rx->deferred = false;
+
+	if(!CanTp_RxGetBuffer(link, ffDl)){
+		/* Allocated buffers may free up, hold the sender with FC.WAIT;
+		 * a message larger than the whole pool never fits, refuse it now */
+		if(link->RxBufferRequest != NULL && ffDl <= CANTP_POOL_BLOCK_SIZE * CANTP_POOL_BLOCK_COUNT){
+			rx->deferred = true;
+		}
+		else{
+			frame[0] = CANTP_PCI_FC | CANTP_FS_OVFLW;
+			frame[1] = 0;
+			frame[2] = 0;
+			(void)CanTp_Send(link, frame, 3);
+			CanTp_RxFinish(link, CANTP_N_BUFFER_OVFLW);
+			return;
+		}
+	}
+
+	/* A stream that cannot take the FF yet is held with FC.WAIT as well */
+	if(!rx->deferred && !CanTp_RxStore(link, &data[pci], CANTP_CAN_DL - pci)){
+		rx->deferred = true;
+	}
+	if(rx->deferred){
+		memcpy(rx->ffData, &data[pci], CANTP_CAN_DL - pci);
+		rx->ffLen = CANTP_CAN_DL - pci;
+		rx->offset = rx->ffLen;
+	}
+	rx->sn = 1;
+	rx->wftCount = 0;
+	rx->waitSent = false;
+	rx->fcPending = false;
+	rx->state = CANTP_RX_WAIT_CF;
+
+	CanTp_RxSendFlowControl(link, now);
+}
+
+static void CanTp_RxConsecutiveFrame(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now){
+	CanTp_RxState_t* const rx = &link->rx;
+	uint32_t chunk;
+
+	/* Not expected, or the sender ignored our FC */
+	if(rx->state != CANTP_RX_WAIT_CF || rx->fcPending || rx->waitSent) return;
+
+	if((data[0] & 0x0F) != rx->sn){
+		CanTp_RxFinish(link, CANTP_N_WRONG_SN);
+		return;
+	}
+
+	chunk = rx->length - rx->offset;
+	if(chunk > CANTP_CF_MAX_DL) chunk = CANTP_CF_MAX_DL;
+	if(chunk > (uint32_t)(dlc - 1)) return;
+
+	if(!CanTp_RxStore(link, &data[1], chunk)){
+		CanTp_RxFinish(link, CANTP_N_BUFFER_OVFLW);
+		return;
+	}
+	rx->sn = (rx->sn + 1) & 0x0F;
+
+	if(rx->offset >= rx->length){
+		CanTp_RxFinish(link, CANTP_N_OK);
+		return;
+	}
+
+	rx->deadline = now + CANTP_N_CR_TIMEOUT;
+
+	/* End of block */
+	if(rx->bs != 0 && --rx->bsLeft == 0){
+		CanTp_RxSendFlowControl(link, now);
+	}
+}
+
+static void CanTp_RxFlowControl(CanTp_Link_t* link, const uint8_t* data, uint8_t dlc, uint32_t now){
+	CanTp_TxState_t* const tx = &link->tx;
+
+	if(tx->state != CANTP_TX_WAIT_FC || dlc < 3) return;
+
+	switch(data[0] & 0x0F){
+	case CANTP_FS_CTS:
+		tx->bs = data[1];
+		tx->bsLeft = tx->bs;
+		tx->stMinUs = CanTp_StMinToUs(data[2]);
+		tx->wftCount = 0;
+		tx->paced = false;
+		tx->state = CANTP_TX_SEND;
+		if(CanTp_HwPaced(link)){
+			link->StartTimer(link, 0);
+		}
+		else{
+			CanTp_TxProcess(link, now);
+		}
+		break;
+	case CANTP_FS_WAIT:
+		if(++tx->wftCount > CANTP_WFT_MAX){
+			CanTp_TxFinish(link, CANTP_N_WFT_OVRN);
+		}
+		else{
+			tx->deadline = now + CANTP_N_BS_TIMEOUT;
+		}
+		break;
+	case CANTP_FS_OVFLW:
+		CanTp_TxFinish(link, CANTP_N_BUFFER_OVFLW);
+		break;
+	default:
+		CanTp_TxFinish(link, CANTP_N_INVALID_FS);
+		break;
+	}
+}
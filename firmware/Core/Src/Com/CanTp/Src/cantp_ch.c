@@ -0,0 +1,223 @@
+/*
+ * cantp_ch.c
+ *
+ *  Created on: Jul 28, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/cantp_ch.h"
+#include "../../../Util/Inc/block_pool.h"
+
+/* Structures */
+typedef struct{
+	/* Must stay the first member, the link is cast back to its channel */
+	CanTp_Link_t link;
+	bool used;
+	/* User indication, called before the buffer returns to the pool */
+	CanTp_RxIndication_t RxIndication;
+}CanTpCh_t;
+
+/* Functions prototype */
+static uint8_t* CanTpCh_RxBufferRequest(CanTp_Link_t* link, uint32_t length);
+static void CanTpCh_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length);
+
+/* Variables */
+static CanTpCh_t channels[CANTP_CH_MAX];
+static CanTp_SendFrame_t chSendFrame;
+/* Flow control parameters advertised by every channel */
+static uint8_t chBlockSize = CANTP_RX_BLOCK_SIZE;
+static uint8_t chStMin = CANTP_RX_STMIN;
+/* Hardware pacer, NULL when CFs are paced by CanTpCh_MainFunction() */
+static CanTpCh_PacerAttach_t chPacerAttach;
+static CanTpCh_PacerDetach_t chPacerDetach;
+
+static BlockPool_t pool;
+static uint8_t poolMem[CANTP_POOL_BLOCK_SIZE * CANTP_POOL_BLOCK_COUNT] __attribute__((aligned(4)));
+static uint16_t poolRuns[CANTP_POOL_BLOCK_COUNT];
+
+
+bool CanTpCh_Init(CanTp_SendFrame_t sendFrame){
+	if(sendFrame == NULL) return false;
+
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		channels[i].used = false;
+	}
+	chSendFrame = sendFrame;
+
+	return BlockPool_Init(&pool, poolMem, poolRuns, CANTP_POOL_BLOCK_SIZE, CANTP_POOL_BLOCK_COUNT);
+}
+
+/**
+ * @brief Opens a channel for an ID pair.
+ *
+ * @param txId   ID used for our SF / FF / CF / FC frames.
+ * @param rxId   ID the peer answers on, CANTP_ID_NONE for a transmit only
+ *               (functional) channel.
+ *
+ * @return The channel link, or NULL if the pair is open already or all
+ *         channels are in use.
+ */
+CanTp_Link_t* CanTpCh_Open(uint32_t txId, uint32_t rxId, CanTp_RxIndication_t rxIndication,
+		CanTp_TxConfirmation_t txConfirmation, void* context){
+	CanTpCh_t* free = NULL;
+
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		if(!channels[i].used){
+			if(free == NULL) free = &channels[i];
+			continue;
+		}
+		if(channels[i].link.txId == txId || (rxId != CANTP_ID_NONE && channels[i].link.rxId == rxId)){
+			return NULL;
+		}
+	}
+	if(free == NULL) return NULL;
+
+	if(!CanTp_Init(&free->link, txId, rxId, chSendFrame)) return NULL;
+
+	free->link.blockSize = chBlockSize;
+	free->link.stMin = chStMin;
+	free->link.RxBufferRequest = CanTpCh_RxBufferRequest;
+	free->link.RxIndication = CanTpCh_RxIndication;
+	free->link.TxConfirmation = txConfirmation;
+	free->link.context = context;
+	free->RxIndication = rxIndication;
+	free->used = true;
+
+	return &free->link;
+}
+
+/**
+ * @brief Closes a channel; a reception in progress is dropped silently.
+ */
+void CanTpCh_Close(CanTp_Link_t* link){
+	CanTpCh_t* const ch = (CanTpCh_t*)link;
+
+	if(ch == NULL || ch < &channels[0] || ch >= &channels[CANTP_CH_MAX] || !ch->used) return;
+
+	if(chPacerDetach != NULL){
+		chPacerDetach(link);
+	}
+	BlockPool_Free(&pool, link->rx.buff);
+	link->rx.buff = NULL;
+	ch->used = false;
+}
+
+CanTp_Link_t* CanTpCh_Find(uint32_t txId, uint32_t rxId){
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		if(channels[i].used && channels[i].link.txId == txId && channels[i].link.rxId == rxId){
+			return &channels[i].link;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Hands a received CAN frame to the channel listening on its ID.
+ *
+ * @return false if no channel receives on this ID.
+ */
+bool CanTpCh_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now){
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		if(channels[i].used && channels[i].link.rxId == id){
+			CanTp_Link_t* const link = &channels[i].link;
+
+			/* The CFs start with this flow control; take the pacer if it is free */
+			if(chPacerAttach != NULL && link->tx.state == CANTP_TX_WAIT_FC && link->SendFrameIsr == NULL){
+				(void)chPacerAttach(link);
+			}
+			CanTp_RxFrame(link, data, dlc, now);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void CanTpCh_MainFunction(uint32_t now){
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		if(!channels[i].used) continue;
+
+		CanTp_MainFunction(&channels[i].link, now);
+		/* Transmission over, the pacer is free for the next one */
+		if(chPacerDetach != NULL && channels[i].link.SendFrameIsr != NULL && channels[i].link.tx.state == CANTP_TX_IDLE){
+			chPacerDetach(&channels[i].link);
+		}
+	}
+}
+
+/**
+ * @brief Sets the BS / STmin advertised by all channels, open or opened later.
+ *
+ * Takes effect from the next FC frame of each channel (CanTpFc_Apply_t).
+ */
+void CanTpCh_SetFlowControl(uint8_t blockSize, uint8_t stMin){
+	chBlockSize = blockSize;
+	chStMin = stMin;
+
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		channels[i].link.blockSize = blockSize;
+		channels[i].link.stMin = stMin;
+	}
+}
+
+/**
+ * @brief Installs the hardware pacer (e.g. CanTpHw_Attach / CanTpHw_Detach), NULL removes it.
+ */
+void CanTpCh_SetPacer(CanTpCh_PacerAttach_t attach, CanTpCh_PacerDetach_t detach){
+	chPacerAttach = attach;
+	chPacerDetach = detach;
+}
+
+uint32_t CanTpCh_PoolFreeBytes(void){
+	return BlockPool_FreeCount(&pool) * CANTP_POOL_BLOCK_SIZE;
+}
+
+/**
+ * @brief Checks every open link and accounts for every pool block (debug / test builds).
+ *
+ * Between two calls into the channels the only pool blocks in use are the
+ * reassembly buffers of receptions in progress; anything else is a leak.
+ */
+bool CanTpCh_Check(void){
+	uint32_t held = 0;
+
+	if(!BlockPool_Check(&pool)) return false;
+
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		const CanTp_Link_t* const link = &channels[i].link;
+
+		if(!channels[i].used) continue;
+		if(!CanTp_CheckLink(link)) return false;
+
+		if(link->rx.buff != NULL){
+			const uint32_t blocks = BlockPool_RunLength(&pool, link->rx.buff);
+
+			/* A buffer outlives its reception only by mistake */
+			if(blocks == 0 || link->rx.state == CANTP_RX_IDLE) return false;
+			held += blocks;
+		}
+	}
+
+	return held == CANTP_POOL_BLOCK_COUNT - BlockPool_FreeCount(&pool);
+}
+
+
+/* Private functions */
+
+static uint8_t* CanTpCh_RxBufferRequest(CanTp_Link_t* link, uint32_t length){
+	(void)link;
+
+	return BlockPool_Alloc(&pool, length);
+}
+
+static void CanTpCh_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length){
+	CanTpCh_t* const ch = (CanTpCh_t*)link;
+
+	if(ch->RxIndication != NULL){
+		ch->RxIndication(link, result, data, length);
+	}
+
+	BlockPool_Free(&pool, data);
+}
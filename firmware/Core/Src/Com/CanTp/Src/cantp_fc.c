@@ -0,0 +1,114 @@
+/*
+ * cantp_fc.c
+ *
+ *  Created on: Jul 31, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/cantp_fc.h"
+
+/* Structures */
+typedef struct{
+	uint8_t blockSize;
+	uint8_t stMin;
+	uint8_t enterPct;
+}CanTpFc_Level_t;
+
+/* Functions prototype */
+static uint8_t CanTpFc_Percent(uint32_t used, uint32_t size);
+static void CanTpFc_SetLevel(uint8_t level, CanTpFc_ReasonTypeDef reason, uint8_t rxPct, uint8_t usbPct, uint32_t now);
+
+/* Variables */
+static const CanTpFc_Level_t levels[] = {
+	{ 0,  0x00, 0                   },
+	{ 16, 0x00, CANTP_FC_LEVEL1_PCT },
+	{ 8,  0xF5, CANTP_FC_LEVEL2_PCT },	/* 500 us */
+	{ 4,  0x02, CANTP_FC_LEVEL3_PCT },
+	{ 2,  0x0A, CANTP_FC_LEVEL4_PCT }
+};
+#define CANTP_FC_LEVELS ((uint8_t)(sizeof(levels) / sizeof(levels[0])))
+
+static uint8_t fcLevel;
+/* Last time the pressure was at or above the current level */
+static uint32_t fcLastBusy;
+static CanTpFc_Apply_t fcApply;
+static CanTpFc_Log_t fcLog;
+
+
+void CanTpFc_Init(CanTpFc_Apply_t apply, CanTpFc_Log_t log){
+	fcApply = apply;
+	fcLog = log;
+	fcLevel = 0;
+	fcLastBusy = 0;
+
+	if(fcApply != NULL){
+		fcApply(levels[0].blockSize, levels[0].stMin);
+	}
+}
+
+/**
+ * @brief Re-evaluates the flow control level, called periodically from the CAN task.
+ *
+ * Backing off is immediate and may skip levels; relaxing goes down one
+ * level per CANTP_FC_RELAX_MS of low pressure.
+ *
+ * @param rxUsed/rxSize    CAN Rx ring frames in use / capacity.
+ * @param usbUsed/usbSize  USB Tx ring bytes in use / capacity.
+ */
+void CanTpFc_Update(uint32_t rxUsed, uint32_t rxSize, uint32_t usbUsed, uint32_t usbSize, uint32_t now){
+	const uint8_t rxPct = CanTpFc_Percent(rxUsed, rxSize);
+	const uint8_t usbPct = CanTpFc_Percent(usbUsed, usbSize);
+	const uint8_t pct = (rxPct > usbPct) ? rxPct : usbPct;
+	uint8_t target = 0;
+
+	for(uint8_t i = 1; i < CANTP_FC_LEVELS; i++){
+		if(pct >= levels[i].enterPct) target = i;
+	}
+
+	if(target >= fcLevel){
+		fcLastBusy = now;
+		if(target > fcLevel){
+			CanTpFc_SetLevel(target, (rxPct >= usbPct) ? CANTP_FC_REASON_RX_RING : CANTP_FC_REASON_USB, rxPct, usbPct, now);
+		}
+	}
+	else if((uint32_t)(now - fcLastBusy) >= CANTP_FC_RELAX_MS){
+		fcLastBusy = now;
+		CanTpFc_SetLevel(fcLevel - 1, CANTP_FC_REASON_RELAX, rxPct, usbPct, now);
+	}
+}
+
+uint8_t CanTpFc_GetLevel(void){
+	return fcLevel;
+}
+
+
+/* Private functions */
+
+static uint8_t CanTpFc_Percent(uint32_t used, uint32_t size){
+	if(size == 0) return 0;
+	if(used >= size) return 100;
+
+	return (uint8_t)((used * 100) / size);
+}
+
+static void CanTpFc_SetLevel(uint8_t level, CanTpFc_ReasonTypeDef reason, uint8_t rxPct, uint8_t usbPct, uint32_t now){
+	CanTpFc_Change_t change;
+
+	fcLevel = level;
+
+	if(fcApply != NULL){
+		fcApply(levels[level].blockSize, levels[level].stMin);
+	}
+
+	if(fcLog != NULL){
+		change.level = level;
+		change.blockSize = levels[level].blockSize;
+		change.stMin = levels[level].stMin;
+		change.reason = reason;
+		change.rxRingPct = rxPct;
+		change.usbPct = usbPct;
+		change.time = now;
+		fcLog(&change);
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * cantp_hw.c
+ *
+ *  Created on: Jul 24, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include "can_if.h"
+#include "../Inc/cantp_hw.h"
+#include "../../../Util/Inc/time_us.h"
+
+/* Functions prototype */
+static bool CanTpHw_SendFrameIsr(uint32_t id, const uint8_t* data, uint8_t dlc);
+static void CanTpHw_StartTimer(CanTp_Link_t* link, uint32_t us);
+static void CanTpHw_TimerElapsed(void);
+
+/* Variables */
+static CanTp_Link_t* volatile pacedLink;
+/* Mailbox holding the last CF, STmin starts when it has been sent */
+static volatile uint32_t cfMailbox;
+static volatile bool cfInFlight;
+
+
+/**
+ * @brief Moves the consecutive frames of a link to ISR context.
+ *
+ * The link may be idle or waiting for a flow control: its CFs are not
+ * sent yet, so the ISRs cannot race with the task over them.
+ *
+ * @return false if another link is attached or the link is sending.
+ */
+bool CanTpHw_Attach(CanTp_Link_t* link){
+	if(link == NULL || pacedLink != NULL) return false;
+	if(link->tx.state != CANTP_TX_IDLE && link->tx.state != CANTP_TX_WAIT_FC) return false;
+
+	cfInFlight = false;
+	link->SendFrameIsr = CanTpHw_SendFrameIsr;
+	link->StartTimer = CanTpHw_StartTimer;
+	pacedLink = link;
+
+	return true;
+}
+
+void CanTpHw_Detach(CanTp_Link_t* link){
+	if(link == NULL || pacedLink != link) return;
+
+	HAL_NVIC_DisableIRQ(CAN1_TX_IRQn);
+	TimeUs_Cancel();
+	pacedLink = NULL;
+	link->SendFrameIsr = NULL;
+	link->StartTimer = NULL;
+	HAL_NVIC_EnableIRQ(CAN1_TX_IRQn);
+}
+
+/**
+ * @brief Called from the CAN Tx ISR for every completed mailbox.
+ *
+ * Starts STmin once the last CF has left its mailbox, or refills the
+ * mailboxes right away when STmin is 0 or the sender found none free.
+ */
+void CanTpHw_TxMailboxComplete(uint32_t mailbox){
+	CanTp_Link_t* const link = pacedLink;
+
+	if(link == NULL) return;
+
+	if(link->tx.state != CANTP_TX_SEND){
+		cfInFlight = false;
+		return;
+	}
+
+	if(cfInFlight && mailbox == cfMailbox){
+		cfInFlight = false;
+		if(link->tx.stMinUs != 0){
+			TimeUs_StartOneShot(link->tx.stMinUs, CanTpHw_TimerElapsed);
+			return;
+		}
+	}
+
+	if(link->tx.stMinUs == 0 || link->tx.asPending){
+		CanTp_TxIsr(link, HAL_GetTick());
+	}
+}
+
+
+/* Private functions */
+
+static bool CanTpHw_SendFrameIsr(uint32_t id, const uint8_t* data, uint8_t dlc){
+	uint32_t mailbox;
+
+	if(CanIf_SendFrameFromIsr(id, data, dlc, &mailbox) != CANIF_OK){
+		return false;
+	}
+
+	cfMailbox = mailbox;
+	cfInFlight = true;
+
+	return true;
+}
+
+static void CanTpHw_StartTimer(CanTp_Link_t* link, uint32_t us){
+	(void)link;
+
+	TimeUs_StartOneShot(us, CanTpHw_TimerElapsed);
+}
+
+static void CanTpHw_TimerElapsed(void){
+	CanTp_TxIsr(pacedLink, HAL_GetTick());
+}
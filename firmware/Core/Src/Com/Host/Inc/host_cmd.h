@@ -0,0 +1,47 @@
+/*
+ * host_cmd.h
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Runs the commands the host sends (HostIf_CmdTypeDef).
+ *
+ * Called by the diagnostic task: whole commands are taken from the USB Rx
+ * ring with HostIf_Receive() and handed, by type, to the handler of the
+ * module they drive. Each command is answered with one HOSTIF_MSG_CMD_ACK;
+ * a command stays in the ring until the Tx ring has room for that answer.
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_CMD_H_
+#define SRC_COM_HOST_INC_HOST_CMD_H_
+
+#include <stdint.h>
+#include "host_if.h"
+
+/* Defines */
+/* Commands run per pass of the diagnostic task */
+#define HOSTCMD_PER_PASS ((uint8_t) 4)
+#define HOSTCMD_ACK_SIZE ((uint16_t) 2)
+/* Tx ring room a handler sending messages must leave for the acknowledgement */
+#define HOSTCMD_ACK_ROOM ((uint32_t)(HOSTIF_HEADER_SIZE + HOSTCMD_ACK_SIZE))
+
+/* Enums */
+typedef enum{
+	HOSTCMD_OK,
+	/* No handler for the command type */
+	HOSTCMD_UNKNOWN,
+	/* Payload length or parameters rejected */
+	HOSTCMD_INVALID,
+	/* The module is running something else, send again later */
+	HOSTCMD_BUSY,
+	/* No room for the data yet, send again later */
+	HOSTCMD_FULL
+}HostCmd_StatusTypeDef;
+
+/* Handles the payload of one command */
+typedef HostCmd_StatusTypeDef (*HostCmd_Handler_t)(const uint8_t* data, uint16_t length, uint32_t now);
+
+/* Functions */
+extern void HostCmd_MainFunction(uint32_t now);
+
+#endif /* SRC_COM_HOST_INC_HOST_CMD_H_ */
@@ -0,0 +1,27 @@
+/*
+ * host_ddid.h
+ *
+ *  Created on: Aug 12, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Composite DIDs (uds_ddid) driven by the host; polls are sent
+ * already split into signals.
+ *
+ * HOSTIF_CMD_DDID_DEFINE defines a DID, its outcome and the handle for
+ * HOSTIF_CMD_DDID_POLL / HOSTIF_CMD_DDID_CLEAR come back in
+ * HOSTIF_MSG_DDID_DEFINED.
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_DDID_H_
+#define SRC_COM_HOST_INC_HOST_DDID_H_
+
+#include "../../../Uds/Inc/uds_ddid.h"
+#include "host_cmd.h"
+
+/* Functions */
+extern void HostDdid_Sink(uint8_t handle, const UdsDdid_Value_t* values, uint8_t count, void* context);
+extern HostCmd_StatusTypeDef HostDdid_CmdDefine(const uint8_t* data, uint16_t length, uint32_t now);
+extern HostCmd_StatusTypeDef HostDdid_CmdPoll(const uint8_t* data, uint16_t length, uint32_t now);
+extern HostCmd_StatusTypeDef HostDdid_CmdClear(const uint8_t* data, uint16_t length, uint32_t now);
+
+#endif /* SRC_COM_HOST_INC_HOST_DDID_H_ */
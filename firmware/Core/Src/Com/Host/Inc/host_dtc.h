@@ -0,0 +1,25 @@
+/*
+ * host_dtc.h
+ *
+ *  Created on: Aug 7, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Forwards streamed DTC reports (uds_dtc) to the host.
+ *
+ * Each UdsDtc_Event_t becomes one HOSTIF_MSG_DTC_* message as soon as it is
+ * decoded. DTC records are sent 4 bytes each, the DTC little endian like
+ * every other field.
+ *
+ * Usage:
+ *   UdsDtc_Read(txId, rxId, REPORT_DTC_BY_STATUS_MASK, 0, mask, HostDtc_Sink, NULL, now);
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_DTC_H_
+#define SRC_COM_HOST_INC_HOST_DTC_H_
+
+#include "../../../Uds/Inc/uds_dtc.h"
+
+/* Functions */
+extern bool HostDtc_Sink(const UdsDtc_Event_t* evt, void* context);
+
+#endif /* SRC_COM_HOST_INC_HOST_DTC_H_ */
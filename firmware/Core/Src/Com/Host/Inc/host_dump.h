@@ -0,0 +1,26 @@
+/*
+ * host_dump.h
+ *
+ *  Created on: Aug 9, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Forwards memory dumps (uds_dump) to the host.
+ *
+ * Every data chunk becomes one HOSTIF_MSG_DUMP_DATA message tagged with its
+ * memory address, so a block received twice simply overwrites itself on
+ * the host. HOSTIF_MSG_DUMP_END closes the dump with its statistics.
+ *
+ * The host starts a dump with HOSTIF_CMD_DUMP_START.
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_DUMP_H_
+#define SRC_COM_HOST_INC_HOST_DUMP_H_
+
+#include "../../../Uds/Inc/uds_dump.h"
+#include "host_cmd.h"
+
+/* Functions */
+extern bool HostDump_Sink(const UdsDump_Event_t* evt, void* context);
+extern HostCmd_StatusTypeDef HostDump_CmdStart(const uint8_t* data, uint16_t length, uint32_t now);
+
+#endif /* SRC_COM_HOST_INC_HOST_DUMP_H_ */
@@ -0,0 +1,32 @@
+/*
+ * host_flash.h
+ *
+ *  Created on: Aug 10, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Flashing (uds_flash) driven by the host.
+ *
+ * HOSTIF_CMD_FLASH_START starts the download; the image follows in
+ * HOSTIF_CMD_FLASH_DATA commands, which are buffered in a ring of
+ * HOSTFLASH_RING_SIZE bytes that HostFlash_Source() drains in order. A
+ * command that does not fit is answered HOSTCMD_FULL and sent again. The
+ * report goes out as HOSTIF_MSG_FLASH_END.
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_FLASH_H_
+#define SRC_COM_HOST_INC_HOST_FLASH_H_
+
+#include "../../../Uds/Inc/uds_flash.h"
+#include "host_cmd.h"
+
+/* Defines */
+/* Image bytes buffered ahead of the ECU, two blocks of UDS_FLASH_BLOCK_MAX */
+#define HOSTFLASH_RING_SIZE ((uint32_t) 4096)
+
+/* Functions */
+extern uint32_t HostFlash_Source(uint32_t offset, uint8_t* data, uint32_t len, void* context);
+extern void HostFlash_Done(const UdsFlash_Report_t* report, void* context);
+extern HostCmd_StatusTypeDef HostFlash_CmdStart(const uint8_t* data, uint16_t length, uint32_t now);
+extern HostCmd_StatusTypeDef HostFlash_CmdData(const uint8_t* data, uint16_t length, uint32_t now);
+
+#endif /* SRC_COM_HOST_INC_HOST_FLASH_H_ */
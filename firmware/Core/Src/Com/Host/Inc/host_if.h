@@ -0,0 +1,173 @@
+/*
+ * host_if.h
+ *
+ *  Created on: Jul 30, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Framed messages to and from the host over USB CDC.
+ *
+ * Every message is sent as
+ *   [HOSTIF_SYNC][type][length LSB][length MSB][payload ...]
+ * Multi-byte payload fields are little endian. Messages are appended to a
+ * Tx ring that is drained by USB IN transfers straight out of the ring.
+ *
+ * Commands from the host use the same framing. USB OUT packets are copied
+ * to an Rx ring by the USB ISR, which wakes hostRxTaskHandle; the task
+ * takes whole commands with HostIf_Receive(). While the ring has no room
+ * for another packet the OUT endpoint is not re-armed, so the host is held
+ * off by the USB flow control instead of losing bytes.
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_IF_H_
+#define SRC_COM_HOST_INC_HOST_IF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Defines */
+#define HOSTIF_SYNC         ((uint8_t) 0xA5)
+#define HOSTIF_HEADER_SIZE  ((uint16_t) 4)
+#define HOSTIF_TX_RING_SIZE ((uint32_t) 4096)
+/* Largest single USB IN transfer taken out of the ring */
+#define HOSTIF_TX_CHUNK     ((uint32_t) 1024)
+#define HOSTIF_RX_RING_SIZE ((uint32_t) 4096)
+/* One USB FS OUT packet, the room needed to re-arm the endpoint */
+#define HOSTIF_RX_PACKET    ((uint32_t) 64)
+/* Longest command payload (HOSTIF_CMD_FLASH_DATA: offset and 1 KB of image) */
+#define HOSTIF_RX_PAYLOAD_MAX ((uint16_t) 1028)
+
+/* Enums */
+typedef enum{
+	HOSTIF_OK,
+	HOSTIF_NOT_OK,
+	HOSTIF_FULL
+}HOSTIF_StatusTypeDef;
+
+/* Device to host message types */
+typedef enum{
+	/* ISO-TP stream: [rxId u32][length u32] */
+	HOSTIF_MSG_ISOTP_START = 0x10,
+	/* ISO-TP stream: [rxId u32][offset u32][data ...] */
+	HOSTIF_MSG_ISOTP_DATA  = 0x11,
+	/* ISO-TP stream: [rxId u32][result u8][received u32], result != 0 aborts */
+	HOSTIF_MSG_ISOTP_END   = 0x12,
+	/* Flow control change: [level u8][BS u8][STmin u8][reason u8][rxRing % u8][usb % u8][time ms u32] */
+	HOSTIF_MSG_FC_CHANGE   = 0x13,
+	/* DTC report: [txId u32][report type u8][availMask u8][formatId u8][count u16] */
+	HOSTIF_MSG_DTC_HEADER  = 0x20,
+	/* DTC report: [txId u32] then per DTC [dtc u24][status u8] */
+	HOSTIF_MSG_DTC_RECORDS = 0x21,
+	/* DTC report: [txId u32][offset u32][snapshot / extended data ...] */
+	HOSTIF_MSG_DTC_DATA    = 0x22,
+	/* DTC report: [txId u32][result u8][nrc u8][records u16], result != 0 aborts */
+	HOSTIF_MSG_DTC_END     = 0x23,
+	/* Memory dump: [txId u32][address u32][data ...] */
+	HOSTIF_MSG_DUMP_DATA   = 0x24,
+	/* Memory dump: [txId u32][result u8][nrc u8][bytes u32][requests u16][time ms u32], result != 0 aborts */
+	HOSTIF_MSG_DUMP_END    = 0x25,
+	/* Flashing: [txId u32][result u8][nrc u8][sid u8][bytes u32][time ms u32][bytes/s u32]
+	 * [host wait ms u32][ecu wait ms u32][block u16][retries u16], result != 0 failed */
+	HOSTIF_MSG_FLASH_END   = 0x26,
+	/* Periodic DIDs: [periodicId u32] then per sample [time ms u32][pdid u8][length u8][data, 7 bytes zero padded] */
+	HOSTIF_MSG_PDID_SAMPLES = 0x27,
+	/* Composite DID poll: [handle u8][count u8][size u8 per signal][values back to back] */
+	HOSTIF_MSG_DDID_VALUES = 0x28,
+	/* Response time profile, one per ECU / SID: [txId u32][sid u8][count u16][failures u16][pending u16]
+	 * [pendingMax u8][max ms u16][spare u16][first u16 x UDS_PROF_BUCKETS][complete u16 x UDS_PROF_BUCKETS] */
+	HOSTIF_MSG_PROF_ENTRY  = 0x29,
+	/* End of a profile report: [entries u8][dropped u16] */
+	HOSTIF_MSG_PROF_END    = 0x2A,
+	/* Sequence output (EMIT): [tag u8][data ...] */
+	HOSTIF_MSG_SEQ_EMIT    = 0x2B,
+	/* Sequence end: [result u8][fault u8][pc u16][steps u32][requests u32][time ms u32] */
+	HOSTIF_MSG_SEQ_END     = 0x2C,
+	/* Mode 01 poll response: [txId u32][time ms u32] then per PID [pid u8][length u8][data ...] */
+	HOSTIF_MSG_OBD_SAMPLES = 0x2D,
+	/* Mode 01 poll response decoded: [txId u32][time ms u32] then per PID [pid u8][unit u8][value i32],
+	 * value in thousandths of the unit (ObdPid_UnitTypeDef) */
+	HOSTIF_MSG_OBD_VALUES  = 0x2E,
+	/* Functional query, one per ECU response: [rxId u32][mode u8][nrc u8][latency ms u16][response ...] */
+	HOSTIF_MSG_OBD_RESPONSE = 0x2F,
+	/* Functional query end: [responses u16][lost u16][time ms u32] */
+	HOSTIF_MSG_OBD_QUERY_END = 0x30,
+	/* Answer to every host command: [cmd u8][status u8] (HostCmd_StatusTypeDef) */
+	HOSTIF_MSG_CMD_ACK     = 0x31,
+	/* Sequence program rejected by HOSTIF_CMD_SEQ_LOAD, sent before its acknowledgement: [pc u16] */
+	HOSTIF_MSG_SEQ_REJECTED = 0x32,
+	/* Composite DID defined by HOSTIF_CMD_DDID_DEFINE: [handle u8][result u8][nrc u8], result != 0 failed */
+	HOSTIF_MSG_DDID_DEFINED = 0x33
+}HostIf_MsgTypeDef;
+
+/* Host to device commands */
+typedef enum{
+	/* Flashing: [txId u32][rxId u32][address u32][length u32][alfid u8][dataFormat u8] */
+	HOSTIF_CMD_FLASH_START = 0x80,
+	/* Flashing: [offset u32][image data ...], offsets in order; HOSTCMD_FULL until the image buffer has room */
+	HOSTIF_CMD_FLASH_DATA  = 0x81,
+	/* Response time profile report: [reset u8], reset != 0 starts the profile over once it is sent;
+	 * HOSTCMD_FULL until the Tx ring can take the whole report */
+	HOSTIF_CMD_PROF_READ   = 0x82,
+	/* Response time profile: starts over, no payload */
+	HOSTIF_CMD_PROF_RESET  = 0x83,
+	/* Sequence program: [code ...], up to UDS_SEQ_CODE_MAX bytes */
+	HOSTIF_CMD_SEQ_LOAD    = 0x84,
+	/* Sequence: runs the loaded program, output in HOSTIF_MSG_SEQ_EMIT / HOSTIF_MSG_SEQ_END; no payload */
+	HOSTIF_CMD_SEQ_START   = 0x85,
+	/* Sequence: stops the program, HOSTIF_MSG_SEQ_END follows if it was running; no payload */
+	HOSTIF_CMD_SEQ_STOP    = 0x86,
+	/* Memory dump: [txId u32][rxId u32][method u8][address u32][length u32][alfid u8],
+	 * method 0 ReadMemoryByAddress, 1 RequestUpload */
+	HOSTIF_CMD_DUMP_START  = 0x87,
+	/* Composite DID: [txId u32][rxId u32][ddid u16][alfid u8] then per signal
+	 * [source u8][size u8][did u16][position u8][address u32], source 0 by DID, 1 by address */
+	HOSTIF_CMD_DDID_DEFINE = 0x88,
+	/* Composite DID: [handle u8], one read sent as HOSTIF_MSG_DDID_VALUES */
+	HOSTIF_CMD_DDID_POLL   = 0x89,
+	/* Composite DID: [handle u8], cleared on the ECU and released */
+	HOSTIF_CMD_DDID_CLEAR  = 0x8A
+}HostIf_CmdTypeDef;
+
+/* Structures */
+typedef struct{
+	uint8_t type;
+	uint16_t length;
+	uint8_t data[HOSTIF_RX_PAYLOAD_MAX];
+}HostIf_Cmd_t;
+
+/* Variables */
+/* Task woken by received USB data */
+extern TaskHandle_t hostRxTaskHandle;
+
+/* Functions */
+extern void HostIf_Init(void);
+extern HOSTIF_StatusTypeDef HostIf_Send(uint8_t type, const uint8_t* head, uint16_t headLen,
+		const uint8_t* data, uint16_t dataLen);
+extern uint32_t HostIf_TxFree(void);
+extern void HostIf_TxComplete(void);
+extern bool HostIf_RxPacket(const uint8_t* data, uint32_t len);
+extern HOSTIF_StatusTypeDef HostIf_Receive(HostIf_Cmd_t* cmd);
+
+/* Little endian field helpers */
+static inline void HostIf_PutU16(uint8_t* p, uint16_t v){
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void HostIf_PutU32(uint8_t* p, uint32_t v){
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t HostIf_GetU16(const uint8_t* p){
+	return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline uint32_t HostIf_GetU32(const uint8_t* p){
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#endif /* SRC_COM_HOST_INC_HOST_IF_H_ */
@@ -0,0 +1,40 @@
+/*
+ * host_isotp.h
+ *
+ *  Created on: Jul 30, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Streams ISO-TP receptions to the host as they arrive.
+ *
+ * Instead of reassembling a message and forwarding it at the end, every
+ * SF / FF / CF payload is appended to the USB Tx ring right away, so the
+ * host sees the first bytes one CAN frame after the FF. A reception is sent
+ * as HOSTIF_MSG_ISOTP_START, one HOSTIF_MSG_ISOTP_DATA per frame and a
+ * closing HOSTIF_MSG_ISOTP_END whose result tells the host to keep or drop
+ * the bytes received so far. The offset in every DATA record lets the host
+ * check that no frame was lost on the USB side.
+ *
+ * HostIsoTp_Open() opens a CanTpCh channel with both callbacks installed;
+ * every message received on it goes to the host until HostIsoTp_Close().
+ * The channel answers with flow control like any other, so it takes the
+ * place of the tester on that ID pair:
+ *   link = HostIsoTp_Open(0x7E0, 0x7E8);
+ *   ...
+ *   HostIsoTp_Close(link);
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_ISOTP_H_
+#define SRC_COM_HOST_INC_HOST_ISOTP_H_
+
+#include "../../CanTp/Inc/cantp.h"
+#include "../../CanTp/Inc/cantp_ch.h"
+#include "../../CanTp/Inc/cantp_fc.h"
+
+/* Functions */
+extern CanTp_Link_t* HostIsoTp_Open(uint32_t txId, uint32_t rxId);
+extern void HostIsoTp_Close(CanTp_Link_t* link);
+extern bool HostIsoTp_RxStream(CanTp_Link_t* link, uint32_t offset, const uint8_t* data, uint32_t len);
+extern void HostIsoTp_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length);
+extern void HostIsoTp_FcLog(const CanTpFc_Change_t* change);
+
+#endif /* SRC_COM_HOST_INC_HOST_ISOTP_H_ */
@@ -0,0 +1,32 @@
+/*
+ * host_obd.h
+ *
+ *  Created on: Aug 16, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Streams Mode 01 poll results (obd_poll) to the host.
+ *
+ * HostObd_Sink sends the values decoded on the device (obd_pid), six bytes
+ * per PID; HostObd_RawSink sends the data bytes as they came from the ECU.
+ *
+ * HostObd_QuerySink / HostObd_QueryDone forward functional queries
+ * (obd_query) response by response.
+ *
+ * Usage:
+ *   ObdPoll_Start(txId, rxId, signals, count, HostObd_Sink, NULL, &handle, now);
+ *   ObdQuery_StartCheck(HostObd_QuerySink, HostObd_QueryDone, NULL, now);
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_OBD_H_
+#define SRC_COM_HOST_INC_HOST_OBD_H_
+
+#include "../../../Obd/Inc/obd_poll.h"
+#include "../../../Obd/Inc/obd_query.h"
+
+/* Functions */
+extern bool HostObd_Sink(uint32_t txId, uint32_t time, const ObdPoll_Value_t* values, uint8_t count, void* context);
+extern bool HostObd_RawSink(uint32_t txId, uint32_t time, const ObdPoll_Value_t* values, uint8_t count, void* context);
+extern bool HostObd_QuerySink(const ObdQuery_Response_t* rsp, void* context);
+extern void HostObd_QueryDone(uint16_t responses, uint16_t lost, uint32_t duration, void* context);
+
+#endif /* SRC_COM_HOST_INC_HOST_OBD_H_ */
@@ -0,0 +1,24 @@
+/*
+ * host_pdid.h
+ *
+ *  Created on: Aug 11, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Streams periodic DID samples (uds_pdid) to the host.
+ *
+ * Each batch becomes one HOSTIF_MSG_PDID_SAMPLES message of fixed size
+ * records, so the host can index samples without parsing them.
+ *
+ * Usage:
+ *   UdsPdid_Start(txId, rxId, periodicId, SEND_AT_FAST_RATE, pdids, count, HostPdid_Sink, NULL, NULL, now);
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_PDID_H_
+#define SRC_COM_HOST_INC_HOST_PDID_H_
+
+#include "../../../Uds/Inc/uds_pdid.h"
+
+/* Functions */
+extern bool HostPdid_Sink(uint32_t periodicId, const UdsPdid_Sample_t* samples, uint8_t count, void* context);
+
+#endif /* SRC_COM_HOST_INC_HOST_PDID_H_ */
@@ -0,0 +1,27 @@
+/*
+ * host_prof.h
+ *
+ *  Created on: Aug 13, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Sends the response time profile (uds_prof) to the host.
+ *
+ * A report is one HOSTIF_MSG_PROF_ENTRY per ECU / SID pair followed by
+ * HOSTIF_MSG_PROF_END; with reset the profile starts over once the whole
+ * report went out. The host asks for it with HOSTIF_CMD_PROF_READ and
+ * clears it with HOSTIF_CMD_PROF_RESET.
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_PROF_H_
+#define SRC_COM_HOST_INC_HOST_PROF_H_
+
+#include <stdbool.h>
+#include "../../../Uds/Inc/uds_prof.h"
+#include "host_cmd.h"
+
+/* Functions */
+extern bool HostProf_Report(bool reset);
+extern HostCmd_StatusTypeDef HostProf_CmdRead(const uint8_t* data, uint16_t length, uint32_t now);
+extern HostCmd_StatusTypeDef HostProf_CmdReset(const uint8_t* data, uint16_t length, uint32_t now);
+
+#endif /* SRC_COM_HOST_INC_HOST_PROF_H_ */
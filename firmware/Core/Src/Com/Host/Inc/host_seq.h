@@ -0,0 +1,28 @@
+/*
+ * host_seq.h
+ *
+ *  Created on: Aug 15, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Sequences (uds_seq) driven by the host.
+ *
+ * HOSTIF_CMD_SEQ_LOAD, HOSTIF_CMD_SEQ_START and HOSTIF_CMD_SEQ_STOP map to
+ * UdsSeq_Load(), UdsSeq_Start() and UdsSeq_Stop(); a rejected program is
+ * reported with HOSTIF_MSG_SEQ_REJECTED. The output and the end of a
+ * sequence go to the host as HOSTIF_MSG_SEQ_EMIT and HOSTIF_MSG_SEQ_END.
+ */
+
+#ifndef SRC_COM_HOST_INC_HOST_SEQ_H_
+#define SRC_COM_HOST_INC_HOST_SEQ_H_
+
+#include "../../../Uds/Inc/uds_seq.h"
+#include "host_cmd.h"
+
+/* Functions */
+extern bool HostSeq_Sink(uint8_t tag, const uint8_t* data, uint16_t len, void* context);
+extern void HostSeq_Done(const UdsSeq_Report_t* report, void* context);
+extern HostCmd_StatusTypeDef HostSeq_CmdLoad(const uint8_t* data, uint16_t length, uint32_t now);
+extern HostCmd_StatusTypeDef HostSeq_CmdStart(const uint8_t* data, uint16_t length, uint32_t now);
+extern HostCmd_StatusTypeDef HostSeq_CmdStop(const uint8_t* data, uint16_t length, uint32_t now);
+
+#endif /* SRC_COM_HOST_INC_HOST_SEQ_H_ */
@@ -0,0 +1,72 @@
+/*
+ * host_cmd.c
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_cmd.h"
+#include "../Inc/host_flash.h"
+#include "../Inc/host_prof.h"
+#include "../Inc/host_seq.h"
+#include "../Inc/host_dump.h"
+#include "../Inc/host_ddid.h"
+
+/* Structures */
+typedef struct{
+	uint8_t type;
+	HostCmd_Handler_t handler;
+}HostCmd_Entry_t;
+
+/* Functions prototype */
+static HostCmd_StatusTypeDef HostCmd_Run(const HostIf_Cmd_t* cmd, uint32_t now);
+
+/* Variables */
+static const HostCmd_Entry_t hostCmds[] = {
+	{ HOSTIF_CMD_FLASH_START, HostFlash_CmdStart },
+	{ HOSTIF_CMD_FLASH_DATA,  HostFlash_CmdData },
+	{ HOSTIF_CMD_PROF_READ,   HostProf_CmdRead },
+	{ HOSTIF_CMD_PROF_RESET,  HostProf_CmdReset },
+	{ HOSTIF_CMD_SEQ_LOAD,    HostSeq_CmdLoad },
+	{ HOSTIF_CMD_SEQ_START,   HostSeq_CmdStart },
+	{ HOSTIF_CMD_SEQ_STOP,    HostSeq_CmdStop },
+	{ HOSTIF_CMD_DUMP_START,  HostDump_CmdStart },
+	{ HOSTIF_CMD_DDID_DEFINE, HostDdid_CmdDefine },
+	{ HOSTIF_CMD_DDID_POLL,   HostDdid_CmdPoll },
+	{ HOSTIF_CMD_DDID_CLEAR,  HostDdid_CmdClear }
+};
+
+/* Too large for the task stack */
+static HostIf_Cmd_t hostCmd;
+
+
+/**
+ * @brief Runs up to HOSTCMD_PER_PASS received commands and acknowledges them.
+ */
+void HostCmd_MainFunction(uint32_t now){
+	uint8_t ack[HOSTCMD_ACK_SIZE];
+
+	for(uint8_t i = 0; i < HOSTCMD_PER_PASS; i++){
+		if(HostIf_TxFree() < HOSTCMD_ACK_ROOM) return;
+		if(HostIf_Receive(&hostCmd) != HOSTIF_OK) return;
+
+		ack[0] = hostCmd.type;
+		ack[1] = (uint8_t)HostCmd_Run(&hostCmd, now);
+		(void)HostIf_Send(HOSTIF_MSG_CMD_ACK, ack, HOSTCMD_ACK_SIZE, NULL, 0);
+	}
+}
+
+
+/* Private functions */
+
+static HostCmd_StatusTypeDef HostCmd_Run(const HostIf_Cmd_t* cmd, uint32_t now){
+	for(uint8_t i = 0; i < sizeof(hostCmds) / sizeof(hostCmds[0]); i++){
+		if(hostCmds[i].type == cmd->type){
+			return hostCmds[i].handler(cmd->data, cmd->length, now);
+		}
+	}
+
+	return HOSTCMD_UNKNOWN;
+}
@@ -0,0 +1,145 @@
+/*
+ * host_ddid.c
+ *
+ *  Created on: Aug 12, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_ddid.h"
+
+/* Defines */
+#define HOSTDDID_HEAD_SIZE    ((uint16_t)(2 + UDS_DDID_MAX_SIGNALS))
+#define HOSTDDID_DEFINE_HEAD  ((uint16_t) 11)
+#define HOSTDDID_SIGNAL_SIZE  ((uint16_t) 9)
+#define HOSTDDID_DEFINED_SIZE ((uint16_t) 3)
+
+/* Structures */
+/* Definition in progress, context of its callback */
+typedef struct{
+	bool used;
+	uint8_t handle;
+}HostDdid_Define_t;
+
+/* Functions prototype */
+static void HostDdid_Defined(const Uds_Response_t* rsp, void* context);
+
+/* Variables */
+static HostDdid_Define_t defines[UDS_DDID_MAX_DEFS];
+/* Signal list of a command, copied by UdsDdid_Define() */
+static UdsDdid_Signal_t signals[UDS_DDID_MAX_SIGNALS];
+
+
+/**
+ * @brief UdsDdid_Sink_t sending one HOSTIF_MSG_DDID_VALUES message per poll.
+ *
+ * The values lie back to back in the response, so they are sent from there
+ * behind a head with the size of each signal.
+ */
+void HostDdid_Sink(uint8_t handle, const UdsDdid_Value_t* values, uint8_t count, void* context){
+	uint8_t head[HOSTDDID_HEAD_SIZE];
+	uint16_t len = 0;
+
+	(void)context;
+
+	if(count == 0 || count > UDS_DDID_MAX_SIGNALS) return;
+
+	head[0] = handle;
+	head[1] = count;
+	for(uint8_t i = 0; i < count; i++){
+		head[2 + i] = values[i].size;
+		len += values[i].size;
+	}
+
+	(void)HostIf_Send(HOSTIF_MSG_DDID_VALUES, head, (uint16_t)(2 + count), values[0].data, len);
+}
+
+/**
+ * @brief HOSTIF_CMD_DDID_DEFINE: [txId u32][rxId u32][ddid u16][alfid u8] then per signal
+ *        [source u8][size u8][did u16][position u8][address u32]
+ */
+HostCmd_StatusTypeDef HostDdid_CmdDefine(const uint8_t* data, uint16_t length, uint32_t now){
+	HostDdid_Define_t* def = NULL;
+	uint8_t count;
+	uint8_t handle;
+	UDS_StatusTypeDef status;
+
+	if(length <= HOSTDDID_DEFINE_HEAD || (length - HOSTDDID_DEFINE_HEAD) % HOSTDDID_SIGNAL_SIZE != 0) return HOSTCMD_INVALID;
+	if((length - HOSTDDID_DEFINE_HEAD) / HOSTDDID_SIGNAL_SIZE > UDS_DDID_MAX_SIGNALS) return HOSTCMD_INVALID;
+	count = (uint8_t)((length - HOSTDDID_DEFINE_HEAD) / HOSTDDID_SIGNAL_SIZE);
+
+	for(uint8_t i = 0; i < UDS_DDID_MAX_DEFS; i++){
+		if(!defines[i].used){
+			def = &defines[i];
+			break;
+		}
+	}
+	if(def == NULL) return HOSTCMD_BUSY;
+
+	for(uint8_t i = 0; i < count; i++){
+		const uint8_t* const p = &data[HOSTDDID_DEFINE_HEAD + i * HOSTDDID_SIGNAL_SIZE];
+
+		if(p[0] > UDS_DDID_BY_ADDRESS) return HOSTCMD_INVALID;
+		signals[i].source = (UdsDdid_SourceTypeDef)p[0];
+		signals[i].size = p[1];
+		signals[i].did = HostIf_GetU16(&p[2]);
+		signals[i].position = p[4];
+		signals[i].address = HostIf_GetU32(&p[5]);
+	}
+
+	status = UdsDdid_Define(HostIf_GetU32(&data[0]), HostIf_GetU32(&data[4]), HostIf_GetU16(&data[8]), data[10],
+			signals, count, HostDdid_Defined, def, &handle, now);
+	if(status == UDS_BUSY) return HOSTCMD_BUSY;
+	if(status != UDS_OK) return HOSTCMD_INVALID;
+
+	/* The outcome never comes back before UdsDdid_Define() returns */
+	def->used = true;
+	def->handle = handle;
+
+	return HOSTCMD_OK;
+}
+
+/**
+ * @brief HOSTIF_CMD_DDID_POLL: [handle u8]
+ */
+HostCmd_StatusTypeDef HostDdid_CmdPoll(const uint8_t* data, uint16_t length, uint32_t now){
+	UDS_StatusTypeDef status;
+
+	if(length != 1) return HOSTCMD_INVALID;
+
+	status = UdsDdid_Poll(data[0], HostDdid_Sink, NULL, NULL, now);
+	if(status == UDS_BUSY) return HOSTCMD_BUSY;
+
+	return (status == UDS_OK) ? HOSTCMD_OK : HOSTCMD_INVALID;
+}
+
+/**
+ * @brief HOSTIF_CMD_DDID_CLEAR: [handle u8]
+ */
+HostCmd_StatusTypeDef HostDdid_CmdClear(const uint8_t* data, uint16_t length, uint32_t now){
+	UDS_StatusTypeDef status;
+
+	if(length != 1) return HOSTCMD_INVALID;
+
+	status = UdsDdid_Clear(data[0], now);
+	if(status == UDS_BUSY) return HOSTCMD_BUSY;
+
+	return (status == UDS_OK) ? HOSTCMD_OK : HOSTCMD_INVALID;
+}
+
+
+/* Private functions */
+
+/* Uds_Callback_t of a definition, sends HOSTIF_MSG_DDID_DEFINED */
+static void HostDdid_Defined(const Uds_Response_t* rsp, void* context){
+	HostDdid_Define_t* const def = (HostDdid_Define_t*)context;
+	uint8_t msg[HOSTDDID_DEFINED_SIZE];
+
+	msg[0] = def->handle;
+	msg[1] = (uint8_t)rsp->result;
+	msg[2] = rsp->nrc;
+	def->used = false;
+
+	(void)HostIf_Send(HOSTIF_MSG_DDID_DEFINED, msg, HOSTDDID_DEFINED_SIZE, NULL, 0);
+}
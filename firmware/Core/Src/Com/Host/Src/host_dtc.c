@@ -0,0 +1,80 @@
+/*
+ * host_dtc.c
+ *
+ *  Created on: Aug 7, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_dtc.h"
+
+/* Defines */
+#define HOSTDTC_HEADER_SIZE   ((uint16_t) 9)
+#define HOSTDTC_RECORDS_SIZE  ((uint16_t) 4)
+#define HOSTDTC_DATA_SIZE     ((uint16_t) 8)
+#define HOSTDTC_END_SIZE      ((uint16_t) 8)
+#define HOSTDTC_RECORD_SIZE   ((uint16_t) 4)
+
+/* Functions prototype */
+static bool HostDtc_Room(uint32_t len);
+
+
+/**
+ * @brief UdsDtc_Sink_t sending the report to the host.
+ *
+ * Like HostIsoTp_RxStream(), a message is refused, and the reception
+ * aborted, when it would leave no room for the closing END message.
+ */
+bool HostDtc_Sink(const UdsDtc_Event_t* evt, void* context){
+	uint8_t head[HOSTDTC_HEADER_SIZE];
+
+	(void)context;
+
+	HostIf_PutU32(&head[0], evt->txId);
+
+	switch(evt->type){
+		case UDS_DTC_EVT_HEADER:
+			if(!HostDtc_Room(HOSTDTC_HEADER_SIZE)) return false;
+			head[4] = evt->subFunction;
+			head[5] = evt->availMask;
+			head[6] = evt->formatId;
+			HostIf_PutU16(&head[7], evt->count);
+			return HostIf_Send(HOSTIF_MSG_DTC_HEADER, head, HOSTDTC_HEADER_SIZE, NULL, 0) == HOSTIF_OK;
+
+		case UDS_DTC_EVT_RECORDS:{
+			uint8_t records[UDS_DTC_BATCH * HOSTDTC_RECORD_SIZE];
+			const uint16_t len = (uint16_t)(evt->recordCount * HOSTDTC_RECORD_SIZE);
+
+			if(!HostDtc_Room(HOSTDTC_RECORDS_SIZE + len)) return false;
+			for(uint8_t i = 0; i < evt->recordCount; i++){
+				HostIf_PutU32(&records[i * HOSTDTC_RECORD_SIZE], evt->records[i].dtc);
+				records[i * HOSTDTC_RECORD_SIZE + 3] = evt->records[i].status;
+			}
+			return HostIf_Send(HOSTIF_MSG_DTC_RECORDS, head, HOSTDTC_RECORDS_SIZE, records, len) == HOSTIF_OK;
+		}
+
+		case UDS_DTC_EVT_DATA:
+			if(!HostDtc_Room(HOSTDTC_DATA_SIZE + evt->length)) return false;
+			HostIf_PutU32(&head[4], evt->offset);
+			return HostIf_Send(HOSTIF_MSG_DTC_DATA, head, HOSTDTC_DATA_SIZE, evt->data, (uint16_t)evt->length) == HOSTIF_OK;
+
+		case UDS_DTC_EVT_END:
+			head[4] = (uint8_t)evt->result;
+			head[5] = evt->nrc;
+			HostIf_PutU16(&head[6], evt->total);
+			(void)HostIf_Send(HOSTIF_MSG_DTC_END, head, HOSTDTC_END_SIZE, NULL, 0);
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+
+/* Private functions */
+
+/* Room for a payload of len bytes plus the END message */
+static bool HostDtc_Room(uint32_t len){
+	return HostIf_TxFree() >= HOSTIF_HEADER_SIZE + len + HOSTIF_HEADER_SIZE + HOSTDTC_END_SIZE;
+}
@@ -0,0 +1,85 @@
+/*
+ * host_dump.c
+ *
+ *  Created on: Aug 9, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_dump.h"
+
+/* Defines */
+#define HOSTDUMP_DATA_SIZE   ((uint16_t) 8)
+#define HOSTDUMP_END_SIZE    ((uint16_t) 16)
+#define HOSTDUMP_START_SIZE  ((uint16_t) 18)
+/* Room a block needs before it is accepted */
+#define HOSTDUMP_BLOCK_ROOM  ((uint32_t)(HOSTIF_TX_RING_SIZE / 2))
+
+/* Functions prototype */
+static bool HostDump_Room(uint32_t len);
+
+
+/**
+ * @brief UdsDump_Sink_t sending the dump to the host.
+ *
+ * A block is only accepted while the Tx ring has room for a good part of
+ * it; otherwise it is refused and the ECU held with FC.WAIT until USB has
+ * caught up. Data is refused, and the block aborted, when it would leave
+ * no room for the closing END message.
+ */
+bool HostDump_Sink(const UdsDump_Event_t* evt, void* context){
+	uint8_t head[HOSTDUMP_END_SIZE];
+
+	(void)context;
+
+	HostIf_PutU32(&head[0], evt->txId);
+
+	switch(evt->type){
+		case UDS_DUMP_EVT_BLOCK:{
+			const uint32_t room = (evt->length < HOSTDUMP_BLOCK_ROOM) ? evt->length : HOSTDUMP_BLOCK_ROOM;
+
+			return HostDump_Room(HOSTDUMP_DATA_SIZE + room);
+		}
+
+		case UDS_DUMP_EVT_DATA:
+			if(!HostDump_Room(HOSTDUMP_DATA_SIZE + evt->length)) return false;
+			HostIf_PutU32(&head[4], evt->address);
+			return HostIf_Send(HOSTIF_MSG_DUMP_DATA, head, HOSTDUMP_DATA_SIZE, evt->data, (uint16_t)evt->length) == HOSTIF_OK;
+
+		case UDS_DUMP_EVT_END:
+			head[4] = (uint8_t)evt->result;
+			head[5] = evt->nrc;
+			HostIf_PutU32(&head[6], evt->bytes);
+			HostIf_PutU16(&head[10], evt->requests);
+			HostIf_PutU32(&head[12], evt->duration);
+			(void)HostIf_Send(HOSTIF_MSG_DUMP_END, head, HOSTDUMP_END_SIZE, NULL, 0);
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+
+/* Private functions */
+
+/* Room for a payload of len bytes plus the END message */
+static bool HostDump_Room(uint32_t len){
+	return HostIf_TxFree() >= HOSTIF_HEADER_SIZE + len + HOSTIF_HEADER_SIZE + HOSTDUMP_END_SIZE;
+}
+
+/**
+ * @brief HOSTIF_CMD_DUMP_START: [txId u32][rxId u32][method u8][address u32][length u32][alfid u8]
+ */
+HostCmd_StatusTypeDef HostDump_CmdStart(const uint8_t* data, uint16_t length, uint32_t now){
+	UDS_StatusTypeDef status;
+
+	if(length != HOSTDUMP_START_SIZE || data[8] > UDS_DUMP_UPLOAD) return HOSTCMD_INVALID;
+
+	status = UdsDump_Start(HostIf_GetU32(&data[0]), HostIf_GetU32(&data[4]), (UdsDump_MethodTypeDef)data[8],
+			HostIf_GetU32(&data[9]), HostIf_GetU32(&data[13]), data[17], HostDump_Sink, NULL, now);
+	if(status == UDS_BUSY) return HOSTCMD_BUSY;
+
+	return (status == UDS_OK) ? HOSTCMD_OK : HOSTCMD_INVALID;
+}
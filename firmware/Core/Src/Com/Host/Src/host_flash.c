@@ -0,0 +1,118 @@
+/*
+ * host_flash.c
+ *
+ *  Created on: Aug 10, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_flash.h"
+
+/* Defines */
+#define HOSTFLASH_END_SIZE   ((uint16_t) 31)
+#define HOSTFLASH_START_SIZE ((uint16_t) 18)
+#define HOSTFLASH_DATA_HEAD  ((uint16_t) 4)
+
+/* Variables */
+static uint8_t image[HOSTFLASH_RING_SIZE];
+/* Image offset of the oldest byte held and the bytes held; a byte at
+ * offset o sits at o % HOSTFLASH_RING_SIZE */
+static uint32_t imageOffset;
+static uint32_t imageCount;
+
+
+/**
+ * @brief UdsFlash_Source_t handing out the image received from the host.
+ *
+ * uds_flash reads the image once, in order; the bytes read are released.
+ */
+uint32_t HostFlash_Source(uint32_t offset, uint8_t* data, uint32_t len, void* context){
+	const uint32_t at = imageOffset % HOSTFLASH_RING_SIZE;
+	uint32_t first = HOSTFLASH_RING_SIZE - at;
+
+	(void)context;
+
+	if(offset != imageOffset) return 0;
+	if(len > imageCount) len = imageCount;
+	if(first > len) first = len;
+
+	memcpy(data, &image[at], first);
+	memcpy(&data[first], &image[0], len - first);
+	imageOffset += len;
+	imageCount -= len;
+
+	return len;
+}
+
+/**
+ * @brief UdsFlash_DoneCallback_t sending the report as HOSTIF_MSG_FLASH_END.
+ */
+void HostFlash_Done(const UdsFlash_Report_t* report, void* context){
+	uint8_t msg[HOSTFLASH_END_SIZE];
+
+	(void)context;
+
+	HostIf_PutU32(&msg[0], report->txId);
+	msg[4] = (uint8_t)report->result;
+	msg[5] = report->nrc;
+	msg[6] = report->sid;
+	HostIf_PutU32(&msg[7], report->bytes);
+	HostIf_PutU32(&msg[11], report->duration);
+	HostIf_PutU32(&msg[15], report->bytesPerSecond);
+	HostIf_PutU32(&msg[19], report->hostWait);
+	HostIf_PutU32(&msg[23], report->ecuWait);
+	HostIf_PutU16(&msg[27], report->blockLength);
+	HostIf_PutU16(&msg[29], report->retries);
+
+	(void)HostIf_Send(HOSTIF_MSG_FLASH_END, msg, HOSTFLASH_END_SIZE, NULL, 0);
+}
+
+/**
+ * @brief HOSTIF_CMD_FLASH_START: [txId u32][rxId u32][address u32][length u32][alfid u8][dataFormat u8]
+ */
+HostCmd_StatusTypeDef HostFlash_CmdStart(const uint8_t* data, uint16_t length, uint32_t now){
+	UDS_StatusTypeDef status;
+
+	if(length != HOSTFLASH_START_SIZE) return HOSTCMD_INVALID;
+	if(UdsFlash_IsRunning()) return HOSTCMD_BUSY;
+
+	imageOffset = 0;
+	imageCount = 0;
+	status = UdsFlash_Start(HostIf_GetU32(&data[0]), HostIf_GetU32(&data[4]), HostIf_GetU32(&data[8]),
+			HostIf_GetU32(&data[12]), data[16], data[17], HostFlash_Source, HostFlash_Done, NULL, now);
+
+	if(status == UDS_BUSY) return HOSTCMD_BUSY;
+
+	return (status == UDS_OK) ? HOSTCMD_OK : HOSTCMD_INVALID;
+}
+
+/**
+ * @brief HOSTIF_CMD_FLASH_DATA: [offset u32][image data ...]
+ *
+ * The offset must follow the data already received; data that does not
+ * fit whole is refused with HOSTCMD_FULL.
+ */
+HostCmd_StatusTypeDef HostFlash_CmdData(const uint8_t* data, uint16_t length, uint32_t now){
+	uint32_t len;
+	uint32_t at;
+	uint32_t first;
+
+	(void)now;
+
+	if(length < HOSTFLASH_DATA_HEAD || !UdsFlash_IsRunning()) return HOSTCMD_INVALID;
+	if(HostIf_GetU32(data) != imageOffset + imageCount) return HOSTCMD_INVALID;
+
+	len = length - HOSTFLASH_DATA_HEAD;
+	if(len > HOSTFLASH_RING_SIZE - imageCount) return HOSTCMD_FULL;
+
+	at = (imageOffset + imageCount) % HOSTFLASH_RING_SIZE;
+	first = HOSTFLASH_RING_SIZE - at;
+	if(first > len) first = len;
+	memcpy(&image[at], &data[HOSTFLASH_DATA_HEAD], first);
+	memcpy(&image[0], &data[HOSTFLASH_DATA_HEAD + first], len - first);
+	imageCount += len;
+
+	return HOSTCMD_OK;
+}
@@ -0,0 +1,233 @@
+/*
+ * host_if.c
+ *
+ *  Created on: Jul 30, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "usbd_cdc_if.h"
+#include "../Inc/host_if.h"
+
+/* Functions prototype */
+static void HostIf_RingWrite(const uint8_t* data, uint32_t len);
+static void HostIf_Kick(void);
+static uint32_t HostIf_RxCount(void);
+static void HostIf_RxPeek(uint8_t* data, uint32_t len);
+static void HostIf_RxDrop(uint32_t len);
+static void HostIf_RxResume(void);
+
+/* Variables */
+static uint8_t txRing[HOSTIF_TX_RING_SIZE];
+/* Write index, owned by senders */
+static volatile uint32_t txHead;
+/* Read index, advanced when a USB transfer completes */
+static volatile uint32_t txTail;
+/* Length of the USB transfer in progress, 0 when idle */
+static volatile uint32_t txInFlight;
+
+TaskHandle_t hostRxTaskHandle = NULL;
+static uint8_t rxRing[HOSTIF_RX_RING_SIZE];
+/* Write index, advanced by the USB ISR */
+static volatile uint32_t rxHead;
+/* Read index, owned by the receiving task */
+static volatile uint32_t rxTail;
+/* OUT endpoint left un-armed for lack of room */
+static volatile bool rxStalled;
+
+
+void HostIf_Init(void){
+	txHead = 0;
+	txTail = 0;
+	txInFlight = 0;
+	rxHead = 0;
+	rxTail = 0;
+	rxStalled = false;
+}
+
+/**
+ * @brief Queues one message for the host.
+ *
+ * The payload is given in two parts (fixed header fields and data) so that
+ * callers never assemble it in a temporary buffer. The message is either
+ * queued whole or not at all. Callable from tasks only.
+ *
+ * @return HOSTIF_FULL if the ring has no room for the whole message.
+ */
+HOSTIF_StatusTypeDef HostIf_Send(uint8_t type, const uint8_t* head, uint16_t headLen,
+		const uint8_t* data, uint16_t dataLen){
+	uint8_t header[HOSTIF_HEADER_SIZE];
+	const uint32_t payloadLen = (uint32_t)headLen + dataLen;
+
+	if((headLen != 0 && head == NULL) || (dataLen != 0 && data == NULL)) return HOSTIF_NOT_OK;
+	if(payloadLen > 0xFFFF) return HOSTIF_NOT_OK;
+
+	header[0] = HOSTIF_SYNC;
+	header[1] = type;
+	HostIf_PutU16(&header[2], (uint16_t)payloadLen);
+
+	taskENTER_CRITICAL();
+	if(HostIf_TxFree() < HOSTIF_HEADER_SIZE + payloadLen){
+		taskEXIT_CRITICAL();
+		return HOSTIF_FULL;
+	}
+	HostIf_RingWrite(header, HOSTIF_HEADER_SIZE);
+	HostIf_RingWrite(head, headLen);
+	HostIf_RingWrite(data, dataLen);
+	taskEXIT_CRITICAL();
+
+	HostIf_Kick();
+
+	return HOSTIF_OK;
+}
+
+/* Free bytes in the Tx ring (one slot is kept empty) */
+uint32_t HostIf_TxFree(void){
+	return (txTail + HOSTIF_TX_RING_SIZE - txHead - 1) % HOSTIF_TX_RING_SIZE;
+}
+
+/**
+ * @brief Called from CDC_TransmitCplt_FS (USB ISR) when an IN transfer is done.
+ */
+void HostIf_TxComplete(void){
+	UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+	txTail = (txTail + txInFlight) % HOSTIF_TX_RING_SIZE;
+	txInFlight = 0;
+	taskEXIT_CRITICAL_FROM_ISR(state);
+
+	HostIf_Kick();
+}
+
+/**
+ * @brief Called from CDC_Receive_FS (USB ISR) with one OUT packet.
+ *
+ * @return true if the endpoint may be re-armed, false once the ring has no
+ *         room for another packet; HostIf_Receive() re-arms it then.
+ */
+bool HostIf_RxPacket(const uint8_t* data, uint32_t len){
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+	const uint32_t head = rxHead;
+	const uint32_t free = (rxTail + HOSTIF_RX_RING_SIZE - head - 1) % HOSTIF_RX_RING_SIZE;
+	uint32_t first = HOSTIF_RX_RING_SIZE - head;
+	bool rearm;
+
+	/* Armed with a packet of room, so this only guards a bad length */
+	if(len > free) len = free;
+	if(first > len) first = len;
+	memcpy(&rxRing[head], data, first);
+	memcpy(&rxRing[0], &data[first], len - first);
+	rxHead = (head + len) % HOSTIF_RX_RING_SIZE;
+
+	rearm = (free - len) >= HOSTIF_RX_PACKET;
+	rxStalled = !rearm;
+	taskEXIT_CRITICAL_FROM_ISR(state);
+
+	if(hostRxTaskHandle != NULL){
+		vTaskNotifyGiveFromISR(hostRxTaskHandle, &xHigherPriorityTaskWoken);
+	}
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+
+	return rearm;
+}
+
+/**
+ * @brief Takes the next whole command from the Rx ring.
+ *
+ * Bytes that do not start a frame, and frames longer than
+ * HOSTIF_RX_PAYLOAD_MAX, are skipped up to the next HOSTIF_SYNC.
+ * Callable from one task only.
+ *
+ * @return HOSTIF_NOT_OK if no whole command has been received yet.
+ */
+HOSTIF_StatusTypeDef HostIf_Receive(HostIf_Cmd_t* cmd){
+	HOSTIF_StatusTypeDef status = HOSTIF_NOT_OK;
+	uint8_t header[HOSTIF_HEADER_SIZE];
+
+	while(HostIf_RxCount() >= HOSTIF_HEADER_SIZE){
+		uint16_t length;
+
+		HostIf_RxPeek(header, HOSTIF_HEADER_SIZE);
+		length = HostIf_GetU16(&header[2]);
+		if(header[0] != HOSTIF_SYNC || length > HOSTIF_RX_PAYLOAD_MAX){
+			HostIf_RxDrop(1);
+			continue;
+		}
+		if(HostIf_RxCount() < HOSTIF_HEADER_SIZE + (uint32_t)length) break;
+
+		HostIf_RxDrop(HOSTIF_HEADER_SIZE);
+		cmd->type = header[1];
+		cmd->length = length;
+		HostIf_RxPeek(cmd->data, length);
+		HostIf_RxDrop(length);
+		status = HOSTIF_OK;
+		break;
+	}
+
+	HostIf_RxResume();
+
+	return status;
+}
+
+
+/* Private functions */
+
+static void HostIf_RingWrite(const uint8_t* data, uint32_t len){
+	uint32_t head = txHead;
+	uint32_t first = HOSTIF_TX_RING_SIZE - head;
+
+	if(len == 0) return;
+	if(first > len) first = len;
+
+	memcpy(&txRing[head], data, first);
+	memcpy(&txRing[0], &data[first], len - first);
+	txHead = (head + len) % HOSTIF_TX_RING_SIZE;
+}
+
+/* Starts an IN transfer of the contiguous data at the tail, if idle */
+static void HostIf_Kick(void){
+	uint32_t len;
+	UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+
+	if(txInFlight != 0 || txHead == txTail){
+		taskEXIT_CRITICAL_FROM_ISR(state);
+		return;
+	}
+
+	len = (txHead > txTail) ? (txHead - txTail) : (HOSTIF_TX_RING_SIZE - txTail);
+	if(len > HOSTIF_TX_CHUNK) len = HOSTIF_TX_CHUNK;
+
+	if(CDC_Transmit_FS(&txRing[txTail], (uint16_t)len) == USBD_OK){
+		txInFlight = len;
+	}
+	taskEXIT_CRITICAL_FROM_ISR(state);
+}
+
+static uint32_t HostIf_RxCount(void){
+	return (rxHead + HOSTIF_RX_RING_SIZE - rxTail) % HOSTIF_RX_RING_SIZE;
+}
+
+static void HostIf_RxPeek(uint8_t* data, uint32_t len){
+	const uint32_t tail = rxTail;
+	uint32_t first = HOSTIF_RX_RING_SIZE - tail;
+
+	if(first > len) first = len;
+	memcpy(data, &rxRing[tail], first);
+	memcpy(&data[first], &rxRing[0], len - first);
+}
+
+static void HostIf_RxDrop(uint32_t len){
+	rxTail = (rxTail + len) % HOSTIF_RX_RING_SIZE;
+}
+
+/* Re-arms the OUT endpoint held back by HostIf_RxPacket() once there is room */
+static void HostIf_RxResume(void){
+	taskENTER_CRITICAL();
+	if(rxStalled && (rxTail + HOSTIF_RX_RING_SIZE - rxHead - 1) % HOSTIF_RX_RING_SIZE >= HOSTIF_RX_PACKET){
+		rxStalled = false;
+		(void)CDC_ReceiveNext_FS();
+	}
+	taskEXIT_CRITICAL();
+}
@@ -0,0 +1,96 @@
+/*
+ * host_isotp.c
+ *
+ *  Created on: Jul 30, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_isotp.h"
+
+/* Defines */
+#define HOSTISOTP_START_SIZE  ((uint16_t) 8)
+#define HOSTISOTP_DATA_SIZE   ((uint16_t) 8)
+#define HOSTISOTP_END_SIZE    ((uint16_t) 9)
+#define HOSTISOTP_FC_SIZE     ((uint16_t) 10)
+
+
+/**
+ * @brief Opens a channel whose receptions are streamed to the host.
+ *
+ * @return The channel link, or NULL if the pair is in use or no channel is free.
+ */
+CanTp_Link_t* HostIsoTp_Open(uint32_t txId, uint32_t rxId){
+	CanTp_Link_t* const link = CanTpCh_Open(txId, rxId, HostIsoTp_RxIndication, NULL, NULL);
+
+	if(link != NULL){
+		link->RxStream = HostIsoTp_RxStream;
+	}
+
+	return link;
+}
+
+void HostIsoTp_Close(CanTp_Link_t* link){
+	CanTpCh_Close(link);
+}
+
+/**
+ * @brief CanTp_RxStream_t sink forwarding each frame payload to the host.
+ *
+ * Refuses the data when the Tx ring cannot take it together with the
+ * closing END record, so the end of a stream is never lost for lack of
+ * room. At the FF CanTp then holds the sender with FC.WAIT; later on the
+ * reception is aborted and the host is told so.
+ */
+bool HostIsoTp_RxStream(CanTp_Link_t* link, uint32_t offset, const uint8_t* data, uint32_t len){
+	uint8_t head[HOSTISOTP_DATA_SIZE];
+	uint32_t need = HOSTIF_HEADER_SIZE + HOSTISOTP_DATA_SIZE + len + HOSTIF_HEADER_SIZE + HOSTISOTP_END_SIZE;
+
+	if(offset == 0){
+		need += HOSTIF_HEADER_SIZE + HOSTISOTP_START_SIZE;
+	}
+	if(HostIf_TxFree() < need) return false;
+
+	HostIf_PutU32(&head[0], link->rxId);
+	if(offset == 0){
+		HostIf_PutU32(&head[4], link->rx.length);
+		if(HostIf_Send(HOSTIF_MSG_ISOTP_START, head, HOSTISOTP_START_SIZE, NULL, 0) != HOSTIF_OK) return false;
+	}
+
+	HostIf_PutU32(&head[4], offset);
+
+	return HostIf_Send(HOSTIF_MSG_ISOTP_DATA, head, HOSTISOTP_DATA_SIZE, data, (uint16_t)len) == HOSTIF_OK;
+}
+
+/**
+ * @brief Closes the stream; a result other than CANTP_N_OK aborts it on the host.
+ */
+void HostIsoTp_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length){
+	uint8_t head[HOSTISOTP_END_SIZE];
+
+	(void)data;
+
+	HostIf_PutU32(&head[0], link->rxId);
+	head[4] = (uint8_t)result;
+	HostIf_PutU32(&head[5], length);
+
+	(void)HostIf_Send(HOSTIF_MSG_ISOTP_END, head, HOSTISOTP_END_SIZE, NULL, 0);
+}
+
+/**
+ * @brief CanTpFc_Log_t reporting flow control changes to the host.
+ */
+void HostIsoTp_FcLog(const CanTpFc_Change_t* change){
+	uint8_t head[HOSTISOTP_FC_SIZE];
+
+	head[0] = change->level;
+	head[1] = change->blockSize;
+	head[2] = change->stMin;
+	head[3] = (uint8_t)change->reason;
+	head[4] = change->rxRingPct;
+	head[5] = change->usbPct;
+	HostIf_PutU32(&head[6], change->time);
+
+	(void)HostIf_Send(HOSTIF_MSG_FC_CHANGE, head, HOSTISOTP_FC_SIZE, NULL, 0);
+}
@@ -0,0 +1,104 @@
+/*
+ * host_obd.c
+ *
+ *  Created on: Aug 16, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <string.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_obd.h"
+#include "../../../Obd/Inc/obd_pid.h"
+
+/* Defines */
+#define HOSTOBD_HEAD_SIZE    ((uint16_t) 8)
+#define HOSTOBD_RECORDS_SIZE ((uint16_t)(OBD_MAX_PIDS_PER_REQUEST * (2 + OBD_PID_DATA_MAX)))
+#define HOSTOBD_VALUE_SIZE   ((uint16_t) 6)
+#define HOSTOBD_QUERY_HEAD_SIZE ((uint16_t) 8)
+#define HOSTOBD_QUERY_END_SIZE  ((uint16_t) 8)
+
+
+/**
+ * @brief ObdPoll_Sink_t sending the decoded values of one response as one message;
+ *        refused if the Tx ring is full.
+ */
+bool HostObd_Sink(uint32_t txId, uint32_t time, const ObdPoll_Value_t* values, uint8_t count, void* context){
+	uint8_t head[HOSTOBD_HEAD_SIZE];
+	uint8_t records[OBD_MAX_PIDS_PER_REQUEST * HOSTOBD_VALUE_SIZE];
+	uint8_t* p = records;
+
+	(void)context;
+
+	if(count > OBD_MAX_PIDS_PER_REQUEST) return false;
+
+	HostIf_PutU32(&head[0], txId);
+	HostIf_PutU32(&head[4], time);
+	for(uint8_t i = 0; i < count; i++){
+		p[0] = values[i].pid;
+		p[1] = (uint8_t)ObdPid_GetUnit(values[i].pid);
+		HostIf_PutU32(&p[2], (uint32_t)ObdPid_Decode(values[i].pid, values[i].data));
+		p += HOSTOBD_VALUE_SIZE;
+	}
+
+	return HostIf_Send(HOSTIF_MSG_OBD_VALUES, head, HOSTOBD_HEAD_SIZE, records, (uint16_t)(count * HOSTOBD_VALUE_SIZE)) == HOSTIF_OK;
+}
+
+/**
+ * @brief ObdPoll_Sink_t sending the data bytes of one response as one message;
+ *        refused if the Tx ring is full.
+ */
+bool HostObd_RawSink(uint32_t txId, uint32_t time, const ObdPoll_Value_t* values, uint8_t count, void* context){
+	uint8_t head[HOSTOBD_HEAD_SIZE];
+	uint8_t records[HOSTOBD_RECORDS_SIZE];
+	uint16_t len = 0;
+
+	(void)context;
+
+	if(count > OBD_MAX_PIDS_PER_REQUEST) return false;
+
+	HostIf_PutU32(&head[0], txId);
+	HostIf_PutU32(&head[4], time);
+	for(uint8_t i = 0; i < count; i++){
+		if(values[i].length > OBD_PID_DATA_MAX) return false;
+
+		records[len++] = values[i].pid;
+		records[len++] = values[i].length;
+		memcpy(&records[len], values[i].data, values[i].length);
+		len = (uint16_t)(len + values[i].length);
+	}
+
+	return HostIf_Send(HOSTIF_MSG_OBD_SAMPLES, head, HOSTOBD_HEAD_SIZE, records, len) == HOSTIF_OK;
+}
+
+/**
+ * @brief ObdQuery_Sink_t sending one ECU response as one message; refused if the Tx ring is full.
+ */
+bool HostObd_QuerySink(const ObdQuery_Response_t* rsp, void* context){
+	uint8_t head[HOSTOBD_QUERY_HEAD_SIZE];
+
+	(void)context;
+
+	if(rsp->length > UINT16_MAX) return false;
+
+	HostIf_PutU32(&head[0], rsp->rxId);
+	head[4] = rsp->mode;
+	head[5] = rsp->nrc;
+	HostIf_PutU16(&head[6], (uint16_t)((rsp->latency > UINT16_MAX) ? UINT16_MAX : rsp->latency));
+
+	return HostIf_Send(HOSTIF_MSG_OBD_RESPONSE, head, HOSTOBD_QUERY_HEAD_SIZE, rsp->data, (uint16_t)rsp->length) == HOSTIF_OK;
+}
+
+/**
+ * @brief ObdQuery_DoneCallback_t sending the end of the run.
+ */
+void HostObd_QueryDone(uint16_t responses, uint16_t lost, uint32_t duration, void* context){
+	uint8_t msg[HOSTOBD_QUERY_END_SIZE];
+
+	(void)context;
+
+	HostIf_PutU16(&msg[0], responses);
+	HostIf_PutU16(&msg[2], lost);
+	HostIf_PutU32(&msg[4], duration);
+
+	(void)HostIf_Send(HOSTIF_MSG_OBD_QUERY_END, msg, HOSTOBD_QUERY_END_SIZE, NULL, 0);
+}
@@ -0,0 +1,42 @@
+/*
+ * host_pdid.c
+ *
+ *  Created on: Aug 11, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_pdid.h"
+
+/* Defines */
+#define HOSTPDID_HEAD_SIZE   ((uint16_t) 4)
+#define HOSTPDID_RECORD_SIZE ((uint16_t)(6 + UDS_PDID_DATA_MAX))
+
+
+/**
+ * @brief UdsPdid_Sink_t sending a batch as one message; refused if the Tx ring is full.
+ */
+bool HostPdid_Sink(uint32_t periodicId, const UdsPdid_Sample_t* samples, uint8_t count, void* context){
+	uint8_t head[HOSTPDID_HEAD_SIZE];
+	uint8_t records[UDS_PDID_BATCH * HOSTPDID_RECORD_SIZE];
+
+	(void)context;
+
+	if(count > UDS_PDID_BATCH) return false;
+
+	HostIf_PutU32(head, periodicId);
+	memset(records, 0, (size_t)count * HOSTPDID_RECORD_SIZE);
+	for(uint8_t i = 0; i < count; i++){
+		uint8_t* const record = &records[i * HOSTPDID_RECORD_SIZE];
+
+		HostIf_PutU32(&record[0], samples[i].time);
+		record[4] = samples[i].pdid;
+		record[5] = samples[i].length;
+		memcpy(&record[6], samples[i].data, samples[i].length);
+	}
+
+	return HostIf_Send(HOSTIF_MSG_PDID_SAMPLES, head, HOSTPDID_HEAD_SIZE,
+			records, (uint16_t)(count * HOSTPDID_RECORD_SIZE)) == HOSTIF_OK;
+}
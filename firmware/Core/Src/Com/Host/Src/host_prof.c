@@ -0,0 +1,92 @@
+/*
+ * host_prof.c
+ *
+ *  Created on: Aug 13, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_prof.h"
+
+/* Defines */
+#define HOSTPROF_HEAD_SIZE  ((uint16_t) 16)
+#define HOSTPROF_ENTRY_SIZE ((uint16_t)(HOSTPROF_HEAD_SIZE + 4 * UDS_PROF_BUCKETS))
+#define HOSTPROF_END_SIZE   ((uint16_t) 3)
+
+
+/**
+ * @brief Sends every profile entry, then the end message.
+ *
+ * @return false if the Tx ring cannot take the whole report (and the
+ *         acknowledgement of the command asking for it); nothing is sent
+ *         and the profile is kept.
+ */
+bool HostProf_Report(bool reset){
+	uint16_t dropped;
+	const UdsProf_Entry_t* const entries = UdsProf_GetEntries(&dropped);
+	uint8_t msg[HOSTPROF_ENTRY_SIZE];
+	uint8_t count = 0;
+
+	for(uint8_t i = 0; i < UDS_PROF_ENTRIES; i++){
+		if(entries[i].used) count++;
+	}
+	if(HostIf_TxFree() < (uint32_t)count * (HOSTIF_HEADER_SIZE + HOSTPROF_ENTRY_SIZE)
+			+ HOSTIF_HEADER_SIZE + HOSTPROF_END_SIZE + HOSTCMD_ACK_ROOM) return false;
+
+	for(uint8_t i = 0; i < UDS_PROF_ENTRIES; i++){
+		const UdsProf_Entry_t* const entry = &entries[i];
+
+		if(!entry->used) continue;
+
+		HostIf_PutU32(&msg[0], entry->txId);
+		msg[4] = entry->sid;
+		HostIf_PutU16(&msg[5], entry->count);
+		HostIf_PutU16(&msg[7], entry->failures);
+		HostIf_PutU16(&msg[9], entry->pending);
+		msg[11] = entry->pendingMax;
+		HostIf_PutU16(&msg[12], entry->maxComplete);
+		/* Spare, keeps the buckets 16-bit aligned in the payload */
+		HostIf_PutU16(&msg[14], 0);
+		for(uint8_t b = 0; b < UDS_PROF_BUCKETS; b++){
+			HostIf_PutU16(&msg[HOSTPROF_HEAD_SIZE + 2 * b], entry->first[b]);
+			HostIf_PutU16(&msg[HOSTPROF_HEAD_SIZE + 2 * (UDS_PROF_BUCKETS + b)], entry->complete[b]);
+		}
+		(void)HostIf_Send(HOSTIF_MSG_PROF_ENTRY, msg, HOSTPROF_ENTRY_SIZE, NULL, 0);
+	}
+
+	msg[0] = count;
+	HostIf_PutU16(&msg[1], dropped);
+	(void)HostIf_Send(HOSTIF_MSG_PROF_END, msg, HOSTPROF_END_SIZE, NULL, 0);
+
+	if(reset){
+		UdsProf_Reset();
+	}
+
+	return true;
+}
+
+/**
+ * @brief HOSTIF_CMD_PROF_READ: [reset u8]
+ */
+HostCmd_StatusTypeDef HostProf_CmdRead(const uint8_t* data, uint16_t length, uint32_t now){
+	(void)now;
+
+	if(length != 1) return HOSTCMD_INVALID;
+
+	return HostProf_Report(data[0] != 0) ? HOSTCMD_OK : HOSTCMD_FULL;
+}
+
+/**
+ * @brief HOSTIF_CMD_PROF_RESET, no payload.
+ */
+HostCmd_StatusTypeDef HostProf_CmdReset(const uint8_t* data, uint16_t length, uint32_t now){
+	(void)data;
+	(void)now;
+
+	if(length != 0) return HOSTCMD_INVALID;
+
+	UdsProf_Reset();
+
+	return HOSTCMD_OK;
+}
@@ -0,0 +1,96 @@
+/*
+ * host_seq.c
+ *
+ *  Created on: Aug 15, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/host_if.h"
+#include "../Inc/host_seq.h"
+
+/* Defines */
+#define HOSTSEQ_END_SIZE      ((uint16_t) 16)
+#define HOSTSEQ_REJECTED_SIZE ((uint16_t) 2)
+
+
+/**
+ * @brief UdsSeq_Sink_t sending one HOSTIF_MSG_SEQ_EMIT; refused if the Tx ring is full.
+ */
+bool HostSeq_Sink(uint8_t tag, const uint8_t* data, uint16_t len, void* context){
+	(void)context;
+
+	return HostIf_Send(HOSTIF_MSG_SEQ_EMIT, &tag, 1, data, len) == HOSTIF_OK;
+}
+
+/**
+ * @brief UdsSeq_DoneCallback_t sending the report as HOSTIF_MSG_SEQ_END.
+ */
+void HostSeq_Done(const UdsSeq_Report_t* report, void* context){
+	uint8_t msg[HOSTSEQ_END_SIZE];
+
+	(void)context;
+
+	msg[0] = (uint8_t)report->result;
+	msg[1] = (uint8_t)report->fault;
+	HostIf_PutU16(&msg[2], report->pc);
+	HostIf_PutU32(&msg[4], report->steps);
+	HostIf_PutU32(&msg[8], report->requests);
+	HostIf_PutU32(&msg[12], report->duration);
+
+	(void)HostIf_Send(HOSTIF_MSG_SEQ_END, msg, HOSTSEQ_END_SIZE, NULL, 0);
+}
+
+/**
+ * @brief HOSTIF_CMD_SEQ_LOAD: [code ...]
+ */
+HostCmd_StatusTypeDef HostSeq_CmdLoad(const uint8_t* data, uint16_t length, uint32_t now){
+	uint8_t msg[HOSTSEQ_REJECTED_SIZE];
+	uint16_t errorPc = 0;
+	UDS_StatusTypeDef status;
+
+	(void)now;
+
+	if(HostIf_TxFree() < HOSTCMD_ACK_ROOM + HOSTIF_HEADER_SIZE + HOSTSEQ_REJECTED_SIZE) return HOSTCMD_FULL;
+
+	status = UdsSeq_Load(data, length, &errorPc);
+	if(status == UDS_BUSY) return HOSTCMD_BUSY;
+	if(status != UDS_OK){
+		HostIf_PutU16(msg, errorPc);
+		(void)HostIf_Send(HOSTIF_MSG_SEQ_REJECTED, msg, HOSTSEQ_REJECTED_SIZE, NULL, 0);
+		return HOSTCMD_INVALID;
+	}
+
+	return HOSTCMD_OK;
+}
+
+/**
+ * @brief HOSTIF_CMD_SEQ_START, no payload.
+ */
+HostCmd_StatusTypeDef HostSeq_CmdStart(const uint8_t* data, uint16_t length, uint32_t now){
+	UDS_StatusTypeDef status;
+
+	(void)data;
+
+	if(length != 0) return HOSTCMD_INVALID;
+
+	status = UdsSeq_Start(HostSeq_Sink, HostSeq_Done, NULL, now);
+	if(status == UDS_BUSY) return HOSTCMD_BUSY;
+
+	return (status == UDS_OK) ? HOSTCMD_OK : HOSTCMD_INVALID;
+}
+
+/**
+ * @brief HOSTIF_CMD_SEQ_STOP, no payload; waits for room for the end message.
+ */
+HostCmd_StatusTypeDef HostSeq_CmdStop(const uint8_t* data, uint16_t length, uint32_t now){
+	(void)data;
+	(void)now;
+
+	if(length != 0) return HOSTCMD_INVALID;
+	if(HostIf_TxFree() < HOSTCMD_ACK_ROOM + HOSTIF_HEADER_SIZE + HOSTSEQ_END_SIZE) return HOSTCMD_FULL;
+
+	UdsSeq_Stop();
+
+	return HOSTCMD_OK;
+}
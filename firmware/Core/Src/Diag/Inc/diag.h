@@ -0,0 +1,22 @@
+/*
+ * diag.h
+ *
+ *  Created on: Aug 2, 2025
+ *      Author: Josu Alexandru
+ */
+
+#ifndef SRC_DIAG_INC_DIAG_H_
+#define SRC_DIAG_INC_DIAG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines */
+/* Period of Diag_MainFunction() when no CAN event wakes the task (ms) */
+#define DIAG_MAIN_PERIOD ((uint32_t) 1)
+
+/* Functions */
+extern bool Diag_Init(void);
+extern void Diag_MainFunction(uint32_t now);
+
+#endif /* SRC_DIAG_INC_DIAG_H_ */
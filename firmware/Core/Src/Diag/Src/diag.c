@@ -13,3 +13,121 @@
  * and vehicle identification data (VIN).
  *
  */
+
+#include "../Inc/diag.h"
+#include "can_if.h"
+#include "../../Com/CanTp/Inc/cantp_ch.h"
+#include "../../Com/CanTp/Inc/cantp_fc.h"
+#include "../../Com/CanTp/Inc/cantp_hw.h"
+#include "../../Com/Host/Inc/host_if.h"
+#include "../../Com/Host/Inc/host_cmd.h"
+#include "../../Com/Host/Inc/host_isotp.h"
+#include "../../Uds/Inc/uds_services.h"
+#include "../../Uds/Inc/uds_rdbi.h"
+#include "../../Uds/Inc/uds_didcache.h"
+#include "../../Uds/Inc/uds_dtc.h"
+#include "../../Uds/Inc/uds_discovery.h"
+#include "../../Uds/Inc/uds_dump.h"
+#include "../../Uds/Inc/uds_flash.h"
+#include "../../Uds/Inc/uds_pdid.h"
+#include "../../Uds/Inc/uds_ddid.h"
+#include "../../Uds/Inc/uds_prof.h"
+#include "../../Uds/Inc/uds_server.h"
+#include "../../Uds/Inc/uds_seq.h"
+#include "../../Obd/Inc/obd_poll.h"
+#include "../../Obd/Inc/obd_supp.h"
+#include "../../Obd/Inc/obd_query.h"
+#include "../../Util/Inc/nv_store.h"
+
+/* Functions prototype */
+static bool Diag_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc);
+static bool Diag_SetFilter(uint32_t id, bool enable);
+
+/* Variables */
+static const ObdSupp_Store_t diagStore = { NvStore_Read, NvStore_Write, NvStore_Erase, NVSTORE_SIZE };
+
+
+/**
+ * @brief Sets up the transport and UDS layers, called once by the diagnostic task.
+ */
+bool Diag_Init(void){
+	if(!CanTpCh_Init(Diag_SendFrame)) return false;
+
+	/* CFs of segmented transmissions (TransferData, long writes) are timed by TIM5 */
+	CanTpCh_SetPacer(CanTpHw_Attach, CanTpHw_Detach);
+	CanTpFc_Init(CanTpCh_SetFlowControl, HostIsoTp_FcLog);
+	UdsRdbi_Init();
+	UdsDtc_Init();
+	UdsDisc_Init(Diag_SendFrame);
+	UdsDump_Init();
+	UdsFlash_Init();
+	UdsPdid_Init(Diag_SetFilter);
+	UdsDdid_Init();
+	UdsProf_Reset();
+	UdsServer_Init(Diag_SendFrame, Diag_SetFilter);
+	UdsSeq_Init();
+	ObdPoll_Init();
+	ObdSupp_Init(&diagStore);
+	ObdQuery_Init();
+	if(!UdsDidCache_Init()) return false;
+
+	return Uds_Init();
+}
+
+/**
+ * @brief One pass of the diagnostic task.
+ *
+ * Called whenever the CAN ISRs notify the task, and at least every
+ * DIAG_MAIN_PERIOD ms for the protocol timers.
+ */
+void Diag_MainFunction(uint32_t now){
+	CAN_RxHeaderTypeDef header;
+	uint8_t data[CAN_DATA_SIZE];
+	CAN_RxMessage_t msg = { .header = &header, .data = data };
+
+	Uds_SetTime(now);
+
+	/* Received frames; CAN_ID_EXT_FLAG and CANTP_ID_EXT are the same bit */
+	while(CanIf_Receive(&msg) == CANIF_OK){
+		const uint32_t id = CanIf_GetId(&header);
+
+		UdsDisc_RxFrame(id, data, (uint8_t)header.DLC, now);
+		/* Requests to the simulated ECU */
+		if(UdsServer_RxFrame(id, data, (uint8_t)header.DLC, now)) continue;
+		/* Periodic DID frames carry no ISO-TP PCI */
+		if(UdsPdid_RxFrame(id, data, (uint8_t)header.DLC, now)) continue;
+		(void)CanTpCh_RxFrame(id, data, (uint8_t)header.DLC, now);
+	}
+
+	/* Commands from the host */
+	HostCmd_MainFunction(now);
+
+	/* Frames waiting for a mailbox */
+	CanIf_TransmitPending();
+
+	CanTpCh_MainFunction(now);
+	Uds_MainFunction(now);
+	UdsRdbi_MainFunction(now);
+	UdsDisc_MainFunction(now);
+	UdsFlash_MainFunction(now);
+	UdsPdid_MainFunction(now);
+	UdsServer_MainFunction(now);
+	UdsSeq_MainFunction(now);
+	ObdPoll_MainFunction(now);
+	ObdQuery_MainFunction(now);
+	ObdSupp_MainFunction(now);
+
+	CanTpFc_Update(CanIf_RxPending(), CAN_RX_BUFFER_SIZE,
+			HOSTIF_TX_RING_SIZE - 1 - HostIf_TxFree(), HOSTIF_TX_RING_SIZE, now);
+}
+
+
+/* Private functions */
+
+static bool Diag_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc){
+	return CanIf_SendFrame(id, data, dlc) == CANIF_OK;
+}
+
+static bool Diag_SetFilter(uint32_t id, bool enable){
+	return CanIf_SetFilter(id, enable) == CANIF_OK;
+}
@@ -0,0 +1,71 @@
+/*
+ * obd_cfg.h
+ *
+ *  Created on: Aug 16, 2025
+ *      Author: Josu Alexandru
+ */
+
+#ifndef SRC_OBD_INC_OBD_CFG_H_
+#define SRC_OBD_INC_OBD_CFG_H_
+
+#include <stdint.h>
+
+/* Modes (SAE J1979 / ISO 15031-5) */
+#define OBD_MODE_CURRENT_DATA  ((uint8_t) 0x01)
+#define OBD_MODE_FREEZE_FRAME  ((uint8_t) 0x02)
+#define OBD_MODE_STORED_DTC    ((uint8_t) 0x03)
+#define OBD_MODE_PENDING_DTC   ((uint8_t) 0x07)
+#define OBD_MODE_VEHICLE_INFO  ((uint8_t) 0x09)
+#define OBD_MODE_PERMANENT_DTC ((uint8_t) 0x0A)
+
+/* Mode 09 InfoTypes (VIN, calibration IDs and verification numbers) and the VIN length */
+#define OBD_INFO_VIN     ((uint8_t) 0x02)
+#define OBD_INFO_CALID   ((uint8_t) 0x04)
+#define OBD_INFO_CVN     ((uint8_t) 0x06)
+#define OBD_VIN_LENGTH   ((uint8_t) 17)
+/* Mode 02 PID of the DTC that stored the freeze frame */
+#define OBD_PID_FREEZE_DTC ((uint8_t) 0x02)
+
+/* PIDs one Mode 01 request may carry */
+#define OBD_MAX_PIDS_PER_REQUEST ((uint8_t) 6)
+/* Longest PID data record of the PID table */
+#define OBD_PID_DATA_MAX ((uint8_t) 5)
+
+/* Supported PID discovery: ECUs kept and the modes discovered on each */
+#define OBD_SUPP_MAX_ECUS   ((uint8_t) 8)
+#define OBD_SUPP_MODE_COUNT ((uint8_t) 2)
+#define OBD_SUPP_MODE_LIST  { OBD_MODE_CURRENT_DATA, OBD_MODE_VEHICLE_INFO }
+/* A full store is erased only after the UDS client has been idle this long (ms) */
+#define OBD_SUPP_ERASE_IDLE ((uint32_t) 2000)
+
+/* Mode 01 poller: jobs (one per ECU), PIDs per job and requests a job may
+ * have outstanding */
+#define OBD_POLL_MAX_JOBS     ((uint8_t) 2)
+#define OBD_POLL_MAX_SIGNALS  ((uint8_t) 32)
+#define OBD_POLL_MAX_INFLIGHT ((uint8_t) 8)
+/* Periods of the rate classes in ms (100 Hz, 10 Hz, 1 Hz); each is a
+ * multiple of the previous one */
+#define OBD_POLL_PERIOD_FAST   ((uint32_t) 10)
+#define OBD_POLL_PERIOD_MEDIUM ((uint32_t) 100)
+#define OBD_POLL_PERIOD_SLOW   ((uint32_t) 1000)
+/* Bus-load budget of one job: bit rate, share of the bus (%) and bits of
+ * one 8 byte frame with worst case stuffing */
+#define OBD_POLL_BITRATE    ((uint32_t) 500000)
+#define OBD_POLL_BUS_LOAD   ((uint32_t) 30)
+#define OBD_POLL_FRAME_BITS ((uint32_t) 135)
+/* Rate controller: responses per evaluation, timeouts allowed per
+ * evaluation (%), margin over the measured latency (%) and the largest
+ * back-off added to the slot period (ms) */
+#define OBD_POLL_CTRL_WINDOW    ((uint16_t) 50)
+#define OBD_POLL_TIMEOUT_LIMIT  ((uint32_t) 2)
+#define OBD_POLL_LATENCY_MARGIN ((uint32_t) 25)
+#define OBD_POLL_BACKOFF_MAX    ((uint32_t) 1000)
+/* Packing is tried doubled again after this many positive responses in a
+ * row to requests packed full */
+#define OBD_POLL_PACK_PROBE     ((uint16_t) 200)
+
+/* Functional queries: requests of one run and the longest request (a single frame) */
+#define OBD_QUERY_MAX_STEPS   ((uint8_t) 8)
+#define OBD_QUERY_REQUEST_MAX ((uint8_t) 7)
+
+#endif /* SRC_OBD_INC_OBD_CFG_H_ */
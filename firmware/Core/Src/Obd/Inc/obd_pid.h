@@ -0,0 +1,54 @@
+/*
+ * obd_pid.h
+ *
+ *  Created on: Aug 16, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Mode 01 PID table (SAE J1979): data length and decoding of each known PID.
+ *
+ * Mode 01 responses carry PID / data pairs back to back without lengths,
+ * so a response can only be split on the PIDs listed here.
+ *
+ * Every entry holds the position and width of its quantity, a Q16 scale and
+ * an offset worked out by the compiler from the J1979 formula, so all PIDs
+ * go through the same fixed-point arithmetic. Values are in thousandths of
+ * their unit; multi-value PIDs (e.g. oxygen sensors) decode the first one.
+ */
+
+#ifndef SRC_OBD_INC_OBD_PID_H_
+#define SRC_OBD_INC_OBD_PID_H_
+
+#include <stdint.h>
+#include "obd_cfg.h"
+
+/* Enums */
+typedef enum{
+	/* Bit field or enumeration, not scaled */
+	OBD_UNIT_NONE,
+	OBD_UNIT_PERCENT,
+	OBD_UNIT_DEGC,
+	OBD_UNIT_KPA,
+	OBD_UNIT_PA,
+	OBD_UNIT_RPM,
+	OBD_UNIT_KMH,
+	/* Degrees (angle) */
+	OBD_UNIT_DEG,
+	/* Grams per second */
+	OBD_UNIT_GPS,
+	OBD_UNIT_V,
+	OBD_UNIT_S,
+	OBD_UNIT_MIN,
+	OBD_UNIT_KM,
+	OBD_UNIT_RATIO,
+	OBD_UNIT_COUNT,
+	/* Litres per hour */
+	OBD_UNIT_LPH,
+	OBD_UNIT_NM
+}ObdPid_UnitTypeDef;
+
+/* Functions */
+extern uint8_t ObdPid_GetLength(uint8_t pid);
+extern ObdPid_UnitTypeDef ObdPid_GetUnit(uint8_t pid);
+extern int32_t ObdPid_Decode(uint8_t pid, const uint8_t* data);
+
+#endif /* SRC_OBD_INC_OBD_PID_H_ */
@@ -0,0 +1,92 @@
+/*
+ * obd_poll.h
+ *
+ *  Created on: Aug 16, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Mode 01 (current data) poller with rate classes.
+ *
+ * Each PID of a job polls at 100 Hz, 10 Hz or 1 Hz. Time is cut into slots
+ * of the fast period; medium and slow PIDs get a phase within their period,
+ * chosen so every slot carries about the same number of PIDs. A slot sends
+ * all PIDs due in it packed up to six per request. Packing starts at
+ * OBD_MAX_PIDS_PER_REQUEST and is halved whenever the ECU answers a request
+ * carrying more than one PID with a negative response; timeouts and other
+ * failures are left to the rate controller. After OBD_POLL_PACK_PROBE
+ * positive responses in a row to full requests packing is doubled again,
+ * up to OBD_MAX_PIDS_PER_REQUEST, so a transient rejection is not kept
+ * forever.
+ *
+ * The slot period is the longer of two floors plus a back-off:
+ *  - bus: the slot whose requests and responses take the most bus time
+ *    must fit OBD_POLL_BUS_LOAD of the period;
+ *  - latency: requests to one ECU go one after the other, so the period
+ *    must cover the most requests of a slot times the measured response
+ *    latency (moving average) plus OBD_POLL_LATENCY_MARGIN.
+ * Every OBD_POLL_CTRL_WINDOW responses the timeout share is checked: above
+ * OBD_POLL_TIMEOUT_LIMIT the back-off doubles, otherwise it shrinks by a
+ * quarter. Stretching the period drops all rates of the job in proportion.
+ * A slot is not started while requests of the previous one are outstanding.
+ */
+
+#ifndef SRC_OBD_INC_OBD_POLL_H_
+#define SRC_OBD_INC_OBD_POLL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "obd_cfg.h"
+#include "../../Uds/Inc/uds_services.h"
+
+/* Enums */
+typedef enum{
+	OBD_RATE_FAST,
+	OBD_RATE_MEDIUM,
+	OBD_RATE_SLOW
+}ObdPoll_RateTypeDef;
+
+/* Structures */
+typedef struct{
+	uint8_t pid;
+	ObdPoll_RateTypeDef rate;
+}ObdPoll_Signal_t;
+
+typedef struct{
+	uint8_t pid;
+	const uint8_t* data;
+	uint8_t length;
+}ObdPoll_Value_t;
+
+typedef struct{
+	/* PIDs per request and slot period (ms) currently in use */
+	uint8_t perRequest;
+	uint32_t slotPeriod;
+	/* Rate controller: bus and latency floors and back-off (ms), response
+	 * latency moving average (ms) */
+	uint32_t busPeriod;
+	uint32_t latencyPeriod;
+	uint32_t backoff;
+	uint32_t latency;
+	/* Signals dropped at start, not supported by the ECU */
+	uint8_t unsupported;
+	uint32_t requests;
+	/* Failed requests, timeouts included */
+	uint32_t failures;
+	uint32_t timeouts;
+	/* Slots started late because the previous one was still running */
+	uint32_t overruns;
+	/* Responses refused by the sink */
+	uint32_t lost;
+}ObdPoll_Stats_t;
+
+/* PIDs of one response, time is its arrival; false if it cannot be taken */
+typedef bool (*ObdPoll_Sink_t)(uint32_t txId, uint32_t time, const ObdPoll_Value_t* values, uint8_t count, void* context);
+
+/* Functions */
+extern void ObdPoll_Init(void);
+extern UDS_StatusTypeDef ObdPoll_Start(uint32_t txId, uint32_t rxId, const ObdPoll_Signal_t* signals, uint8_t count,
+		ObdPoll_Sink_t sink, void* context, uint8_t* handle, uint32_t now);
+extern void ObdPoll_Stop(uint8_t handle);
+extern const ObdPoll_Stats_t* ObdPoll_GetStats(uint8_t handle);
+extern void ObdPoll_MainFunction(uint32_t now);
+
+#endif /* SRC_OBD_INC_OBD_POLL_H_ */
@@ -0,0 +1,68 @@
+/*
+ * obd_query.h
+ *
+ *  Created on: Aug 18, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Functional OBD-II requests answered by all ECUs at once.
+ *
+ * Every request of a run is sent once on BROADCAST_REQUEST_ID with
+ * Uds_RequestFunctional() and the responses of all ECUs (0x7E8-0x7EF) are
+ * collected in the same window: multi-frame responses (Mode 09 CALID / CVN,
+ * long DTC lists) are reassembled side by side on the client's channels of
+ * their ECUs. A window lasts P2 from the request, longer while an ECU is
+ * still sending or has asked for time with NRC 0x78. A run of N modes thus
+ * takes N windows whatever the number of ECUs.
+ *
+ * ObdQuery_StartCheck() runs the emissions check: stored, pending and
+ * permanent DTCs, the freeze frame DTC, VIN, CALID and CVN.
+ *
+ * The channels are the UDS client's: a step waits for the requests to
+ * 0x7E0-0x7E7 queued before it (Mode 01 polling) and those queued during
+ * its window wait for it to close, rather than either side failing.
+ */
+
+#ifndef SRC_OBD_INC_OBD_QUERY_H_
+#define SRC_OBD_INC_OBD_QUERY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "obd_cfg.h"
+#include "../../Uds/Inc/uds_services.h"
+
+/* Structures */
+typedef struct{
+	uint8_t data[OBD_QUERY_REQUEST_MAX];
+	uint8_t length;
+}ObdQuery_Request_t;
+
+typedef struct{
+	/* ID the ECU answered on */
+	uint32_t rxId;
+	/* Mode of the request */
+	uint8_t mode;
+	/* NRC of a negative response, 0 otherwise */
+	uint8_t nrc;
+	/* Whole response starting with mode + 0x40 (or 0x7F), valid during the call only */
+	const uint8_t* data;
+	uint32_t length;
+	/* Request sent to response complete (ms) */
+	uint32_t latency;
+}ObdQuery_Response_t;
+
+/* One ECU's response; false if it cannot be taken */
+typedef bool (*ObdQuery_Sink_t)(const ObdQuery_Response_t* rsp, void* context);
+/* Run finished: responses taken, refused by the sink, and duration in ms */
+typedef void (*ObdQuery_DoneCallback_t)(uint16_t responses, uint16_t lost, uint32_t duration, void* context);
+
+/* Functions */
+extern void ObdQuery_Init(void);
+extern UDS_StatusTypeDef ObdQuery_Start(const ObdQuery_Request_t* requests, uint8_t count,
+		ObdQuery_Sink_t sink, ObdQuery_DoneCallback_t callback, void* context, uint32_t now);
+extern UDS_StatusTypeDef ObdQuery_StartCheck(ObdQuery_Sink_t sink, ObdQuery_DoneCallback_t callback, void* context, uint32_t now);
+extern void ObdQuery_Stop(void);
+extern bool ObdQuery_IsRunning(void);
+extern void ObdQuery_MainFunction(uint32_t now);
+extern uint8_t ObdQuery_GetDtcs(const ObdQuery_Response_t* rsp, uint16_t* dtcs, uint8_t max);
+
+#endif /* SRC_OBD_INC_OBD_QUERY_H_ */
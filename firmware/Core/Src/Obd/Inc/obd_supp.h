@@ -0,0 +1,70 @@
+/*
+ * obd_supp.h
+ *
+ *  Created on: Aug 17, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Supported PID discovery with bitmaps kept per VIN.
+ *
+ * For every mode of OBD_SUPP_MODE_LIST the ECU is asked for PID 0x00, then
+ * 0x20, 0x40 ... 0xE0 for as long as the last bit of the previous answer
+ * says the next range exists. The result is a 256-bit bitmap per ECU and
+ * mode, tested in constant time with ObdSupp_Test().
+ *
+ * Discovery first reads the VIN (Mode 09 InfoType 02) unless a VIN is
+ * already known. If the store holds bitmaps for that VIN and ECU they are
+ * taken as they are; otherwise the ranges are queried and the result is
+ * appended to the store. The store is a log of fixed size records, erased
+ * when it is full. Erasing stalls the CPU for a second or more, so it is
+ * never done from a response: ObdSupp_MainFunction() erases once the UDS
+ * client has been idle for OBD_SUPP_ERASE_IDLE ms and then writes the
+ * bitmaps of all ECUs known for the current VIN.
+ */
+
+#ifndef SRC_OBD_INC_OBD_SUPP_H_
+#define SRC_OBD_INC_OBD_SUPP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "obd_cfg.h"
+#include "../../Uds/Inc/uds_services.h"
+
+/* Enums */
+typedef enum{
+	/* Ranges queried on the ECU */
+	OBD_SUPP_DISCOVERED,
+	/* Bitmaps taken from the store */
+	OBD_SUPP_RESTORED,
+	/* The ECU answered none of the supported PID requests */
+	OBD_SUPP_FAILED
+}ObdSupp_ResultTypeDef;
+
+/* Structures */
+/* Bit n set: PID n supported */
+typedef struct{
+	uint32_t bits[8];
+}ObdSupp_Bitmap_t;
+
+/* Non-volatile store; offsets and lengths are multiples of 4, erased bytes read 0xFF */
+typedef struct{
+	bool (*Read)(uint32_t offset, void* data, uint32_t length);
+	bool (*Write)(uint32_t offset, const void* data, uint32_t length);
+	bool (*Erase)(void);
+	uint32_t size;
+}ObdSupp_Store_t;
+
+typedef void (*ObdSupp_DoneCallback_t)(uint32_t txId, ObdSupp_ResultTypeDef result, void* context);
+
+/* Functions */
+extern void ObdSupp_Init(const ObdSupp_Store_t* store);
+extern UDS_StatusTypeDef ObdSupp_Discover(uint32_t txId, uint32_t rxId, ObdSupp_DoneCallback_t callback, void* context, uint32_t now);
+extern const ObdSupp_Bitmap_t* ObdSupp_Get(uint32_t txId, uint8_t mode);
+extern const uint8_t* ObdSupp_GetVin(void);
+extern void ObdSupp_Reset(void);
+extern void ObdSupp_MainFunction(uint32_t now);
+
+static inline bool ObdSupp_Test(const ObdSupp_Bitmap_t* bitmap, uint8_t pid){
+	return ((bitmap->bits[pid >> 5] >> (pid & 31u)) & 1u) != 0;
+}
+
+#endif /* SRC_OBD_INC_OBD_SUPP_H_ */
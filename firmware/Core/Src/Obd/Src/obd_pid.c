@@ -0,0 +1,178 @@
+/*
+ * obd_pid.c
+ *
+ *  Created on: Aug 16, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include "../Inc/obd_pid.h"
+
+/* Defines */
+/* Q16 factor turning the raw value into thousandths: num / den per bit */
+#define OBD_PID_SCALE(num, den) ((int32_t)(((int64_t)(num) * 1000 * 65536 + (den) / 2) / (den)))
+/* Quantity of size bytes at pos: raw * num / den + off (thousandths) */
+#define OBD_PID(len, pos, size, sgn, num, den, off, unit) \
+	{ (len), (pos), (size), (sgn), (unit), OBD_PID_SCALE(num, den), (off) }
+/* Bit fields and enumerations, the data bytes as they are */
+#define OBD_PID_RAW(len) \
+	{ (len), 0, (len), 0, OBD_UNIT_NONE, 65536, 0 }
+
+/* Structures */
+typedef struct{
+	/* Data bytes, 0 for PIDs not in the table */
+	uint8_t length;
+	/* First byte and width of the decoded quantity (first one of multi-value PIDs) */
+	uint8_t position;
+	uint8_t size;
+	uint8_t sign;
+	uint8_t unit;
+	int32_t scale;
+	int32_t offset;
+}ObdPid_Entry_t;
+
+/* Variables */
+static const ObdPid_Entry_t obdPid[256] = {
+	[0x00] = OBD_PID_RAW(4),
+	[0x01] = OBD_PID_RAW(4),
+	[0x02] = OBD_PID_RAW(2),
+	[0x03] = OBD_PID_RAW(2),
+	[0x04] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x05] = OBD_PID(1, 0, 1, 0, 1, 1, -40000, OBD_UNIT_DEGC),
+	[0x06] = OBD_PID(1, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x07] = OBD_PID(1, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x08] = OBD_PID(1, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x09] = OBD_PID(1, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x0A] = OBD_PID(1, 0, 1, 0, 3, 1, 0, OBD_UNIT_KPA),
+	[0x0B] = OBD_PID(1, 0, 1, 0, 1, 1, 0, OBD_UNIT_KPA),
+	[0x0C] = OBD_PID(2, 0, 2, 0, 1, 4, 0, OBD_UNIT_RPM),
+	[0x0D] = OBD_PID(1, 0, 1, 0, 1, 1, 0, OBD_UNIT_KMH),
+	[0x0E] = OBD_PID(1, 0, 1, 0, 1, 2, -64000, OBD_UNIT_DEG),
+	[0x0F] = OBD_PID(1, 0, 1, 0, 1, 1, -40000, OBD_UNIT_DEGC),
+	[0x10] = OBD_PID(2, 0, 2, 0, 1, 100, 0, OBD_UNIT_GPS),
+	[0x11] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x12] = OBD_PID_RAW(1),
+	[0x13] = OBD_PID_RAW(1),
+	/* Oxygen sensors: voltage, then short term fuel trim */
+	[0x14] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x15] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x16] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x17] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x18] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x19] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x1A] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x1B] = OBD_PID(2, 0, 1, 0, 1, 200, 0, OBD_UNIT_V),
+	[0x1C] = OBD_PID_RAW(1),
+	[0x1D] = OBD_PID_RAW(1),
+	[0x1E] = OBD_PID_RAW(1),
+	[0x1F] = OBD_PID(2, 0, 2, 0, 1, 1, 0, OBD_UNIT_S),
+	[0x20] = OBD_PID_RAW(4),
+	[0x21] = OBD_PID(2, 0, 2, 0, 1, 1, 0, OBD_UNIT_KM),
+	[0x22] = OBD_PID(2, 0, 2, 0, 79, 1000, 0, OBD_UNIT_KPA),
+	[0x23] = OBD_PID(2, 0, 2, 0, 10, 1, 0, OBD_UNIT_KPA),
+	/* Wide range oxygen sensors: equivalence ratio, then voltage */
+	[0x24] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x25] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x26] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x27] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x28] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x29] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x2A] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x2B] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x2C] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x2D] = OBD_PID(1, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x2E] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x2F] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x30] = OBD_PID(1, 0, 1, 0, 1, 1, 0, OBD_UNIT_COUNT),
+	[0x31] = OBD_PID(2, 0, 2, 0, 1, 1, 0, OBD_UNIT_KM),
+	[0x32] = OBD_PID(2, 0, 2, 1, 1, 4, 0, OBD_UNIT_PA),
+	[0x33] = OBD_PID(1, 0, 1, 0, 1, 1, 0, OBD_UNIT_KPA),
+	/* Wide range oxygen sensors: equivalence ratio, then current */
+	[0x34] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x35] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x36] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x37] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x38] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x39] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x3A] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x3B] = OBD_PID(4, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x3C] = OBD_PID(2, 0, 2, 0, 1, 10, -40000, OBD_UNIT_DEGC),
+	[0x3D] = OBD_PID(2, 0, 2, 0, 1, 10, -40000, OBD_UNIT_DEGC),
+	[0x3E] = OBD_PID(2, 0, 2, 0, 1, 10, -40000, OBD_UNIT_DEGC),
+	[0x3F] = OBD_PID(2, 0, 2, 0, 1, 10, -40000, OBD_UNIT_DEGC),
+	[0x40] = OBD_PID_RAW(4),
+	[0x41] = OBD_PID_RAW(4),
+	[0x42] = OBD_PID(2, 0, 2, 0, 1, 1000, 0, OBD_UNIT_V),
+	[0x43] = OBD_PID(2, 0, 2, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x44] = OBD_PID(2, 0, 2, 0, 2, 65536, 0, OBD_UNIT_RATIO),
+	[0x45] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x46] = OBD_PID(1, 0, 1, 0, 1, 1, -40000, OBD_UNIT_DEGC),
+	[0x47] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x48] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x49] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x4A] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x4B] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x4C] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x4D] = OBD_PID(2, 0, 2, 0, 1, 1, 0, OBD_UNIT_MIN),
+	[0x4E] = OBD_PID(2, 0, 2, 0, 1, 1, 0, OBD_UNIT_MIN),
+	[0x4F] = OBD_PID_RAW(4),
+	[0x50] = OBD_PID_RAW(4),
+	[0x51] = OBD_PID_RAW(1),
+	[0x52] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x53] = OBD_PID(2, 0, 2, 0, 1, 200, 0, OBD_UNIT_KPA),
+	[0x54] = OBD_PID(2, 0, 2, 1, 1, 1, 0, OBD_UNIT_PA),
+	/* Secondary oxygen sensor trim, bank 1/3 or 2/4: first bank */
+	[0x55] = OBD_PID(2, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x56] = OBD_PID(2, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x57] = OBD_PID(2, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x58] = OBD_PID(2, 0, 1, 0, 100, 128, -100000, OBD_UNIT_PERCENT),
+	[0x59] = OBD_PID(2, 0, 2, 0, 10, 1, 0, OBD_UNIT_KPA),
+	[0x5A] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x5B] = OBD_PID(1, 0, 1, 0, 100, 255, 0, OBD_UNIT_PERCENT),
+	[0x5C] = OBD_PID(1, 0, 1, 0, 1, 1, -40000, OBD_UNIT_DEGC),
+	[0x5D] = OBD_PID(2, 0, 2, 0, 1, 128, -210000, OBD_UNIT_DEG),
+	[0x5E] = OBD_PID(2, 0, 2, 0, 1, 20, 0, OBD_UNIT_LPH),
+	[0x5F] = OBD_PID_RAW(1),
+	[0x60] = OBD_PID_RAW(4),
+	[0x61] = OBD_PID(1, 0, 1, 0, 1, 1, -125000, OBD_UNIT_PERCENT),
+	[0x62] = OBD_PID(1, 0, 1, 0, 1, 1, -125000, OBD_UNIT_PERCENT),
+	[0x63] = OBD_PID(2, 0, 2, 0, 1, 1, 0, OBD_UNIT_NM),
+	/* Engine percent torque: idle point */
+	[0x64] = OBD_PID(5, 0, 1, 0, 1, 1, -125000, OBD_UNIT_PERCENT),
+	[0x80] = OBD_PID_RAW(4),
+	[0xA0] = OBD_PID_RAW(4),
+	[0xC0] = OBD_PID_RAW(4)
+};
+
+
+/**
+ * @return Data bytes of the PID, 0 if unknown.
+ */
+uint8_t ObdPid_GetLength(uint8_t pid){
+	return obdPid[pid].length;
+}
+
+/**
+ * @return Unit of the value returned by ObdPid_Decode().
+ */
+ObdPid_UnitTypeDef ObdPid_GetUnit(uint8_t pid){
+	return (ObdPid_UnitTypeDef)obdPid[pid].unit;
+}
+
+/**
+ * @brief Decodes the data bytes of a known PID, the same arithmetic for every PID.
+ *
+ * @return Value in thousandths of its unit; OBD_UNIT_NONE PIDs return the
+ *         data bytes big endian as they are.
+ */
+int32_t ObdPid_Decode(uint8_t pid, const uint8_t* data){
+	const ObdPid_Entry_t* const entry = &obdPid[pid];
+	const uint32_t sign = (uint32_t)entry->sign << ((entry->size * 8u - 1u) & 31u);
+	uint32_t raw = 0;
+
+	for(uint8_t i = 0; i < entry->size; i++){
+		raw = (raw << 8) | data[entry->position + i];
+	}
+
+	/* Sign extension without a branch: sign is 0 for unsigned quantities */
+	return (int32_t)(((int64_t)(int32_t)((raw ^ sign) - sign) * entry->scale + 0x8000) >> 16) + entry->offset;
+}
@@ -0,0 +1,435 @@
+/*
+ * obd_poll.c
+ *
+ *  Created on: Aug 16, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/obd_poll.h"
+#include "../Inc/obd_pid.h"
+#include "../Inc/obd_supp.h"
+
+/* Defines */
+/* Phases of the medium and slow classes, in fast slots */
+#define OBD_POLL_MEDIUM_SLOTS ((uint8_t)(OBD_POLL_PERIOD_MEDIUM / OBD_POLL_PERIOD_FAST))
+#define OBD_POLL_SLOW_SLOTS   ((uint8_t)(OBD_POLL_PERIOD_SLOW / OBD_POLL_PERIOD_FAST))
+/* Bus time one job may use in a fast slot */
+#define OBD_POLL_SLOT_BITS    ((uint32_t)(OBD_POLL_BITRATE / 1000u * OBD_POLL_PERIOD_FAST * OBD_POLL_BUS_LOAD / 100u))
+
+/* Structures */
+typedef struct ObdPoll_Job ObdPoll_Job_t;
+
+/* One outstanding request, the context of its callback */
+typedef struct{
+	ObdPoll_Job_t* job;
+	bool used;
+	/* PIDs in the request */
+	uint8_t count;
+}ObdPoll_Flight_t;
+
+struct ObdPoll_Job{
+	bool used;
+	/* Stopped, released once the last response is in */
+	bool stopping;
+	uint32_t txId;
+	uint32_t rxId;
+	ObdPoll_Signal_t signals[OBD_POLL_MAX_SIGNALS];
+	/* Slot of each medium / slow PID within its period */
+	uint8_t phase[OBD_POLL_MAX_SIGNALS];
+	uint8_t count;
+	/* Slot within the slow period and the time it is due */
+	uint8_t slot;
+	uint32_t due;
+	bool late;
+	/* Packing changed, phases and pace are worked out again before the next slot */
+	bool rebuild;
+	/* Most requests in one slot */
+	uint8_t slotRequests;
+	/* Response latency moving average (ms, Q4) */
+	uint32_t latencyQ4;
+	/* Responses and timeouts of the current controller window */
+	uint16_t windowCount;
+	uint16_t windowTimeouts;
+	/* Positive responses to full requests in a row, for growing the packing back */
+	uint16_t packStreak;
+	uint8_t inFlight;
+	ObdPoll_Flight_t flights[OBD_POLL_MAX_INFLIGHT];
+	ObdPoll_Stats_t stats;
+	ObdPoll_Sink_t sink;
+	void* context;
+};
+
+/* Functions prototype */
+static void ObdPoll_Build(ObdPoll_Job_t* job);
+static uint8_t ObdPoll_Collect(const ObdPoll_Job_t* job, uint8_t slot, uint8_t* pids);
+static uint32_t ObdPoll_SlotBits(const ObdPoll_Job_t* job, uint8_t slot);
+static void ObdPoll_Pace(ObdPoll_Job_t* job);
+static void ObdPoll_Control(ObdPoll_Job_t* job, const Uds_Response_t* rsp);
+static void ObdPoll_Fire(ObdPoll_Job_t* job, uint32_t now);
+static void ObdPoll_Response(const Uds_Response_t* rsp, void* context);
+
+/* Variables */
+static ObdPoll_Job_t jobs[OBD_POLL_MAX_JOBS];
+
+
+void ObdPoll_Init(void){
+	for(uint8_t i = 0; i < OBD_POLL_MAX_JOBS; i++){
+		jobs[i].used = false;
+	}
+}
+
+/**
+ * @brief Starts polling a list of PIDs on an ECU.
+ *
+ * @param handle  Receives the handle for ObdPoll_Stop() / ObdPoll_GetStats().
+ *
+ * Once ObdSupp has discovered the ECU, PIDs it does not support are dropped
+ * from the job and counted in the stats.
+ *
+ * @return UDS_NOT_OK for bad arguments, a PID missing from the PID table or
+ *         no supported PID left, UDS_BUSY if all jobs are in use.
+ */
+UDS_StatusTypeDef ObdPoll_Start(uint32_t txId, uint32_t rxId, const ObdPoll_Signal_t* signals, uint8_t count,
+		ObdPoll_Sink_t sink, void* context, uint8_t* handle, uint32_t now){
+	ObdPoll_Job_t* job = NULL;
+	const ObdSupp_Bitmap_t* const supported = ObdSupp_Get(txId, OBD_MODE_CURRENT_DATA);
+	uint8_t kept = 0;
+
+	if(signals == NULL || count == 0 || count > OBD_POLL_MAX_SIGNALS || sink == NULL || handle == NULL) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < count; i++){
+		if(signals[i].rate > OBD_RATE_SLOW || ObdPid_GetLength(signals[i].pid) == 0) return UDS_NOT_OK;
+		if(supported == NULL || ObdSupp_Test(supported, signals[i].pid)) kept++;
+	}
+	if(kept == 0) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < OBD_POLL_MAX_JOBS; i++){
+		if(!jobs[i].used){
+			job = &jobs[i];
+			*handle = i;
+			break;
+		}
+	}
+	if(job == NULL) return UDS_BUSY;
+
+	memset(job, 0, sizeof(*job));
+	job->txId = txId;
+	job->rxId = rxId;
+	/* PIDs the ECU is known not to support are never requested */
+	for(uint8_t i = 0; i < count; i++){
+		if(supported == NULL || ObdSupp_Test(supported, signals[i].pid)){
+			job->signals[job->count++] = signals[i];
+		}
+	}
+	job->stats.unsupported = (uint8_t)(count - kept);
+	job->sink = sink;
+	job->context = context;
+	job->due = now;
+	for(uint8_t i = 0; i < OBD_POLL_MAX_INFLIGHT; i++){
+		job->flights[i].job = job;
+	}
+	job->stats.perRequest = OBD_MAX_PIDS_PER_REQUEST;
+	ObdPoll_Build(job);
+	job->used = true;
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Stops a job; the handle is free once its outstanding responses are in.
+ */
+void ObdPoll_Stop(uint8_t handle){
+	if(handle >= OBD_POLL_MAX_JOBS || !jobs[handle].used) return;
+
+	if(jobs[handle].inFlight == 0){
+		jobs[handle].used = false;
+	}
+	else{
+		jobs[handle].stopping = true;
+	}
+}
+
+const ObdPoll_Stats_t* ObdPoll_GetStats(uint8_t handle){
+	if(handle >= OBD_POLL_MAX_JOBS || !jobs[handle].used) return NULL;
+
+	return &jobs[handle].stats;
+}
+
+/**
+ * @brief Starts the slots that are due.
+ */
+void ObdPoll_MainFunction(uint32_t now){
+	for(uint8_t i = 0; i < OBD_POLL_MAX_JOBS; i++){
+		ObdPoll_Job_t* const job = &jobs[i];
+
+		if(!job->used || job->stopping || (int32_t)(now - job->due) < 0) continue;
+
+		if(job->inFlight != 0){
+			if(!job->late){
+				job->late = true;
+				job->stats.overruns++;
+			}
+			continue;
+		}
+		job->late = false;
+
+		if(job->rebuild){
+			job->rebuild = false;
+			ObdPoll_Build(job);
+		}
+
+		ObdPoll_Fire(job, now);
+		job->slot = (uint8_t)((job->slot + 1) % OBD_POLL_SLOW_SLOTS);
+
+		/* A late slot does not make the next ones come in a burst */
+		job->due += job->stats.slotPeriod;
+		if((int32_t)(now - job->due) >= 0){
+			job->due = now + job->stats.slotPeriod;
+		}
+	}
+}
+
+
+/* Private functions */
+
+/**
+ * @brief Spreads the medium and slow PIDs over the slots and sets the bus
+ *        floor from the heaviest slot.
+ */
+static void ObdPoll_Build(ObdPoll_Job_t* job){
+	uint8_t medium[OBD_POLL_MEDIUM_SLOTS] = { 0 };
+	uint8_t slow[OBD_POLL_SLOW_SLOTS] = { 0 };
+	uint8_t pids[OBD_POLL_MAX_SIGNALS];
+	uint32_t heaviest = 0;
+	uint32_t scale;
+
+	for(uint8_t i = 0; i < job->count; i++){
+		uint8_t best = 0;
+
+		if(job->signals[i].rate != OBD_RATE_MEDIUM) continue;
+
+		for(uint8_t p = 1; p < OBD_POLL_MEDIUM_SLOTS; p++){
+			if(medium[p] < medium[best]) best = p;
+		}
+		job->phase[i] = best;
+		medium[best]++;
+	}
+
+	for(uint8_t i = 0; i < job->count; i++){
+		uint8_t best = 0;
+
+		if(job->signals[i].rate != OBD_RATE_SLOW) continue;
+
+		for(uint8_t q = 1; q < OBD_POLL_SLOW_SLOTS; q++){
+			if(medium[q % OBD_POLL_MEDIUM_SLOTS] + slow[q]
+					< medium[best % OBD_POLL_MEDIUM_SLOTS] + slow[best]) best = q;
+		}
+		job->phase[i] = best;
+		slow[best]++;
+	}
+
+	job->slotRequests = 0;
+	for(uint8_t s = 0; s < OBD_POLL_SLOW_SLOTS; s++){
+		const uint32_t bits = ObdPoll_SlotBits(job, s);
+		const uint8_t requests = (uint8_t)((ObdPoll_Collect(job, s, pids) + job->stats.perRequest - 1) / job->stats.perRequest);
+
+		if(bits > heaviest) heaviest = bits;
+		if(requests > job->slotRequests) job->slotRequests = requests;
+	}
+
+	scale = (heaviest + OBD_POLL_SLOT_BITS - 1) / OBD_POLL_SLOT_BITS;
+	if(scale == 0) scale = 1;
+	job->stats.busPeriod = OBD_POLL_PERIOD_FAST * scale;
+	ObdPoll_Pace(job);
+}
+
+/**
+ * @brief Slot period: the longer of the bus and latency floors plus the back-off.
+ */
+static void ObdPoll_Pace(ObdPoll_Job_t* job){
+	ObdPoll_Stats_t* const stats = &job->stats;
+
+	stats->latency = (job->latencyQ4 + 8u) >> 4;
+	stats->latencyPeriod = (job->slotRequests * job->latencyQ4 * (100u + OBD_POLL_LATENCY_MARGIN) / 100u + 15u) >> 4;
+	stats->slotPeriod = ((stats->busPeriod > stats->latencyPeriod) ? stats->busPeriod : stats->latencyPeriod) + stats->backoff;
+}
+
+/**
+ * @brief Feeds one completed request to the rate controller.
+ *
+ * The latency average follows every answered request; the back-off is
+ * doubled or shrunk once per window depending on the share of timeouts.
+ * Requests that never reached the ECU are left out of both.
+ */
+static void ObdPoll_Control(ObdPoll_Job_t* job, const Uds_Response_t* rsp){
+	ObdPoll_Stats_t* const stats = &job->stats;
+
+	/* Never reached the ECU: tells nothing about its load */
+	if(rsp->result == UDS_RESULT_TX_ERROR || rsp->result == UDS_RESULT_CANCELLED) return;
+
+	if(rsp->result == UDS_RESULT_TIMEOUT){
+		stats->timeouts++;
+		job->windowTimeouts++;
+	}
+	/* Moving average over about eight responses; only answers carry a latency */
+	else if(rsp->result != UDS_RESULT_RX_ERROR && rsp->latency != 0){
+		job->latencyQ4 = job->latencyQ4 + ((int32_t)(rsp->latency << 4) - (int32_t)job->latencyQ4) / 8;
+	}
+
+	if(++job->windowCount >= OBD_POLL_CTRL_WINDOW){
+		if(job->windowTimeouts * 100u > job->windowCount * OBD_POLL_TIMEOUT_LIMIT){
+			stats->backoff = (stats->backoff == 0) ? OBD_POLL_PERIOD_FAST : stats->backoff * 2u;
+			if(stats->backoff > OBD_POLL_BACKOFF_MAX) stats->backoff = OBD_POLL_BACKOFF_MAX;
+		}
+		else{
+			stats->backoff -= (stats->backoff + 3u) / 4u;
+		}
+		job->windowCount = 0;
+		job->windowTimeouts = 0;
+	}
+
+	ObdPoll_Pace(job);
+}
+
+/**
+ * @return PIDs due in the slot, written to pids.
+ */
+static uint8_t ObdPoll_Collect(const ObdPoll_Job_t* job, uint8_t slot, uint8_t* pids){
+	uint8_t count = 0;
+
+	for(uint8_t i = 0; i < job->count; i++){
+		bool due;
+
+		switch(job->signals[i].rate){
+		case OBD_RATE_MEDIUM: due = job->phase[i] == slot % OBD_POLL_MEDIUM_SLOTS; break;
+		case OBD_RATE_SLOW:   due = job->phase[i] == slot;                        break;
+		default:              due = true;                                         break;
+		}
+		if(due){
+			pids[count++] = job->signals[i].pid;
+		}
+	}
+
+	return count;
+}
+
+/**
+ * @return Bits of all frames of the slot: request SF, response SF or
+ *         FF + CFs and our flow control frame.
+ */
+static uint32_t ObdPoll_SlotBits(const ObdPoll_Job_t* job, uint8_t slot){
+	uint8_t pids[OBD_POLL_MAX_SIGNALS];
+	const uint8_t count = ObdPoll_Collect(job, slot, pids);
+	uint32_t frames = 0;
+
+	for(uint8_t i = 0; i < count; i += job->stats.perRequest){
+		const uint8_t n = (uint8_t)((count - i < job->stats.perRequest) ? count - i : job->stats.perRequest);
+		uint32_t rspLength = 1;
+
+		for(uint8_t k = 0; k < n; k++){
+			rspLength += 1u + ObdPid_GetLength(pids[i + k]);
+		}
+		/* Request SF, response SF or FF + FC + CFs */
+		frames += (rspLength <= 7) ? 2u : 3u + (rspLength - 6u + 6u) / 7u;
+	}
+
+	return frames * OBD_POLL_FRAME_BITS;
+}
+
+static void ObdPoll_Fire(ObdPoll_Job_t* job, uint32_t now){
+	uint8_t pids[OBD_POLL_MAX_SIGNALS];
+	const uint8_t count = ObdPoll_Collect(job, job->slot, pids);
+
+	for(uint8_t i = 0; i < count; i += job->stats.perRequest){
+		const uint8_t n = (uint8_t)((count - i < job->stats.perRequest) ? count - i : job->stats.perRequest);
+		uint8_t req[1 + OBD_MAX_PIDS_PER_REQUEST];
+		ObdPoll_Flight_t* flight = NULL;
+
+		for(uint8_t f = 0; f < OBD_POLL_MAX_INFLIGHT; f++){
+			if(!job->flights[f].used){
+				flight = &job->flights[f];
+				break;
+			}
+		}
+		if(flight == NULL) break;
+
+		req[0] = OBD_MODE_CURRENT_DATA;
+		memcpy(&req[1], &pids[i], n);
+		/* Claimed before the request, released if the client refuses it */
+		flight->used = true;
+		flight->count = n;
+		job->inFlight++;
+		/* Copied by the client, short requests are kept inline */
+		if(Uds_Request(job->txId, job->rxId, req, 1u + n, ObdPoll_Response, flight, now) != UDS_OK){
+			flight->used = false;
+			job->inFlight--;
+			break;
+		}
+		job->stats.requests++;
+	}
+}
+
+static void ObdPoll_Response(const Uds_Response_t* rsp, void* context){
+	ObdPoll_Flight_t* const flight = (ObdPoll_Flight_t*)context;
+	ObdPoll_Job_t* const job = flight->job;
+	const uint8_t sent = flight->count;
+	ObdPoll_Value_t values[OBD_MAX_PIDS_PER_REQUEST];
+	uint8_t count = 0;
+	uint32_t offset = 1;
+
+	flight->used = false;
+	job->inFlight--;
+
+	if(job->stopping){
+		if(job->inFlight == 0){
+			job->stopping = false;
+			job->used = false;
+		}
+		return;
+	}
+
+	ObdPoll_Control(job, rsp);
+
+	if(rsp->result != UDS_RESULT_POSITIVE){
+		job->stats.failures++;
+		/* The ECU may not take that many PIDs at once */
+		if(rsp->result == UDS_RESULT_NEGATIVE && sent > 1){
+			const uint8_t limit = (uint8_t)(sent / 2);
+
+			job->packStreak = 0;
+			if(limit < job->stats.perRequest){
+				job->stats.perRequest = limit;
+				job->rebuild = true;
+			}
+		}
+		return;
+	}
+
+	/* Packing was cut: try more PIDs again once the ECU has kept up */
+	if(sent == job->stats.perRequest && sent < OBD_MAX_PIDS_PER_REQUEST && ++job->packStreak >= OBD_POLL_PACK_PROBE){
+		job->packStreak = 0;
+		job->stats.perRequest = (job->stats.perRequest * 2u < OBD_MAX_PIDS_PER_REQUEST)
+				? (uint8_t)(job->stats.perRequest * 2u) : OBD_MAX_PIDS_PER_REQUEST;
+		job->rebuild = true;
+	}
+
+	/* PIDs the ECU does not support are left out of the response */
+	while(offset < rsp->length && count < OBD_MAX_PIDS_PER_REQUEST){
+		const uint8_t pid = rsp->data[offset];
+		const uint8_t length = ObdPid_GetLength(pid);
+
+		if(length == 0 || offset + 1u + length > rsp->length) break;
+
+		values[count].pid = pid;
+		values[count].data = &rsp->data[offset + 1];
+		values[count].length = length;
+		count++;
+		offset += 1u + length;
+	}
+
+	if(count != 0 && !job->sink(job->txId, Uds_GetTime(), values, count, job->context)){
+		job->stats.lost++;
+	}
+}
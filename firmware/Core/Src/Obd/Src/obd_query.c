@@ -0,0 +1,192 @@
+/*
+ * obd_query.c
+ *
+ *  Created on: Aug 18, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/obd_query.h"
+
+/* Structures */
+typedef struct{
+	bool running;
+	/* Request of the step queued in the client, its window not closed yet */
+	bool inFlight;
+	ObdQuery_Request_t requests[OBD_QUERY_MAX_STEPS];
+	uint8_t count;
+	uint8_t step;
+	uint32_t startTime;
+	uint16_t responses;
+	uint16_t lost;
+	ObdQuery_Sink_t sink;
+	ObdQuery_DoneCallback_t callback;
+	void* context;
+}ObdQuery_Job_t;
+
+/* Functions prototype */
+static void ObdQuery_Send(uint32_t now);
+static void ObdQuery_End(uint32_t now);
+static void ObdQuery_Response(const Uds_Response_t* rsp, void* context);
+static void ObdQuery_WindowClosed(const Uds_Response_t* rsp, void* context);
+
+/* Variables */
+static ObdQuery_Job_t job;
+/* Emissions check, one window per request */
+static const ObdQuery_Request_t obdQueryCheck[] = {
+	{ { OBD_MODE_STORED_DTC }, 1 },
+	{ { OBD_MODE_PENDING_DTC }, 1 },
+	{ { OBD_MODE_PERMANENT_DTC }, 1 },
+	{ { OBD_MODE_FREEZE_FRAME, OBD_PID_FREEZE_DTC, 0x00 }, 3 },
+	{ { OBD_MODE_VEHICLE_INFO, OBD_INFO_VIN }, 2 },
+	{ { OBD_MODE_VEHICLE_INFO, OBD_INFO_CALID }, 2 },
+	{ { OBD_MODE_VEHICLE_INFO, OBD_INFO_CVN }, 2 }
+};
+
+
+void ObdQuery_Init(void){
+	job.running = false;
+	job.inFlight = false;
+}
+
+/**
+ * @brief Sends a list of functional requests one window after the other.
+ *
+ * @param requests  Single frame requests, copied.
+ * @param callback  Called once the last window has closed, may be NULL.
+ *
+ * @return UDS_NOT_OK for bad arguments, UDS_BUSY if a run is going on or
+ *         the window of a stopped one has not closed yet.
+ */
+UDS_StatusTypeDef ObdQuery_Start(const ObdQuery_Request_t* requests, uint8_t count,
+		ObdQuery_Sink_t sink, ObdQuery_DoneCallback_t callback, void* context, uint32_t now){
+	if(requests == NULL || count == 0 || count > OBD_QUERY_MAX_STEPS || sink == NULL) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < count; i++){
+		if(requests[i].length == 0 || requests[i].length > OBD_QUERY_REQUEST_MAX) return UDS_NOT_OK;
+	}
+
+	if(job.running || job.inFlight) return UDS_BUSY;
+
+	memcpy(job.requests, requests, count * sizeof(requests[0]));
+	job.count = count;
+	job.step = 0;
+	job.startTime = now;
+	job.responses = 0;
+	job.lost = 0;
+	job.sink = sink;
+	job.callback = callback;
+	job.context = context;
+	job.running = true;
+
+	ObdQuery_Send(now);
+
+	return UDS_OK;
+}
+
+UDS_StatusTypeDef ObdQuery_StartCheck(ObdQuery_Sink_t sink, ObdQuery_DoneCallback_t callback, void* context, uint32_t now){
+	return ObdQuery_Start(obdQueryCheck, (uint8_t)(sizeof(obdQueryCheck) / sizeof(obdQueryCheck[0])),
+			sink, callback, context, now);
+}
+
+/**
+ * @brief Ends the run without calling the callback; responses still coming are dropped.
+ */
+void ObdQuery_Stop(void){
+	job.running = false;
+}
+
+bool ObdQuery_IsRunning(void){
+	return job.running;
+}
+
+/**
+ * @brief Queues the request of the step again if the client had no slot for it.
+ */
+void ObdQuery_MainFunction(uint32_t now){
+	if(job.running && !job.inFlight){
+		ObdQuery_Send(now);
+	}
+}
+
+/**
+ * @brief Extracts the DTCs of a Mode 03 / 07 / 0A response.
+ *
+ * @return DTCs written to dtcs (2 bytes each, J2012 encoding).
+ */
+uint8_t ObdQuery_GetDtcs(const ObdQuery_Response_t* rsp, uint16_t* dtcs, uint8_t max){
+	uint8_t count = 0;
+
+	if(rsp->nrc != 0 || rsp->length < 2) return 0;
+	if(rsp->mode != OBD_MODE_STORED_DTC && rsp->mode != OBD_MODE_PENDING_DTC && rsp->mode != OBD_MODE_PERMANENT_DTC) return 0;
+
+	/* On CAN the byte after the mode is the DTC count */
+	for(uint32_t offset = 2; offset + 1 < rsp->length && count < rsp->data[1] && count < max; offset += 2){
+		dtcs[count++] = (uint16_t)((rsp->data[offset] << 8) | rsp->data[offset + 1]);
+	}
+
+	return count;
+}
+
+
+/* Private functions */
+
+static void ObdQuery_Send(uint32_t now){
+	const ObdQuery_Request_t* const req = &job.requests[job.step];
+	const UDS_StatusTypeDef status = Uds_RequestFunctional(req->data, req->length,
+			ObdQuery_Response, ObdQuery_WindowClosed, NULL, now);
+
+	if(status == UDS_OK){
+		job.inFlight = true;
+	}
+	/* Rejected by the service table, the run cannot go on */
+	else if(status == UDS_NOT_OK){
+		ObdQuery_End(now);
+	}
+}
+
+static void ObdQuery_End(uint32_t now){
+	job.running = false;
+	if(job.callback != NULL){
+		job.callback(job.responses, job.lost, now - job.startTime, job.context);
+	}
+}
+
+/* Uds_Callback_t of one ECU's response, passed on to the sink */
+static void ObdQuery_Response(const Uds_Response_t* rsp, void* context){
+	ObdQuery_Response_t out;
+
+	(void)context;
+	if(!job.running || rsp->result == UDS_RESULT_INVALID_RSP) return;
+
+	out.rxId = rsp->rxId;
+	out.mode = rsp->sid;
+	out.nrc = rsp->nrc;
+	out.data = rsp->data;
+	out.length = rsp->length;
+	out.latency = rsp->latency;
+
+	if(job.sink(&out, job.context)){
+		job.responses++;
+	}
+	else{
+		job.lost++;
+	}
+}
+
+/* Uds_Callback_t of the step's request; a request that could not be sent ends the run */
+static void ObdQuery_WindowClosed(const Uds_Response_t* rsp, void* context){
+	const uint32_t now = Uds_GetTime();
+
+	(void)context;
+	job.inFlight = false;
+	if(!job.running) return;
+
+	if(rsp->result != UDS_RESULT_TX_ERROR && rsp->result != UDS_RESULT_CANCELLED && ++job.step < job.count){
+		ObdQuery_Send(now);
+		return;
+	}
+
+	ObdQuery_End(now);
+}
@@ -0,0 +1,388 @@
+/*
+ * obd_supp.c
+ *
+ *  Created on: Aug 17, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/obd_supp.h"
+
+/* Defines */
+/* "OBS1", records written before a format change are skipped */
+#define OBD_SUPP_MAGIC  ((uint32_t) 0x3153424F)
+#define OBD_SUPP_ERASED ((uint32_t) 0xFFFFFFFF)
+/* PIDs covered by one supported PID request */
+#define OBD_SUPP_RANGE  ((uint8_t) 0x20)
+#define OBD_SUPP_LAST_RANGE ((uint8_t) 0xE0)
+
+/* Enums */
+typedef enum{
+	OBD_SUPP_IDLE,
+	OBD_SUPP_READ_VIN,
+	OBD_SUPP_READ_RANGES
+}ObdSupp_StateTypeDef;
+
+/* Structures */
+typedef struct{
+	bool used;
+	uint32_t txId;
+	ObdSupp_Bitmap_t bitmaps[OBD_SUPP_MODE_COUNT];
+}ObdSupp_Ecu_t;
+
+/* Store record, the first one with an erased magic is free */
+typedef struct{
+	uint32_t magic;
+	uint32_t txId;
+	uint8_t vin[OBD_VIN_LENGTH];
+	uint8_t spare[3];
+	ObdSupp_Bitmap_t bitmaps[OBD_SUPP_MODE_COUNT];
+	/* FNV-1a of the fields above, a torn write does not match */
+	uint32_t check;
+}ObdSupp_Record_t;
+
+typedef struct{
+	ObdSupp_StateTypeDef state;
+	uint32_t txId;
+	uint32_t rxId;
+	/* Index in OBD_SUPP_MODE_LIST and first PID of the range being read */
+	uint8_t mode;
+	uint8_t base;
+	/* At least one range was answered */
+	bool answered;
+	ObdSupp_Bitmap_t bitmaps[OBD_SUPP_MODE_COUNT];
+	ObdSupp_DoneCallback_t callback;
+	void* context;
+}ObdSupp_Job_t;
+
+/* Functions prototype */
+static UDS_StatusTypeDef ObdSupp_Request(uint32_t now);
+static void ObdSupp_Response(const Uds_Response_t* rsp, void* context);
+static void ObdSupp_NextRange(const Uds_Response_t* rsp);
+static void ObdSupp_Finish(ObdSupp_ResultTypeDef result);
+static bool ObdSupp_Scan(uint32_t txId, ObdSupp_Record_t* found);
+static void ObdSupp_Save(void);
+static void ObdSupp_Append(uint32_t txId, const ObdSupp_Bitmap_t* bitmaps);
+static uint32_t ObdSupp_Check(const ObdSupp_Record_t* record);
+
+/* Variables */
+static const uint8_t suppModes[OBD_SUPP_MODE_COUNT] = OBD_SUPP_MODE_LIST;
+static ObdSupp_Ecu_t ecus[OBD_SUPP_MAX_ECUS];
+/* Entry replaced when all are in use */
+static uint8_t ecuNext;
+static ObdSupp_Job_t job;
+static const ObdSupp_Store_t* suppStore;
+static uint8_t suppVin[OBD_VIN_LENGTH];
+static bool suppVinKnown;
+/* First free record of the store, UINT32_MAX until the store is scanned */
+static uint32_t suppFree;
+/* The store is full and waits for ObdSupp_MainFunction() to erase it */
+static bool suppErasePending;
+static uint32_t suppIdleSince;
+
+
+/**
+ * @param store  Non-volatile store of the bitmaps, may be NULL.
+ */
+void ObdSupp_Init(const ObdSupp_Store_t* store){
+	suppStore = store;
+	suppFree = UINT32_MAX;
+	suppErasePending = false;
+	job.state = OBD_SUPP_IDLE;
+	ObdSupp_Reset();
+}
+
+/**
+ * @brief Discovers the supported PIDs of an ECU.
+ *
+ * With the VIN already known and the ECU in the store, the callback is
+ * called before this function returns and no request is sent.
+ *
+ * @return UDS_BUSY while another discovery runs.
+ */
+UDS_StatusTypeDef ObdSupp_Discover(uint32_t txId, uint32_t rxId, ObdSupp_DoneCallback_t callback, void* context, uint32_t now){
+	ObdSupp_Record_t record;
+	UDS_StatusTypeDef status;
+
+	if(job.state != OBD_SUPP_IDLE) return UDS_BUSY;
+
+	job.txId = txId;
+	job.rxId = rxId;
+	job.mode = 0;
+	job.base = 0;
+	job.answered = false;
+	memset(job.bitmaps, 0, sizeof(job.bitmaps));
+	job.callback = callback;
+	job.context = context;
+
+	if(suppVinKnown && ObdSupp_Scan(txId, &record)){
+		memcpy(job.bitmaps, record.bitmaps, sizeof(job.bitmaps));
+		ObdSupp_Finish(OBD_SUPP_RESTORED);
+		return UDS_OK;
+	}
+
+	job.state = suppVinKnown ? OBD_SUPP_READ_RANGES : OBD_SUPP_READ_VIN;
+	status = ObdSupp_Request(now);
+	if(status != UDS_OK){
+		job.state = OBD_SUPP_IDLE;
+	}
+
+	return status;
+}
+
+/**
+ * @return Bitmap of a discovered ECU and mode, NULL if there is none.
+ */
+const ObdSupp_Bitmap_t* ObdSupp_Get(uint32_t txId, uint8_t mode){
+	for(uint8_t i = 0; i < OBD_SUPP_MAX_ECUS; i++){
+		if(!ecus[i].used || ecus[i].txId != txId) continue;
+
+		for(uint8_t m = 0; m < OBD_SUPP_MODE_COUNT; m++){
+			if(suppModes[m] == mode) return &ecus[i].bitmaps[m];
+		}
+		return NULL;
+	}
+
+	return NULL;
+}
+
+/**
+ * @return VIN of the vehicle (OBD_VIN_LENGTH bytes), NULL if not read yet.
+ */
+const uint8_t* ObdSupp_GetVin(void){
+	return suppVinKnown ? suppVin : NULL;
+}
+
+/**
+ * @brief Erases a full store once the UDS client has been idle for
+ *        OBD_SUPP_ERASE_IDLE ms, then writes the bitmaps of every ECU known
+ *        for the current VIN. Called by the diagnostic task.
+ */
+void ObdSupp_MainFunction(uint32_t now){
+	if(!suppErasePending) return;
+
+	/* The erase stalls the CPU: not while anything waits on the bus */
+	if(job.state != OBD_SUPP_IDLE || Uds_OutstandingCount() != 0){
+		suppIdleSince = now;
+		return;
+	}
+	if((now - suppIdleSince) < OBD_SUPP_ERASE_IDLE) return;
+
+	suppErasePending = false;
+	if(!suppStore->Erase()){
+		/* Scanned again before the next save */
+		suppFree = UINT32_MAX;
+		return;
+	}
+	suppFree = 0;
+
+	if(!suppVinKnown) return;
+	for(uint8_t i = 0; i < OBD_SUPP_MAX_ECUS; i++){
+		if(ecus[i].used){
+			ObdSupp_Append(ecus[i].txId, ecus[i].bitmaps);
+		}
+	}
+}
+
+/**
+ * @brief Forgets the VIN and all bitmaps, e.g. for another vehicle. The store is kept.
+ */
+void ObdSupp_Reset(void){
+	suppVinKnown = false;
+	ecuNext = 0;
+	for(uint8_t i = 0; i < OBD_SUPP_MAX_ECUS; i++){
+		ecus[i].used = false;
+	}
+}
+
+
+/* Private functions */
+
+static UDS_StatusTypeDef ObdSupp_Request(uint32_t now){
+	uint8_t req[2];
+
+	if(job.state == OBD_SUPP_READ_VIN){
+		req[0] = OBD_MODE_VEHICLE_INFO;
+		req[1] = OBD_INFO_VIN;
+	}
+	else{
+		req[0] = suppModes[job.mode];
+		req[1] = job.base;
+	}
+
+	return Uds_Request(job.txId, job.rxId, req, sizeof(req), ObdSupp_Response, NULL, now);
+}
+
+static void ObdSupp_Response(const Uds_Response_t* rsp, void* context){
+	ObdSupp_Record_t record;
+
+	(void)context;
+
+	if(job.state == OBD_SUPP_READ_VIN){
+		/* 49 02 [NODI] VIN, the VIN is the last 17 bytes */
+		if(rsp->result == UDS_RESULT_POSITIVE && rsp->length >= 3u + OBD_VIN_LENGTH){
+			memcpy(suppVin, &rsp->data[rsp->length - OBD_VIN_LENGTH], OBD_VIN_LENGTH);
+			suppVinKnown = true;
+
+			if(ObdSupp_Scan(job.txId, &record)){
+				memcpy(job.bitmaps, record.bitmaps, sizeof(job.bitmaps));
+				ObdSupp_Finish(OBD_SUPP_RESTORED);
+				return;
+			}
+		}
+
+		job.state = OBD_SUPP_READ_RANGES;
+		if(ObdSupp_Request(Uds_GetTime()) != UDS_OK){
+			ObdSupp_Finish(OBD_SUPP_FAILED);
+		}
+		return;
+	}
+
+	ObdSupp_NextRange(rsp);
+}
+
+/**
+ * @brief Takes the answer of one range and asks for the next range or mode.
+ */
+static void ObdSupp_NextRange(const Uds_Response_t* rsp){
+	bool more = false;
+
+	/* 41 PID A B C D, bit 7 of A is PID + 1 */
+	if(rsp->result == UDS_RESULT_POSITIVE && rsp->length >= 6 && rsp->data[1] == job.base){
+		ObdSupp_Bitmap_t* const bitmap = &job.bitmaps[job.mode];
+
+		job.answered = true;
+		bitmap->bits[job.base >> 5] |= 1u;
+		for(uint8_t i = 0; i < 32; i++){
+			const uint32_t pid = (uint32_t)job.base + 1u + i;
+
+			if(pid > 0xFF) break;
+			if((rsp->data[2 + i / 8] & (0x80u >> (i % 8))) != 0){
+				bitmap->bits[pid >> 5] |= 1u << (pid & 31u);
+			}
+		}
+		more = job.base < OBD_SUPP_LAST_RANGE && ObdSupp_Test(bitmap, (uint8_t)(job.base + OBD_SUPP_RANGE));
+	}
+
+	if(more){
+		job.base = (uint8_t)(job.base + OBD_SUPP_RANGE);
+	}
+	else{
+		job.mode++;
+		job.base = 0;
+		if(job.mode == OBD_SUPP_MODE_COUNT){
+			if(job.answered){
+				ObdSupp_Save();
+				ObdSupp_Finish(OBD_SUPP_DISCOVERED);
+			}
+			else{
+				ObdSupp_Finish(OBD_SUPP_FAILED);
+			}
+			return;
+		}
+	}
+
+	if(ObdSupp_Request(Uds_GetTime()) != UDS_OK){
+		ObdSupp_Finish(OBD_SUPP_FAILED);
+	}
+}
+
+static void ObdSupp_Finish(ObdSupp_ResultTypeDef result){
+	ObdSupp_Ecu_t* ecu = NULL;
+
+	if(result != OBD_SUPP_FAILED){
+		for(uint8_t i = 0; i < OBD_SUPP_MAX_ECUS; i++){
+			if(ecus[i].used && ecus[i].txId == job.txId){
+				ecu = &ecus[i];
+				break;
+			}
+		}
+		if(ecu == NULL){
+			ecu = &ecus[ecuNext];
+			ecuNext = (uint8_t)((ecuNext + 1) % OBD_SUPP_MAX_ECUS);
+		}
+		ecu->used = true;
+		ecu->txId = job.txId;
+		memcpy(ecu->bitmaps, job.bitmaps, sizeof(ecu->bitmaps));
+	}
+
+	job.state = OBD_SUPP_IDLE;
+	if(job.callback != NULL){
+		job.callback(job.txId, result, job.context);
+	}
+}
+
+/**
+ * @brief Looks up the latest record of the current VIN and ECU and finds
+ *        the first free record on the way.
+ */
+static bool ObdSupp_Scan(uint32_t txId, ObdSupp_Record_t* found){
+	ObdSupp_Record_t record;
+	bool match = false;
+	uint32_t offset;
+
+	if(suppStore == NULL) return false;
+
+	for(offset = 0; offset + sizeof(record) <= suppStore->size; offset += sizeof(record)){
+		if(!suppStore->Read(offset, &record, sizeof(record)) || record.magic == OBD_SUPP_ERASED) break;
+
+		if(record.magic == OBD_SUPP_MAGIC && record.check == ObdSupp_Check(&record) && record.txId == txId
+				&& memcmp(record.vin, suppVin, OBD_VIN_LENGTH) == 0){
+			*found = record;
+			match = true;
+		}
+	}
+	suppFree = offset;
+
+	return match;
+}
+
+/**
+ * @brief Appends the bitmaps of the job; a full store is left to
+ *        ObdSupp_MainFunction(), which writes them after the erase.
+ */
+static void ObdSupp_Save(void){
+	ObdSupp_Record_t record;
+
+	if(suppStore == NULL || !suppVinKnown) return;
+
+	if(suppFree == UINT32_MAX){
+		(void)ObdSupp_Scan(job.txId, &record);
+	}
+	if(suppFree + sizeof(record) > suppStore->size){
+		if(!suppErasePending){
+			suppErasePending = true;
+			suppIdleSince = Uds_GetTime();
+		}
+		return;
+	}
+
+	ObdSupp_Append(job.txId, job.bitmaps);
+}
+
+static void ObdSupp_Append(uint32_t txId, const ObdSupp_Bitmap_t* bitmaps){
+	ObdSupp_Record_t record;
+
+	memset(&record, 0, sizeof(record));
+	record.magic = OBD_SUPP_MAGIC;
+	record.txId = txId;
+	memcpy(record.vin, suppVin, OBD_VIN_LENGTH);
+	memcpy(record.bitmaps, bitmaps, sizeof(record.bitmaps));
+	record.check = ObdSupp_Check(&record);
+
+	/* A failed write leaves a record that fails its check, it is skipped */
+	(void)suppStore->Write(suppFree, &record, sizeof(record));
+	suppFree += sizeof(record);
+}
+
+static uint32_t ObdSupp_Check(const ObdSupp_Record_t* record){
+	const uint8_t* const p = (const uint8_t*)record;
+	uint32_t hash = 2166136261u;
+
+	for(uint32_t i = 0; i < offsetof(ObdSupp_Record_t, check); i++){
+		hash = (hash ^ p[i]) * 16777619u;
+	}
+
+	return hash;
+}
@@ -8,22 +8,234 @@
 #ifndef SRC_UDS_INC_UDS_CFG_H_
 #define SRC_UDS_INC_UDS_CFG_H_
 
+#include <stdint.h>
+
 /* CAN IDs / Request IDs */
 #define BROADCAST_REQUEST_ID 0x7DF
+/* Physical request IDs 0x7E0-0x7E7, the ECU answers on request ID + 8 */
+#define PHYSICAL_REQUEST_ID_BASE 0x7E0
+#define PHYSICAL_RESPONSE_OFFSET 0x08
+/* 29-bit normal fixed addressing (ISO 15765-4): 0x18DA<target><source>,
+ * functional 0x18DB33<source>, the tester is address 0xF1 */
+#define BROADCAST_REQUEST_ID_EXT      0x18DB33F1
+#define PHYSICAL_REQUEST_ID_EXT_BASE  0x18DA00F1
+#define PHYSICAL_RESPONSE_ID_EXT_BASE 0x18DAF100
 
 /* Services IDs */
 #define SID_DIAGNOSTIC_SESSION_CONTROL 0x10
+#define SID_ECU_RESET                  0x11
 #define SID_READ_DTC_INFO              0x19
 #define SID_READ_DATA_BY_ID            0x22
+#define SID_READ_MEMORY_BY_ADDRESS     0x23
+#define SID_READ_DATA_BY_PERIODIC_ID   0x2A
+#define SID_DYNAMICALLY_DEFINE_DATA_ID 0x2C
+#define SID_REQUEST_DOWNLOAD           0x34
+#define SID_REQUEST_UPLOAD             0x35
+#define SID_TRANSFER_DATA              0x36
+#define SID_REQUEST_TRANSFER_EXIT      0x37
+#define SID_TESTER_PRESENT             0x3E
+#define SID_NEGATIVE_RESPONSE          0x7F
+
+/* Positive response SID = request SID + offset */
+#define POSITIVE_RESPONSE_OFFSET 0x40
 
 /* Sub-Functions */
 #define DEFAULT_SESSION             0x01
 #define PROGRAMMING_SESSION         0x02
 #define EXTENDED_DIAGNOSTIC_SESSION 0x03
 
+#define HARD_RESET                  0x01
+#define KEY_OFF_ON_RESET            0x02
+#define SOFT_RESET                  0x03
+
+#define ZERO_SUB_FUNCTION           0x00
+
+/* transmissionMode of ReadDataByPeriodicIdentifier */
+#define SEND_AT_SLOW_RATE           0x01
+#define SEND_AT_MEDIUM_RATE         0x02
+#define SEND_AT_FAST_RATE           0x03
+#define STOP_SENDING                0x04
+
+/* DynamicallyDefineDataIdentifier */
+#define DEFINE_BY_IDENTIFIER        0x01
+#define DEFINE_BY_MEMORY_ADDRESS    0x02
+#define CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER 0x03
+
+/* Report types of ReadDTCInformation */
+#define REPORT_NUMBER_OF_DTC_BY_STATUS_MASK  0x01
+#define REPORT_DTC_BY_STATUS_MASK            0x02
+#define REPORT_DTC_SNAPSHOT_RECORD_BY_DTC    0x04
+#define REPORT_DTC_EXT_DATA_RECORD_BY_DTC    0x06
+#define REPORT_SUPPORTED_DTC                 0x0A
+
+/* Set in a sub-function byte: the server sends no positive response */
+#define SUPPRESS_POS_RSP_MSG_INDICATION_BIT 0x80
+
 /* Data Identifier */
+#define DID_ACTIVE_DIAGNOSTIC_SESSION         0xF186
+#define DID_SPARE_PART_NUMBER                 0xF187
+#define DID_ECU_SOFTWARE_NUMBER               0xF188
 #define DID_MANUFACTURER_ECU_SOFTWARE_VERSION 0xF189
+#define DID_SYSTEM_SUPPLIER_IDENTIFIER        0xF18A
+#define DID_ECU_MANUFACTURING_DATE            0xF18B
+#define DID_ECU_SERIAL_NUMBER                 0xF18C
 #define DID_VEHICLE_INDENTIFICATION_NUMBER    0xF190
+#define DID_ECU_HARDWARE_NUMBER               0xF191
+#define DID_SYSTEM_NAME                       0xF197
+/* Range of dynamically defined DIDs */
+#define DID_DYNAMIC_FIRST                     0xF200
+#define DID_DYNAMIC_LAST                      0xF3FF
+
+/* Session masks of the service table */
+#define UDS_SESSION_BIT(session) ((uint8_t)(((session) >= 1 && (session) <= 6) ? (1u << (session)) : 0x80))
+#define UDS_SESSIONS_ALL         ((uint8_t) 0xFF)
+#define UDS_SESSIONS_NON_DEFAULT ((uint8_t)(UDS_SESSIONS_ALL & ~UDS_SESSION_BIT(DEFAULT_SESSION)))
+
+/*
+ * Service table, expanded into the 256 entry dispatch table (uds_dispatch.c).
+ * X(sid, request min length, response min length, sessions, sub-functions, handler, parser)
+ *   sub-functions: UDS_SUBFN(sorted array in uds_dispatch.c) or UDS_NO_SUBFN
+ *   handler:       side effects of a positive response, or NULL
+ *   parser:        checks the response against the request, or NULL
+ */
+#define UDS_SERVICE_TABLE(X) \
+	X(SID_DIAGNOSTIC_SESSION_CONTROL, 2, 2, UDS_SESSIONS_ALL, UDS_SUBFN(udsSubFnSessionControl), Uds_HandleSessionControl, Uds_ParseEchoSubFunction) \
+	X(SID_ECU_RESET,                  2, 2, UDS_SESSIONS_ALL, UDS_SUBFN(udsSubFnEcuReset),       Uds_HandleEcuReset,       Uds_ParseEchoSubFunction) \
+	X(SID_READ_DTC_INFO,              2, 2, UDS_SESSIONS_ALL, UDS_SUBFN(udsSubFnReadDtcInfo),    NULL,                     Uds_ParseEchoSubFunction) \
+	X(SID_READ_DATA_BY_ID,            3, 3, UDS_SESSIONS_ALL, UDS_NO_SUBFN,                      NULL,                     Uds_ParseReadDataById) \
+	X(SID_READ_MEMORY_BY_ADDRESS,     4, 1, UDS_SESSIONS_ALL, UDS_NO_SUBFN,                      NULL,                     NULL) \
+	X(SID_READ_DATA_BY_PERIODIC_ID,   2, 1, UDS_SESSIONS_ALL, UDS_NO_SUBFN,                      NULL,                     NULL) \
+	X(SID_DYNAMICALLY_DEFINE_DATA_ID, 2, 2, UDS_SESSIONS_ALL, UDS_SUBFN(udsSubFnDynamicDefine),  Uds_HandleDynamicDefine,  Uds_ParseEchoSubFunction) \
+	X(SID_REQUEST_DOWNLOAD,           5, 2, UDS_SESSIONS_NON_DEFAULT, UDS_NO_SUBFN,              Uds_HandleRequestDownload, NULL) \
+	X(SID_REQUEST_UPLOAD,             5, 3, UDS_SESSIONS_NON_DEFAULT, UDS_NO_SUBFN,              NULL,                     NULL) \
+	X(SID_TRANSFER_DATA,              2, 2, UDS_SESSIONS_NON_DEFAULT, UDS_NO_SUBFN,              NULL,                     Uds_ParseTransferData) \
+	X(SID_REQUEST_TRANSFER_EXIT,      1, 1, UDS_SESSIONS_NON_DEFAULT, UDS_NO_SUBFN,              NULL,                     NULL) \
+	X(SID_TESTER_PRESENT,             2, 2, UDS_SESSIONS_ALL, UDS_SUBFN(udsSubFnTesterPresent),  NULL,                     Uds_ParseEchoSubFunction)
+
+/*
+ * Known DIDs, SORTED by DID (binary search).
+ * X(did, data length or 0 if variable, UDS_DID_STATIC if the value never changes while powered)
+ */
+#define UDS_DID_TABLE(X) \
+	X(DID_ACTIVE_DIAGNOSTIC_SESSION,         1,  0) \
+	X(DID_SPARE_PART_NUMBER,                 0,  UDS_DID_STATIC) \
+	X(DID_ECU_SOFTWARE_NUMBER,               0,  UDS_DID_STATIC) \
+	X(DID_MANUFACTURER_ECU_SOFTWARE_VERSION, 0,  UDS_DID_STATIC) \
+	X(DID_SYSTEM_SUPPLIER_IDENTIFIER,        0,  UDS_DID_STATIC) \
+	X(DID_ECU_MANUFACTURING_DATE,            0,  UDS_DID_STATIC) \
+	X(DID_ECU_SERIAL_NUMBER,                 0,  UDS_DID_STATIC) \
+	X(DID_VEHICLE_INDENTIFICATION_NUMBER,    17, UDS_DID_STATIC) \
+	X(DID_ECU_HARDWARE_NUMBER,               0,  UDS_DID_STATIC) \
+	X(DID_SYSTEM_NAME,                       0,  UDS_DID_STATIC)
+
+/* Negative Response Codes */
+#define NRC_GENERAL_REJECT               0x10
+#define NRC_SERVICE_NOT_SUPPORTED        0x11
+#define NRC_SUB_FUNCTION_NOT_SUPPORTED   0x12
+#define NRC_INCORRECT_MESSAGE_LENGTH     0x13
+#define NRC_RESPONSE_TOO_LONG            0x14
+#define NRC_BUSY_REPEAT_REQUEST          0x21
+#define NRC_CONDITIONS_NOT_CORRECT       0x22
+#define NRC_REQUEST_SEQUENCE_ERROR       0x24
+#define NRC_REQUEST_OUT_OF_RANGE         0x31
+#define NRC_SECURITY_ACCESS_DENIED       0x33
+#define NRC_RESPONSE_PENDING             0x78
+#define NRC_SERVICE_NOT_SUPPORTED_IN_SESSION 0x7F
+
+/* Client timing in ms (ISO 14229-2): P2 / P2* server defaults plus bus margin */
+#define UDS_P2_CLIENT     ((uint32_t) 150)
+#define UDS_P2_EXT_CLIENT ((uint32_t) 5100)
+/* Idle time after which an ECU in a non-default session gets a TesterPresent
+ * (S3client, ISO 14229-2; the server drops the session after S3 = 5000 ms) */
+#define UDS_S3_CLIENT     ((uint32_t) 2000)
+/* NRC 0x78 accepted in a row before the request is given up */
+#define UDS_RESPONSE_PENDING_MAX ((uint8_t) 32)
+
+/* Outstanding client requests (all ECUs) */
+#define UDS_CLIENT_MAX_REQUESTS ((uint8_t) 16)
+/* ECUs whose non-default session is tracked */
+#define UDS_CLIENT_MAX_ECUS     ((uint8_t) 16)
+/* Requests up to this size are copied, longer ones are referenced */
+#define UDS_CLIENT_INLINE_SIZE  ((uint8_t) 16)
+/* Longest wait of a queued request for a free ISO-TP channel (ms) */
+#define UDS_CLIENT_LINK_WAIT    ((uint32_t) 10000)
+/* ECUs answering a functional request on BROADCAST_REQUEST_ID (0x7E0-0x7E7) */
+#define UDS_CLIENT_FUNCTIONAL_ECUS ((uint8_t) 8)
+
+/* ReadDataByIdentifier batching */
+#define UDS_RDBI_MAX_JOBS        ((uint8_t) 4)
+/* DIDs of one batch job */
+#define UDS_RDBI_MAX_DIDS        ((uint8_t) 32)
+/* DIDs packed into one request until an ECU asks for fewer */
+#define UDS_RDBI_MAX_PER_REQUEST ((uint8_t) 16)
+/* Lengths of variable length DIDs learned per ECU */
+#define UDS_RDBI_LEARNED_LENGTHS ((uint8_t) 32)
+
+/* DID cache: entries, arena (blocks of UDS_DIDCACHE_BLOCK_SIZE bytes) and
+ * lifetime of volatile values in ms */
+#define UDS_DIDCACHE_ENTRIES      ((uint8_t) 48)
+#define UDS_DIDCACHE_BLOCK_SIZE   ((uint32_t) 16)
+#define UDS_DIDCACHE_BLOCK_COUNT  ((uint32_t) 128)
+#define UDS_DIDCACHE_VOLATILE_TTL ((uint32_t) 1000)
+
+/* ReadDTCInformation streaming: reports running at once and DTC records
+ * decoded before they are passed on */
+#define UDS_DTC_MAX_JOBS ((uint8_t) 2)
+#define UDS_DTC_BATCH    ((uint8_t) 16)
+
+/* Memory dump: largest ReadMemoryByAddress block (the whole response must fit
+ * the 4095 byte ISO-TP length) and retries of a failed block */
+#define UDS_DUMP_RMBA_BLOCK ((uint16_t) 4094)
+#define UDS_DUMP_RETRIES    ((uint8_t) 2)
+/* Dump data is passed on in chunks of this size, not per CAN frame */
+#define UDS_DUMP_CHUNK      ((uint16_t) 256)
+
+/* Flashing: largest TransferData payload (two blocks are buffered) and
+ * retries of a failed block */
+#define UDS_FLASH_BLOCK_MAX ((uint16_t) 2048)
+#define UDS_FLASH_RETRIES   ((uint8_t) 2)
+
+/* Periodic DIDs (0x2A): schedules running at once, periodicDataIdentifiers
+ * per schedule, samples passed on together and the longest they are held */
+#define UDS_PDID_MAX_JOBS ((uint8_t) 4)
+#define UDS_PDID_MAX_IDS  ((uint8_t) 8)
+#define UDS_PDID_BATCH    ((uint8_t) 16)
+#define UDS_PDID_FLUSH    ((uint32_t) 10)
+
+/* Dynamically defined DIDs (0x2C): composite DIDs defined at once, signals
+ * per composite DID and size of one define request */
+#define UDS_DDID_MAX_DEFS    ((uint8_t) 2)
+#define UDS_DDID_MAX_SIGNALS ((uint8_t) 32)
+#define UDS_DDID_REQUEST_MAX ((uint8_t) 64)
+
+/* Response time profile: ECU / SID pairs tracked and log2 buckets per
+ * histogram (the last one holds 1024 ms and more) */
+#define UDS_PROF_ENTRIES ((uint8_t) 32)
+#define UDS_PROF_BUCKETS ((uint8_t) 12)
+
+/* Simulated ECU: largest request and response, pending response period
+ * and server timing (ISO 14229-2) in ms */
+#define UDS_SERVER_REQUEST_MAX    ((uint16_t) 64)
+#define UDS_SERVER_RESPONSE_MAX   ((uint16_t) 1024)
+#define UDS_SERVER_P2             ((uint16_t) 50)
+#define UDS_SERVER_P2_EXT         ((uint16_t) 5000)
+#define UDS_SERVER_S3             ((uint32_t) 5000)
+#define UDS_SERVER_PENDING_PERIOD ((uint32_t) 2000)
+
+/* Sequence bytecode: largest program, registers, response bytes kept,
+ * output buffer of EMIT and instructions run per pass */
+#define UDS_SEQ_CODE_MAX       ((uint16_t) 1024)
+#define UDS_SEQ_REGS           ((uint8_t) 16)
+#define UDS_SEQ_RSP_MAX        ((uint16_t) 512)
+#define UDS_SEQ_OUT_MAX        ((uint16_t) 256)
+#define UDS_SEQ_STEPS_PER_PASS ((uint8_t) 32)
+
+/* ECU discovery: ECUs kept, physical probes queued per call and the
+ * 29-bit target addresses probed physically */
+#define UDS_DISC_MAX_ECUS     ((uint8_t) 32)
+#define UDS_DISC_BATCH        ((uint8_t) 16)
+#define UDS_DISC_EXT_FIRST    ((uint8_t) 0x00)
+#define UDS_DISC_EXT_LAST     ((uint8_t) 0xFF)
 
 
 #endif /* SRC_UDS_INC_UDS_CFG_H_ */
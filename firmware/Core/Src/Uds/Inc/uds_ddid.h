@@ -0,0 +1,59 @@
+/*
+ * uds_ddid.h
+ *
+ *  Created on: Aug 12, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Composite DIDs built with DynamicallyDefineDataIdentifier (0x2C).
+ *
+ * A list of signals, each taken from a source DID (defineByIdentifier) or
+ * from a memory address (defineByMemoryAddress), is packed into one
+ * dynamically defined DID. UdsDdid_Define() clears the DID and defines it
+ * with as few requests as possible: consecutive signals of the same kind
+ * share a request, each further request appends to the DID. A poll is then
+ * a single ReadDataByIdentifier whose response is split back into the
+ * signals, in list order.
+ */
+
+#ifndef SRC_UDS_INC_UDS_DDID_H_
+#define SRC_UDS_INC_UDS_DDID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+
+/* Enums */
+typedef enum{
+	UDS_DDID_BY_ID,
+	UDS_DDID_BY_ADDRESS
+}UdsDdid_SourceTypeDef;
+
+/* Structures */
+typedef struct{
+	UdsDdid_SourceTypeDef source;
+	/* Bytes of the signal */
+	uint8_t size;
+	/* UDS_DDID_BY_ID: source DID and 1-based position in its data record */
+	uint16_t did;
+	uint8_t position;
+	/* UDS_DDID_BY_ADDRESS */
+	uint32_t address;
+}UdsDdid_Signal_t;
+
+typedef struct{
+	const uint8_t* data;
+	uint8_t size;
+}UdsDdid_Value_t;
+
+/* Signal values of one poll, in the order of the definition */
+typedef void (*UdsDdid_Sink_t)(uint8_t handle, const UdsDdid_Value_t* values, uint8_t count, void* context);
+
+/* Functions */
+extern void UdsDdid_Init(void);
+extern UDS_StatusTypeDef UdsDdid_Define(uint32_t txId, uint32_t rxId, uint16_t ddid, uint8_t alfid,
+		const UdsDdid_Signal_t* signals, uint8_t count, Uds_Callback_t callback, void* context,
+		uint8_t* handle, uint32_t now);
+extern UDS_StatusTypeDef UdsDdid_Poll(uint8_t handle, UdsDdid_Sink_t sink, Uds_Callback_t callback, void* context, uint32_t now);
+extern UDS_StatusTypeDef UdsDdid_Clear(uint8_t handle, uint32_t now);
+
+#endif /* SRC_UDS_INC_UDS_DDID_H_ */
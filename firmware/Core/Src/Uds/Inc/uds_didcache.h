@@ -0,0 +1,41 @@
+/*
+ * uds_didcache.h
+ *
+ *  Created on: Aug 6, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Cache of DID values keyed by (ECU, DID).
+ *
+ * Values live in a fixed block arena; when it or the entry table is full
+ * the least recently used entries are evicted. DIDs flagged UDS_DID_STATIC
+ * in UDS_DID_TABLE stay valid until any DiagnosticSessionControl response
+ * (to whichever session), a reset or a download; all other DIDs also
+ * expire after
+ * UDS_DIDCACHE_VOLATILE_TTL ms.
+ */
+
+#ifndef SRC_UDS_INC_UDS_DIDCACHE_H_
+#define SRC_UDS_INC_UDS_DIDCACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Structures */
+typedef struct{
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t evictions;
+	uint32_t invalidations;
+	uint8_t entries;
+	uint32_t bytesFree;
+}UdsDidCache_Stats_t;
+
+/* Functions */
+extern bool UdsDidCache_Init(void);
+extern bool UdsDidCache_Lookup(uint32_t txId, uint16_t did, uint32_t now, const uint8_t** data, uint16_t* length);
+extern void UdsDidCache_Store(uint32_t txId, uint16_t did, const uint8_t* data, uint16_t length, uint32_t now);
+extern void UdsDidCache_Invalidate(uint32_t txId, bool keepStatic);
+extern void UdsDidCache_GetStats(UdsDidCache_Stats_t* stats);
+extern void UdsDidCache_ResetStats(void);
+
+#endif /* SRC_UDS_INC_UDS_DIDCACHE_H_ */
@@ -0,0 +1,55 @@
+/*
+ * uds_discovery.h
+ *
+ *  Created on: Aug 8, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief ECU discovery on 11-bit and 29-bit addressing.
+ *
+ * A scan sends TesterPresent (3E 00) functionally on BROADCAST_REQUEST_ID
+ * and BROADCAST_REQUEST_ID_EXT and collects every responder within one P2
+ * window. Addresses that stayed silent are then probed physically
+ * (0x7E0-0x7E7 and 0x18DA<UDS_DISC_EXT_FIRST..LAST>F1): the probes are
+ * single frames queued back to back, as fast as the CAN Tx buffer takes
+ * them, each one timing out P2 after it was queued, so the whole physical
+ * pass takes about one bus burst plus one P2 instead of one P2 per address.
+ *
+ * Probes and responses are raw single frames, no ISO-TP channel is used;
+ * UdsDisc_RxFrame() sees every received frame before the channels do.
+ */
+
+#ifndef SRC_UDS_INC_UDS_DISCOVERY_H_
+#define SRC_UDS_INC_UDS_DISCOVERY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+#include "../../Com/CanTp/Inc/cantp.h"
+
+/* Defines */
+/* How an ECU was found */
+#define UDS_DISC_FUNCTIONAL ((uint8_t) 0x01)
+#define UDS_DISC_PHYSICAL   ((uint8_t) 0x02)
+
+/* Structures */
+typedef struct{
+	/* Physical request / response IDs, CANTP_ID_EXT marks 29-bit IDs */
+	uint32_t txId;
+	uint32_t rxId;
+	/* Request queued to first response frame (ms) */
+	uint16_t latency;
+	uint8_t found;
+}UdsDisc_Ecu_t;
+
+/* Scan finished; duration in ms */
+typedef void (*UdsDisc_DoneCallback_t)(const UdsDisc_Ecu_t* ecus, uint8_t count, uint32_t duration, void* context);
+
+/* Functions */
+extern void UdsDisc_Init(CanTp_SendFrame_t sendFrame);
+extern UDS_StatusTypeDef UdsDisc_Start(UdsDisc_DoneCallback_t callback, void* context, uint32_t now);
+extern void UdsDisc_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now);
+extern void UdsDisc_MainFunction(uint32_t now);
+extern bool UdsDisc_IsRunning(void);
+extern const UdsDisc_Ecu_t* UdsDisc_GetEcus(uint8_t* count);
+
+#endif /* SRC_UDS_INC_UDS_DISCOVERY_H_ */
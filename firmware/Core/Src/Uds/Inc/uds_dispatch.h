@@ -0,0 +1,74 @@
+/*
+ * uds_dispatch.h
+ *
+ *  Created on: Aug 4, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Constant service, sub-function and DID tables.
+ *
+ * The service table is indexed by SID (256 entries in flash), so looking up
+ * a service costs one indexed load however many services are configured.
+ * Sub-functions and DIDs are kept in sorted const arrays and found by
+ * binary search. All tables are generated from the X-macro lists in
+ * uds_cfg.h; adding a service or DID is a one line change there.
+ */
+
+#ifndef SRC_UDS_INC_UDS_DISPATCH_H_
+#define SRC_UDS_INC_UDS_DISPATCH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_cfg.h"
+
+/* Defines */
+/* DID flag: the value does not change while the ECU is powered */
+#define UDS_DID_STATIC ((uint8_t) 0x01)
+
+/* Structures */
+/* Side effects of a positive response (e.g. session tracking) */
+typedef void (*Uds_Handler_t)(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+/* Checks a positive response against its request; false if malformed */
+typedef bool (*Uds_Parser_t)(const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+
+typedef struct{
+	Uds_Handler_t handler;
+	Uds_Parser_t parser;
+	/* Sorted supported sub-functions, NULL if the service has none */
+	const uint8_t* subFunctions;
+	uint8_t subFunctionCount;
+	/* 0 marks a SID that is not configured */
+	uint8_t reqMinLen;
+	uint8_t rspMinLen;
+	/* UDS_SESSION_BIT() mask of the sessions the service is allowed in */
+	uint8_t sessions;
+}Uds_Service_t;
+
+typedef struct{
+	uint16_t did;
+	/* Data length, 0 if variable */
+	uint8_t length;
+	uint8_t flags;
+}Uds_DidInfo_t;
+
+/* Variables */
+extern const Uds_Service_t udsServices[256];
+
+/* Functions */
+extern bool Uds_DispatchCheck(void);
+extern bool Uds_HasSubFunction(const Uds_Service_t* svc, uint8_t subFunction);
+extern const Uds_DidInfo_t* Uds_FindDid(uint16_t did);
+
+/* Handlers and parsers referenced by UDS_SERVICE_TABLE */
+extern void Uds_HandleSessionControl(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+extern void Uds_HandleEcuReset(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+extern void Uds_HandleRequestDownload(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+extern void Uds_HandleDynamicDefine(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+extern bool Uds_ParseEchoSubFunction(const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+extern bool Uds_ParseReadDataById(const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+extern bool Uds_ParseTransferData(const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen);
+
+static inline const Uds_Service_t* Uds_GetService(uint8_t sid){
+	return &udsServices[sid];
+}
+
+#endif /* SRC_UDS_INC_UDS_DISPATCH_H_ */
@@ -0,0 +1,75 @@
+/*
+ * uds_dtc.h
+ *
+ *  Created on: Aug 7, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Streaming ReadDTCInformation (0x19) decoder.
+ *
+ * The response is decoded while ISO-TP receives it (Uds_RequestStream()),
+ * it is never buffered: every CAN frame yields the DTC records it completes,
+ * so the first DTCs are known one frame after the FF and memory use does
+ * not depend on the number of DTCs stored in the ECU.
+ *
+ * Supported report types:
+ *   0x01 reportNumberOfDTCByStatusMask      HEADER with the count
+ *   0x02 reportDTCByStatusMask              HEADER, RECORDS ...
+ *   0x04 reportDTCSnapshotRecordByDTCNumber HEADER, RECORDS (1), DATA ...
+ *   0x06 reportDTCExtDataRecordByDTCNumber  HEADER, RECORDS (1), DATA ...
+ *   0x0A reportSupportedDTC                 HEADER, RECORDS ...
+ * each report closed by one END event. Snapshot and extended data records
+ * have ECU specific layouts and are passed on raw.
+ */
+
+#ifndef SRC_UDS_INC_UDS_DTC_H_
+#define SRC_UDS_INC_UDS_DTC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+
+/* Enums */
+typedef enum{
+	UDS_DTC_EVT_HEADER,
+	UDS_DTC_EVT_RECORDS,
+	UDS_DTC_EVT_DATA,
+	UDS_DTC_EVT_END
+}UdsDtc_EventTypeDef;
+
+/* Structures */
+typedef struct{
+	/* 24-bit DTC */
+	uint32_t dtc;
+	uint8_t status;
+}UdsDtc_Record_t;
+
+typedef struct{
+	UdsDtc_EventTypeDef type;
+	uint32_t txId;
+	uint8_t subFunction;
+	/* HEADER: DTCStatusAvailabilityMask, plus format and count for 0x01 */
+	uint8_t availMask;
+	uint8_t formatId;
+	uint16_t count;
+	/* RECORDS */
+	const UdsDtc_Record_t* records;
+	uint8_t recordCount;
+	/* DATA: record data following the DTC, offset counts from its first byte */
+	uint32_t offset;
+	const uint8_t* data;
+	uint32_t length;
+	/* END: outcome, NRC of a negative response and DTC records decoded */
+	Uds_ResultTypeDef result;
+	uint8_t nrc;
+	uint16_t total;
+}UdsDtc_Event_t;
+
+/* Receives the decoded report; false (HEADER, RECORDS, DATA) aborts the reception */
+typedef bool (*UdsDtc_Sink_t)(const UdsDtc_Event_t* evt, void* context);
+
+/* Functions */
+extern void UdsDtc_Init(void);
+extern UDS_StatusTypeDef UdsDtc_Read(uint32_t txId, uint32_t rxId, uint8_t subFunction, uint32_t dtc, uint8_t param,
+		UdsDtc_Sink_t sink, void* context, uint32_t now);
+
+#endif /* SRC_UDS_INC_UDS_DTC_H_ */
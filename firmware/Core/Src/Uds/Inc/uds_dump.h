@@ -0,0 +1,69 @@
+/*
+ * uds_dump.h
+ *
+ *  Created on: Aug 9, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief ECU memory dump driven by the device.
+ *
+ * The caller gives an address range; the dump then issues
+ * ReadMemoryByAddress (0x23) requests, or RequestUpload (0x35) followed by
+ * TransferData (0x36) and RequestTransferExit (0x37), back to back: each
+ * request is queued from the completion of the previous one. Blocks are as
+ * large as the ECU allows (maxNumberOfBlockLength for an upload,
+ * UDS_DUMP_RMBA_BLOCK halved on NRC 0x13 / 0x14 / 0x31 for 0x23).
+ *
+ * Responses are streamed, not reassembled: data is collected in
+ * UDS_DUMP_CHUNK byte chunks and handed to the sink while the rest of the
+ * block is still on the bus. A failed block is requested again (same
+ * blockSequenceCounter for an upload), so the sink may see an address
+ * range twice; the last data wins.
+ */
+
+#ifndef SRC_UDS_INC_UDS_DUMP_H_
+#define SRC_UDS_INC_UDS_DUMP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+
+/* Enums */
+typedef enum{
+	UDS_DUMP_READ_MEMORY,
+	UDS_DUMP_UPLOAD
+}UdsDump_MethodTypeDef;
+
+typedef enum{
+	/* A block is about to be received; refusing it holds the ECU (FC.WAIT) */
+	UDS_DUMP_EVT_BLOCK,
+	UDS_DUMP_EVT_DATA,
+	UDS_DUMP_EVT_END
+}UdsDump_EventTypeDef;
+
+/* Structures */
+typedef struct{
+	UdsDump_EventTypeDef type;
+	uint32_t txId;
+	/* BLOCK / DATA: memory address of the block / of data[0] */
+	uint32_t address;
+	/* BLOCK: block length requested (upper bound for an upload) */
+	uint32_t length;
+	const uint8_t* data;
+	/* END */
+	Uds_ResultTypeDef result;
+	uint8_t nrc;
+	uint32_t bytes;
+	uint16_t requests;
+	uint32_t duration;
+}UdsDump_Event_t;
+
+/* BLOCK and DATA may refuse (false); END is final */
+typedef bool (*UdsDump_Sink_t)(const UdsDump_Event_t* evt, void* context);
+
+/* Functions */
+extern void UdsDump_Init(void);
+extern UDS_StatusTypeDef UdsDump_Start(uint32_t txId, uint32_t rxId, UdsDump_MethodTypeDef method,
+		uint32_t address, uint32_t length, uint8_t alfid, UdsDump_Sink_t sink, void* context, uint32_t now);
+extern bool UdsDump_IsRunning(void);
+
+#endif /* SRC_UDS_INC_UDS_DUMP_H_ */
@@ -0,0 +1,66 @@
+/*
+ * uds_flash.h
+ *
+ *  Created on: Aug 10, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief ECU reflashing with RequestDownload (0x34), TransferData (0x36)
+ * and RequestTransferExit (0x37).
+ *
+ * The image is pulled from a source (HostFlash_Source(), fed by the host
+ * over USB) into two block buffers: while one block is on the bus the next
+ * one is filled, so the next TransferData goes out as soon as the previous
+ * one is confirmed.
+ * The first block is already filled while the ECU erases during 0x34.
+ * Blocks are as large as maxNumberOfBlockLength allows, up to
+ * UDS_FLASH_BLOCK_MAX. NRC 0x78 (erase, write) is handled by the client;
+ * a lost block is sent again with the same blockSequenceCounter, which
+ * wraps from 0xFF to 0x00.
+ *
+ * The ECU must be in the programming session (and unlocked) before
+ * UdsFlash_Start().
+ */
+
+#ifndef SRC_UDS_INC_UDS_FLASH_H_
+#define SRC_UDS_INC_UDS_FLASH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+
+/* Structures */
+typedef struct{
+	uint32_t txId;
+	Uds_ResultTypeDef result;
+	uint8_t nrc;
+	/* Service that failed, 0 on success */
+	uint8_t sid;
+	uint32_t bytes;
+	uint16_t blocks;
+	uint16_t retries;
+	/* TransferData payload negotiated */
+	uint16_t blockLength;
+	/* Whole transfer, 0x34 to 0x37, in ms */
+	uint32_t duration;
+	uint32_t bytesPerSecond;
+	/* ms the bus was idle for lack of host data / ms spent waiting for ECU responses */
+	uint32_t hostWait;
+	uint32_t ecuWait;
+}UdsFlash_Report_t;
+
+/*
+ * Copies up to len bytes of the image, starting at offset, to data.
+ * Returns the bytes copied, 0 if the host has not sent them yet.
+ */
+typedef uint32_t (*UdsFlash_Source_t)(uint32_t offset, uint8_t* data, uint32_t len, void* context);
+typedef void (*UdsFlash_DoneCallback_t)(const UdsFlash_Report_t* report, void* context);
+
+/* Functions */
+extern void UdsFlash_Init(void);
+extern UDS_StatusTypeDef UdsFlash_Start(uint32_t txId, uint32_t rxId, uint32_t address, uint32_t length,
+		uint8_t alfid, uint8_t dataFormat, UdsFlash_Source_t source, UdsFlash_DoneCallback_t callback,
+		void* context, uint32_t now);
+extern void UdsFlash_MainFunction(uint32_t now);
+extern bool UdsFlash_IsRunning(void);
+
+#endif /* SRC_UDS_INC_UDS_FLASH_H_ */
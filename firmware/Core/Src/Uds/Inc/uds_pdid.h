@@ -0,0 +1,54 @@
+/*
+ * uds_pdid.h
+ *
+ *  Created on: Aug 11, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief ReadDataByPeriodicIdentifier (0x2A) reception.
+ *
+ * After one request the ECU sends the scheduled periodic DIDs by itself,
+ * each as a single CAN frame [periodicDataIdentifier][data ...] on the
+ * periodic response ID (ISO 14229-2 message type 1, no ISO-TP PCI). These
+ * frames bypass ISO-TP: UdsPdid_RxFrame() takes them straight from the Rx
+ * loop, timestamps them and collects them in batches of UDS_PDID_BATCH
+ * samples, passed to the sink when full or UDS_PDID_FLUSH ms old.
+ *
+ * The periodic response ID is let through the CAN acceptance filter while
+ * a schedule uses it. It must differ from the ECU's USDT response ID.
+ */
+
+#ifndef SRC_UDS_INC_UDS_PDID_H_
+#define SRC_UDS_INC_UDS_PDID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+
+/* Defines */
+/* A periodic frame carries up to 7 data bytes after the identifier */
+#define UDS_PDID_DATA_MAX ((uint8_t) 7)
+
+/* Structures */
+typedef struct{
+	/* Reception time in ms */
+	uint32_t time;
+	uint8_t pdid;
+	uint8_t length;
+	uint8_t data[UDS_PDID_DATA_MAX];
+}UdsPdid_Sample_t;
+
+/* false drops the batch (counted as lost) */
+typedef bool (*UdsPdid_Sink_t)(uint32_t periodicId, const UdsPdid_Sample_t* samples, uint8_t count, void* context);
+/* Lets a CAN ID pass the acceptance filter (enable) or releases it */
+typedef bool (*UdsPdid_Filter_t)(uint32_t id, bool enable);
+
+/* Functions */
+extern void UdsPdid_Init(UdsPdid_Filter_t filter);
+extern UDS_StatusTypeDef UdsPdid_Start(uint32_t txId, uint32_t rxId, uint32_t periodicId, uint8_t rate,
+		const uint8_t* pdids, uint8_t count, UdsPdid_Sink_t sink, Uds_Callback_t callback, void* context, uint32_t now);
+extern UDS_StatusTypeDef UdsPdid_Stop(uint32_t txId, uint32_t rxId, uint32_t now);
+extern bool UdsPdid_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now);
+extern void UdsPdid_MainFunction(uint32_t now);
+extern uint32_t UdsPdid_GetLost(void);
+
+#endif /* SRC_UDS_INC_UDS_PDID_H_ */
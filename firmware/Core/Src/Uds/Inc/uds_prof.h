@@ -0,0 +1,47 @@
+/*
+ * uds_prof.h
+ *
+ *  Created on: Aug 13, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Response time profile of every ECU / service pair.
+ *
+ * The client reports each transaction that got past the Tx confirmation:
+ * the time from the end of the request to the first frame of the first
+ * response (NRC 0x78 included) and to the end of the final response, and
+ * the number of NRC 0x78 received. Times go into log2 buckets:
+ *   bucket 0: 0 ms, bucket n: 2^(n-1) to 2^n - 1 ms, the last one open ended.
+ * Memory is fixed: UDS_PROF_ENTRIES pairs, pairs seen after that are only
+ * counted. Counters saturate at 0xFFFF.
+ */
+
+#ifndef SRC_UDS_INC_UDS_PROF_H_
+#define SRC_UDS_INC_UDS_PROF_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_cfg.h"
+
+/* Structures */
+typedef struct{
+	bool used;
+	uint32_t txId;
+	uint8_t sid;
+	/* Transactions with a final response, and without (timeout, Rx error) */
+	uint16_t count;
+	uint16_t failures;
+	/* NRC 0x78 received in total and at most in one transaction */
+	uint16_t pending;
+	uint8_t pendingMax;
+	/* Slowest final response, ms */
+	uint16_t maxComplete;
+	uint16_t first[UDS_PROF_BUCKETS];
+	uint16_t complete[UDS_PROF_BUCKETS];
+}UdsProf_Entry_t;
+
+/* Functions */
+extern void UdsProf_Reset(void);
+extern void UdsProf_Record(uint32_t txId, uint8_t sid, bool responded, uint32_t first, uint32_t complete, uint8_t pending);
+extern const UdsProf_Entry_t* UdsProf_GetEntries(uint16_t* dropped);
+
+#endif /* SRC_UDS_INC_UDS_PROF_H_ */
@@ -0,0 +1,47 @@
+/*
+ * uds_rdbi.h
+ *
+ *  Created on: Aug 5, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Batched ReadDataByIdentifier (0x22) with several DIDs per request.
+ *
+ * A batch job packs as many DIDs into each request as the ECU accepts. The
+ * limit starts at UDS_RDBI_MAX_PER_REQUEST and is halved, and remembered
+ * per ECU, whenever the ECU answers NRC 0x13 (incorrectMessageLength) or
+ * 0x14 (responseTooLong); the rejected DIDs are simply sent again in
+ * smaller requests.
+ *
+ * The concatenated response can only be split where DID lengths are known:
+ * fixed lengths come from UDS_DID_TABLE, lengths of variable DIDs are
+ * learned the first time they are read alone or last. A request therefore
+ * carries at most one DID of unknown length, always as its last DID.
+ *
+ * A batch that finds all request slots of the client in use is sent again
+ * by UdsRdbi_MainFunction(); only a request the client refuses outright
+ * fails its DIDs with UDS_RESULT_TX_ERROR.
+ */
+
+#ifndef SRC_UDS_INC_UDS_RDBI_H_
+#define SRC_UDS_INC_UDS_RDBI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+
+/* Structures */
+/* One DID done: data on UDS_RESULT_POSITIVE, nrc on UDS_RESULT_NEGATIVE
+ * (NRC_REQUEST_OUT_OF_RANGE for a DID the ECU left out) */
+typedef void (*UdsRdbi_DidCallback_t)(uint32_t txId, uint16_t did, Uds_ResultTypeDef result, uint8_t nrc,
+		const uint8_t* data, uint32_t length, void* context);
+/* All DIDs of the job done; requests is the number of 0x22 requests it took */
+typedef void (*UdsRdbi_DoneCallback_t)(uint32_t txId, uint8_t requests, void* context);
+
+/* Functions */
+extern void UdsRdbi_Init(void);
+extern UDS_StatusTypeDef UdsRdbi_Read(uint32_t txId, uint32_t rxId, const uint16_t* dids, uint8_t count,
+		bool useCache, UdsRdbi_DidCallback_t didCallback, UdsRdbi_DoneCallback_t doneCallback, void* context, uint32_t now);
+extern void UdsRdbi_MainFunction(uint32_t now);
+extern uint8_t UdsRdbi_GetLimit(uint32_t txId);
+
+#endif /* SRC_UDS_INC_UDS_RDBI_H_ */
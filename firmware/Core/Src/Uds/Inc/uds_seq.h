@@ -0,0 +1,120 @@
+/*
+ * uds_seq.h
+ *
+ *  Created on: Aug 15, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Diagnostic sequences run on the device from a small bytecode.
+ *
+ * A program is checked once by UdsSeq_Load(): every opcode known, every
+ * operand inside the program, every register valid and every branch on the
+ * start of an instruction. It then runs from UdsSeq_MainFunction() with at
+ * most UDS_SEQ_STEPS_PER_PASS instructions per pass, touching nothing but
+ * its registers, the last response and its output buffer. Response and
+ * output accesses are checked at run time and stop the program with a fault.
+ *
+ * Encoding: one opcode byte, then the operands; multi-byte operands are
+ * little endian like the host messages, r is a register index below
+ * UDS_SEQ_REGS, registers are int32. LOAD reads the response big endian.
+ *
+ *   00 END                          program done
+ *   01 TARGET tx:4 rx:4             ECU of the following requests
+ *   02 SEND n:1 data:n              queues a request (no response outstanding)
+ *   03 WAIT r                       waits for its response, r = Uds_ResultTypeDef
+ *   04 LEN r                        r = length of the response
+ *   05 LOAD r off:2 size:1          r = response[off..off+size), size 1-4
+ *   06 SET r imm:4                  r = imm
+ *   07 ADD r imm:4                  r += imm
+ *   08 CMP r imm:4                  compares r with imm for BR
+ *   09 BR cond:1 addr:2             jumps if cond holds (UdsSeq_CondTypeDef)
+ *   0A LOOP r addr:2                r -= 1, jumps while r != 0
+ *   0B DELAY ms:2                   waits
+ *   0C STORE off:2 len:2            appends response bytes to the output
+ *   0D STOREREG r                   appends r (4 bytes) to the output
+ *   0E EMIT tag:1                   passes the output to the sink, clears it
+ *
+ * The response buffer holds the whole response starting with the response
+ * SID (7F SID NRC for a negative one), cut to UDS_SEQ_RSP_MAX bytes.
+ */
+
+#ifndef SRC_UDS_INC_UDS_SEQ_H_
+#define SRC_UDS_INC_UDS_SEQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+
+/* Enums */
+typedef enum{
+	UDS_SEQ_OP_END      = 0x00,
+	UDS_SEQ_OP_TARGET   = 0x01,
+	UDS_SEQ_OP_SEND     = 0x02,
+	UDS_SEQ_OP_WAIT     = 0x03,
+	UDS_SEQ_OP_LEN      = 0x04,
+	UDS_SEQ_OP_LOAD     = 0x05,
+	UDS_SEQ_OP_SET      = 0x06,
+	UDS_SEQ_OP_ADD      = 0x07,
+	UDS_SEQ_OP_CMP      = 0x08,
+	UDS_SEQ_OP_BR       = 0x09,
+	UDS_SEQ_OP_LOOP     = 0x0A,
+	UDS_SEQ_OP_DELAY    = 0x0B,
+	UDS_SEQ_OP_STORE    = 0x0C,
+	UDS_SEQ_OP_STOREREG = 0x0D,
+	UDS_SEQ_OP_EMIT     = 0x0E
+}UdsSeq_OpTypeDef;
+
+/* Conditions of BR, on the last CMP */
+typedef enum{
+	UDS_SEQ_ALWAYS,
+	UDS_SEQ_EQ,
+	UDS_SEQ_NE,
+	UDS_SEQ_LT,
+	UDS_SEQ_GE,
+	UDS_SEQ_GT,
+	UDS_SEQ_LE
+}UdsSeq_CondTypeDef;
+
+typedef enum{
+	/* END reached */
+	UDS_SEQ_DONE,
+	UDS_SEQ_FAULT,
+	UDS_SEQ_STOPPED
+}UdsSeq_ResultTypeDef;
+
+typedef enum{
+	UDS_SEQ_FAULT_NONE,
+	/* LOAD / STORE outside the response */
+	UDS_SEQ_FAULT_RANGE,
+	/* Output buffer full */
+	UDS_SEQ_FAULT_OUTPUT,
+	/* SEND with a response outstanding, WAIT without a request */
+	UDS_SEQ_FAULT_STATE,
+	/* Request refused by the client */
+	UDS_SEQ_FAULT_REQUEST
+}UdsSeq_FaultTypeDef;
+
+/* Structures */
+typedef struct{
+	UdsSeq_ResultTypeDef result;
+	UdsSeq_FaultTypeDef fault;
+	/* Instruction that ended the program */
+	uint16_t pc;
+	uint32_t steps;
+	uint32_t requests;
+	/* ms */
+	uint32_t duration;
+}UdsSeq_Report_t;
+
+/* Output of an EMIT; false if it cannot be taken now, the EMIT is retried */
+typedef bool (*UdsSeq_Sink_t)(uint8_t tag, const uint8_t* data, uint16_t len, void* context);
+typedef void (*UdsSeq_DoneCallback_t)(const UdsSeq_Report_t* report, void* context);
+
+/* Functions */
+extern void UdsSeq_Init(void);
+extern UDS_StatusTypeDef UdsSeq_Load(const uint8_t* code, uint16_t length, uint16_t* errorPc);
+extern UDS_StatusTypeDef UdsSeq_Start(UdsSeq_Sink_t sink, UdsSeq_DoneCallback_t callback, void* context, uint32_t now);
+extern void UdsSeq_Stop(void);
+extern bool UdsSeq_IsRunning(void);
+extern void UdsSeq_MainFunction(uint32_t now);
+
+#endif /* SRC_UDS_INC_UDS_SEQ_H_ */
@@ -0,0 +1,85 @@
+/*
+ * uds_server.h
+ *
+ *  Created on: Aug 14, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Simulated ECU (UDS server) for testing clients without a vehicle.
+ *
+ * Answers DiagnosticSessionControl, ECUReset, ReadDTCInformation (0x01,
+ * 0x02, 0x0A), ReadDataByIdentifier and TesterPresent on a physical
+ * request ID and optionally a functional one (single frames only). DIDs,
+ * DTCs and artificial response delays come from a const database, which
+ * stays in flash. A delay longer than P2 is covered with NRC 0x78.
+ *
+ * Without delays a request is answered in the pass it completes in, so
+ * the server runs at the speed of the bus. Like CanTp the module knows
+ * nothing of the HAL and is built on a host as well.
+ */
+
+#ifndef SRC_UDS_INC_UDS_SERVER_H_
+#define SRC_UDS_INC_UDS_SERVER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_services.h"
+#include "../../Com/CanTp/Inc/cantp.h"
+
+/* Structures */
+typedef struct{
+	uint16_t did;
+	uint16_t length;
+	/* Offset of the value in UdsServer_Db_t.data */
+	uint16_t offset;
+}UdsServer_Did_t;
+
+typedef struct{
+	/* DTC high, middle and low byte */
+	uint8_t dtc[3];
+	uint8_t status;
+}UdsServer_Dtc_t;
+
+typedef struct{
+	uint8_t sid;
+	/* Time from the request to the final response (ms) */
+	uint16_t delay;
+}UdsServer_Delay_t;
+
+typedef struct{
+	/* Sorted by DID */
+	const UdsServer_Did_t* dids;
+	uint16_t didCount;
+	const uint8_t* data;
+	const UdsServer_Dtc_t* dtcs;
+	uint16_t dtcCount;
+	uint8_t dtcAvailabilityMask;
+	/* SIDs not listed are answered at once */
+	const UdsServer_Delay_t* delays;
+	uint8_t delayCount;
+}UdsServer_Db_t;
+
+typedef struct{
+	/* Physical request and response IDs, CANTP_ID_EXT marks 29-bit IDs */
+	uint32_t rxId;
+	uint32_t txId;
+	/* Functional request ID, 0 for none */
+	uint32_t functionalId;
+	const UdsServer_Db_t* db;
+}UdsServer_Config_t;
+
+/* Enables (true) or releases (false) the reception of a CAN ID; false if no filter is left */
+typedef bool (*UdsServer_Filter_t)(uint32_t id, bool enable);
+
+/* Variables */
+/* Example database (uds_server_db.c) */
+extern const UdsServer_Db_t udsServerDb;
+
+/* Functions */
+extern void UdsServer_Init(CanTp_SendFrame_t sendFrame, UdsServer_Filter_t filter);
+extern UDS_StatusTypeDef UdsServer_Start(const UdsServer_Config_t* config, uint32_t now);
+extern void UdsServer_Stop(void);
+extern bool UdsServer_IsRunning(void);
+extern bool UdsServer_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now);
+extern void UdsServer_MainFunction(uint32_t now);
+
+#endif /* SRC_UDS_INC_UDS_SERVER_H_ */
@@ -0,0 +1,106 @@
+/*
+ * uds_services.h
+ *
+ *  Created on: Aug 2, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Asynchronous UDS (ISO 14229) client.
+ *
+ * Requests are queued with Uds_Request() and completed through a callback,
+ * never from inside Uds_Request() itself; no task ever blocks on an ECU. Each ECU (Tx ID / Rx ID pair) gets its own
+ * ISO-TP channel, so requests to different ECUs run in parallel; requests to
+ * the same ECU are sent one after the other, in order.
+ *
+ * A response is matched to the outstanding request of its ECU by SID:
+ * SID + 0x40 completes it positively, 0x7F SID NRC negatively, and NRC 0x78
+ * (responsePending) switches the timeout from P2 to P2*. Anything else is
+ * ignored. All functions are called from the diagnostic task.
+ *
+ * Requests and positive responses of the SIDs listed in UDS_SERVICE_TABLE
+ * are checked against the service table (length, sub-function, session);
+ * other SIDs are passed through unchecked. A request with the
+ * suppressPosRspMsgIndicationBit set completes once it has been sent.
+ *
+ * ECUs switched to a non-default session by the client are kept there with
+ * TesterPresent (3E 80), sent only after UDS_S3_CLIENT ms without any other
+ * request; ECUs sharing a functional address get one functional frame.
+ *
+ * Uds_RequestStream() hands a positive response to a stream callback frame
+ * by frame instead of reassembling it, for responses too long to buffer.
+ * The service table length check still applies, the parser does not.
+ *
+ * Uds_RequestFunctional() sends one request on BROADCAST_REQUEST_ID and
+ * collects the responses of all ECUs (0x7E8-0x7EF) on the client's own
+ * channels of those ECUs. Physical requests to them queue behind it, in
+ * submission order, so OBD functional queries and physical polling share
+ * the channels instead of taking them from each other.
+ */
+
+#ifndef SRC_UDS_INC_UDS_SERVICES_H_
+#define SRC_UDS_INC_UDS_SERVICES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uds_cfg.h"
+
+/* Enums */
+typedef enum{
+	UDS_OK,
+	UDS_NOT_OK,
+	UDS_BUSY
+}UDS_StatusTypeDef;
+
+typedef enum{
+	UDS_RESULT_POSITIVE,
+	UDS_RESULT_NEGATIVE,
+	/* No (final) response within P2 / P2* */
+	UDS_RESULT_TIMEOUT,
+	/* ISO-TP failed to send the request */
+	UDS_RESULT_TX_ERROR,
+	/* ISO-TP failed to receive the response */
+	UDS_RESULT_RX_ERROR,
+	/* Positive response that does not match the request */
+	UDS_RESULT_INVALID_RSP,
+	UDS_RESULT_CANCELLED
+}Uds_ResultTypeDef;
+
+/* Structures */
+typedef struct{
+	Uds_ResultTypeDef result;
+	uint32_t txId;
+	uint32_t rxId;
+	/* Request SID */
+	uint8_t sid;
+	/* NRC of a negative response, 0 otherwise */
+	uint8_t nrc;
+	/* NRC 0x78 frames received for this request */
+	uint8_t pendingCount;
+	/* Whole response starting with the response SID, valid during the callback only.
+	 * NULL for a streamed positive response, length is then its total length */
+	const uint8_t* data;
+	uint32_t length;
+	/* Time from the end of the request to the final response (ms) */
+	uint32_t latency;
+}Uds_Response_t;
+
+typedef void (*Uds_Callback_t)(const Uds_Response_t* rsp, void* context);
+/* Consumes len bytes at offset of a positive response; false aborts the reception */
+typedef bool (*Uds_Stream_t)(uint32_t offset, const uint8_t* data, uint32_t len, void* context);
+
+/* Functions */
+extern bool Uds_Init(void);
+extern UDS_StatusTypeDef Uds_Request(uint32_t txId, uint32_t rxId, const uint8_t* data, uint32_t length,
+		Uds_Callback_t callback, void* context, uint32_t now);
+extern UDS_StatusTypeDef Uds_RequestStream(uint32_t txId, uint32_t rxId, const uint8_t* data, uint32_t length,
+		Uds_Stream_t stream, Uds_Callback_t callback, void* context, uint32_t now);
+extern UDS_StatusTypeDef Uds_RequestFunctional(const uint8_t* data, uint32_t length,
+		Uds_Callback_t sink, Uds_Callback_t callback, void* context, uint32_t now);
+extern void Uds_Cancel(uint32_t txId);
+extern void Uds_MainFunction(uint32_t now);
+extern uint8_t Uds_OutstandingCount(void);
+extern void Uds_SetTime(uint32_t now);
+extern uint32_t Uds_GetTime(void);
+extern uint8_t Uds_GetSession(uint32_t txId);
+extern void Uds_SetSession(uint32_t txId, uint8_t session);
+
+#endif /* SRC_UDS_INC_UDS_SERVICES_H_ */
@@ -0,0 +1,315 @@
+/*
+ * uds_ddid.c
+ *
+ *  Created on: Aug 12, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_ddid.h"
+
+/* Defines */
+/* Request header: SID, sub-function, dynamicDataIdentifier (+ ALFID by address) */
+#define UDS_DDID_HEADER_ID      ((uint8_t) 4)
+#define UDS_DDID_HEADER_ADDRESS ((uint8_t) 5)
+/* Source DID, position and size */
+#define UDS_DDID_ENTRY_ID       ((uint8_t) 4)
+/* The 0x22 response (SID and DID before the data) must fit one ISO-TP message */
+#define UDS_DDID_DATA_MAX       ((uint16_t) 4092)
+
+/* Enums */
+typedef enum{
+	UDS_DDID_FREE,
+	UDS_DDID_CLEARING,
+	UDS_DDID_DEFINING,
+	UDS_DDID_READY,
+	UDS_DDID_POLLING
+}UdsDdid_StateTypeDef;
+
+/* Structures */
+typedef struct{
+	UdsDdid_StateTypeDef state;
+	uint32_t txId;
+	uint32_t rxId;
+	uint16_t ddid;
+	uint8_t alfid;
+	UdsDdid_Signal_t signals[UDS_DDID_MAX_SIGNALS];
+	uint8_t count;
+	/* First signal not defined yet */
+	uint8_t next;
+	/* Data bytes of the composite DID */
+	uint16_t size;
+	uint8_t req[UDS_DDID_REQUEST_MAX];
+	UdsDdid_Sink_t sink;
+	Uds_Callback_t callback;
+	void* context;
+}UdsDdid_Job_t;
+
+/* Functions prototype */
+static bool UdsDdid_SendDefine(UdsDdid_Job_t* job, uint32_t now);
+static void UdsDdid_DefineResponse(const Uds_Response_t* rsp, void* context);
+static void UdsDdid_PollResponse(const Uds_Response_t* rsp, void* context);
+static void UdsDdid_Done(UdsDdid_Job_t* job, const Uds_Response_t* rsp, Uds_ResultTypeDef result);
+static uint8_t UdsDdid_PutValue(uint8_t* p, uint32_t value, uint8_t size);
+
+/* Variables */
+static UdsDdid_Job_t jobs[UDS_DDID_MAX_DEFS];
+
+
+void UdsDdid_Init(void){
+	for(uint8_t i = 0; i < UDS_DDID_MAX_DEFS; i++){
+		jobs[i].state = UDS_DDID_FREE;
+	}
+}
+
+/**
+ * @brief Defines ddid on the ECU from a signal list.
+ *
+ * @param ddid      Dynamic DID, DID_DYNAMIC_FIRST to DID_DYNAMIC_LAST.
+ * @param alfid     addressAndLengthFormatIdentifier of UDS_DDID_BY_ADDRESS
+ *                  signals, ignored if there are none.
+ * @param callback  Outcome of the definition (the last 0x2C response), may be NULL.
+ * @param handle    Set to the handle used by UdsDdid_Poll() / UdsDdid_Clear().
+ *
+ * @return UDS_NOT_OK for a bad signal list, UDS_BUSY if all definitions
+ *         (or client request slots) are in use.
+ */
+UDS_StatusTypeDef UdsDdid_Define(uint32_t txId, uint32_t rxId, uint16_t ddid, uint8_t alfid,
+		const UdsDdid_Signal_t* signals, uint8_t count, Uds_Callback_t callback, void* context,
+		uint8_t* handle, uint32_t now){
+	UdsDdid_Job_t* job = NULL;
+	uint32_t size = 0;
+	UDS_StatusTypeDef status;
+
+	if(signals == NULL || handle == NULL || count == 0 || count > UDS_DDID_MAX_SIGNALS) return UDS_NOT_OK;
+	if(ddid < DID_DYNAMIC_FIRST || ddid > DID_DYNAMIC_LAST) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < count; i++){
+		const UdsDdid_Signal_t* const signal = &signals[i];
+
+		if(signal->size == 0) return UDS_NOT_OK;
+		if(signal->source == UDS_DDID_BY_ID){
+			if(signal->position == 0) return UDS_NOT_OK;
+		}
+		else{
+			const uint8_t addrSize = alfid & 0x0F;
+			const uint8_t lenSize = alfid >> 4;
+
+			if(addrSize == 0 || addrSize > 4 || lenSize == 0 || lenSize > 4) return UDS_NOT_OK;
+			if(addrSize < 4 && signal->address >> (8 * addrSize) != 0) return UDS_NOT_OK;
+		}
+		size += signal->size;
+	}
+	if(size > UDS_DDID_DATA_MAX) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < UDS_DDID_MAX_DEFS; i++){
+		if(jobs[i].state == UDS_DDID_FREE){
+			job = &jobs[i];
+			*handle = i;
+			break;
+		}
+	}
+	if(job == NULL) return UDS_BUSY;
+
+	memcpy(job->signals, signals, count * sizeof(UdsDdid_Signal_t));
+	job->count = count;
+	job->next = 0;
+	job->size = (uint16_t)size;
+	job->txId = txId;
+	job->rxId = rxId;
+	job->ddid = ddid;
+	job->alfid = alfid;
+	job->callback = callback;
+	job->context = context;
+
+	/* Definitions append, so whatever the DID held goes first */
+	job->req[0] = SID_DYNAMICALLY_DEFINE_DATA_ID;
+	job->req[1] = CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER;
+	job->req[2] = (uint8_t)(ddid >> 8);
+	job->req[3] = (uint8_t)ddid;
+	job->state = UDS_DDID_CLEARING;
+
+	status = Uds_Request(txId, rxId, job->req, 4, UdsDdid_DefineResponse, job, now);
+	if(status != UDS_OK){
+		job->state = UDS_DDID_FREE;
+	}
+
+	return status;
+}
+
+/**
+ * @brief Reads the composite DID once; sink gets the signal values.
+ *
+ * @param callback  Outcome of the read, after sink, may be NULL. A response
+ *                  of the wrong length is reported as UDS_RESULT_INVALID_RSP.
+ *
+ * @return UDS_NOT_OK for an unknown handle, UDS_BUSY while the DID is
+ *         being defined or polled.
+ */
+UDS_StatusTypeDef UdsDdid_Poll(uint8_t handle, UdsDdid_Sink_t sink, Uds_Callback_t callback, void* context, uint32_t now){
+	UdsDdid_Job_t* job;
+	UDS_StatusTypeDef status;
+
+	if(handle >= UDS_DDID_MAX_DEFS || sink == NULL) return UDS_NOT_OK;
+	job = &jobs[handle];
+	if(job->state == UDS_DDID_FREE) return UDS_NOT_OK;
+	if(job->state != UDS_DDID_READY) return UDS_BUSY;
+
+	job->req[0] = SID_READ_DATA_BY_ID;
+	job->req[1] = (uint8_t)(job->ddid >> 8);
+	job->req[2] = (uint8_t)job->ddid;
+	job->sink = sink;
+	job->callback = callback;
+	job->context = context;
+	job->state = UDS_DDID_POLLING;
+
+	status = Uds_Request(job->txId, job->rxId, job->req, 3, UdsDdid_PollResponse, job, now);
+	if(status != UDS_OK){
+		job->state = UDS_DDID_READY;
+	}
+
+	return status;
+}
+
+/**
+ * @brief Clears the DID on the ECU and frees the handle.
+ */
+UDS_StatusTypeDef UdsDdid_Clear(uint8_t handle, uint32_t now){
+	UdsDdid_Job_t* job;
+	UDS_StatusTypeDef status;
+
+	if(handle >= UDS_DDID_MAX_DEFS) return UDS_NOT_OK;
+	job = &jobs[handle];
+	if(job->state == UDS_DDID_FREE) return UDS_NOT_OK;
+	if(job->state != UDS_DDID_READY) return UDS_BUSY;
+
+	job->req[0] = SID_DYNAMICALLY_DEFINE_DATA_ID;
+	job->req[1] = CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER;
+	job->req[2] = (uint8_t)(job->ddid >> 8);
+	job->req[3] = (uint8_t)job->ddid;
+
+	/* Copied by the client, the handle can go at once */
+	status = Uds_Request(job->txId, job->rxId, job->req, 4, NULL, NULL, now);
+	if(status == UDS_OK){
+		job->state = UDS_DDID_FREE;
+	}
+
+	return status;
+}
+
+
+/* Private functions */
+
+/* Packs the next run of signals of one kind into a define request */
+static bool UdsDdid_SendDefine(UdsDdid_Job_t* job, uint32_t now){
+	const UdsDdid_SourceTypeDef source = job->signals[job->next].source;
+	const uint8_t addrSize = job->alfid & 0x0F;
+	const uint8_t lenSize = job->alfid >> 4;
+	uint8_t len = 0;
+
+	job->req[len++] = SID_DYNAMICALLY_DEFINE_DATA_ID;
+	job->req[len++] = (source == UDS_DDID_BY_ID) ? DEFINE_BY_IDENTIFIER : DEFINE_BY_MEMORY_ADDRESS;
+	job->req[len++] = (uint8_t)(job->ddid >> 8);
+	job->req[len++] = (uint8_t)job->ddid;
+	if(source == UDS_DDID_BY_ADDRESS){
+		job->req[len++] = job->alfid;
+	}
+
+	while(job->next < job->count && job->signals[job->next].source == source){
+		const UdsDdid_Signal_t* const signal = &job->signals[job->next];
+
+		if(source == UDS_DDID_BY_ID){
+			if(len + UDS_DDID_ENTRY_ID > UDS_DDID_REQUEST_MAX) break;
+			job->req[len++] = (uint8_t)(signal->did >> 8);
+			job->req[len++] = (uint8_t)signal->did;
+			job->req[len++] = signal->position;
+			job->req[len++] = signal->size;
+		}
+		else{
+			if(len + addrSize + lenSize > UDS_DDID_REQUEST_MAX) break;
+			len += UdsDdid_PutValue(&job->req[len], signal->address, addrSize);
+			len += UdsDdid_PutValue(&job->req[len], signal->size, lenSize);
+		}
+		job->next++;
+	}
+
+	return Uds_Request(job->txId, job->rxId, job->req, len, UdsDdid_DefineResponse, job, now) == UDS_OK;
+}
+
+static void UdsDdid_DefineResponse(const Uds_Response_t* rsp, void* context){
+	UdsDdid_Job_t* const job = (UdsDdid_Job_t*)context;
+
+	if(job->state == UDS_DDID_CLEARING){
+		/* A DID that was never defined may be refused */
+		if(rsp->result != UDS_RESULT_POSITIVE
+				&& !(rsp->result == UDS_RESULT_NEGATIVE && rsp->nrc == NRC_REQUEST_OUT_OF_RANGE)){
+			UdsDdid_Done(job, rsp, rsp->result);
+			return;
+		}
+		job->state = UDS_DDID_DEFINING;
+	}
+	else if(rsp->result != UDS_RESULT_POSITIVE){
+		UdsDdid_Done(job, rsp, rsp->result);
+		return;
+	}
+
+	if(job->next == job->count){
+		UdsDdid_Done(job, rsp, UDS_RESULT_POSITIVE);
+		return;
+	}
+	if(!UdsDdid_SendDefine(job, Uds_GetTime())){
+		UdsDdid_Done(job, rsp, UDS_RESULT_TX_ERROR);
+	}
+}
+
+static void UdsDdid_PollResponse(const Uds_Response_t* rsp, void* context){
+	UdsDdid_Job_t* const job = (UdsDdid_Job_t*)context;
+	Uds_ResultTypeDef result = rsp->result;
+
+	if(result == UDS_RESULT_POSITIVE){
+		/* SID and DID, then the signals back to back */
+		if(rsp->length != 3u + job->size){
+			result = UDS_RESULT_INVALID_RSP;
+		}
+		else{
+			UdsDdid_Value_t values[UDS_DDID_MAX_SIGNALS];
+			const uint8_t* data = &rsp->data[3];
+
+			for(uint8_t i = 0; i < job->count; i++){
+				values[i].data = data;
+				values[i].size = job->signals[i].size;
+				data += job->signals[i].size;
+			}
+			job->sink((uint8_t)(job - jobs), values, job->count, job->context);
+		}
+	}
+
+	UdsDdid_Done(job, rsp, result);
+}
+
+/* Reports rsp with result; a failed definition frees the handle */
+static void UdsDdid_Done(UdsDdid_Job_t* job, const Uds_Response_t* rsp, Uds_ResultTypeDef result){
+	Uds_Response_t out = *rsp;
+
+	if(job->state == UDS_DDID_CLEARING || job->state == UDS_DDID_DEFINING){
+		job->state = (result == UDS_RESULT_POSITIVE) ? UDS_DDID_READY : UDS_DDID_FREE;
+	}
+	else{
+		job->state = UDS_DDID_READY;
+	}
+
+	if(job->callback != NULL){
+		out.result = result;
+		job->callback(&out, job->context);
+	}
+}
+
+/* Big endian, the last size bytes of value */
+static uint8_t UdsDdid_PutValue(uint8_t* p, uint32_t value, uint8_t size){
+	for(uint8_t i = 0; i < size; i++){
+		p[i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+	}
+
+	return size;
+}
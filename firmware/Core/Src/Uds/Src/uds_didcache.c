@@ -0,0 +1,187 @@
+/*
+ * uds_didcache.c
+ *
+ *  Created on: Aug 6, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_didcache.h"
+#include "../Inc/uds_dispatch.h"
+#include "../../Util/Inc/block_pool.h"
+
+/* Structures */
+typedef struct{
+	bool used;
+	bool isStatic;
+	uint16_t did;
+	uint16_t length;
+	uint32_t txId;
+	/* Time the value was read from the ECU */
+	uint32_t stored;
+	/* Use stamp, the lowest one is evicted first */
+	uint32_t lastUse;
+	uint8_t* data;
+}UdsDidCache_Entry_t;
+
+/* Functions prototype */
+static UdsDidCache_Entry_t* UdsDidCache_Find(uint32_t txId, uint16_t did);
+static void UdsDidCache_Drop(UdsDidCache_Entry_t* entry);
+static bool UdsDidCache_EvictLru(void);
+
+/* Variables */
+static UdsDidCache_Entry_t entries[UDS_DIDCACHE_ENTRIES];
+static uint32_t useStamp;
+static UdsDidCache_Stats_t stats;
+
+static BlockPool_t arena;
+static uint8_t arenaMem[UDS_DIDCACHE_BLOCK_SIZE * UDS_DIDCACHE_BLOCK_COUNT] __attribute__((aligned(4)));
+static uint16_t arenaRuns[UDS_DIDCACHE_BLOCK_COUNT];
+
+
+bool UdsDidCache_Init(void){
+	for(uint8_t i = 0; i < UDS_DIDCACHE_ENTRIES; i++){
+		entries[i].used = false;
+	}
+	useStamp = 0;
+	memset(&stats, 0, sizeof(stats));
+
+	return BlockPool_Init(&arena, arenaMem, arenaRuns, UDS_DIDCACHE_BLOCK_SIZE, UDS_DIDCACHE_BLOCK_COUNT);
+}
+
+/**
+ * @brief Looks up a cached DID value.
+ *
+ * The data pointer stays valid until the next store or invalidation.
+ *
+ * @return false on a miss (not cached, or a volatile value that expired).
+ */
+bool UdsDidCache_Lookup(uint32_t txId, uint16_t did, uint32_t now, const uint8_t** data, uint16_t* length){
+	UdsDidCache_Entry_t* const entry = UdsDidCache_Find(txId, did);
+
+	if(entry != NULL && !entry->isStatic && (uint32_t)(now - entry->stored) >= UDS_DIDCACHE_VOLATILE_TTL){
+		UdsDidCache_Drop(entry);
+		stats.misses++;
+		return false;
+	}
+	if(entry == NULL){
+		stats.misses++;
+		return false;
+	}
+
+	entry->lastUse = ++useStamp;
+	*data = entry->data;
+	*length = entry->length;
+	stats.hits++;
+
+	return true;
+}
+
+/**
+ * @brief Caches a value read from an ECU, evicting older entries if needed.
+ */
+void UdsDidCache_Store(uint32_t txId, uint16_t did, const uint8_t* data, uint16_t length, uint32_t now){
+	UdsDidCache_Entry_t* entry = UdsDidCache_Find(txId, did);
+	const Uds_DidInfo_t* const info = Uds_FindDid(did);
+	uint8_t* buff;
+
+	if(data == NULL || length == 0 || length > UDS_DIDCACHE_BLOCK_SIZE * UDS_DIDCACHE_BLOCK_COUNT) return;
+
+	if(entry != NULL){
+		UdsDidCache_Drop(entry);
+	}
+
+	/* A free entry, and room in the arena */
+	entry = NULL;
+	while(entry == NULL){
+		for(uint8_t i = 0; i < UDS_DIDCACHE_ENTRIES; i++){
+			if(!entries[i].used){
+				entry = &entries[i];
+				break;
+			}
+		}
+		if(entry == NULL && !UdsDidCache_EvictLru()) return;
+	}
+	while((buff = BlockPool_Alloc(&arena, length)) == NULL){
+		if(!UdsDidCache_EvictLru()) return;
+	}
+
+	memcpy(buff, data, length);
+	entry->used = true;
+	entry->isStatic = info != NULL && (info->flags & UDS_DID_STATIC) != 0;
+	entry->did = did;
+	entry->length = length;
+	entry->txId = txId;
+	entry->stored = now;
+	entry->lastUse = ++useStamp;
+	entry->data = buff;
+}
+
+/**
+ * @brief Drops the cached values of an ECU.
+ *
+ * @param keepStatic  true to drop only volatile values (session change).
+ */
+void UdsDidCache_Invalidate(uint32_t txId, bool keepStatic){
+	for(uint8_t i = 0; i < UDS_DIDCACHE_ENTRIES; i++){
+		if(entries[i].used && entries[i].txId == txId && !(keepStatic && entries[i].isStatic)){
+			UdsDidCache_Drop(&entries[i]);
+			stats.invalidations++;
+		}
+	}
+}
+
+void UdsDidCache_GetStats(UdsDidCache_Stats_t* out){
+	if(out == NULL) return;
+
+	stats.entries = 0;
+	for(uint8_t i = 0; i < UDS_DIDCACHE_ENTRIES; i++){
+		if(entries[i].used) stats.entries++;
+	}
+	stats.bytesFree = BlockPool_FreeCount(&arena) * UDS_DIDCACHE_BLOCK_SIZE;
+
+	*out = stats;
+}
+
+void UdsDidCache_ResetStats(void){
+	stats.hits = 0;
+	stats.misses = 0;
+	stats.evictions = 0;
+	stats.invalidations = 0;
+}
+
+
+/* Private functions */
+
+static UdsDidCache_Entry_t* UdsDidCache_Find(uint32_t txId, uint16_t did){
+	for(uint8_t i = 0; i < UDS_DIDCACHE_ENTRIES; i++){
+		if(entries[i].used && entries[i].did == did && entries[i].txId == txId){
+			return &entries[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void UdsDidCache_Drop(UdsDidCache_Entry_t* entry){
+	BlockPool_Free(&arena, entry->data);
+	entry->data = NULL;
+	entry->used = false;
+}
+
+static bool UdsDidCache_EvictLru(void){
+	UdsDidCache_Entry_t* lru = NULL;
+
+	for(uint8_t i = 0; i < UDS_DIDCACHE_ENTRIES; i++){
+		if(entries[i].used && (lru == NULL || (int32_t)(entries[i].lastUse - lru->lastUse) < 0)){
+			lru = &entries[i];
+		}
+	}
+	if(lru == NULL) return false;
+
+	UdsDidCache_Drop(lru);
+	stats.evictions++;
+
+	return true;
+}
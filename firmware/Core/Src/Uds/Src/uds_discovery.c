@@ -0,0 +1,250 @@
+/*
+ * uds_discovery.c
+ *
+ *  Created on: Aug 8, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/uds_discovery.h"
+
+/* Defines */
+/* Candidates: the 8 OBD addresses, then the 29-bit target addresses */
+#define UDS_DISC_STD_COUNT   ((uint16_t) 8)
+#define UDS_DISC_CANDIDATES  ((uint16_t)(UDS_DISC_STD_COUNT + (UDS_DISC_EXT_LAST - UDS_DISC_EXT_FIRST) + 1))
+#define UDS_DISC_NOT_SENT    ((uint16_t) 0xFFFF)
+#define UDS_DISC_TESTER_ADDR ((uint8_t) 0xF1)
+#define UDS_DISC_FUNC_ADDR   ((uint8_t) 0x33)
+
+/* Enums */
+typedef enum{
+	UDS_DISC_IDLE,
+	/* Functional requests sent, collecting responses for one P2 */
+	UDS_DISC_FUNCTIONAL_WAIT,
+	/* Probing silent addresses physically */
+	UDS_DISC_PHYSICAL_PROBE
+}UdsDisc_StateTypeDef;
+
+/* Functions prototype */
+static bool UdsDisc_SendProbe(uint32_t id);
+static void UdsDisc_SendFunctional(uint32_t now);
+static void UdsDisc_Done(uint32_t now);
+static int32_t UdsDisc_Candidate(uint32_t rxId);
+static uint32_t UdsDisc_TxId(uint16_t index);
+static bool UdsDisc_IsFound(uint16_t index);
+
+/* Variables */
+static CanTp_SendFrame_t discSendFrame;
+static UdsDisc_StateTypeDef discState;
+static uint32_t discStart;
+/* Functional requests: [0] 11-bit, [1] 29-bit */
+static bool funcPending[2];
+static uint32_t funcSent[2];
+/* Physical probes, ms after discStart or UDS_DISC_NOT_SENT */
+static uint16_t probeTime[UDS_DISC_CANDIDATES];
+static uint8_t probeFound[(UDS_DISC_CANDIDATES + 7) / 8];
+static uint16_t probeNext;
+static bool probeSent;
+static uint32_t probeLast;
+static UdsDisc_Ecu_t ecus[UDS_DISC_MAX_ECUS];
+static uint8_t ecuCount;
+static UdsDisc_DoneCallback_t discCallback;
+static void* discContext;
+
+
+void UdsDisc_Init(CanTp_SendFrame_t sendFrame){
+	discSendFrame = sendFrame;
+	discState = UDS_DISC_IDLE;
+	ecuCount = 0;
+}
+
+/**
+ * @brief Starts a scan; the previous ECU table is cleared.
+ *
+ * @return UDS_BUSY if a scan is running already.
+ */
+UDS_StatusTypeDef UdsDisc_Start(UdsDisc_DoneCallback_t callback, void* context, uint32_t now){
+	if(discSendFrame == NULL) return UDS_NOT_OK;
+	if(discState != UDS_DISC_IDLE) return UDS_BUSY;
+
+	for(uint16_t i = 0; i < UDS_DISC_CANDIDATES; i++){
+		probeTime[i] = UDS_DISC_NOT_SENT;
+	}
+	for(uint16_t i = 0; i < sizeof(probeFound); i++){
+		probeFound[i] = 0;
+	}
+	probeNext = 0;
+	probeSent = false;
+	ecuCount = 0;
+	funcPending[0] = true;
+	funcPending[1] = true;
+	discCallback = callback;
+	discContext = context;
+	discStart = now;
+	discState = UDS_DISC_FUNCTIONAL_WAIT;
+
+	UdsDisc_SendFunctional(now);
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Looks at every received frame while a scan runs.
+ *
+ * A single frame TesterPresent response (or any negative response to it)
+ * from a candidate response ID records the ECU once.
+ */
+void UdsDisc_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now){
+	const int32_t index = UdsDisc_Candidate(id);
+	UdsDisc_Ecu_t* ecu;
+	uint8_t sfDl;
+
+	if(discState == UDS_DISC_IDLE || index < 0 || dlc < 3) return;
+
+	sfDl = data[0] & 0x0F;
+	if((data[0] & 0xF0) != CANTP_PCI_SF || sfDl < 2 || sfDl >= dlc) return;
+	if(!(data[1] == (uint8_t)(SID_TESTER_PRESENT + POSITIVE_RESPONSE_OFFSET)
+			|| (data[1] == SID_NEGATIVE_RESPONSE && sfDl >= 3 && data[2] == SID_TESTER_PRESENT))) return;
+
+	if(UdsDisc_IsFound((uint16_t)index) || ecuCount >= UDS_DISC_MAX_ECUS) return;
+	/* Nothing was sent to it yet */
+	if(probeTime[index] == UDS_DISC_NOT_SENT && funcPending[(index < UDS_DISC_STD_COUNT) ? 0 : 1]) return;
+	probeFound[index / 8] |= (uint8_t)(1u << (index % 8));
+
+	ecu = &ecus[ecuCount++];
+	ecu->txId = UdsDisc_TxId((uint16_t)index);
+	ecu->rxId = id;
+	if(probeTime[index] != UDS_DISC_NOT_SENT){
+		ecu->latency = (uint16_t)(now - (discStart + probeTime[index]));
+		ecu->found = UDS_DISC_PHYSICAL;
+	}
+	else{
+		ecu->latency = (uint16_t)(now - funcSent[(index < UDS_DISC_STD_COUNT) ? 0 : 1]);
+		ecu->found = UDS_DISC_FUNCTIONAL;
+	}
+}
+
+void UdsDisc_MainFunction(uint32_t now){
+	uint8_t sent = 0;
+
+	switch(discState){
+		case UDS_DISC_FUNCTIONAL_WAIT:
+			UdsDisc_SendFunctional(now);
+			if(funcPending[0] || funcPending[1]) return;
+			if((int32_t)(now - funcSent[0]) < (int32_t)UDS_P2_CLIENT || (int32_t)(now - funcSent[1]) < (int32_t)UDS_P2_CLIENT) return;
+
+			discState = UDS_DISC_PHYSICAL_PROBE;
+			/* fall through */
+
+		case UDS_DISC_PHYSICAL_PROBE:
+			/* Queued back to back until the Tx buffer is full, responses are matched by ID */
+			while(probeNext < UDS_DISC_CANDIDATES && sent < UDS_DISC_BATCH){
+				if(!UdsDisc_IsFound(probeNext) && UdsDisc_TxId(probeNext) != 0){
+					if(!UdsDisc_SendProbe(UdsDisc_TxId(probeNext))) break;
+					probeTime[probeNext] = (uint16_t)(now - discStart);
+					probeSent = true;
+					probeLast = now;
+					sent++;
+				}
+				probeNext++;
+			}
+
+			if(probeNext == UDS_DISC_CANDIDATES && (!probeSent || (int32_t)(now - probeLast) >= (int32_t)UDS_P2_CLIENT)){
+				UdsDisc_Done(now);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool UdsDisc_IsRunning(void){
+	return discState != UDS_DISC_IDLE;
+}
+
+/**
+ * @brief ECUs found by the last scan, in the order they answered.
+ */
+const UdsDisc_Ecu_t* UdsDisc_GetEcus(uint8_t* count){
+	if(count != NULL){
+		*count = ecuCount;
+	}
+
+	return ecus;
+}
+
+
+/* Private functions */
+
+/* TesterPresent as a padded single frame */
+static bool UdsDisc_SendProbe(uint32_t id){
+	uint8_t frame[CANTP_CAN_DL];
+
+	frame[0] = CANTP_PCI_SF | 2;
+	frame[1] = SID_TESTER_PRESENT;
+	frame[2] = 0x00;
+	for(uint8_t i = 3; i < CANTP_CAN_DL; i++){
+		frame[i] = CANTP_PADDING_BYTE;
+	}
+
+	return discSendFrame(id, frame, CANTP_CAN_DL);
+}
+
+static void UdsDisc_SendFunctional(uint32_t now){
+	if(funcPending[0] && UdsDisc_SendProbe(BROADCAST_REQUEST_ID)){
+		funcPending[0] = false;
+		funcSent[0] = now;
+	}
+	if(funcPending[1] && UdsDisc_SendProbe(BROADCAST_REQUEST_ID_EXT | CANTP_ID_EXT)){
+		funcPending[1] = false;
+		funcSent[1] = now;
+	}
+}
+
+/* Idle first, so the callback may start the next scan */
+static void UdsDisc_Done(uint32_t now){
+	const UdsDisc_DoneCallback_t callback = discCallback;
+
+	discState = UDS_DISC_IDLE;
+
+	if(callback != NULL){
+		callback(ecus, ecuCount, now - discStart, discContext);
+	}
+}
+
+/* Candidate index of a response ID, -1 if it is none */
+static int32_t UdsDisc_Candidate(uint32_t rxId){
+	const uint32_t stdFirst = PHYSICAL_REQUEST_ID_BASE + PHYSICAL_RESPONSE_OFFSET;
+
+	if(rxId >= stdFirst && rxId < stdFirst + UDS_DISC_STD_COUNT){
+		return (int32_t)(rxId - stdFirst);
+	}
+	if((rxId & ~(uint32_t)0xFF) == (PHYSICAL_RESPONSE_ID_EXT_BASE | CANTP_ID_EXT)){
+		const uint32_t offset = (rxId & 0xFF) - UDS_DISC_EXT_FIRST;
+
+		if(offset <= (uint32_t)(UDS_DISC_EXT_LAST - UDS_DISC_EXT_FIRST)){
+			return (int32_t)(UDS_DISC_STD_COUNT + offset);
+		}
+	}
+
+	return -1;
+}
+
+/* Physical request ID of a candidate, 0 for addresses never probed */
+static uint32_t UdsDisc_TxId(uint16_t index){
+	uint8_t target;
+
+	if(index < UDS_DISC_STD_COUNT){
+		return PHYSICAL_REQUEST_ID_BASE + index;
+	}
+
+	target = (uint8_t)(UDS_DISC_EXT_FIRST + index - UDS_DISC_STD_COUNT);
+	if(target == UDS_DISC_TESTER_ADDR || target == UDS_DISC_FUNC_ADDR) return 0;
+
+	return (PHYSICAL_REQUEST_ID_EXT_BASE | ((uint32_t)target << 8)) | CANTP_ID_EXT;
+}
+
+static bool UdsDisc_IsFound(uint16_t index){
+	return (probeFound[index / 8] & (1u << (index % 8))) != 0;
+}
@@ -0,0 +1,184 @@
+/*
+ * uds_dispatch.c
+ *
+ *  Created on: Aug 4, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/uds_dispatch.h"
+#include "../Inc/uds_services.h"
+#include "../Inc/uds_didcache.h"
+
+/* Defines */
+#define UDS_SUBFN(table) (table), (uint8_t)sizeof(table)
+#define UDS_NO_SUBFN     NULL, 0
+
+#define UDS_SERVICE_ENTRY(sid, reqMin, rspMin, sess, subFn, hnd, prs) \
+	[(sid)] = { .handler = (hnd), .parser = (prs), UDS_SERVICE_SUBFN(subFn), \
+			.reqMinLen = (reqMin), .rspMinLen = (rspMin), .sessions = (sess) },
+/* Splits "table, count" from UDS_SUBFN() into the two members */
+#define UDS_SERVICE_SUBFN(...)          UDS_SERVICE_SUBFN_(__VA_ARGS__)
+#define UDS_SERVICE_SUBFN_(table, count) .subFunctions = (table), .subFunctionCount = (count)
+
+#define UDS_DID_ENTRY(id, len, flg) { .did = (id), .length = (len), .flags = (flg) },
+
+/* Variables */
+/* Sorted sub-function lists (suppressPosRspMsgIndicationBit cleared) */
+static const uint8_t udsSubFnSessionControl[] = {
+	DEFAULT_SESSION, PROGRAMMING_SESSION, EXTENDED_DIAGNOSTIC_SESSION
+};
+static const uint8_t udsSubFnEcuReset[] = {
+	HARD_RESET, KEY_OFF_ON_RESET, SOFT_RESET
+};
+static const uint8_t udsSubFnReadDtcInfo[] = {
+	REPORT_NUMBER_OF_DTC_BY_STATUS_MASK, REPORT_DTC_BY_STATUS_MASK, REPORT_DTC_SNAPSHOT_RECORD_BY_DTC,
+	REPORT_DTC_EXT_DATA_RECORD_BY_DTC, REPORT_SUPPORTED_DTC
+};
+static const uint8_t udsSubFnDynamicDefine[] = {
+	DEFINE_BY_IDENTIFIER, DEFINE_BY_MEMORY_ADDRESS, CLEAR_DYNAMICALLY_DEFINED_DATA_IDENTIFIER
+};
+static const uint8_t udsSubFnTesterPresent[] = {
+	ZERO_SUB_FUNCTION
+};
+
+const Uds_Service_t udsServices[256] = {
+	UDS_SERVICE_TABLE(UDS_SERVICE_ENTRY)
+};
+
+static const Uds_DidInfo_t udsDids[] = {
+	UDS_DID_TABLE(UDS_DID_ENTRY)
+};
+#define UDS_DID_COUNT ((uint16_t)(sizeof(udsDids) / sizeof(udsDids[0])))
+
+
+/**
+ * @brief Checks that the sorted tables really are sorted, called once at init.
+ */
+bool Uds_DispatchCheck(void){
+	for(uint16_t i = 1; i < UDS_DID_COUNT; i++){
+		if(udsDids[i - 1].did >= udsDids[i].did) return false;
+	}
+	for(uint16_t sid = 0; sid < 256; sid++){
+		const Uds_Service_t* const svc = &udsServices[sid];
+
+		for(uint8_t i = 1; i < svc->subFunctionCount; i++){
+			if(svc->subFunctions[i - 1] >= svc->subFunctions[i]) return false;
+		}
+	}
+
+	return true;
+}
+
+bool Uds_HasSubFunction(const Uds_Service_t* svc, uint8_t subFunction){
+	uint8_t lo = 0;
+	uint8_t hi = svc->subFunctionCount;
+
+	subFunction &= (uint8_t)~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+
+	while(lo < hi){
+		const uint8_t mid = (uint8_t)((lo + hi) / 2);
+
+		if(svc->subFunctions[mid] == subFunction) return true;
+		if(svc->subFunctions[mid] < subFunction) lo = mid + 1;
+		else hi = mid;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Looks up a DID, NULL if it is not in UDS_DID_TABLE.
+ */
+const Uds_DidInfo_t* Uds_FindDid(uint16_t did){
+	uint16_t lo = 0;
+	uint16_t hi = UDS_DID_COUNT;
+
+	while(lo < hi){
+		const uint16_t mid = (uint16_t)((lo + hi) / 2);
+
+		if(udsDids[mid].did == did) return &udsDids[mid];
+		if(udsDids[mid].did < did) lo = mid + 1;
+		else hi = mid;
+	}
+
+	return NULL;
+}
+
+/*
+ * Tracks the session the ECU switched to. Any DID may read differently in
+ * the new session (some ECUs report other identification outside the
+ * default session, the programming session may run other software), so
+ * static DIDs go as well.
+ */
+void Uds_HandleSessionControl(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen){
+	(void)req;
+	(void)reqLen;
+	(void)rspLen;
+
+	Uds_SetSession(txId, rsp[1]);
+	UdsDidCache_Invalidate(txId, false);
+}
+
+/* The ECU restarts in the default session */
+void Uds_HandleEcuReset(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen){
+	(void)req;
+	(void)reqLen;
+	(void)rsp;
+	(void)rspLen;
+
+	Uds_SetSession(txId, DEFAULT_SESSION);
+	UdsDidCache_Invalidate(txId, false);
+}
+
+/* A download is about to replace software or data */
+void Uds_HandleRequestDownload(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen){
+	(void)req;
+	(void)reqLen;
+	(void)rsp;
+	(void)rspLen;
+
+	UdsDidCache_Invalidate(txId, false);
+}
+
+/* A dynamic DID now reads differently; only static DIDs keep their value */
+void Uds_HandleDynamicDefine(uint32_t txId, const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen){
+	(void)req;
+	(void)reqLen;
+	(void)rsp;
+	(void)rspLen;
+
+	UdsDidCache_Invalidate(txId, true);
+}
+
+/* The response echoes the sub-function (without the suppress bit) */
+bool Uds_ParseEchoSubFunction(const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen){
+	(void)reqLen;
+	(void)rspLen;
+
+	return rsp[1] == (uint8_t)(req[1] & ~SUPPRESS_POS_RSP_MSG_INDICATION_BIT);
+}
+
+/*
+ * The response starts with one of the requested DIDs (unsupported DIDs of
+ * a multi-DID request are left out); a known fixed length must fit.
+ */
+bool Uds_ParseReadDataById(const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen){
+	for(uint32_t i = 1; i + 1 < reqLen; i += 2){
+		if(rsp[1] == req[i] && rsp[2] == req[i + 1]){
+			const Uds_DidInfo_t* const info = Uds_FindDid((uint16_t)((req[i] << 8) | req[i + 1]));
+
+			return info == NULL || rspLen >= 3u + info->length;
+		}
+	}
+
+	return false;
+}
+
+/* TransferData echoes the blockSequenceCounter */
+bool Uds_ParseTransferData(const uint8_t* req, uint32_t reqLen, const uint8_t* rsp, uint32_t rspLen){
+	(void)reqLen;
+	(void)rspLen;
+
+	return rsp[1] == req[1];
+}
@@ -0,0 +1,281 @@
+/*
+ * uds_dtc.c
+ *
+ *  Created on: Aug 7, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/uds_dtc.h"
+
+/* Defines */
+#define UDS_DTC_RECORD_SIZE  ((uint8_t) 4)
+/* Longest response header: 59 01 availMask formatId count(2) */
+#define UDS_DTC_HEADER_MAX   ((uint8_t) 6)
+#define UDS_DTC_REQUEST_MAX  ((uint8_t) 6)
+
+/* Structures */
+typedef struct{
+	bool used;
+	uint32_t txId;
+	uint8_t subFunction;
+	uint8_t req[UDS_DTC_REQUEST_MAX];
+	/* Response header collected so far */
+	uint8_t header[UDS_DTC_HEADER_MAX];
+	uint8_t headerLen;
+	uint8_t headerPos;
+	/* Bytes of a DTC record split over two frames */
+	uint8_t part[UDS_DTC_RECORD_SIZE];
+	uint8_t partLen;
+	/* Records decoded but not passed on yet */
+	UdsDtc_Record_t batch[UDS_DTC_BATCH];
+	uint8_t batchCount;
+	uint16_t total;
+	/* Snapshot / extended data bytes passed on */
+	uint32_t dataOffset;
+	UdsDtc_Sink_t sink;
+	void* context;
+}UdsDtc_Job_t;
+
+/* Functions prototype */
+static bool UdsDtc_Stream(uint32_t offset, const uint8_t* data, uint32_t len, void* context);
+static void UdsDtc_Response(const Uds_Response_t* rsp, void* context);
+static bool UdsDtc_Header(UdsDtc_Job_t* job);
+static bool UdsDtc_Flush(UdsDtc_Job_t* job);
+static bool UdsDtc_HasRecords(const UdsDtc_Job_t* job);
+static bool UdsDtc_HasData(const UdsDtc_Job_t* job);
+static void UdsDtc_EventInit(const UdsDtc_Job_t* job, UdsDtc_Event_t* evt, UdsDtc_EventTypeDef type);
+
+/* Variables */
+static UdsDtc_Job_t jobs[UDS_DTC_MAX_JOBS];
+
+
+void UdsDtc_Init(void){
+	for(uint8_t i = 0; i < UDS_DTC_MAX_JOBS; i++){
+		jobs[i].used = false;
+	}
+}
+
+/**
+ * @brief Requests a DTC report and streams the decoded response to sink.
+ *
+ * @param subFunction  One of the REPORT_* types listed in uds_dtc.h.
+ * @param dtc          DTC of a snapshot / extended data report, ignored otherwise.
+ * @param param        DTCStatusMask (0x01, 0x02) or record number (0x04, 0x06).
+ *
+ * @return UDS_NOT_OK for an unsupported report type, UDS_BUSY if all jobs
+ *         (or client request slots) are in use.
+ */
+UDS_StatusTypeDef UdsDtc_Read(uint32_t txId, uint32_t rxId, uint8_t subFunction, uint32_t dtc, uint8_t param,
+		UdsDtc_Sink_t sink, void* context, uint32_t now){
+	UdsDtc_Job_t* job = NULL;
+	UDS_StatusTypeDef status;
+	uint8_t reqLen;
+
+	if(sink == NULL) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < UDS_DTC_MAX_JOBS; i++){
+		if(!jobs[i].used){
+			job = &jobs[i];
+			break;
+		}
+	}
+	if(job == NULL) return UDS_BUSY;
+
+	job->req[0] = SID_READ_DTC_INFO;
+	job->req[1] = subFunction;
+
+	switch(subFunction){
+		case REPORT_NUMBER_OF_DTC_BY_STATUS_MASK:
+			job->req[2] = param;
+			reqLen = 3;
+			job->headerLen = 6;
+			break;
+
+		case REPORT_DTC_BY_STATUS_MASK:
+			job->req[2] = param;
+			reqLen = 3;
+			job->headerLen = 3;
+			break;
+
+		case REPORT_SUPPORTED_DTC:
+			reqLen = 2;
+			job->headerLen = 3;
+			break;
+
+		case REPORT_DTC_SNAPSHOT_RECORD_BY_DTC:
+		case REPORT_DTC_EXT_DATA_RECORD_BY_DTC:
+			job->req[2] = (uint8_t)(dtc >> 16);
+			job->req[3] = (uint8_t)(dtc >> 8);
+			job->req[4] = (uint8_t)dtc;
+			job->req[5] = param;
+			reqLen = 6;
+			job->headerLen = 2;
+			break;
+
+		default:
+			return UDS_NOT_OK;
+	}
+
+	job->txId = txId;
+	job->subFunction = subFunction;
+	job->headerPos = 0;
+	job->partLen = 0;
+	job->batchCount = 0;
+	job->total = 0;
+	job->dataOffset = 0;
+	job->sink = sink;
+	job->context = context;
+	/* Taken before the request, which may complete right away */
+	job->used = true;
+
+	status = Uds_RequestStream(txId, rxId, job->req, reqLen, UdsDtc_Stream, UdsDtc_Response, job, now);
+	if(status != UDS_OK){
+		job->used = false;
+	}
+
+	return status;
+}
+
+
+/* Private functions */
+
+/* Uds_Stream_t: decodes whatever the frame completes */
+static bool UdsDtc_Stream(uint32_t offset, const uint8_t* data, uint32_t len, void* context){
+	UdsDtc_Job_t* const job = (UdsDtc_Job_t*)context;
+	uint32_t i = 0;
+
+	/* A new response (after NRC 0x78 or a FC.WAIT retry) starts over */
+	if(offset == 0){
+		job->headerPos = 0;
+		job->partLen = 0;
+		job->batchCount = 0;
+		job->total = 0;
+		job->dataOffset = 0;
+	}
+
+	while(i < len && job->headerPos < job->headerLen){
+		job->header[job->headerPos++] = data[i++];
+		if(job->headerPos == job->headerLen && !UdsDtc_Header(job)) return false;
+	}
+
+	while(i < len && UdsDtc_HasRecords(job)){
+		job->part[job->partLen++] = data[i++];
+		if(job->partLen < UDS_DTC_RECORD_SIZE) continue;
+
+		job->batch[job->batchCount].dtc = ((uint32_t)job->part[0] << 16) | ((uint32_t)job->part[1] << 8) | job->part[2];
+		job->batch[job->batchCount].status = job->part[3];
+		job->batchCount++;
+		job->total++;
+		job->partLen = 0;
+
+		if(job->batchCount == UDS_DTC_BATCH && !UdsDtc_Flush(job)) return false;
+	}
+
+	/* Records of this frame go out now, not with the next batch */
+	if(!UdsDtc_Flush(job)) return false;
+
+	if(i < len && UdsDtc_HasData(job)){
+		UdsDtc_Event_t evt;
+
+		UdsDtc_EventInit(job, &evt, UDS_DTC_EVT_DATA);
+		evt.offset = job->dataOffset;
+		evt.data = &data[i];
+		evt.length = len - i;
+		job->dataOffset += len - i;
+
+		return job->sink(&evt, job->context);
+	}
+
+	return true;
+}
+
+static void UdsDtc_Response(const Uds_Response_t* rsp, void* context){
+	UdsDtc_Job_t* const job = (UdsDtc_Job_t*)context;
+	UdsDtc_Event_t evt;
+
+	UdsDtc_EventInit(job, &evt, UDS_DTC_EVT_END);
+	evt.result = rsp->result;
+	evt.nrc = rsp->nrc;
+	evt.total = job->total;
+
+	/* A header cut short or a record split at the end of the response */
+	if(evt.result == UDS_RESULT_POSITIVE && (job->headerPos < job->headerLen || job->partLen != 0)){
+		evt.result = UDS_RESULT_INVALID_RSP;
+	}
+	if(evt.result != UDS_RESULT_POSITIVE){
+		evt.total = 0;
+	}
+
+	/* Freed first, so the sink may start the next report */
+	job->used = false;
+	(void)job->sink(&evt, job->context);
+}
+
+static bool UdsDtc_Header(UdsDtc_Job_t* job){
+	UdsDtc_Event_t evt;
+
+	if(job->header[1] != job->subFunction) return false;
+
+	UdsDtc_EventInit(job, &evt, UDS_DTC_EVT_HEADER);
+	if(job->headerLen > 2){
+		evt.availMask = job->header[2];
+	}
+	if(job->subFunction == REPORT_NUMBER_OF_DTC_BY_STATUS_MASK){
+		evt.formatId = job->header[3];
+		evt.count = (uint16_t)((job->header[4] << 8) | job->header[5]);
+	}
+
+	return job->sink(&evt, job->context);
+}
+
+static bool UdsDtc_Flush(UdsDtc_Job_t* job){
+	UdsDtc_Event_t evt;
+
+	if(job->batchCount == 0) return true;
+
+	UdsDtc_EventInit(job, &evt, UDS_DTC_EVT_RECORDS);
+	evt.records = job->batch;
+	evt.recordCount = job->batchCount;
+	job->batchCount = 0;
+
+	return job->sink(&evt, job->context);
+}
+
+/* 0x02 / 0x0A are lists of records, 0x04 / 0x06 carry a single one */
+static bool UdsDtc_HasRecords(const UdsDtc_Job_t* job){
+	switch(job->subFunction){
+		case REPORT_DTC_BY_STATUS_MASK:
+		case REPORT_SUPPORTED_DTC:
+			return true;
+
+		case REPORT_DTC_SNAPSHOT_RECORD_BY_DTC:
+		case REPORT_DTC_EXT_DATA_RECORD_BY_DTC:
+			return job->total == 0;
+
+		default:
+			return false;
+	}
+}
+
+static bool UdsDtc_HasData(const UdsDtc_Job_t* job){
+	return (job->subFunction == REPORT_DTC_SNAPSHOT_RECORD_BY_DTC || job->subFunction == REPORT_DTC_EXT_DATA_RECORD_BY_DTC)
+			&& job->total == 1;
+}
+
+static void UdsDtc_EventInit(const UdsDtc_Job_t* job, UdsDtc_Event_t* evt, UdsDtc_EventTypeDef type){
+	evt->type = type;
+	evt->txId = job->txId;
+	evt->subFunction = job->subFunction;
+	evt->availMask = 0;
+	evt->formatId = 0;
+	evt->count = 0;
+	evt->records = NULL;
+	evt->recordCount = 0;
+	evt->offset = 0;
+	evt->data = NULL;
+	evt->length = 0;
+	evt->result = UDS_RESULT_POSITIVE;
+	evt->nrc = 0;
+	evt->total = 0;
+}
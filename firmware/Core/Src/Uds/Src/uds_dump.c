@@ -0,0 +1,372 @@
+/*
+ * uds_dump.c
+ *
+ *  Created on: Aug 9, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_dump.h"
+
+/* Defines */
+/* 0x35: SID, dataFormatIdentifier, ALFID, address and size of up to 4 bytes each */
+#define UDS_DUMP_REQUEST_MAX  ((uint8_t) 11)
+/* Largest TransferData payload (4095 byte ISO-TP message less SID and counter) */
+#define UDS_DUMP_UPLOAD_BLOCK ((uint32_t) 4093)
+/* ReadMemoryByAddress blocks are not halved below this */
+#define UDS_DUMP_MIN_BLOCK    ((uint32_t) 16)
+
+/* Enums */
+typedef enum{
+	UDS_DUMP_IDLE,
+	UDS_DUMP_READ,
+	UDS_DUMP_UPLOAD_REQUEST,
+	UDS_DUMP_TRANSFER,
+	UDS_DUMP_EXIT
+}UdsDump_StateTypeDef;
+
+/* Structures */
+typedef struct{
+	UdsDump_StateTypeDef state;
+	uint32_t txId;
+	uint32_t rxId;
+	uint8_t alfid;
+	/* Next address to request and end of the range */
+	uint32_t address;
+	uint32_t end;
+	/* Current block: length requested and bytes received so far */
+	uint32_t blockMax;
+	uint32_t blockLength;
+	uint32_t received;
+	uint8_t seq;
+	uint8_t retries;
+	uint8_t req[UDS_DUMP_REQUEST_MAX];
+	/* Data received but not passed on yet */
+	uint8_t chunk[UDS_DUMP_CHUNK];
+	uint16_t chunkLen;
+	uint32_t chunkAddress;
+	/* Statistics */
+	uint32_t bytes;
+	uint16_t requests;
+	uint32_t start;
+	UdsDump_Sink_t sink;
+	void* context;
+}UdsDump_Job_t;
+
+/* Functions prototype */
+static bool UdsDump_Next(uint32_t now);
+static void UdsDump_Continue(void);
+static void UdsDump_Finish(Uds_ResultTypeDef result, uint8_t nrc);
+static bool UdsDump_Stream(uint32_t offset, const uint8_t* data, uint32_t len, void* context);
+static void UdsDump_Response(const Uds_Response_t* rsp, void* context);
+static bool UdsDump_Flush(void);
+static uint8_t UdsDump_PutValue(uint8_t* p, uint32_t value, uint8_t size);
+
+/* Variables */
+static UdsDump_Job_t dump;
+
+
+void UdsDump_Init(void){
+	dump.state = UDS_DUMP_IDLE;
+}
+
+/**
+ * @brief Dumps length bytes from address.
+ *
+ * @param method  UDS_DUMP_UPLOAD needs the ECU in a non-default session.
+ * @param alfid   addressAndLengthFormatIdentifier: size bytes in the high
+ *                nibble, address bytes in the low nibble (1 to 4 each).
+ *
+ * @return UDS_BUSY if a dump is running, UDS_NOT_OK for a bad range or
+ *         format, or if the first request is rejected.
+ */
+UDS_StatusTypeDef UdsDump_Start(uint32_t txId, uint32_t rxId, UdsDump_MethodTypeDef method,
+		uint32_t address, uint32_t length, uint8_t alfid, UdsDump_Sink_t sink, void* context, uint32_t now){
+	const uint8_t addrSize = alfid & 0x0F;
+	const uint8_t lenSize = alfid >> 4;
+
+	if(dump.state != UDS_DUMP_IDLE) return UDS_BUSY;
+	if(sink == NULL || length == 0 || address + length < address) return UDS_NOT_OK;
+	if(addrSize == 0 || addrSize > 4 || lenSize == 0 || lenSize > 4) return UDS_NOT_OK;
+	if(addrSize < 4 && (address + length - 1) >> (8 * addrSize) != 0) return UDS_NOT_OK;
+	if(method == UDS_DUMP_UPLOAD && lenSize < 4 && length >> (8 * lenSize) != 0) return UDS_NOT_OK;
+
+	dump.txId = txId;
+	dump.rxId = rxId;
+	dump.alfid = alfid;
+	dump.address = address;
+	dump.end = address + length;
+	dump.blockMax = UDS_DUMP_RMBA_BLOCK;
+	/* memorySize must fit its field */
+	if(lenSize < 4 && dump.blockMax >> (8 * lenSize) != 0){
+		dump.blockMax = (1u << (8 * lenSize)) - 1;
+	}
+	dump.retries = 0;
+	dump.chunkLen = 0;
+	dump.bytes = 0;
+	dump.requests = 0;
+	dump.start = now;
+	dump.sink = sink;
+	dump.context = context;
+	dump.state = (method == UDS_DUMP_UPLOAD) ? UDS_DUMP_UPLOAD_REQUEST : UDS_DUMP_READ;
+
+	if(!UdsDump_Next(now)){
+		dump.state = UDS_DUMP_IDLE;
+		return UDS_NOT_OK;
+	}
+
+	return UDS_OK;
+}
+
+bool UdsDump_IsRunning(void){
+	return dump.state != UDS_DUMP_IDLE;
+}
+
+
+/* Private functions */
+
+/* Queues the next request of the dump, or ends it; false if the request is refused */
+static bool UdsDump_Next(uint32_t now){
+	const uint8_t addrSize = dump.alfid & 0x0F;
+	const uint8_t lenSize = dump.alfid >> 4;
+	uint8_t len = 0;
+	bool stream = true;
+
+	switch(dump.state){
+		case UDS_DUMP_READ:
+			if(dump.address == dump.end){
+				UdsDump_Finish(UDS_RESULT_POSITIVE, 0);
+				return true;
+			}
+			dump.blockLength = dump.end - dump.address;
+			if(dump.blockLength > dump.blockMax) dump.blockLength = dump.blockMax;
+
+			dump.req[len++] = SID_READ_MEMORY_BY_ADDRESS;
+			dump.req[len++] = dump.alfid;
+			len += UdsDump_PutValue(&dump.req[len], dump.address, addrSize);
+			len += UdsDump_PutValue(&dump.req[len], dump.blockLength, lenSize);
+			break;
+
+		case UDS_DUMP_UPLOAD_REQUEST:
+			dump.req[len++] = SID_REQUEST_UPLOAD;
+			/* dataFormatIdentifier: neither compressed nor encrypted */
+			dump.req[len++] = 0x00;
+			dump.req[len++] = dump.alfid;
+			len += UdsDump_PutValue(&dump.req[len], dump.address, addrSize);
+			len += UdsDump_PutValue(&dump.req[len], dump.end - dump.address, lenSize);
+			stream = false;
+			break;
+
+		case UDS_DUMP_TRANSFER:
+			if(dump.address == dump.end){
+				dump.state = UDS_DUMP_EXIT;
+				dump.req[len++] = SID_REQUEST_TRANSFER_EXIT;
+				stream = false;
+				break;
+			}
+			dump.blockLength = dump.end - dump.address;
+			if(dump.blockLength > dump.blockMax) dump.blockLength = dump.blockMax;
+
+			dump.req[len++] = SID_TRANSFER_DATA;
+			dump.req[len++] = dump.seq;
+			break;
+
+		default:
+			return true;
+	}
+
+	dump.received = 0;
+	if(Uds_RequestStream(dump.txId, dump.rxId, dump.req, len, stream ? UdsDump_Stream : NULL,
+			UdsDump_Response, NULL, now) != UDS_OK){
+		return false;
+	}
+	dump.requests++;
+
+	return true;
+}
+
+/* Next request from a completion */
+static void UdsDump_Continue(void){
+	if(!UdsDump_Next(Uds_GetTime())){
+		UdsDump_Finish(UDS_RESULT_TX_ERROR, 0);
+	}
+}
+
+static void UdsDump_Finish(Uds_ResultTypeDef result, uint8_t nrc){
+	UdsDump_Event_t evt;
+
+	dump.state = UDS_DUMP_IDLE;
+
+	memset(&evt, 0, sizeof(evt));
+	evt.type = UDS_DUMP_EVT_END;
+	evt.txId = dump.txId;
+	evt.result = result;
+	evt.nrc = nrc;
+	evt.bytes = dump.bytes;
+	evt.requests = dump.requests;
+	evt.duration = Uds_GetTime() - dump.start;
+
+	(void)dump.sink(&evt, dump.context);
+}
+
+/*
+ * Uds_Stream_t of 0x23 / 0x36 responses. The response SID (and for 0x36
+ * the echoed counter) is skipped, the data goes to the chunk buffer.
+ */
+static bool UdsDump_Stream(uint32_t offset, const uint8_t* data, uint32_t len, void* context){
+	const uint32_t header = (dump.state == UDS_DUMP_TRANSFER) ? 2 : 1;
+
+	(void)context;
+
+	if(offset == 0){
+		UdsDump_Event_t evt;
+
+		memset(&evt, 0, sizeof(evt));
+		evt.type = UDS_DUMP_EVT_BLOCK;
+		evt.txId = dump.txId;
+		evt.address = dump.address;
+		evt.length = dump.blockLength;
+		if(!dump.sink(&evt, dump.context)) return false;
+
+		dump.received = 0;
+		dump.chunkLen = 0;
+	}
+
+	/* A TransferData response for another block */
+	if(header == 2 && offset <= 1 && offset + len > 1 && data[1 - offset] != dump.seq) return false;
+
+	while(offset < header && len > 0){
+		offset++;
+		data++;
+		len--;
+	}
+	if(dump.received + len > dump.blockLength) return false;
+
+	while(len > 0){
+		uint32_t n = UDS_DUMP_CHUNK - dump.chunkLen;
+
+		if(n > len) n = len;
+		if(dump.chunkLen == 0){
+			dump.chunkAddress = dump.address + dump.received;
+		}
+		memcpy(&dump.chunk[dump.chunkLen], data, n);
+		dump.chunkLen += (uint16_t)n;
+		dump.received += n;
+		data += n;
+		len -= n;
+
+		if((dump.chunkLen == UDS_DUMP_CHUNK || dump.received == dump.blockLength) && !UdsDump_Flush()) return false;
+	}
+
+	return true;
+}
+
+static void UdsDump_Response(const Uds_Response_t* rsp, void* context){
+	Uds_ResultTypeDef result = rsp->result;
+
+	(void)context;
+
+	if(dump.state == UDS_DUMP_IDLE) return;
+
+	if(result == UDS_RESULT_POSITIVE){
+		switch(dump.state){
+			case UDS_DUMP_READ:
+			case UDS_DUMP_TRANSFER:
+				/* 0x23 returns the whole block, an upload block may be shorter */
+				if(dump.received == 0 || (dump.state == UDS_DUMP_READ && dump.received != dump.blockLength)){
+					result = UDS_RESULT_INVALID_RSP;
+					break;
+				}
+				if(!UdsDump_Flush()){
+					result = UDS_RESULT_RX_ERROR;
+					break;
+				}
+				dump.address += dump.received;
+				dump.bytes += dump.received;
+				dump.retries = 0;
+				if(dump.state == UDS_DUMP_TRANSFER){
+					/* Wraps from 0xFF to 0x00 */
+					dump.seq++;
+				}
+				UdsDump_Continue();
+				return;
+
+			case UDS_DUMP_UPLOAD_REQUEST:{
+				/* lengthFormatIdentifier: size of maxNumberOfBlockLength in the high nibble */
+				const uint8_t size = rsp->data[1] >> 4;
+				uint32_t maxLength = 0;
+
+				if(size == 0 || size > 4 || rsp->length < 2u + size){
+					result = UDS_RESULT_INVALID_RSP;
+					break;
+				}
+				for(uint8_t i = 0; i < size; i++){
+					maxLength = (maxLength << 8) | rsp->data[2 + i];
+				}
+				/* Includes the SID and the blockSequenceCounter */
+				if(maxLength <= 2){
+					result = UDS_RESULT_INVALID_RSP;
+					break;
+				}
+				dump.blockMax = maxLength - 2;
+				if(dump.blockMax > UDS_DUMP_UPLOAD_BLOCK) dump.blockMax = UDS_DUMP_UPLOAD_BLOCK;
+				dump.seq = 1;
+				dump.state = UDS_DUMP_TRANSFER;
+				UdsDump_Continue();
+				return;
+			}
+
+			case UDS_DUMP_EXIT:
+				UdsDump_Finish(UDS_RESULT_POSITIVE, 0);
+				return;
+
+			default:
+				return;
+		}
+	}
+
+	/* Block too large for the ECU: smaller blocks, no retry used */
+	if(result == UDS_RESULT_NEGATIVE && dump.state == UDS_DUMP_READ && dump.blockLength > UDS_DUMP_MIN_BLOCK
+			&& (rsp->nrc == NRC_INCORRECT_MESSAGE_LENGTH || rsp->nrc == NRC_RESPONSE_TOO_LONG || rsp->nrc == NRC_REQUEST_OUT_OF_RANGE)){
+		dump.blockMax = dump.blockLength / 2;
+		UdsDump_Continue();
+		return;
+	}
+
+	/* Lost or damaged block: the same request once more */
+	if((result == UDS_RESULT_TIMEOUT || result == UDS_RESULT_RX_ERROR || result == UDS_RESULT_INVALID_RSP)
+			&& dump.state != UDS_DUMP_UPLOAD_REQUEST && dump.retries < UDS_DUMP_RETRIES){
+		dump.retries++;
+		dump.chunkLen = 0;
+		UdsDump_Continue();
+		return;
+	}
+
+	UdsDump_Finish(result, rsp->nrc);
+}
+
+static bool UdsDump_Flush(void){
+	UdsDump_Event_t evt;
+
+	if(dump.chunkLen == 0) return true;
+
+	memset(&evt, 0, sizeof(evt));
+	evt.type = UDS_DUMP_EVT_DATA;
+	evt.txId = dump.txId;
+	evt.address = dump.chunkAddress;
+	evt.data = dump.chunk;
+	evt.length = dump.chunkLen;
+	dump.chunkLen = 0;
+
+	return dump.sink(&evt, dump.context);
+}
+
+/* Big endian, the last size bytes of value */
+static uint8_t UdsDump_PutValue(uint8_t* p, uint32_t value, uint8_t size){
+	for(uint8_t i = 0; i < size; i++){
+		p[i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+	}
+
+	return size;
+}
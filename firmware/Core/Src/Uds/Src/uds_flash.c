@@ -0,0 +1,348 @@
+/*
+ * uds_flash.c
+ *
+ *  Created on: Aug 10, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_flash.h"
+
+/* Defines */
+/* 0x34: SID, dataFormatIdentifier, ALFID, address and size of up to 4 bytes each */
+#define UDS_FLASH_REQUEST_MAX  ((uint8_t) 11)
+/* TransferData header: SID and blockSequenceCounter */
+#define UDS_FLASH_BLOCK_HEADER ((uint8_t) 2)
+
+/* Enums */
+typedef enum{
+	UDS_FLASH_IDLE,
+	/* RequestDownload outstanding (the ECU erases), first block filling */
+	UDS_FLASH_DOWNLOAD,
+	/* TransferData outstanding, next block filling */
+	UDS_FLASH_TRANSFER,
+	/* Nothing outstanding, waiting for the host to fill the block */
+	UDS_FLASH_HOST,
+	UDS_FLASH_EXIT
+}UdsFlash_StateTypeDef;
+
+/* Structures */
+typedef struct{
+	/* TransferData request: SID, counter, then the data */
+	uint8_t buff[UDS_FLASH_BLOCK_HEADER + UDS_FLASH_BLOCK_MAX];
+	/* Image offset of the data and bytes filled */
+	uint32_t offset;
+	uint32_t fill;
+}UdsFlash_Block_t;
+
+typedef struct{
+	UdsFlash_StateTypeDef state;
+	uint32_t txId;
+	uint32_t rxId;
+	uint32_t length;
+	uint32_t blockMax;
+	uint8_t seq;
+	uint8_t retries;
+	uint8_t req[UDS_FLASH_REQUEST_MAX];
+	/* blocks[current] is sent next or is on the bus, the other one fills */
+	UdsFlash_Block_t blocks[2];
+	uint8_t current;
+	UdsFlash_Source_t source;
+	UdsFlash_DoneCallback_t callback;
+	void* context;
+	/* Statistics */
+	uint32_t start;
+	uint32_t sent;
+	uint32_t hostSince;
+	UdsFlash_Report_t report;
+}UdsFlash_Job_t;
+
+/* Functions prototype */
+static void UdsFlash_Fill(UdsFlash_Block_t* block, uint32_t target);
+static uint32_t UdsFlash_BlockLength(const UdsFlash_Block_t* block);
+static void UdsFlash_Next(uint32_t now);
+static bool UdsFlash_Send(const uint8_t* data, uint32_t length, uint32_t now);
+static void UdsFlash_Response(const Uds_Response_t* rsp, void* context);
+static void UdsFlash_Finish(Uds_ResultTypeDef result, uint8_t nrc, uint8_t sid);
+static uint8_t UdsFlash_PutValue(uint8_t* p, uint32_t value, uint8_t size);
+
+/* Variables */
+static UdsFlash_Job_t flash;
+
+
+void UdsFlash_Init(void){
+	flash.state = UDS_FLASH_IDLE;
+}
+
+/**
+ * @brief Downloads length bytes of the image from source to address.
+ *
+ * @param alfid       addressAndLengthFormatIdentifier: size bytes in the high
+ *                    nibble, address bytes in the low nibble (1 to 4 each).
+ * @param dataFormat  dataFormatIdentifier (compression / encryption), 0x00 for none.
+ * @param callback    Called once with the report, also on failure.
+ *
+ * @return UDS_BUSY if a download is running, UDS_NOT_OK for a bad range or
+ *         format, or if RequestDownload is rejected (e.g. default session).
+ */
+UDS_StatusTypeDef UdsFlash_Start(uint32_t txId, uint32_t rxId, uint32_t address, uint32_t length,
+		uint8_t alfid, uint8_t dataFormat, UdsFlash_Source_t source, UdsFlash_DoneCallback_t callback,
+		void* context, uint32_t now){
+	const uint8_t addrSize = alfid & 0x0F;
+	const uint8_t lenSize = alfid >> 4;
+	uint8_t len = 0;
+
+	if(flash.state != UDS_FLASH_IDLE) return UDS_BUSY;
+	if(source == NULL || length == 0 || address + length < address) return UDS_NOT_OK;
+	if(addrSize == 0 || addrSize > 4 || lenSize == 0 || lenSize > 4) return UDS_NOT_OK;
+	if(addrSize < 4 && (address + length - 1) >> (8 * addrSize) != 0) return UDS_NOT_OK;
+	if(lenSize < 4 && length >> (8 * lenSize) != 0) return UDS_NOT_OK;
+
+	flash.req[len++] = SID_REQUEST_DOWNLOAD;
+	flash.req[len++] = dataFormat;
+	flash.req[len++] = alfid;
+	len += UdsFlash_PutValue(&flash.req[len], address, addrSize);
+	len += UdsFlash_PutValue(&flash.req[len], length, lenSize);
+
+	flash.txId = txId;
+	flash.rxId = rxId;
+	flash.length = length;
+	/* Until the ECU tells its maxNumberOfBlockLength */
+	flash.blockMax = UDS_FLASH_BLOCK_MAX;
+	flash.retries = 0;
+	flash.current = 0;
+	flash.blocks[0].offset = 0;
+	flash.blocks[0].fill = 0;
+	flash.blocks[1].fill = 0;
+	flash.source = source;
+	flash.callback = callback;
+	flash.context = context;
+	flash.start = now;
+	memset(&flash.report, 0, sizeof(flash.report));
+	flash.report.txId = txId;
+	flash.state = UDS_FLASH_DOWNLOAD;
+
+	if(!UdsFlash_Send(flash.req, len, now)){
+		flash.state = UDS_FLASH_IDLE;
+		return UDS_NOT_OK;
+	}
+
+	/* The first block fills while the ECU erases */
+	if(flash.state == UDS_FLASH_DOWNLOAD){
+		UdsFlash_Fill(&flash.blocks[0], UdsFlash_BlockLength(&flash.blocks[0]));
+	}
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Pulls image data from the source and sends a block held back for it.
+ */
+void UdsFlash_MainFunction(uint32_t now){
+	switch(flash.state){
+		case UDS_FLASH_DOWNLOAD:
+			UdsFlash_Fill(&flash.blocks[0], UdsFlash_BlockLength(&flash.blocks[0]));
+			break;
+
+		case UDS_FLASH_TRANSFER:{
+			UdsFlash_Block_t* const next = &flash.blocks[flash.current ^ 1];
+
+			UdsFlash_Fill(next, UdsFlash_BlockLength(next));
+			break;
+		}
+
+		case UDS_FLASH_HOST:
+			UdsFlash_Next(now);
+			break;
+
+		default:
+			break;
+	}
+}
+
+bool UdsFlash_IsRunning(void){
+	return flash.state != UDS_FLASH_IDLE;
+}
+
+
+/* Private functions */
+
+static void UdsFlash_Fill(UdsFlash_Block_t* block, uint32_t target){
+	while(block->fill < target){
+		uint32_t n = flash.source(block->offset + block->fill, &block->buff[UDS_FLASH_BLOCK_HEADER + block->fill],
+				target - block->fill, flash.context);
+
+		if(n == 0) break;
+		if(n > target - block->fill) n = target - block->fill;
+		block->fill += n;
+	}
+}
+
+/* Data length of the block at the block's offset */
+static uint32_t UdsFlash_BlockLength(const UdsFlash_Block_t* block){
+	const uint32_t left = flash.length - block->offset;
+
+	return (left < flash.blockMax) ? left : flash.blockMax;
+}
+
+/*
+ * Sends blocks[current] once it is complete, or RequestTransferExit after
+ * the last one. Otherwise waits for the host (UDS_FLASH_HOST).
+ */
+static void UdsFlash_Next(uint32_t now){
+	UdsFlash_Block_t* const block = &flash.blocks[flash.current];
+	UdsFlash_Block_t* const next = &flash.blocks[flash.current ^ 1];
+	uint32_t length;
+
+	if(block->offset == flash.length){
+		if(flash.state == UDS_FLASH_HOST){
+			flash.report.hostWait += now - flash.hostSince;
+		}
+		flash.state = UDS_FLASH_EXIT;
+		flash.req[0] = SID_REQUEST_TRANSFER_EXIT;
+		if(!UdsFlash_Send(flash.req, 1, now)){
+			UdsFlash_Finish(UDS_RESULT_TX_ERROR, 0, SID_REQUEST_TRANSFER_EXIT);
+		}
+		return;
+	}
+
+	length = UdsFlash_BlockLength(block);
+	UdsFlash_Fill(block, length);
+	if(block->fill < length){
+		if(flash.state != UDS_FLASH_HOST){
+			flash.hostSince = now;
+			flash.state = UDS_FLASH_HOST;
+		}
+		return;
+	}
+	if(flash.state == UDS_FLASH_HOST){
+		flash.report.hostWait += now - flash.hostSince;
+	}
+
+	/* The first block was filled before the block length was known */
+	next->offset = block->offset + length;
+	next->fill = block->fill - length;
+	if(next->fill != 0){
+		memcpy(&next->buff[UDS_FLASH_BLOCK_HEADER], &block->buff[UDS_FLASH_BLOCK_HEADER + length], next->fill);
+		block->fill = length;
+	}
+
+	block->buff[0] = SID_TRANSFER_DATA;
+	block->buff[1] = flash.seq;
+	flash.state = UDS_FLASH_TRANSFER;
+	if(!UdsFlash_Send(block->buff, UDS_FLASH_BLOCK_HEADER + length, now)){
+		UdsFlash_Finish(UDS_RESULT_TX_ERROR, 0, SID_TRANSFER_DATA);
+		return;
+	}
+
+	/* Prefetch while the block is on the bus */
+	if(flash.state == UDS_FLASH_TRANSFER){
+		UdsFlash_Fill(next, UdsFlash_BlockLength(next));
+	}
+}
+
+static bool UdsFlash_Send(const uint8_t* data, uint32_t length, uint32_t now){
+	flash.sent = now;
+
+	return Uds_Request(flash.txId, flash.rxId, data, length, UdsFlash_Response, NULL, now) == UDS_OK;
+}
+
+static void UdsFlash_Response(const Uds_Response_t* rsp, void* context){
+	const uint32_t now = Uds_GetTime();
+
+	(void)context;
+
+	if(flash.state == UDS_FLASH_IDLE) return;
+
+	flash.report.ecuWait += now - flash.sent;
+
+	if(rsp->result == UDS_RESULT_POSITIVE){
+		switch(flash.state){
+			case UDS_FLASH_DOWNLOAD:{
+				/* lengthFormatIdentifier: size of maxNumberOfBlockLength in the high nibble */
+				const uint8_t size = rsp->data[1] >> 4;
+				uint32_t maxLength = 0;
+
+				if(size == 0 || size > 4 || rsp->length < 2u + size){
+					UdsFlash_Finish(UDS_RESULT_INVALID_RSP, 0, SID_REQUEST_DOWNLOAD);
+					return;
+				}
+				for(uint8_t i = 0; i < size; i++){
+					maxLength = (maxLength << 8) | rsp->data[2 + i];
+				}
+				/* Includes the SID and the blockSequenceCounter */
+				if(maxLength <= UDS_FLASH_BLOCK_HEADER){
+					UdsFlash_Finish(UDS_RESULT_INVALID_RSP, 0, SID_REQUEST_DOWNLOAD);
+					return;
+				}
+				if(maxLength - UDS_FLASH_BLOCK_HEADER < flash.blockMax){
+					flash.blockMax = maxLength - UDS_FLASH_BLOCK_HEADER;
+				}
+				flash.report.blockLength = (uint16_t)flash.blockMax;
+				flash.seq = 1;
+				UdsFlash_Next(now);
+				return;
+			}
+
+			case UDS_FLASH_TRANSFER:{
+				const UdsFlash_Block_t* const block = &flash.blocks[flash.current];
+
+				flash.report.bytes += block->fill;
+				flash.report.blocks++;
+				flash.retries = 0;
+				/* Wraps from 0xFF to 0x00 */
+				flash.seq++;
+				flash.current ^= 1;
+				UdsFlash_Next(now);
+				return;
+			}
+
+			case UDS_FLASH_EXIT:
+				UdsFlash_Finish(UDS_RESULT_POSITIVE, 0, 0);
+				return;
+
+			default:
+				return;
+		}
+	}
+
+	/* Lost block or response: the same block, same counter, once more */
+	if(flash.state == UDS_FLASH_TRANSFER && flash.retries < UDS_FLASH_RETRIES
+			&& (rsp->result == UDS_RESULT_TIMEOUT || rsp->result == UDS_RESULT_RX_ERROR
+			|| rsp->result == UDS_RESULT_TX_ERROR || rsp->result == UDS_RESULT_INVALID_RSP)){
+		const UdsFlash_Block_t* const block = &flash.blocks[flash.current];
+
+		flash.retries++;
+		flash.report.retries++;
+		if(UdsFlash_Send(block->buff, UDS_FLASH_BLOCK_HEADER + block->fill, now)) return;
+	}
+
+	UdsFlash_Finish(rsp->result, rsp->nrc, rsp->sid);
+}
+
+static void UdsFlash_Finish(Uds_ResultTypeDef result, uint8_t nrc, uint8_t sid){
+	UdsFlash_Report_t* const report = &flash.report;
+
+	flash.state = UDS_FLASH_IDLE;
+
+	report->result = result;
+	report->nrc = nrc;
+	report->sid = (result == UDS_RESULT_POSITIVE) ? 0 : sid;
+	report->duration = Uds_GetTime() - flash.start;
+	report->bytesPerSecond = (report->duration != 0)
+			? (uint32_t)(((uint64_t)report->bytes * 1000) / report->duration) : report->bytes;
+
+	if(flash.callback != NULL){
+		flash.callback(report, flash.context);
+	}
+}
+
+/* Big endian, the last size bytes of value */
+static uint8_t UdsFlash_PutValue(uint8_t* p, uint32_t value, uint8_t size){
+	for(uint8_t i = 0; i < size; i++){
+		p[i] = (uint8_t)(value >> (8 * (size - 1 - i)));
+	}
+
+	return size;
+}
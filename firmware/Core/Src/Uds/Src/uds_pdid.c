@@ -0,0 +1,231 @@
+/*
+ * uds_pdid.c
+ *
+ *  Created on: Aug 11, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_pdid.h"
+
+/* Defines */
+#define UDS_PDID_REQUEST_MAX ((uint8_t)(2 + UDS_PDID_MAX_IDS))
+
+/* Structures */
+typedef struct{
+	bool used;
+	/* Waiting for the response to the request starting the schedule */
+	bool starting;
+	uint32_t txId;
+	uint32_t periodicId;
+	uint8_t req[UDS_PDID_REQUEST_MAX];
+	uint8_t count;
+	/* Samples not passed on yet and the time of the oldest */
+	UdsPdid_Sample_t batch[UDS_PDID_BATCH];
+	uint8_t batchCount;
+	uint32_t batchTime;
+	UdsPdid_Sink_t sink;
+	Uds_Callback_t callback;
+	void* context;
+}UdsPdid_Job_t;
+
+/* Functions prototype */
+static void UdsPdid_Response(const Uds_Response_t* rsp, void* context);
+static bool UdsPdid_IsScheduled(const UdsPdid_Job_t* job, uint8_t pdid);
+static void UdsPdid_Flush(UdsPdid_Job_t* job);
+static void UdsPdid_Release(UdsPdid_Job_t* job);
+
+/* Variables */
+static UdsPdid_Job_t jobs[UDS_PDID_MAX_JOBS];
+static UdsPdid_Filter_t pdidFilter;
+/* Samples refused by the sinks */
+static uint32_t pdidLost;
+
+
+void UdsPdid_Init(UdsPdid_Filter_t filter){
+	pdidFilter = filter;
+	pdidLost = 0;
+	for(uint8_t i = 0; i < UDS_PDID_MAX_JOBS; i++){
+		jobs[i].used = false;
+	}
+}
+
+/**
+ * @brief Schedules periodic DIDs on an ECU and receives them.
+ *
+ * @param periodicId  CAN ID the ECU sends the periodic frames on.
+ * @param rate        SEND_AT_SLOW_RATE, SEND_AT_MEDIUM_RATE or SEND_AT_FAST_RATE.
+ * @param pdids       periodicDataIdentifiers, the low byte of DIDs 0xF2xx.
+ * @param callback    Outcome of the 0x2A request, may be NULL. A schedule
+ *                    the ECU rejects is released before the callback.
+ *
+ * @return UDS_NOT_OK for bad arguments or no filter bank left, UDS_BUSY if
+ *         all schedules (or client request slots) are in use.
+ */
+UDS_StatusTypeDef UdsPdid_Start(uint32_t txId, uint32_t rxId, uint32_t periodicId, uint8_t rate,
+		const uint8_t* pdids, uint8_t count, UdsPdid_Sink_t sink, Uds_Callback_t callback, void* context, uint32_t now){
+	UdsPdid_Job_t* job = NULL;
+	UDS_StatusTypeDef status;
+
+	if(sink == NULL || pdids == NULL || count == 0 || count > UDS_PDID_MAX_IDS) return UDS_NOT_OK;
+	if(rate < SEND_AT_SLOW_RATE || rate > SEND_AT_FAST_RATE || periodicId == rxId) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < UDS_PDID_MAX_JOBS; i++){
+		if(!jobs[i].used){
+			job = &jobs[i];
+			break;
+		}
+	}
+	if(job == NULL) return UDS_BUSY;
+
+	/* The first samples may arrive before the response is processed */
+	if(pdidFilter != NULL && !pdidFilter(periodicId, true)) return UDS_NOT_OK;
+
+	job->req[0] = SID_READ_DATA_BY_PERIODIC_ID;
+	job->req[1] = rate;
+	memcpy(&job->req[2], pdids, count);
+	job->count = count;
+	job->txId = txId;
+	job->periodicId = periodicId;
+	job->batchCount = 0;
+	job->sink = sink;
+	job->callback = callback;
+	job->context = context;
+	job->starting = true;
+	job->used = true;
+
+	status = Uds_Request(txId, rxId, job->req, 2u + count, UdsPdid_Response, job, now);
+	if(status != UDS_OK){
+		UdsPdid_Release(job);
+	}
+
+	return status;
+}
+
+/**
+ * @brief Stops every periodic DID of an ECU (stopSending without identifiers).
+ *
+ * Pending samples are passed on, the schedules are released right away.
+ *
+ * @return UDS_BUSY while a schedule of the ECU is still being started.
+ */
+UDS_StatusTypeDef UdsPdid_Stop(uint32_t txId, uint32_t rxId, uint32_t now){
+	static const uint8_t stop[] = { SID_READ_DATA_BY_PERIODIC_ID, STOP_SENDING };
+	bool found = false;
+	UDS_StatusTypeDef status;
+
+	for(uint8_t i = 0; i < UDS_PDID_MAX_JOBS; i++){
+		if(!jobs[i].used || jobs[i].txId != txId) continue;
+		if(jobs[i].starting) return UDS_BUSY;
+		found = true;
+	}
+	if(!found) return UDS_NOT_OK;
+
+	status = Uds_Request(txId, rxId, stop, sizeof(stop), NULL, NULL, now);
+	if(status != UDS_OK) return status;
+
+	for(uint8_t i = 0; i < UDS_PDID_MAX_JOBS; i++){
+		if(!jobs[i].used || jobs[i].txId != txId) continue;
+
+		UdsPdid_Flush(&jobs[i]);
+		UdsPdid_Release(&jobs[i]);
+	}
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Takes a received frame if it is on a periodic response ID in use.
+ *
+ * @return true if the frame was a periodic one and must not go to ISO-TP.
+ */
+bool UdsPdid_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now){
+	bool taken = false;
+
+	for(uint8_t i = 0; i < UDS_PDID_MAX_JOBS; i++){
+		UdsPdid_Job_t* const job = &jobs[i];
+		UdsPdid_Sample_t* sample;
+
+		if(!job->used || job->periodicId != id) continue;
+		taken = true;
+
+		if(dlc == 0 || !UdsPdid_IsScheduled(job, data[0])) continue;
+
+		if(job->batchCount == 0){
+			job->batchTime = now;
+		}
+		sample = &job->batch[job->batchCount++];
+		sample->time = now;
+		sample->pdid = data[0];
+		sample->length = (uint8_t)(dlc - 1);
+		if(sample->length > UDS_PDID_DATA_MAX) sample->length = UDS_PDID_DATA_MAX;
+		memcpy(sample->data, &data[1], sample->length);
+
+		if(job->batchCount == UDS_PDID_BATCH){
+			UdsPdid_Flush(job);
+		}
+		break;
+	}
+
+	return taken;
+}
+
+/**
+ * @brief Passes on batches older than UDS_PDID_FLUSH ms.
+ */
+void UdsPdid_MainFunction(uint32_t now){
+	for(uint8_t i = 0; i < UDS_PDID_MAX_JOBS; i++){
+		UdsPdid_Job_t* const job = &jobs[i];
+
+		if(job->used && job->batchCount != 0 && (int32_t)(now - job->batchTime) >= (int32_t)UDS_PDID_FLUSH){
+			UdsPdid_Flush(job);
+		}
+	}
+}
+
+uint32_t UdsPdid_GetLost(void){
+	return pdidLost;
+}
+
+
+/* Private functions */
+
+static void UdsPdid_Response(const Uds_Response_t* rsp, void* context){
+	UdsPdid_Job_t* const job = (UdsPdid_Job_t*)context;
+	const Uds_Callback_t callback = job->callback;
+	void* const callbackContext = job->context;
+
+	job->starting = false;
+	if(rsp->result != UDS_RESULT_POSITIVE){
+		UdsPdid_Release(job);
+	}
+
+	if(callback != NULL){
+		callback(rsp, callbackContext);
+	}
+}
+
+static bool UdsPdid_IsScheduled(const UdsPdid_Job_t* job, uint8_t pdid){
+	for(uint8_t i = 0; i < job->count; i++){
+		if(job->req[2 + i] == pdid) return true;
+	}
+
+	return false;
+}
+
+static void UdsPdid_Flush(UdsPdid_Job_t* job){
+	if(job->batchCount == 0) return;
+
+	if(!job->sink(job->periodicId, job->batch, job->batchCount, job->context)){
+		pdidLost += job->batchCount;
+	}
+	job->batchCount = 0;
+}
+
+static void UdsPdid_Release(UdsPdid_Job_t* job){
+	job->used = false;
+	if(pdidFilter != NULL){
+		(void)pdidFilter(job->periodicId, false);
+	}
+}
@@ -0,0 +1,118 @@
+/*
+ * uds_prof.c
+ *
+ *  Created on: Aug 13, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/uds_prof.h"
+
+/* Functions prototype */
+static UdsProf_Entry_t* UdsProf_Find(uint32_t txId, uint8_t sid);
+static uint8_t UdsProf_Bucket(uint32_t ms);
+static void UdsProf_Inc(uint16_t* counter, uint16_t n);
+
+/* Variables */
+static UdsProf_Entry_t entries[UDS_PROF_ENTRIES];
+/* Transactions of pairs that found no free entry */
+static uint16_t dropped;
+
+
+void UdsProf_Reset(void){
+	for(uint8_t i = 0; i < UDS_PROF_ENTRIES; i++){
+		entries[i].used = false;
+	}
+	dropped = 0;
+}
+
+/**
+ * @brief Adds one transaction, called by the client on completion.
+ *
+ * @param responded  false for a request that timed out or whose response
+ *                   failed; first / complete are then ignored.
+ * @param first      ms to the first response frame.
+ * @param complete   ms to the end of the final response.
+ */
+void UdsProf_Record(uint32_t txId, uint8_t sid, bool responded, uint32_t first, uint32_t complete, uint8_t pending){
+	UdsProf_Entry_t* const entry = UdsProf_Find(txId, sid);
+
+	if(entry == NULL){
+		UdsProf_Inc(&dropped, 1);
+		return;
+	}
+
+	UdsProf_Inc(&entry->pending, pending);
+	if(pending > entry->pendingMax) entry->pendingMax = pending;
+
+	if(!responded){
+		UdsProf_Inc(&entry->failures, 1);
+		return;
+	}
+
+	UdsProf_Inc(&entry->count, 1);
+	UdsProf_Inc(&entry->first[UdsProf_Bucket(first)], 1);
+	UdsProf_Inc(&entry->complete[UdsProf_Bucket(complete)], 1);
+	if(complete > entry->maxComplete){
+		entry->maxComplete = (complete > UINT16_MAX) ? UINT16_MAX : (uint16_t)complete;
+	}
+}
+
+/**
+ * @brief The UDS_PROF_ENTRIES entries, unused ones have used == false.
+ */
+const UdsProf_Entry_t* UdsProf_GetEntries(uint16_t* droppedCount){
+	if(droppedCount != NULL){
+		*droppedCount = dropped;
+	}
+
+	return entries;
+}
+
+
+/* Private functions */
+
+/* Entry of the pair, taken from the free ones if it has none yet */
+static UdsProf_Entry_t* UdsProf_Find(uint32_t txId, uint8_t sid){
+	UdsProf_Entry_t* free = NULL;
+
+	for(uint8_t i = 0; i < UDS_PROF_ENTRIES; i++){
+		if(!entries[i].used){
+			if(free == NULL) free = &entries[i];
+		}
+		else if(entries[i].txId == txId && entries[i].sid == sid){
+			return &entries[i];
+		}
+	}
+	if(free == NULL) return NULL;
+
+	free->used = true;
+	free->txId = txId;
+	free->sid = sid;
+	free->count = 0;
+	free->failures = 0;
+	free->pending = 0;
+	free->pendingMax = 0;
+	free->maxComplete = 0;
+	for(uint8_t i = 0; i < UDS_PROF_BUCKETS; i++){
+		free->first[i] = 0;
+		free->complete[i] = 0;
+	}
+
+	return free;
+}
+
+static uint8_t UdsProf_Bucket(uint32_t ms){
+	uint8_t bucket = 0;
+
+	while(ms != 0 && bucket < UDS_PROF_BUCKETS - 1){
+		ms >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+static void UdsProf_Inc(uint16_t* counter, uint16_t n){
+	*counter = (*counter > UINT16_MAX - n) ? UINT16_MAX : (uint16_t)(*counter + n);
+}
@@ -0,0 +1,345 @@
+/*
+ * uds_rdbi.c
+ *
+ *  Created on: Aug 5, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/uds_rdbi.h"
+#include "../Inc/uds_dispatch.h"
+#include "../Inc/uds_didcache.h"
+
+/* Structures */
+typedef struct{
+	bool used;
+	uint32_t txId;
+	uint32_t rxId;
+	uint16_t dids[UDS_RDBI_MAX_DIDS];
+	bool done[UDS_RDBI_MAX_DIDS];
+	uint8_t count;
+	/* DIDs of the request in flight, as indexes into dids */
+	uint8_t batch[UDS_RDBI_MAX_PER_REQUEST];
+	uint8_t batchCount;
+	/* Batch built but not sent yet, all request slots of the client were in use */
+	bool pending;
+	/* Limit for this job only, lowered by NRC 0x31 on a multi-DID request */
+	uint8_t jobLimit;
+	uint8_t requests;
+	uint8_t req[1 + 2 * UDS_RDBI_MAX_PER_REQUEST];
+	UdsRdbi_DidCallback_t didCallback;
+	UdsRdbi_DoneCallback_t doneCallback;
+	void* context;
+}UdsRdbi_Job_t;
+
+typedef struct{
+	uint32_t txId;
+	uint8_t maxDids;
+}UdsRdbi_EcuLimit_t;
+
+typedef struct{
+	uint32_t txId;
+	uint16_t did;
+	uint16_t length;
+}UdsRdbi_Length_t;
+
+/* Functions prototype */
+static void UdsRdbi_Next(UdsRdbi_Job_t* job, uint32_t now);
+static void UdsRdbi_Send(UdsRdbi_Job_t* job, uint32_t now);
+static void UdsRdbi_Response(const Uds_Response_t* rsp, void* context);
+static void UdsRdbi_Parse(UdsRdbi_Job_t* job, const uint8_t* data, uint32_t length);
+static void UdsRdbi_DidDone(UdsRdbi_Job_t* job, uint8_t index, Uds_ResultTypeDef result, uint8_t nrc, const uint8_t* data, uint32_t length);
+static bool UdsRdbi_GetLength(uint32_t txId, uint16_t did, uint16_t* length);
+static void UdsRdbi_LearnLength(uint32_t txId, uint16_t did, uint16_t length);
+static void UdsRdbi_SetLimit(uint32_t txId, uint8_t maxDids);
+
+/* Variables */
+static UdsRdbi_Job_t jobs[UDS_RDBI_MAX_JOBS];
+static UdsRdbi_EcuLimit_t limits[UDS_CLIENT_MAX_ECUS];
+static UdsRdbi_Length_t lengths[UDS_RDBI_LEARNED_LENGTHS];
+/* Next learned length entry to replace */
+static uint8_t lengthNext;
+
+
+void UdsRdbi_Init(void){
+	for(uint8_t i = 0; i < UDS_RDBI_MAX_JOBS; i++){
+		jobs[i].used = false;
+	}
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		limits[i].txId = 0;
+	}
+	for(uint8_t i = 0; i < UDS_RDBI_LEARNED_LENGTHS; i++){
+		lengths[i].txId = 0;
+	}
+	lengthNext = 0;
+}
+
+/**
+ * @brief Reads a list of DIDs from one ECU with as few requests as possible.
+ *
+ * didCallback is called once per DID, doneCallback once at the end. The
+ * DID list is copied. With useCache, DIDs found in the DID cache are
+ * reported before this function returns and are not requested. Values
+ * read are always stored in the cache.
+ *
+ * @return UDS_BUSY if all jobs are in use.
+ */
+UDS_StatusTypeDef UdsRdbi_Read(uint32_t txId, uint32_t rxId, const uint16_t* dids, uint8_t count,
+		bool useCache, UdsRdbi_DidCallback_t didCallback, UdsRdbi_DoneCallback_t doneCallback, void* context, uint32_t now){
+	UdsRdbi_Job_t* job = NULL;
+
+	if(dids == NULL || count == 0 || count > UDS_RDBI_MAX_DIDS) return UDS_NOT_OK;
+
+	for(uint8_t i = 0; i < UDS_RDBI_MAX_JOBS; i++){
+		if(!jobs[i].used){
+			job = &jobs[i];
+			break;
+		}
+	}
+	if(job == NULL) return UDS_BUSY;
+
+	job->used = true;
+	job->txId = txId;
+	job->rxId = rxId;
+	for(uint8_t i = 0; i < count; i++){
+		job->dids[i] = dids[i];
+		job->done[i] = false;
+	}
+	job->count = count;
+	job->jobLimit = UDS_RDBI_MAX_PER_REQUEST;
+	job->requests = 0;
+	job->pending = false;
+	job->didCallback = didCallback;
+	job->doneCallback = doneCallback;
+	job->context = context;
+
+	/* Cached values are answered right away */
+	if(useCache){
+		for(uint8_t i = 0; i < count; i++){
+			const uint8_t* data;
+			uint16_t length;
+
+			if(UdsDidCache_Lookup(txId, dids[i], now, &data, &length)){
+				UdsRdbi_DidDone(job, i, UDS_RESULT_POSITIVE, 0, data, length);
+			}
+		}
+	}
+
+	UdsRdbi_Next(job, now);
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Sends the batches held back while the UDS client was busy.
+ */
+void UdsRdbi_MainFunction(uint32_t now){
+	for(uint8_t i = 0; i < UDS_RDBI_MAX_JOBS; i++){
+		if(jobs[i].used && jobs[i].pending){
+			UdsRdbi_Send(&jobs[i], now);
+		}
+	}
+}
+
+/**
+ * @brief DIDs per request currently used for an ECU.
+ */
+uint8_t UdsRdbi_GetLimit(uint32_t txId){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		if(limits[i].txId == txId) return limits[i].maxDids;
+	}
+
+	return UDS_RDBI_MAX_PER_REQUEST;
+}
+
+
+/* Private functions */
+
+/* Sends the next batch, or finishes the job */
+static void UdsRdbi_Next(UdsRdbi_Job_t* job, uint32_t now){
+	uint8_t limit = UdsRdbi_GetLimit(job->txId);
+	uint8_t unknown = UDS_RDBI_MAX_DIDS;
+	uint16_t length;
+
+	if(job->jobLimit < limit) limit = job->jobLimit;
+
+	/* DIDs of known length first, then at most one of unknown length last */
+	job->batchCount = 0;
+	for(uint8_t i = 0; i < job->count && job->batchCount < limit; i++){
+		if(job->done[i]) continue;
+
+		if(UdsRdbi_GetLength(job->txId, job->dids[i], &length)){
+			job->batch[job->batchCount++] = i;
+		}
+		else if(unknown == UDS_RDBI_MAX_DIDS){
+			unknown = i;
+		}
+	}
+	if(unknown != UDS_RDBI_MAX_DIDS && job->batchCount < limit){
+		job->batch[job->batchCount++] = unknown;
+	}
+
+	if(job->batchCount == 0){
+		job->used = false;
+		if(job->doneCallback != NULL){
+			job->doneCallback(job->txId, job->requests, job->context);
+		}
+		return;
+	}
+
+	job->req[0] = SID_READ_DATA_BY_ID;
+	for(uint8_t i = 0; i < job->batchCount; i++){
+		job->req[1 + 2 * i] = (uint8_t)(job->dids[job->batch[i]] >> 8);
+		job->req[2 + 2 * i] = (uint8_t)job->dids[job->batch[i]];
+	}
+
+	UdsRdbi_Send(job, now);
+}
+
+/*
+ * Sends the batch built by UdsRdbi_Next(). While the client is busy the
+ * batch is kept for UdsRdbi_MainFunction(); a request that cannot be sent
+ * at all fails the DIDs of this batch only, the others are tried next.
+ */
+static void UdsRdbi_Send(UdsRdbi_Job_t* job, uint32_t now){
+	switch(Uds_Request(job->txId, job->rxId, job->req, 1u + 2u * job->batchCount, UdsRdbi_Response, job, now)){
+	case UDS_OK:
+		job->pending = false;
+		job->requests++;
+		break;
+	case UDS_BUSY:
+		job->pending = true;
+		break;
+	default:
+		job->pending = false;
+		for(uint8_t i = 0; i < job->batchCount; i++){
+			UdsRdbi_DidDone(job, job->batch[i], UDS_RESULT_TX_ERROR, 0, NULL, 0);
+		}
+		UdsRdbi_Next(job, now);
+		break;
+	}
+}
+
+static void UdsRdbi_Response(const Uds_Response_t* rsp, void* context){
+	UdsRdbi_Job_t* const job = (UdsRdbi_Job_t*)context;
+	const uint8_t n = job->batchCount;
+
+	switch(rsp->result){
+	case UDS_RESULT_POSITIVE:
+		UdsRdbi_Parse(job, rsp->data, rsp->length);
+		break;
+	case UDS_RESULT_NEGATIVE:
+		if(n > 1 && (rsp->nrc == NRC_INCORRECT_MESSAGE_LENGTH || rsp->nrc == NRC_RESPONSE_TOO_LONG)){
+			/* Too many DIDs for this ECU: remember, the same DIDs go again */
+			UdsRdbi_SetLimit(job->txId, (uint8_t)(n / 2));
+		}
+		else if(n > 1 && rsp->nrc == NRC_REQUEST_OUT_OF_RANGE){
+			/* Some ECUs reject the whole request for one unsupported DID */
+			job->jobLimit = (uint8_t)(n / 2);
+		}
+		else{
+			for(uint8_t i = 0; i < n; i++){
+				UdsRdbi_DidDone(job, job->batch[i], UDS_RESULT_NEGATIVE, rsp->nrc, NULL, 0);
+			}
+		}
+		break;
+	default:
+		for(uint8_t i = 0; i < n; i++){
+			UdsRdbi_DidDone(job, job->batch[i], rsp->result, 0, NULL, 0);
+		}
+		break;
+	}
+
+	UdsRdbi_Next(job, Uds_GetTime());
+}
+
+/*
+ * Splits 62 [DID data]... along the DIDs of the batch, in request order.
+ * DIDs the ECU left out are reported as out of range.
+ */
+static void UdsRdbi_Parse(UdsRdbi_Job_t* job, const uint8_t* data, uint32_t length){
+	uint32_t pos = 1;
+	uint8_t next = 0;
+
+	while(pos + 2 <= length && next < job->batchCount){
+		const uint16_t did = (uint16_t)((data[pos] << 8) | data[pos + 1]);
+		uint8_t match = next;
+		uint16_t len;
+
+		while(match < job->batchCount && job->dids[job->batch[match]] != did) match++;
+		if(match == job->batchCount) break;
+
+		if(!UdsRdbi_GetLength(job->txId, did, &len)){
+			/* Only the last DID may be of unknown length: it takes the rest */
+			len = (uint16_t)(length - pos - 2);
+			UdsRdbi_LearnLength(job->txId, did, len);
+		}
+		if(pos + 2 + len > length) break;
+
+		for(; next < match; next++){
+			UdsRdbi_DidDone(job, job->batch[next], UDS_RESULT_NEGATIVE, NRC_REQUEST_OUT_OF_RANGE, NULL, 0);
+		}
+		UdsDidCache_Store(job->txId, did, &data[pos + 2], len, Uds_GetTime());
+		UdsRdbi_DidDone(job, job->batch[match], UDS_RESULT_POSITIVE, 0, &data[pos + 2], len);
+		next = match + 1;
+		pos += 2u + len;
+	}
+
+	/* Left out, or the response could not be split any further */
+	for(; next < job->batchCount; next++){
+		UdsRdbi_DidDone(job, job->batch[next], (pos >= length) ? UDS_RESULT_NEGATIVE : UDS_RESULT_INVALID_RSP,
+				(pos >= length) ? NRC_REQUEST_OUT_OF_RANGE : 0, NULL, 0);
+	}
+}
+
+static void UdsRdbi_DidDone(UdsRdbi_Job_t* job, uint8_t index, Uds_ResultTypeDef result, uint8_t nrc, const uint8_t* data, uint32_t length){
+	if(job->done[index]) return;
+
+	job->done[index] = true;
+	if(job->didCallback != NULL){
+		job->didCallback(job->txId, job->dids[index], result, nrc, data, length, job->context);
+	}
+}
+
+/* Length from UDS_DID_TABLE, or learned from an earlier read */
+static bool UdsRdbi_GetLength(uint32_t txId, uint16_t did, uint16_t* length){
+	const Uds_DidInfo_t* const info = Uds_FindDid(did);
+
+	if(info != NULL && info->length != 0){
+		*length = info->length;
+		return true;
+	}
+	for(uint8_t i = 0; i < UDS_RDBI_LEARNED_LENGTHS; i++){
+		if(lengths[i].txId == txId && lengths[i].did == did){
+			*length = lengths[i].length;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void UdsRdbi_LearnLength(uint32_t txId, uint16_t did, uint16_t length){
+	lengths[lengthNext].txId = txId;
+	lengths[lengthNext].did = did;
+	lengths[lengthNext].length = length;
+	lengthNext = (uint8_t)((lengthNext + 1) % UDS_RDBI_LEARNED_LENGTHS);
+}
+
+static void UdsRdbi_SetLimit(uint32_t txId, uint8_t maxDids){
+	UdsRdbi_EcuLimit_t* free = NULL;
+
+	if(maxDids == 0) maxDids = 1;
+
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		if(limits[i].txId == txId){
+			limits[i].maxDids = maxDids;
+			return;
+		}
+		if(limits[i].txId == 0 && free == NULL) free = &limits[i];
+	}
+	if(free != NULL){
+		free->txId = txId;
+		free->maxDids = maxDids;
+	}
+}
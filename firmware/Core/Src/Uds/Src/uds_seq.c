@@ -0,0 +1,410 @@
+/*
+ * uds_seq.c
+ *
+ *  Created on: Aug 15, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_seq.h"
+
+/* Defines */
+#define UDS_SEQ_OP_LAST UDS_SEQ_OP_EMIT
+
+/* Structures */
+typedef struct{
+	bool loaded;
+	bool running;
+	uint8_t code[UDS_SEQ_CODE_MAX];
+	uint16_t length;
+	uint16_t pc;
+	int32_t regs[UDS_SEQ_REGS];
+	/* Last CMP: -1, 0 or 1 */
+	int8_t cmp;
+	uint32_t txId;
+	uint32_t rxId;
+	/* Request sent, its response not in yet; also kept over UdsSeq_Stop() */
+	bool outstanding;
+	/* Response in, not taken by WAIT yet */
+	bool rspReady;
+	Uds_ResultTypeDef rspResult;
+	uint8_t rsp[UDS_SEQ_RSP_MAX];
+	uint16_t rspLength;
+	uint8_t out[UDS_SEQ_OUT_MAX];
+	uint16_t outLength;
+	bool delaying;
+	uint32_t delayEnd;
+	uint32_t startTime;
+	UdsSeq_Report_t report;
+	UdsSeq_Sink_t sink;
+	UdsSeq_DoneCallback_t callback;
+	void* context;
+}UdsSeq_t;
+
+/* Functions prototype */
+static bool UdsSeq_Step(uint32_t now);
+static uint16_t UdsSeq_InstrLength(const uint8_t* code, uint16_t pc, uint16_t length);
+static bool UdsSeq_HasReg(uint8_t op);
+static bool UdsSeq_HasTarget(uint8_t op);
+static void UdsSeq_Response(const Uds_Response_t* rsp, void* context);
+static void UdsSeq_Finish(UdsSeq_ResultTypeDef result, UdsSeq_FaultTypeDef fault, uint32_t now);
+static uint16_t UdsSeq_GetU16(const uint8_t* p);
+static uint32_t UdsSeq_GetU32(const uint8_t* p);
+
+/* Variables */
+static UdsSeq_t seq;
+/* Instruction length by opcode, 0 for SEND (variable) */
+static const uint8_t seqInstrLength[UDS_SEQ_OP_LAST + 1] = {
+	1, 9, 0, 2, 2, 5, 6, 6, 6, 4, 4, 3, 5, 2, 2
+};
+
+
+void UdsSeq_Init(void){
+	seq.loaded = false;
+	seq.running = false;
+	seq.outstanding = false;
+}
+
+/**
+ * @brief Checks a program and copies it in.
+ *
+ * @param errorPc  Offset of the first bad instruction on UDS_NOT_OK, may be NULL.
+ *
+ * @return UDS_BUSY while a program runs or its last request is outstanding.
+ */
+UDS_StatusTypeDef UdsSeq_Load(const uint8_t* code, uint16_t length, uint16_t* errorPc){
+	/* Start of each instruction, for the branch targets */
+	uint8_t starts[UDS_SEQ_CODE_MAX / 8];
+	uint16_t pc = 0;
+
+	if(seq.running || seq.outstanding) return UDS_BUSY;
+	if(code == NULL || length == 0 || length > UDS_SEQ_CODE_MAX) return UDS_NOT_OK;
+
+	seq.loaded = false;
+	memset(starts, 0, sizeof(starts));
+
+	while(pc < length){
+		const uint16_t len = UdsSeq_InstrLength(code, pc, length);
+		const uint8_t op = code[pc];
+
+		if(len == 0 || (UdsSeq_HasReg(op) && code[pc + 1] >= UDS_SEQ_REGS)
+				|| (op == UDS_SEQ_OP_BR && code[pc + 1] > UDS_SEQ_LE)
+				|| (op == UDS_SEQ_OP_LOAD && (code[pc + 4] == 0 || code[pc + 4] > 4))){
+			if(errorPc != NULL) *errorPc = pc;
+			return UDS_NOT_OK;
+		}
+		starts[pc / 8] |= (uint8_t)(1u << (pc % 8));
+		pc = (uint16_t)(pc + len);
+	}
+
+	for(pc = 0; pc < length; pc = (uint16_t)(pc + UdsSeq_InstrLength(code, pc, length))){
+		uint16_t target;
+
+		if(!UdsSeq_HasTarget(code[pc])) continue;
+
+		target = UdsSeq_GetU16(&code[pc + 2]);
+		if(target >= length || (starts[target / 8] & (1u << (target % 8))) == 0){
+			if(errorPc != NULL) *errorPc = pc;
+			return UDS_NOT_OK;
+		}
+	}
+
+	memcpy(seq.code, code, length);
+	seq.length = length;
+	seq.loaded = true;
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Runs the loaded program from the start with cleared registers.
+ *
+ * @param sink      Receives the output of EMIT, may be NULL if the program has none.
+ * @param callback  Called once when the program ends, may be NULL.
+ */
+UDS_StatusTypeDef UdsSeq_Start(UdsSeq_Sink_t sink, UdsSeq_DoneCallback_t callback, void* context, uint32_t now){
+	if(!seq.loaded) return UDS_NOT_OK;
+	if(seq.running || seq.outstanding) return UDS_BUSY;
+
+	seq.pc = 0;
+	memset(seq.regs, 0, sizeof(seq.regs));
+	seq.cmp = 0;
+	seq.txId = 0;
+	seq.rxId = 0;
+	seq.rspReady = false;
+	seq.rspLength = 0;
+	seq.outLength = 0;
+	seq.delaying = false;
+	seq.startTime = now;
+	memset(&seq.report, 0, sizeof(seq.report));
+	seq.sink = sink;
+	seq.callback = callback;
+	seq.context = context;
+	seq.running = true;
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Stops the program; a request already sent still completes.
+ */
+void UdsSeq_Stop(void){
+	if(!seq.running) return;
+
+	UdsSeq_Finish(UDS_SEQ_STOPPED, UDS_SEQ_FAULT_NONE, Uds_GetTime());
+}
+
+bool UdsSeq_IsRunning(void){
+	return seq.running;
+}
+
+/**
+ * @brief Runs the program until it blocks, ends or used up its steps.
+ */
+void UdsSeq_MainFunction(uint32_t now){
+	for(uint8_t i = 0; i < UDS_SEQ_STEPS_PER_PASS && seq.running; i++){
+		if(!UdsSeq_Step(now)) break;
+	}
+}
+
+
+/* Private functions */
+
+/**
+ * @brief Executes one instruction.
+ *
+ * @return false if the program blocks (response, delay, sink, client busy) or ended.
+ */
+static bool UdsSeq_Step(uint32_t now){
+	const uint8_t* const ins = &seq.code[seq.pc];
+	uint16_t next;
+	uint16_t offset;
+	uint16_t len;
+	bool jump;
+
+	if(seq.pc >= seq.length){
+		UdsSeq_Finish(UDS_SEQ_DONE, UDS_SEQ_FAULT_NONE, now);
+		return false;
+	}
+
+	next = (uint16_t)(seq.pc + UdsSeq_InstrLength(seq.code, seq.pc, seq.length));
+
+	switch(ins[0]){
+	case UDS_SEQ_OP_END:
+		UdsSeq_Finish(UDS_SEQ_DONE, UDS_SEQ_FAULT_NONE, now);
+		return false;
+
+	case UDS_SEQ_OP_TARGET:
+		seq.txId = UdsSeq_GetU32(&ins[1]);
+		seq.rxId = UdsSeq_GetU32(&ins[5]);
+		break;
+
+	case UDS_SEQ_OP_SEND:
+		if(seq.outstanding || seq.rspReady){
+			UdsSeq_Finish(UDS_SEQ_FAULT, UDS_SEQ_FAULT_STATE, now);
+			return false;
+		}
+		/* The program stays loaded until the response is in, longer requests may point into it */
+		seq.outstanding = true;
+		switch(Uds_Request(seq.txId, seq.rxId, &ins[2], ins[1], UdsSeq_Response, NULL, now)){
+		case UDS_OK:
+			break;
+		case UDS_BUSY:
+			seq.outstanding = false;
+			return false;
+		default:
+			seq.outstanding = false;
+			UdsSeq_Finish(UDS_SEQ_FAULT, UDS_SEQ_FAULT_REQUEST, now);
+			return false;
+		}
+		seq.report.requests++;
+		break;
+
+	case UDS_SEQ_OP_WAIT:
+		if(!seq.outstanding && !seq.rspReady){
+			UdsSeq_Finish(UDS_SEQ_FAULT, UDS_SEQ_FAULT_STATE, now);
+			return false;
+		}
+		if(!seq.rspReady) return false;
+		seq.rspReady = false;
+		seq.regs[ins[1]] = (int32_t)seq.rspResult;
+		break;
+
+	case UDS_SEQ_OP_LEN:
+		seq.regs[ins[1]] = seq.rspLength;
+		break;
+
+	case UDS_SEQ_OP_LOAD:
+		offset = UdsSeq_GetU16(&ins[2]);
+		if((uint32_t)offset + ins[4] > seq.rspLength){
+			UdsSeq_Finish(UDS_SEQ_FAULT, UDS_SEQ_FAULT_RANGE, now);
+			return false;
+		}
+		seq.regs[ins[1]] = 0;
+		for(uint8_t i = 0; i < ins[4]; i++){
+			seq.regs[ins[1]] = (int32_t)(((uint32_t)seq.regs[ins[1]] << 8) | seq.rsp[offset + i]);
+		}
+		break;
+
+	case UDS_SEQ_OP_SET:
+		seq.regs[ins[1]] = (int32_t)UdsSeq_GetU32(&ins[2]);
+		break;
+
+	case UDS_SEQ_OP_ADD:
+		seq.regs[ins[1]] = (int32_t)((uint32_t)seq.regs[ins[1]] + UdsSeq_GetU32(&ins[2]));
+		break;
+
+	case UDS_SEQ_OP_CMP:{
+		const int32_t imm = (int32_t)UdsSeq_GetU32(&ins[2]);
+
+		seq.cmp = (int8_t)((seq.regs[ins[1]] > imm) - (seq.regs[ins[1]] < imm));
+		break;
+	}
+
+	case UDS_SEQ_OP_BR:
+		switch(ins[1]){
+		case UDS_SEQ_EQ: jump = seq.cmp == 0; break;
+		case UDS_SEQ_NE: jump = seq.cmp != 0; break;
+		case UDS_SEQ_LT: jump = seq.cmp < 0;  break;
+		case UDS_SEQ_GE: jump = seq.cmp >= 0; break;
+		case UDS_SEQ_GT: jump = seq.cmp > 0;  break;
+		case UDS_SEQ_LE: jump = seq.cmp <= 0; break;
+		default:         jump = true;         break;
+		}
+		if(jump){
+			next = UdsSeq_GetU16(&ins[2]);
+		}
+		break;
+
+	case UDS_SEQ_OP_LOOP:
+		seq.regs[ins[1]] = (int32_t)((uint32_t)seq.regs[ins[1]] - 1u);
+		if(seq.regs[ins[1]] != 0){
+			next = UdsSeq_GetU16(&ins[2]);
+		}
+		break;
+
+	case UDS_SEQ_OP_DELAY:
+		if(!seq.delaying){
+			seq.delaying = true;
+			seq.delayEnd = now + UdsSeq_GetU16(&ins[1]);
+		}
+		if((int32_t)(now - seq.delayEnd) < 0) return false;
+		seq.delaying = false;
+		break;
+
+	case UDS_SEQ_OP_STORE:
+		offset = UdsSeq_GetU16(&ins[1]);
+		len = UdsSeq_GetU16(&ins[3]);
+		if((uint32_t)offset + len > seq.rspLength){
+			UdsSeq_Finish(UDS_SEQ_FAULT, UDS_SEQ_FAULT_RANGE, now);
+			return false;
+		}
+		if((uint32_t)seq.outLength + len > UDS_SEQ_OUT_MAX){
+			UdsSeq_Finish(UDS_SEQ_FAULT, UDS_SEQ_FAULT_OUTPUT, now);
+			return false;
+		}
+		memcpy(&seq.out[seq.outLength], &seq.rsp[offset], len);
+		seq.outLength = (uint16_t)(seq.outLength + len);
+		break;
+
+	case UDS_SEQ_OP_STOREREG:
+		if(seq.outLength + 4u > UDS_SEQ_OUT_MAX){
+			UdsSeq_Finish(UDS_SEQ_FAULT, UDS_SEQ_FAULT_OUTPUT, now);
+			return false;
+		}
+		for(uint8_t i = 0; i < 4; i++){
+			seq.out[seq.outLength++] = (uint8_t)((uint32_t)seq.regs[ins[1]] >> (8 * i));
+		}
+		break;
+
+	case UDS_SEQ_OP_EMIT:
+		if(seq.sink != NULL && !seq.sink(ins[1], seq.out, seq.outLength, seq.context)) return false;
+		seq.outLength = 0;
+		break;
+
+	default:
+		/* Not reached, UdsSeq_Load() checked the opcodes */
+		break;
+	}
+
+	seq.pc = next;
+	seq.report.steps++;
+
+	return true;
+}
+
+/**
+ * @return Length of the instruction at pc, 0 if it is unknown or does not fit.
+ */
+static uint16_t UdsSeq_InstrLength(const uint8_t* code, uint16_t pc, uint16_t length){
+	const uint8_t op = code[pc];
+	uint16_t len;
+
+	if(op > UDS_SEQ_OP_LAST) return 0;
+
+	if(op == UDS_SEQ_OP_SEND){
+		if(pc + 1u >= length || code[pc + 1] == 0) return 0;
+		len = (uint16_t)(2u + code[pc + 1]);
+	}
+	else{
+		len = seqInstrLength[op];
+	}
+
+	return ((uint32_t)pc + len <= length) ? len : 0;
+}
+
+static bool UdsSeq_HasReg(uint8_t op){
+	switch(op){
+	case UDS_SEQ_OP_WAIT:
+	case UDS_SEQ_OP_LEN:
+	case UDS_SEQ_OP_LOAD:
+	case UDS_SEQ_OP_SET:
+	case UDS_SEQ_OP_ADD:
+	case UDS_SEQ_OP_CMP:
+	case UDS_SEQ_OP_LOOP:
+	case UDS_SEQ_OP_STOREREG:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool UdsSeq_HasTarget(uint8_t op){
+	return op == UDS_SEQ_OP_BR || op == UDS_SEQ_OP_LOOP;
+}
+
+static void UdsSeq_Response(const Uds_Response_t* rsp, void* context){
+	(void)context;
+
+	seq.outstanding = false;
+	if(!seq.running) return;
+
+	seq.rspResult = rsp->result;
+	seq.rspLength = 0;
+	if(rsp->data != NULL){
+		seq.rspLength = (uint16_t)((rsp->length > UDS_SEQ_RSP_MAX) ? UDS_SEQ_RSP_MAX : rsp->length);
+		memcpy(seq.rsp, rsp->data, seq.rspLength);
+	}
+	seq.rspReady = true;
+}
+
+static void UdsSeq_Finish(UdsSeq_ResultTypeDef result, UdsSeq_FaultTypeDef fault, uint32_t now){
+	seq.running = false;
+	seq.report.result = result;
+	seq.report.fault = fault;
+	seq.report.pc = seq.pc;
+	seq.report.duration = now - seq.startTime;
+
+	if(seq.callback != NULL){
+		seq.callback(&seq.report, seq.context);
+	}
+}
+
+static uint16_t UdsSeq_GetU16(const uint8_t* p){
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t UdsSeq_GetU32(const uint8_t* p){
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
@@ -0,0 +1,474 @@
+/*
+ * uds_server.c
+ *
+ *  Created on: Aug 14, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_server.h"
+
+/* Enums */
+typedef enum{
+	UDS_SERVER_IDLE,
+	/* Response built, held back for the artificial delay */
+	UDS_SERVER_DELAY,
+	/* Response handed to ISO-TP */
+	UDS_SERVER_SENDING
+}UdsServer_StateTypeDef;
+
+/* Structures */
+typedef struct{
+	bool running;
+	UdsServer_Config_t config;
+	CanTp_Link_t link;
+	UdsServer_StateTypeDef state;
+	uint8_t session;
+	/* Last request, for S3 */
+	uint32_t lastRequest;
+	/* Delayed response: when it is due and when the next NRC 0x78 is */
+	uint32_t due;
+	bool pendingSent;
+	uint32_t pendingDue;
+	uint8_t req[UDS_SERVER_REQUEST_MAX];
+	uint8_t rsp[UDS_SERVER_RESPONSE_MAX];
+	uint32_t rspLength;
+	uint8_t pending[3];
+}UdsServer_t;
+
+/* Functions prototype */
+static void UdsServer_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length);
+static void UdsServer_TxConfirmation(CanTp_Link_t* link, CanTp_ResultTypeDef result);
+static void UdsServer_Process(const uint8_t* req, uint32_t length, bool functional, uint32_t now);
+static uint8_t UdsServer_SessionControl(const uint8_t* req, uint32_t length);
+static uint8_t UdsServer_EcuReset(const uint8_t* req, uint32_t length);
+static uint8_t UdsServer_TesterPresent(const uint8_t* req, uint32_t length);
+static uint8_t UdsServer_ReadDataById(const uint8_t* req, uint32_t length);
+static uint8_t UdsServer_ReadDtcInfo(const uint8_t* req, uint32_t length);
+static const UdsServer_Did_t* UdsServer_FindDid(uint16_t did);
+static uint16_t UdsServer_GetDelay(uint8_t sid);
+static void UdsServer_Send(uint32_t now);
+static void UdsServer_SendPending(uint32_t now);
+
+/* Variables */
+static UdsServer_t server;
+static CanTp_SendFrame_t serverSendFrame;
+static UdsServer_Filter_t serverFilter;
+/* Set by a handler whose positive response is suppressed */
+static bool serverSuppress;
+/* Time of the pass, for requests completed inside CanTp */
+static uint32_t serverNow;
+
+
+void UdsServer_Init(CanTp_SendFrame_t sendFrame, UdsServer_Filter_t filter){
+	serverSendFrame = sendFrame;
+	serverFilter = filter;
+	server.running = false;
+}
+
+/**
+ * @brief Starts answering requests on the IDs of the configuration.
+ *
+ * The configuration is copied, the database is referenced.
+ *
+ * @return UDS_NOT_OK for bad arguments or no filter left, UDS_BUSY if the
+ *         server is already running.
+ */
+UDS_StatusTypeDef UdsServer_Start(const UdsServer_Config_t* config, uint32_t now){
+	if(config == NULL || config->db == NULL || serverSendFrame == NULL) return UDS_NOT_OK;
+	if(config->rxId == config->txId || config->functionalId == config->rxId) return UDS_NOT_OK;
+	if(server.running) return UDS_BUSY;
+
+	if(serverFilter != NULL){
+		if(!serverFilter(config->rxId, true)) return UDS_NOT_OK;
+		if(config->functionalId != 0 && !serverFilter(config->functionalId, true)){
+			(void)serverFilter(config->rxId, false);
+			return UDS_NOT_OK;
+		}
+	}
+
+	server.config = *config;
+	(void)CanTp_Init(&server.link, config->txId, config->rxId, serverSendFrame);
+	(void)CanTp_SetRxBuffer(&server.link, server.req, sizeof(server.req));
+	server.link.RxIndication = UdsServer_RxIndication;
+	server.link.TxConfirmation = UdsServer_TxConfirmation;
+	server.state = UDS_SERVER_IDLE;
+	server.session = DEFAULT_SESSION;
+	server.lastRequest = now;
+	server.running = true;
+
+	return UDS_OK;
+}
+
+/**
+ * @brief Stops the server; a response being sent is dropped.
+ */
+void UdsServer_Stop(void){
+	if(!server.running) return;
+
+	server.running = false;
+	if(serverFilter != NULL){
+		(void)serverFilter(server.config.rxId, false);
+		if(server.config.functionalId != 0){
+			(void)serverFilter(server.config.functionalId, false);
+		}
+	}
+}
+
+bool UdsServer_IsRunning(void){
+	return server.running;
+}
+
+/**
+ * @brief Takes a received frame if it is a request to the server.
+ *
+ * @return true if the frame was for the server.
+ */
+bool UdsServer_RxFrame(uint32_t id, const uint8_t* data, uint8_t dlc, uint32_t now){
+	if(!server.running || dlc == 0) return false;
+
+	serverNow = now;
+	if(id == server.config.rxId){
+		CanTp_RxFrame(&server.link, data, dlc, now);
+		return true;
+	}
+
+	if(server.config.functionalId != 0 && id == server.config.functionalId){
+		const uint8_t sfDl = data[0] & 0x0F;
+
+		/* Functional requests are single frames */
+		if((data[0] & 0xF0) == CANTP_PCI_SF && sfDl != 0 && sfDl < dlc){
+			UdsServer_Process(&data[1], sfDl, true, now);
+		}
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Sends delayed responses and runs the ISO-TP and S3 timers.
+ */
+void UdsServer_MainFunction(uint32_t now){
+	if(!server.running) return;
+
+	serverNow = now;
+	CanTp_MainFunction(&server.link, now);
+
+	if(server.state == UDS_SERVER_DELAY){
+		if((int32_t)(now - server.due) >= 0){
+			UdsServer_Send(now);
+		}
+		else if((int32_t)(now - server.pendingDue) >= 0 && server.pendingSent){
+			UdsServer_SendPending(now);
+		}
+	}
+
+	if(server.session != DEFAULT_SESSION && (now - server.lastRequest) >= UDS_SERVER_S3){
+		server.session = DEFAULT_SESSION;
+	}
+}
+
+
+/* Private functions */
+
+static void UdsServer_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length){
+	(void)link;
+
+	if(result != CANTP_N_OK) return;
+
+	UdsServer_Process(data, length, false, serverNow);
+}
+
+static void UdsServer_TxConfirmation(CanTp_Link_t* link, CanTp_ResultTypeDef result){
+	(void)link;
+	(void)result;
+
+	/* NRC 0x78 frames leave the final response waiting */
+	if(server.state == UDS_SERVER_SENDING){
+		server.state = UDS_SERVER_IDLE;
+	}
+}
+
+/**
+ * @brief Answers one request, right away or after the delay of its SID.
+ *
+ * A request arriving while the previous one is still being answered is
+ * dropped, as a single threaded ECU would.
+ */
+static void UdsServer_Process(const uint8_t* req, uint32_t length, bool functional, uint32_t now){
+	uint8_t nrc;
+	uint16_t delay;
+
+	if(length == 0 || server.state != UDS_SERVER_IDLE) return;
+
+	server.lastRequest = now;
+	server.rspLength = 0;
+	serverSuppress = false;
+
+	switch(req[0]){
+	case SID_DIAGNOSTIC_SESSION_CONTROL:
+		nrc = UdsServer_SessionControl(req, length);
+		break;
+	case SID_ECU_RESET:
+		nrc = UdsServer_EcuReset(req, length);
+		break;
+	case SID_READ_DTC_INFO:
+		nrc = UdsServer_ReadDtcInfo(req, length);
+		break;
+	case SID_READ_DATA_BY_ID:
+		nrc = UdsServer_ReadDataById(req, length);
+		break;
+	case SID_TESTER_PRESENT:
+		nrc = UdsServer_TesterPresent(req, length);
+		break;
+	default:
+		nrc = NRC_SERVICE_NOT_SUPPORTED;
+		break;
+	}
+
+	if(nrc != 0){
+		/* Functional requests get no "not supported" answers (ISO 14229-1) */
+		if(functional && (nrc == NRC_SERVICE_NOT_SUPPORTED || nrc == NRC_SUB_FUNCTION_NOT_SUPPORTED
+				|| nrc == NRC_REQUEST_OUT_OF_RANGE)) return;
+
+		server.rsp[0] = SID_NEGATIVE_RESPONSE;
+		server.rsp[1] = req[0];
+		server.rsp[2] = nrc;
+		server.rspLength = 3;
+	}
+	else if(serverSuppress){
+		return;
+	}
+
+	server.pending[0] = SID_NEGATIVE_RESPONSE;
+	server.pending[1] = req[0];
+	server.pending[2] = NRC_RESPONSE_PENDING;
+
+	delay = UdsServer_GetDelay(req[0]);
+	if(delay == 0){
+		UdsServer_Send(now);
+		return;
+	}
+
+	server.state = UDS_SERVER_DELAY;
+	server.due = now + delay;
+	server.pendingSent = false;
+	if(delay > UDS_SERVER_P2){
+		server.pendingSent = true;
+		UdsServer_SendPending(now);
+	}
+}
+
+static uint8_t UdsServer_SessionControl(const uint8_t* req, uint32_t length){
+	uint8_t session;
+
+	if(length < 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+
+	session = req[1] & (uint8_t)~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+	if(session < DEFAULT_SESSION || session > EXTENDED_DIAGNOSTIC_SESSION) return NRC_SUB_FUNCTION_NOT_SUPPORTED;
+	if(length != 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+
+	server.session = session;
+	serverSuppress = (req[1] & SUPPRESS_POS_RSP_MSG_INDICATION_BIT) != 0;
+
+	/* sessionParameterRecord: P2 in ms, P2* in 10 ms */
+	server.rsp[0] = SID_DIAGNOSTIC_SESSION_CONTROL + POSITIVE_RESPONSE_OFFSET;
+	server.rsp[1] = session;
+	server.rsp[2] = (uint8_t)(UDS_SERVER_P2 >> 8);
+	server.rsp[3] = (uint8_t)UDS_SERVER_P2;
+	server.rsp[4] = (uint8_t)((UDS_SERVER_P2_EXT / 10) >> 8);
+	server.rsp[5] = (uint8_t)(UDS_SERVER_P2_EXT / 10);
+	server.rspLength = 6;
+
+	return 0;
+}
+
+static uint8_t UdsServer_EcuReset(const uint8_t* req, uint32_t length){
+	uint8_t type;
+
+	if(length < 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+
+	type = req[1] & (uint8_t)~SUPPRESS_POS_RSP_MSG_INDICATION_BIT;
+	if(type < HARD_RESET || type > SOFT_RESET) return NRC_SUB_FUNCTION_NOT_SUPPORTED;
+	if(length != 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+
+	/* Nothing else of the simulated ECU survives a reset */
+	server.session = DEFAULT_SESSION;
+	serverSuppress = (req[1] & SUPPRESS_POS_RSP_MSG_INDICATION_BIT) != 0;
+
+	server.rsp[0] = SID_ECU_RESET + POSITIVE_RESPONSE_OFFSET;
+	server.rsp[1] = type;
+	server.rspLength = 2;
+
+	return 0;
+}
+
+static uint8_t UdsServer_TesterPresent(const uint8_t* req, uint32_t length){
+	if(length < 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+	if((req[1] & (uint8_t)~SUPPRESS_POS_RSP_MSG_INDICATION_BIT) != ZERO_SUB_FUNCTION) return NRC_SUB_FUNCTION_NOT_SUPPORTED;
+	if(length != 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+
+	serverSuppress = (req[1] & SUPPRESS_POS_RSP_MSG_INDICATION_BIT) != 0;
+
+	server.rsp[0] = SID_TESTER_PRESENT + POSITIVE_RESPONSE_OFFSET;
+	server.rsp[1] = ZERO_SUB_FUNCTION;
+	server.rspLength = 2;
+
+	return 0;
+}
+
+/**
+ * @brief Answers every supported DID of the request; the active session
+ *        (0xF186) is served without a database entry.
+ */
+static uint8_t UdsServer_ReadDataById(const uint8_t* req, uint32_t length){
+	uint32_t len = 1;
+	bool found = false;
+
+	if(length < 3 || ((length - 1) & 1) != 0) return NRC_INCORRECT_MESSAGE_LENGTH;
+
+	server.rsp[0] = SID_READ_DATA_BY_ID + POSITIVE_RESPONSE_OFFSET;
+	for(uint32_t i = 1; i < length; i += 2){
+		const uint16_t did = (uint16_t)((req[i] << 8) | req[i + 1]);
+		const UdsServer_Did_t* entry = NULL;
+		uint32_t size;
+
+		if(did == DID_ACTIVE_DIAGNOSTIC_SESSION){
+			size = 1;
+		}
+		else{
+			entry = UdsServer_FindDid(did);
+			if(entry == NULL) continue;
+			size = entry->length;
+		}
+
+		if(len + 2 + size > UDS_SERVER_RESPONSE_MAX) return NRC_RESPONSE_TOO_LONG;
+
+		server.rsp[len++] = req[i];
+		server.rsp[len++] = req[i + 1];
+		if(entry != NULL){
+			memcpy(&server.rsp[len], &server.config.db->data[entry->offset], size);
+		}
+		else{
+			server.rsp[len] = server.session;
+		}
+		len += size;
+		found = true;
+	}
+
+	if(!found) return NRC_REQUEST_OUT_OF_RANGE;
+
+	server.rspLength = len;
+
+	return 0;
+}
+
+static uint8_t UdsServer_ReadDtcInfo(const uint8_t* req, uint32_t length){
+	const UdsServer_Db_t* const db = server.config.db;
+	uint8_t mask;
+	uint32_t len = 3;
+	uint16_t count = 0;
+
+	if(length < 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+
+	switch(req[1]){
+	case REPORT_NUMBER_OF_DTC_BY_STATUS_MASK:
+	case REPORT_DTC_BY_STATUS_MASK:
+		if(length != 3) return NRC_INCORRECT_MESSAGE_LENGTH;
+		mask = req[2] & db->dtcAvailabilityMask;
+		break;
+	case REPORT_SUPPORTED_DTC:
+		if(length != 2) return NRC_INCORRECT_MESSAGE_LENGTH;
+		mask = 0;
+		break;
+	default:
+		return NRC_SUB_FUNCTION_NOT_SUPPORTED;
+	}
+
+	server.rsp[0] = SID_READ_DTC_INFO + POSITIVE_RESPONSE_OFFSET;
+	server.rsp[1] = req[1];
+	server.rsp[2] = db->dtcAvailabilityMask;
+
+	for(uint16_t i = 0; i < db->dtcCount; i++){
+		const UdsServer_Dtc_t* const dtc = &db->dtcs[i];
+
+		if(req[1] != REPORT_SUPPORTED_DTC && (dtc->status & mask) == 0) continue;
+
+		count++;
+		if(req[1] == REPORT_NUMBER_OF_DTC_BY_STATUS_MASK) continue;
+
+		if(len + 4 > UDS_SERVER_RESPONSE_MAX) return NRC_RESPONSE_TOO_LONG;
+		memcpy(&server.rsp[len], dtc->dtc, 3);
+		server.rsp[len + 3] = dtc->status & db->dtcAvailabilityMask;
+		len += 4;
+	}
+
+	if(req[1] == REPORT_NUMBER_OF_DTC_BY_STATUS_MASK){
+		/* DTCFormatIdentifier ISO 14229-1 */
+		server.rsp[3] = 0x01;
+		server.rsp[4] = (uint8_t)(count >> 8);
+		server.rsp[5] = (uint8_t)count;
+		len = 6;
+	}
+
+	server.rspLength = len;
+
+	return 0;
+}
+
+static const UdsServer_Did_t* UdsServer_FindDid(uint16_t did){
+	const UdsServer_Db_t* const db = server.config.db;
+	uint16_t lo = 0;
+	uint16_t hi = db->didCount;
+
+	while(lo < hi){
+		const uint16_t mid = (uint16_t)((lo + hi) / 2);
+
+		if(db->dids[mid].did == did) return &db->dids[mid];
+		if(db->dids[mid].did < did){
+			lo = (uint16_t)(mid + 1);
+		}
+		else{
+			hi = mid;
+		}
+	}
+
+	return NULL;
+}
+
+static uint16_t UdsServer_GetDelay(uint8_t sid){
+	const UdsServer_Db_t* const db = server.config.db;
+
+	for(uint8_t i = 0; i < db->delayCount; i++){
+		if(db->delays[i].sid == sid) return db->delays[i].delay;
+	}
+
+	return 0;
+}
+
+/* Stays in UDS_SERVER_DELAY while ISO-TP is still busy with a NRC 0x78 */
+static void UdsServer_Send(uint32_t now){
+	server.state = UDS_SERVER_SENDING;
+	switch(CanTp_Transmit(&server.link, server.rsp, server.rspLength, now)){
+	case CANTP_OK:
+		break;
+	case CANTP_BUSY:
+		server.state = UDS_SERVER_DELAY;
+		server.due = now;
+		break;
+	default:
+		server.state = UDS_SERVER_IDLE;
+		break;
+	}
+}
+
+static void UdsServer_SendPending(uint32_t now){
+	/* A 0x78 the link cannot take now is sent on the next pass */
+	if(CanTp_Transmit(&server.link, server.pending, sizeof(server.pending), now) == CANTP_BUSY){
+		server.pendingDue = now;
+		return;
+	}
+	server.pendingDue = now + UDS_SERVER_PENDING_PERIOD;
+}
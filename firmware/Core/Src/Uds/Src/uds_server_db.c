@@ -0,0 +1,57 @@
+/*
+ * uds_server_db.c
+ *
+ *  Created on: Aug 14, 2025
+ *      Author: Josu Alexandru
+ *
+ * Example database of the simulated ECU. Everything is const and stays in
+ * flash; values lie back to back in one array and the DID table points
+ * into it.
+ */
+
+#include "../Inc/uds_server.h"
+
+/* Variables */
+static const uint8_t serverDbData[] = {
+	/* 0x0000 DID_SPARE_PART_NUMBER */
+	'A', 'D', 'D', '-', '0', '0', '0', '1',
+	/* 0x0008 DID_ECU_SOFTWARE_NUMBER */
+	'S', 'W', '0', '1', '0', '2',
+	/* 0x000E DID_ECU_SERIAL_NUMBER */
+	'0', '0', '0', '0', '4', '2',
+	/* 0x0014 DID_VEHICLE_INDENTIFICATION_NUMBER */
+	'W', 'V', 'W', 'Z', 'Z', 'Z', '1', 'J', 'Z', 'X', 'W', '0', '0', '0', '0', '0', '1',
+	/* 0x0025 DID_SYSTEM_NAME */
+	'S', 'I', 'M', 'E', 'C', 'U'
+};
+
+static const UdsServer_Did_t serverDbDids[] = {
+	{ DID_SPARE_PART_NUMBER,              8,  0x0000 },
+	{ DID_ECU_SOFTWARE_NUMBER,            6,  0x0008 },
+	{ DID_ECU_SERIAL_NUMBER,              6,  0x000E },
+	{ DID_VEHICLE_INDENTIFICATION_NUMBER, 17, 0x0014 },
+	{ DID_SYSTEM_NAME,                    6,  0x0025 }
+};
+
+static const UdsServer_Dtc_t serverDbDtcs[] = {
+	/* P0301 confirmed, P0420 pending, U0100 test failed since clear */
+	{ { 0x03, 0x01, 0x00 }, 0x2F },
+	{ { 0x04, 0x20, 0x00 }, 0x24 },
+	{ { 0xC1, 0x00, 0x00 }, 0x20 }
+};
+
+/* A reset takes longer than P2 and exercises NRC 0x78 */
+static const UdsServer_Delay_t serverDbDelays[] = {
+	{ SID_ECU_RESET, 100 }
+};
+
+const UdsServer_Db_t udsServerDb = {
+	.dids = serverDbDids,
+	.didCount = (uint16_t)(sizeof(serverDbDids) / sizeof(serverDbDids[0])),
+	.data = serverDbData,
+	.dtcs = serverDbDtcs,
+	.dtcCount = (uint16_t)(sizeof(serverDbDtcs) / sizeof(serverDbDtcs[0])),
+	.dtcAvailabilityMask = 0xFF,
+	.delays = serverDbDelays,
+	.delayCount = (uint8_t)(sizeof(serverDbDelays) / sizeof(serverDbDelays[0]))
+};
@@ -5,9 +5,829 @@
  *      Author: Josu Alexandru
  */
 
+#include <stddef.h>
+#include <string.h>
+#include "../Inc/uds_services.h"
+#include "../Inc/uds_dispatch.h"
+#include "../Inc/uds_prof.h"
+#include "../../Com/CanTp/Inc/cantp_ch.h"
 
+/* Defines */
+/* Bytes kept of a streamed response, enough for a negative response */
+#define UDS_STREAM_HEAD_SIZE ((uint8_t) 3)
 
+/* Enums */
+typedef enum{
+	UDS_REQ_FREE,
+	/* Waiting for the previous request to the same ECU */
+	UDS_REQ_QUEUED,
+	/* Handed to ISO-TP, waiting for the Tx confirmation */
+	UDS_REQ_SENDING,
+	/* Request sent, P2 / P2* running */
+	UDS_REQ_WAIT_RSP,
+	/* Completed inside Uds_Request(), reported by the next Uds_MainFunction() */
+	UDS_REQ_DONE
+}Uds_ReqStateTypeDef;
 
+/* Structures */
+typedef struct{
+	uint32_t txId;
+	uint32_t rxId;
+	uint8_t session;
+	/* Last request sent to the ECU, physically or functionally */
+	uint32_t lastTx;
+}Uds_EcuSession_t;
 
+typedef struct{
+	Uds_ReqStateTypeDef state;
+	uint32_t txId;
+	uint32_t rxId;
+	CanTp_Link_t* link;
+	/* Request, either copied to reqBuff or owned by the caller */
+	const uint8_t* data;
+	uint32_t length;
+	uint8_t reqBuff[UDS_CLIENT_INLINE_SIZE];
+	uint8_t sid;
+	uint8_t pendingCount;
+	/* No positive response will come (suppressPosRspMsgIndicationBit) */
+	bool suppressPosRsp;
+	/* Submission order, keeps requests to one ECU in order */
+	uint32_t seq;
+	/* Set while no ISO-TP channel is free for the request */
+	bool linkWait;
+	uint32_t linkWaitTime;
+	/* Outcome held in UDS_REQ_DONE */
+	Uds_ResultTypeDef result;
+	/* Sink of a streamed response, NULL if the response is reassembled */
+	Uds_Stream_t stream;
+	/* The response being received is positive and goes to stream */
+	bool streaming;
+	/* First bytes of the response being streamed */
+	uint8_t head[UDS_STREAM_HEAD_SIZE];
+	uint8_t headLen;
+	uint32_t sentTime;
+	/* A response frame arrived, the first one at firstRx */
+	bool rxSeen;
+	uint32_t firstRx;
+	uint32_t deadline;
+	/* Gets each ECU's response of a functional request, NULL for any other request */
+	Uds_Callback_t sink;
+	Uds_Callback_t callback;
+	void* context;
+}Uds_Request_t;
 
+/* One ECU reached by the functional request in progress */
+typedef struct{
+	CanTp_Link_t* link;
+	/* End of the NRC 0x78 extension, valid while pending */
+	uint32_t pendingUntil;
+	bool pending;
+}Uds_FunctionalEcu_t;
 
+/* Functions prototype */
+static UDS_StatusTypeDef Uds_Submit(uint32_t txId, uint32_t rxId, const uint8_t* data, uint32_t length,
+		Uds_Stream_t stream, Uds_Callback_t sink, Uds_Callback_t callback, void* context, uint32_t now);
+static void Uds_StartNext(void);
+static bool Uds_MayStart(const Uds_Request_t* req);
+static bool Uds_Conflicts(const Uds_Request_t* a, const Uds_Request_t* b);
+static void Uds_Start(Uds_Request_t* req);
+static bool Uds_GetFunctionalLinks(void);
+static void Uds_Complete(Uds_Request_t* req, Uds_ResultTypeDef result, uint8_t nrc, const uint8_t* data, uint32_t length);
+static Uds_Request_t* Uds_FindActive(const CanTp_Link_t* link);
+static CanTp_Link_t* Uds_GetLink(uint32_t txId, uint32_t rxId);
+static void Uds_CloseIdleLinks(void);
+static void Uds_TxConfirmation(CanTp_Link_t* link, CanTp_ResultTypeDef result);
+static void Uds_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length);
+static void Uds_FunctionalRx(Uds_Request_t* req, CanTp_Link_t* link, const uint8_t* data, uint32_t length);
+static bool Uds_FunctionalAnswering(uint32_t now);
+static void Uds_NoteRx(Uds_Request_t* req, const CanTp_Link_t* link);
+static bool Uds_RxStream(CanTp_Link_t* link, uint32_t offset, const uint8_t* data, uint32_t len);
+static void Uds_KeepAlive(uint32_t now);
+static void Uds_TouchSessions(uint32_t txId);
+static bool Uds_IsBusy(uint32_t txId);
+static uint32_t Uds_FunctionalId(uint32_t txId);
+
+/* Variables */
+static Uds_Request_t requests[UDS_CLIENT_MAX_REQUESTS];
+/* ISO-TP channels opened by the client */
+static CanTp_Link_t* links[CANTP_CH_MAX];
+static uint32_t udsSeq;
+/* ECUs known to be in a non-default session, txId 0 marks a free entry */
+static Uds_EcuSession_t sessions[UDS_CLIENT_MAX_ECUS];
+/* ECUs of the functional request in progress; there is one at a time, as
+ * all of them go to BROADCAST_REQUEST_ID */
+static Uds_FunctionalEcu_t functionalEcus[UDS_CLIENT_FUNCTIONAL_ECUS];
+/* Time of the last call into the client; ISO-TP callbacks carry no time */
+static uint32_t udsNow;
+/* Request being submitted; its callback must not run before Uds_Request() returns */
+static Uds_Request_t* udsSubmitting;
+/* TesterPresent with suppressPosRspMsgIndicationBit */
+static const uint8_t udsKeepAlive[] = {
+	SID_TESTER_PRESENT, ZERO_SUB_FUNCTION | SUPPRESS_POS_RSP_MSG_INDICATION_BIT
+};
+
+
+bool Uds_Init(void){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		requests[i].state = UDS_REQ_FREE;
+	}
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		links[i] = NULL;
+	}
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		sessions[i].txId = 0;
+	}
+	udsSeq = 0;
+	udsSubmitting = NULL;
+
+	return Uds_DispatchCheck();
+}
+
+/**
+ * @brief Queues a request to one ECU.
+ *
+ * The request is sent right away if the ECU has no request outstanding,
+ * otherwise after the ones queued before it. Requests longer than
+ * UDS_CLIENT_INLINE_SIZE are not copied and must stay valid until the
+ * callback. The callback never runs before this function has returned.
+ *
+ * A request for which no ISO-TP channel is free (all in use, or the ID pair
+ * held by another module) waits in the queue, for at most
+ * UDS_CLIENT_LINK_WAIT ms before it fails with UDS_RESULT_TX_ERROR.
+ *
+ * @param txId      Physical request ID (CANTP_ID_EXT for 29-bit).
+ * @param rxId      ID the ECU responds on.
+ * @param callback  Called once with the final outcome, may be NULL.
+ *
+ * @return UDS_NOT_OK if the service table rejects the request,
+ *         UDS_BUSY if all request slots are in use.
+ */
+UDS_StatusTypeDef Uds_Request(uint32_t txId, uint32_t rxId, const uint8_t* data, uint32_t length,
+		Uds_Callback_t callback, void* context, uint32_t now){
+	return Uds_RequestStream(txId, rxId, data, length, NULL, callback, context, now);
+}
+
+/**
+ * @brief Uds_Request() whose positive response is passed to stream as it arrives.
+ *
+ * stream sees every byte of the response, the response SID included, and is
+ * not called for negative responses. The callback then reports the outcome
+ * with data NULL and the total length. With stream NULL this is Uds_Request().
+ */
+UDS_StatusTypeDef Uds_RequestStream(uint32_t txId, uint32_t rxId, const uint8_t* data, uint32_t length,
+		Uds_Stream_t stream, Uds_Callback_t callback, void* context, uint32_t now){
+	return Uds_Submit(txId, rxId, data, length, stream, NULL, callback, context, now);
+}
+
+/**
+ * @brief Functional request on BROADCAST_REQUEST_ID, answered by every ECU it reaches.
+ *
+ * The responses of 0x7E8-0x7EF are received on the client's channels of
+ * those ECUs, so multi-frame responses are reassembled side by side and
+ * their flow control goes to the physical ID of the ECU. Each one is passed
+ * to sink (POSITIVE, NEGATIVE or INVALID_RSP, with the IDs of the ECU). The
+ * window lasts P2, longer while an ECU is still sending or has asked for
+ * time with NRC 0x78; the callback then reports POSITIVE if any ECU
+ * answered, TIMEOUT otherwise.
+ *
+ * Requests to 0x7E0-0x7E7 and functional requests are served in submission
+ * order: this one waits for those queued before it, and those queued after
+ * it wait until its window has closed.
+ *
+ * @param sink      Called once per ECU response, must not be NULL.
+ * @param callback  Called once the window has closed, may be NULL.
+ *
+ * @return As Uds_Request().
+ */
+UDS_StatusTypeDef Uds_RequestFunctional(const uint8_t* data, uint32_t length,
+		Uds_Callback_t sink, Uds_Callback_t callback, void* context, uint32_t now){
+	if(sink == NULL) return UDS_NOT_OK;
+
+	return Uds_Submit(BROADCAST_REQUEST_ID, CANTP_ID_NONE, data, length, NULL, sink, callback, context, now);
+}
+
+/**
+ * @brief Completes every request to an ECU with UDS_RESULT_CANCELLED.
+ */
+void Uds_Cancel(uint32_t txId){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		Uds_Request_t* const req = &requests[i];
+
+		if(req->state == UDS_REQ_FREE || req->txId != txId) continue;
+
+		/* ISO-TP may still be reading the request */
+		if(req->state == UDS_REQ_SENDING){
+			for(uint8_t j = 0; j < CANTP_CH_MAX; j++){
+				if(links[j] == req->link) links[j] = NULL;
+			}
+			CanTpCh_Close(req->link);
+		}
+		Uds_Complete(req, (req->state == UDS_REQ_DONE) ? req->result : UDS_RESULT_CANCELLED, 0, NULL, 0);
+	}
+}
+
+void Uds_MainFunction(uint32_t now){
+	udsNow = now;
+
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		Uds_Request_t* const req = &requests[i];
+
+		if(req->state == UDS_REQ_WAIT_RSP && (int32_t)(now - req->deadline) >= 0){
+			if(req->sink == NULL){
+				Uds_Complete(req, UDS_RESULT_TIMEOUT, 0, NULL, 0);
+			}
+			/* The window of a functional request closes once no ECU is still answering */
+			else if(!Uds_FunctionalAnswering(now)){
+				Uds_Complete(req, req->rxSeen ? UDS_RESULT_POSITIVE : UDS_RESULT_TIMEOUT, 0, NULL, 0);
+			}
+		}
+		else if(req->state == UDS_REQ_DONE){
+			Uds_Complete(req, req->result, 0, NULL, 0);
+		}
+		else if(req->state == UDS_REQ_QUEUED){
+			if(Uds_MayStart(req)){
+				Uds_Start(req);
+			}
+			/* Still no channel for it */
+			if(req->state == UDS_REQ_QUEUED && req->linkWait && (now - req->linkWaitTime) >= UDS_CLIENT_LINK_WAIT){
+				Uds_Complete(req, UDS_RESULT_TX_ERROR, 0, NULL, 0);
+			}
+		}
+	}
+
+	Uds_KeepAlive(now);
+	Uds_CloseIdleLinks();
+}
+
+/**
+ * @brief Sets the time of the frames about to be processed.
+ *
+ * Called at the start of each pass, before received frames are handed to
+ * ISO-TP, so that callbacks and the response time profile see the time
+ * of this pass.
+ */
+void Uds_SetTime(uint32_t now){
+	udsNow = now;
+}
+
+/**
+ * @brief Time of the last call into the client, for use inside callbacks.
+ */
+uint32_t Uds_GetTime(void){
+	return udsNow;
+}
+
+/**
+ * @brief Session the ECU was last switched to by this client (DEFAULT_SESSION if unknown).
+ */
+uint8_t Uds_GetSession(uint32_t txId){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		if(sessions[i].txId == txId) return sessions[i].session;
+	}
+
+	return DEFAULT_SESSION;
+}
+
+/**
+ * @brief Records the session of an ECU, called by the service handlers.
+ *
+ * ECUs in a non-default session are kept alive with TesterPresent (see
+ * Uds_KeepAlive()) for as long as the client knows them in that session.
+ */
+void Uds_SetSession(uint32_t txId, uint8_t session){
+	Uds_EcuSession_t* free = NULL;
+
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		if(sessions[i].txId == txId){
+			free = &sessions[i];
+			break;
+		}
+		if(sessions[i].txId == 0 && free == NULL) free = &sessions[i];
+	}
+	if(free == NULL) return;
+
+	/* Only non-default sessions are kept */
+	free->txId = (session == DEFAULT_SESSION) ? 0 : txId;
+	free->session = session;
+	free->lastTx = udsNow;
+
+	/* Response ID of the request that changed the session */
+	free->rxId = CANTP_ID_NONE;
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		if(requests[i].state != UDS_REQ_FREE && requests[i].txId == txId){
+			free->rxId = requests[i].rxId;
+			break;
+		}
+	}
+}
+
+uint8_t Uds_OutstandingCount(void){
+	uint8_t count = 0;
+
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		if(requests[i].state != UDS_REQ_FREE) count++;
+	}
+
+	return count;
+}
+
+
+/* Private functions */
+
+/* Queues a request of Uds_RequestStream() or Uds_RequestFunctional() */
+static UDS_StatusTypeDef Uds_Submit(uint32_t txId, uint32_t rxId, const uint8_t* data, uint32_t length,
+		Uds_Stream_t stream, Uds_Callback_t sink, Uds_Callback_t callback, void* context, uint32_t now){
+	Uds_Request_t* const outer = udsSubmitting;
+	Uds_Request_t* req = NULL;
+	const Uds_Service_t* svc;
+
+	if(data == NULL || length == 0) return UDS_NOT_OK;
+
+	svc = Uds_GetService(data[0]);
+	if(svc->reqMinLen != 0){
+		if(length < svc->reqMinLen) return UDS_NOT_OK;
+		if(svc->subFunctions != NULL && !Uds_HasSubFunction(svc, data[1])) return UDS_NOT_OK;
+		if((svc->sessions & UDS_SESSION_BIT(Uds_GetSession(txId))) == 0) return UDS_NOT_OK;
+	}
+
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		if(requests[i].state == UDS_REQ_FREE){
+			req = &requests[i];
+			break;
+		}
+	}
+	if(req == NULL) return UDS_BUSY;
+
+	udsNow = now;
+
+	req->txId = txId;
+	req->rxId = rxId;
+	req->link = NULL;
+	if(length <= UDS_CLIENT_INLINE_SIZE){
+		memcpy(req->reqBuff, data, length);
+		req->data = req->reqBuff;
+	}
+	else{
+		req->data = data;
+	}
+	req->length = length;
+	req->sid = data[0];
+	req->pendingCount = 0;
+	req->suppressPosRsp = svc->subFunctions != NULL && (data[1] & SUPPRESS_POS_RSP_MSG_INDICATION_BIT) != 0;
+	req->seq = ++udsSeq;
+	req->linkWait = false;
+	req->stream = stream;
+	req->streaming = false;
+	req->headLen = 0;
+	req->rxSeen = false;
+	req->sink = sink;
+	req->callback = callback;
+	req->context = context;
+	req->state = UDS_REQ_QUEUED;
+
+	udsSubmitting = req;
+	if(Uds_MayStart(req)){
+		Uds_Start(req);
+	}
+	udsSubmitting = outer;
+
+	return UDS_OK;
+}
+
+/* Starts the queued requests that nothing older or outstanding holds back */
+static void Uds_StartNext(void){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		if(requests[i].state == UDS_REQ_QUEUED && Uds_MayStart(&requests[i])){
+			Uds_Start(&requests[i]);
+		}
+	}
+}
+
+/* A request waits for every conflicting request queued before it or outstanding */
+static bool Uds_MayStart(const Uds_Request_t* req){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		const Uds_Request_t* const other = &requests[i];
+
+		if(other == req || other->state == UDS_REQ_FREE || !Uds_Conflicts(req, other)) continue;
+		if(other->state != UDS_REQ_QUEUED || (int32_t)(other->seq - req->seq) < 0) return false;
+	}
+
+	return true;
+}
+
+/* Same ECU, or a functional request and an ECU it reaches */
+static bool Uds_Conflicts(const Uds_Request_t* a, const Uds_Request_t* b){
+	if(a->txId == b->txId) return true;
+	if(a->sink != NULL && Uds_FunctionalId(b->txId) == a->txId) return true;
+
+	return b->sink != NULL && Uds_FunctionalId(a->txId) == b->txId;
+}
+
+static void Uds_Start(Uds_Request_t* req){
+	CANTP_StatusTypeDef status;
+
+	/* No channel free: stays queued, Uds_MainFunction() tries again */
+	req->link = Uds_GetLink(req->txId, req->rxId);
+	if(req->link == NULL || (req->sink != NULL && !Uds_GetFunctionalLinks())){
+		if(!req->linkWait){
+			req->linkWait = true;
+			req->linkWaitTime = udsNow;
+		}
+		return;
+	}
+	req->linkWait = false;
+
+	/* The link may only switch between buffered and streamed reception
+	 * between two messages; the request stays queued until then */
+	if((req->link->RxStream != NULL) != (req->stream != NULL)){
+		if(req->link->rx.state != CANTP_RX_IDLE) return;
+		req->link->RxStream = (req->stream != NULL) ? Uds_RxStream : NULL;
+	}
+	/* The ECUs answer a functional request on buffered links */
+	if(req->sink != NULL){
+		for(uint8_t i = 0; i < UDS_CLIENT_FUNCTIONAL_ECUS; i++){
+			Uds_FunctionalEcu_t* const ecu = &functionalEcus[i];
+
+			if(ecu->link->RxStream != NULL){
+				if(ecu->link->rx.state != CANTP_RX_IDLE) return;
+				ecu->link->RxStream = NULL;
+			}
+		}
+		for(uint8_t i = 0; i < UDS_CLIENT_FUNCTIONAL_ECUS; i++){
+			functionalEcus[i].pending = false;
+		}
+	}
+
+	/* A single frame is confirmed before CanTp_Transmit() returns */
+	req->sentTime = udsNow;
+	req->state = UDS_REQ_SENDING;
+	status = CanTp_Transmit(req->link, req->data, req->length, udsNow);
+
+	if(status == CANTP_BUSY){
+		req->state = UDS_REQ_QUEUED;
+	}
+	else if(status != CANTP_OK){
+		Uds_Complete(req, UDS_RESULT_TX_ERROR, 0, NULL, 0);
+	}
+}
+
+/* Frees the slot first, so the callback may queue the next request */
+static void Uds_Complete(Uds_Request_t* req, Uds_ResultTypeDef result, uint8_t nrc, const uint8_t* data, uint32_t length){
+	const Uds_Callback_t callback = req->callback;
+	Uds_Response_t rsp;
+
+	rsp.result = result;
+	rsp.txId = req->txId;
+	rsp.rxId = req->rxId;
+	rsp.sid = req->sid;
+	rsp.nrc = nrc;
+	rsp.pendingCount = req->pendingCount;
+	rsp.data = data;
+	rsp.length = length;
+	rsp.latency = (req->state == UDS_REQ_WAIT_RSP) ? (udsNow - req->sentTime) : 0;
+
+	/* Requests that left; the first frame may predate our Tx confirmation */
+	if(req->state == UDS_REQ_WAIT_RSP && result != UDS_RESULT_CANCELLED){
+		const bool responded = req->rxSeen && (result == UDS_RESULT_POSITIVE || result == UDS_RESULT_NEGATIVE
+				|| result == UDS_RESULT_INVALID_RSP);
+		const uint32_t first = ((int32_t)(req->firstRx - req->sentTime) > 0) ? (req->firstRx - req->sentTime) : 0;
+
+		UdsProf_Record(req->txId, req->sid, responded, first, rsp.latency, req->pendingCount);
+	}
+
+	/* Completed while being submitted (no channel answer needed: Tx error,
+	 * suppressed positive response); the caller hears of it later */
+	if(req == udsSubmitting){
+		req->result = result;
+		req->state = UDS_REQ_DONE;
+		return;
+	}
+
+	req->state = UDS_REQ_FREE;
+
+	if(callback != NULL){
+		callback(&rsp, req->context);
+	}
+
+	/* Uds_Cancel() goes on with the rest of the queue */
+	if(result != UDS_RESULT_CANCELLED){
+		Uds_StartNext();
+	}
+}
+
+/* Request a link's frames belong to: its own, or a functional request reaching its ECU */
+static Uds_Request_t* Uds_FindActive(const CanTp_Link_t* link){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		const Uds_Request_t* const req = &requests[i];
+
+		if(req->state != UDS_REQ_SENDING && req->state != UDS_REQ_WAIT_RSP) continue;
+
+		if(req->link == link || (req->sink != NULL && Uds_FunctionalId(link->txId) == req->txId)){
+			return &requests[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Returns the client's channel for an ECU, opening it if needed */
+static CanTp_Link_t* Uds_GetLink(uint32_t txId, uint32_t rxId){
+	CanTp_Link_t** free = NULL;
+
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		if(links[i] == NULL){
+			if(free == NULL) free = &links[i];
+		}
+		else if(links[i]->txId == txId && links[i]->rxId == rxId){
+			return links[i];
+		}
+	}
+	if(free == NULL) return NULL;
+
+	*free = CanTpCh_Open(txId, rxId, Uds_RxIndication, Uds_TxConfirmation, NULL);
+
+	return *free;
+}
+
+/* Channels of the ECUs reached by a functional request, all of them or none yet */
+static bool Uds_GetFunctionalLinks(void){
+	for(uint8_t i = 0; i < UDS_CLIENT_FUNCTIONAL_ECUS; i++){
+		const uint32_t txId = PHYSICAL_REQUEST_ID_BASE + i;
+
+		functionalEcus[i].link = Uds_GetLink(txId, txId + PHYSICAL_RESPONSE_OFFSET);
+		if(functionalEcus[i].link == NULL) return false;
+	}
+
+	return true;
+}
+
+/*
+ * Channels are returned once no request uses them. This is done here and
+ * not on completion, because completion runs inside the channel's own
+ * RxIndication.
+ */
+static void Uds_CloseIdleLinks(void){
+	for(uint8_t i = 0; i < CANTP_CH_MAX; i++){
+		if(links[i] == NULL) continue;
+
+		if(!Uds_IsBusy(links[i]->txId)){
+			CanTpCh_Close(links[i]);
+			links[i] = NULL;
+		}
+	}
+}
+
+static void Uds_TxConfirmation(CanTp_Link_t* link, CanTp_ResultTypeDef result){
+	Uds_Request_t* const req = Uds_FindActive(link);
+
+	if(req == NULL || req->state != UDS_REQ_SENDING) return;
+
+	if(result != CANTP_N_OK){
+		Uds_Complete(req, UDS_RESULT_TX_ERROR, 0, NULL, 0);
+		return;
+	}
+
+	/* Restarts S3 on the ECU(s) addressed */
+	Uds_TouchSessions(req->txId);
+
+	if(req->suppressPosRsp){
+		Uds_Complete(req, UDS_RESULT_POSITIVE, 0, NULL, 0);
+		return;
+	}
+
+	/* P2 starts once the request has left */
+	req->sentTime = udsNow;
+	req->deadline = udsNow + UDS_P2_CLIENT;
+	req->state = UDS_REQ_WAIT_RSP;
+}
+
+static void Uds_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length){
+	Uds_Request_t* const req = Uds_FindActive(link);
+
+	if(req == NULL) return;
+
+	/* One ECU answering a functional request; a failed reception only loses that answer */
+	if(req->sink != NULL){
+		if(link != req->link && result == CANTP_N_OK && data != NULL && length != 0){
+			Uds_FunctionalRx(req, link, data, length);
+		}
+		return;
+	}
+
+	if(result != CANTP_N_OK){
+		Uds_NoteRx(req, link);
+		Uds_Complete(req, UDS_RESULT_RX_ERROR, 0, NULL, 0);
+		return;
+	}
+
+	/* Streamed link: the payload went to Uds_RxStream() */
+	if(data == NULL && req->stream != NULL){
+		if(req->streaming){
+			Uds_NoteRx(req, link);
+			if(length < Uds_GetService(req->sid)->rspMinLen){
+				Uds_Complete(req, UDS_RESULT_INVALID_RSP, 0, NULL, length);
+			}
+			else{
+				Uds_Complete(req, UDS_RESULT_POSITIVE, 0, NULL, length);
+			}
+			return;
+		}
+		data = req->head;
+		length = (length < req->headLen) ? length : req->headLen;
+	}
+	if(data == NULL || length == 0) return;
+
+	/* Positive response, checked against the service table */
+	if(data[0] == (uint8_t)(req->sid + POSITIVE_RESPONSE_OFFSET)){
+		const Uds_Service_t* const svc = Uds_GetService(req->sid);
+
+		Uds_NoteRx(req, link);
+		if(length < svc->rspMinLen || (svc->parser != NULL && !svc->parser(req->data, req->length, data, length))){
+			Uds_Complete(req, UDS_RESULT_INVALID_RSP, 0, data, length);
+			return;
+		}
+		if(svc->handler != NULL){
+			svc->handler(req->txId, req->data, req->length, data, length);
+		}
+		Uds_Complete(req, UDS_RESULT_POSITIVE, 0, data, length);
+		return;
+	}
+
+	/* Negative response to another service, not ours */
+	if(data[0] != SID_NEGATIVE_RESPONSE || length < 3 || data[1] != req->sid) return;
+	Uds_NoteRx(req, link);
+
+	if(data[2] == NRC_RESPONSE_PENDING){
+		if(++req->pendingCount > UDS_RESPONSE_PENDING_MAX){
+			Uds_Complete(req, UDS_RESULT_TIMEOUT, data[2], data, length);
+			return;
+		}
+		/* The ECU may also answer before our own Tx confirmation was processed */
+		if(req->state == UDS_REQ_SENDING){
+			req->sentTime = udsNow;
+			req->state = UDS_REQ_WAIT_RSP;
+		}
+		req->deadline = udsNow + UDS_P2_EXT_CLIENT;
+		return;
+	}
+
+	Uds_Complete(req, UDS_RESULT_NEGATIVE, data[2], data, length);
+}
+
+/* Passes one ECU's response to the sink; the window stays open for the others */
+static void Uds_FunctionalRx(Uds_Request_t* req, CanTp_Link_t* link, const uint8_t* data, uint32_t length){
+	Uds_FunctionalEcu_t* const ecu = &functionalEcus[link->txId - PHYSICAL_REQUEST_ID_BASE];
+	const Uds_Service_t* const svc = Uds_GetService(req->sid);
+	Uds_Response_t rsp;
+
+	rsp.nrc = 0;
+	if(data[0] == (uint8_t)(req->sid + POSITIVE_RESPONSE_OFFSET)){
+		rsp.result = UDS_RESULT_POSITIVE;
+		if(length < svc->rspMinLen || (svc->parser != NULL && !svc->parser(req->data, req->length, data, length))){
+			rsp.result = UDS_RESULT_INVALID_RSP;
+		}
+		else if(svc->handler != NULL){
+			svc->handler(link->txId, req->data, req->length, data, length);
+		}
+	}
+	else if(data[0] == SID_NEGATIVE_RESPONSE && length >= 3 && data[1] == req->sid){
+		if(data[2] == NRC_RESPONSE_PENDING){
+			if(++req->pendingCount <= UDS_RESPONSE_PENDING_MAX){
+				ecu->pending = true;
+				ecu->pendingUntil = udsNow + UDS_P2_EXT_CLIENT;
+			}
+			return;
+		}
+		rsp.result = UDS_RESULT_NEGATIVE;
+		rsp.nrc = data[2];
+	}
+	else{
+		return;
+	}
+
+	ecu->pending = false;
+	Uds_NoteRx(req, link);
+
+	rsp.txId = link->txId;
+	rsp.rxId = link->rxId;
+	rsp.sid = req->sid;
+	rsp.pendingCount = req->pendingCount;
+	rsp.data = data;
+	rsp.length = length;
+	rsp.latency = udsNow - req->sentTime;
+
+	req->sink(&rsp, req->context);
+}
+
+/* An ECU is still sending its response, or has asked for more time */
+static bool Uds_FunctionalAnswering(uint32_t now){
+	for(uint8_t i = 0; i < UDS_CLIENT_FUNCTIONAL_ECUS; i++){
+		const Uds_FunctionalEcu_t* const ecu = &functionalEcus[i];
+
+		if(ecu->link->rx.state != CANTP_RX_IDLE) return true;
+		if(ecu->pending && (int32_t)(now - ecu->pendingUntil) < 0) return true;
+	}
+
+	return false;
+}
+
+/* Keeps the arrival of the first frame of the first response (ISO-TP frame time) */
+static void Uds_NoteRx(Uds_Request_t* req, const CanTp_Link_t* link){
+	if(!req->rxSeen){
+		req->rxSeen = true;
+		req->firstRx = link->rx.startTime;
+	}
+}
+
+/*
+ * CanTp_RxStream_t of a link carrying a streamed request. The first byte
+ * tells a positive response, forwarded to the request's stream, from
+ * anything else, of which the first bytes are kept for Uds_RxIndication().
+ */
+static bool Uds_RxStream(CanTp_Link_t* link, uint32_t offset, const uint8_t* data, uint32_t len){
+	Uds_Request_t* const req = Uds_FindActive(link);
+
+	/* Nobody waits for it, drop it */
+	if(req == NULL || req->stream == NULL) return true;
+
+	if(offset == 0){
+		req->streaming = (data[0] == (uint8_t)(req->sid + POSITIVE_RESPONSE_OFFSET));
+		req->headLen = 0;
+	}
+	for(uint32_t i = 0; i < len && offset + i < UDS_STREAM_HEAD_SIZE; i++){
+		req->head[offset + i] = data[i];
+		req->headLen = (uint8_t)(offset + i + 1);
+	}
+
+	if(!req->streaming) return true;
+
+	return req->stream(offset, data, len, req->context);
+}
+
+/*
+ * Sends TesterPresent (3E 80) to ECUs in a non-default session that had no
+ * request for UDS_S3_CLIENT ms and none outstanding. When a due ECU shares
+ * its functional address with other ECUs in a session, one functional
+ * frame keeps all of them alive instead of one physical request each.
+ */
+static void Uds_KeepAlive(uint32_t now){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		Uds_EcuSession_t* const ecu = &sessions[i];
+		uint32_t functionalId;
+		uint8_t reached = 0;
+
+		if(ecu->txId == 0 || (int32_t)(now - ecu->lastTx) < (int32_t)UDS_S3_CLIENT) continue;
+		if(Uds_IsBusy(ecu->txId)) continue;
+
+		functionalId = Uds_FunctionalId(ecu->txId);
+		if(functionalId != 0){
+			for(uint8_t j = 0; j < UDS_CLIENT_MAX_ECUS; j++){
+				if(sessions[j].txId != 0 && Uds_FunctionalId(sessions[j].txId) == functionalId) reached++;
+			}
+		}
+
+		if(reached > 1){
+			if(!Uds_IsBusy(functionalId)){
+				(void)Uds_Request(functionalId, CANTP_ID_NONE, udsKeepAlive, sizeof(udsKeepAlive), NULL, NULL, now);
+			}
+		}
+		else if(ecu->rxId != CANTP_ID_NONE){
+			(void)Uds_Request(ecu->txId, ecu->rxId, udsKeepAlive, sizeof(udsKeepAlive), NULL, NULL, now);
+		}
+	}
+}
+
+/* A request to txId has left: physical ECU, or every ECU a functional ID reaches */
+static void Uds_TouchSessions(uint32_t txId){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_ECUS; i++){
+		if(sessions[i].txId == 0) continue;
+
+		if(sessions[i].txId == txId || Uds_FunctionalId(sessions[i].txId) == txId){
+			sessions[i].lastTx = udsNow;
+		}
+	}
+}
+
+/* A request to txId, or a functional request reaching it, is queued or outstanding */
+static bool Uds_IsBusy(uint32_t txId){
+	for(uint8_t i = 0; i < UDS_CLIENT_MAX_REQUESTS; i++){
+		const Uds_Request_t* const req = &requests[i];
+
+		if(req->state == UDS_REQ_FREE) continue;
+		if(req->txId == txId || (req->sink != NULL && Uds_FunctionalId(txId) == req->txId)) return true;
+	}
+
+	return false;
+}
+
+/* Functional request ID reaching a physical one (ISO 15765-4), 0 if none */
+static uint32_t Uds_FunctionalId(uint32_t txId){
+	if(txId >= PHYSICAL_REQUEST_ID_BASE && txId < PHYSICAL_REQUEST_ID_BASE + PHYSICAL_RESPONSE_OFFSET){
+		return BROADCAST_REQUEST_ID;
+	}
+	if((txId & ~(uint32_t)0xFF00) == (PHYSICAL_REQUEST_ID_EXT_BASE | CANTP_ID_EXT)){
+		return BROADCAST_REQUEST_ID_EXT | CANTP_ID_EXT;
+	}
+
+	return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * block_pool.h
+ *
+ *  Created on: Jul 28, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Fixed-size block pool handing out contiguous runs of blocks.
+ *
+ * Memory and bookkeeping are provided by the owner, nothing is allocated
+ * at run time. The pool is not thread safe; it is meant to be used from a
+ * single task.
+ */
+
+#ifndef SRC_UTIL_INC_BLOCK_POOL_H_
+#define SRC_UTIL_INC_BLOCK_POOL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Structures */
+typedef struct{
+	uint8_t* mem;
+	/* Per block: run length at the first block of an allocation,
+	 * BLOCK_POOL_CONT for the following blocks, 0 when free */
+	uint16_t* runs;
+	uint32_t blockSize;
+	uint32_t blockCount;
+	uint32_t freeCount;
+}BlockPool_t;
+
+/* Defines */
+#define BLOCK_POOL_CONT ((uint16_t) 0xFFFF)
+
+/* Functions */
+extern bool BlockPool_Init(BlockPool_t* pool, uint8_t* mem, uint16_t* runs, uint32_t blockSize, uint32_t blockCount);
+extern uint8_t* BlockPool_Alloc(BlockPool_t* pool, uint32_t size);
+extern void BlockPool_Free(BlockPool_t* pool, uint8_t* ptr);
+extern uint32_t BlockPool_RunLength(const BlockPool_t* pool, const uint8_t* ptr);
+extern bool BlockPool_Check(const BlockPool_t* pool);
+
+static inline uint32_t BlockPool_FreeCount(const BlockPool_t* pool){
+	if(pool == NULL) return 0;
+	return pool->freeCount;
+}
+
+#endif /* SRC_UTIL_INC_BLOCK_POOL_H_ */
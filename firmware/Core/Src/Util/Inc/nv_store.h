@@ -0,0 +1,31 @@
+/*
+ * nv_store.h
+ *
+ *  Created on: Aug 17, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Non-volatile storage in the last flash sector.
+ *
+ * Sector 7 is kept out of the program by the linker script. Reads are plain
+ * memory reads; writes program 32-bit words, so offsets and lengths are
+ * multiples of 4 and a word can only go from erased (0xFFFFFFFF) to its
+ * value. Erasing the sector stalls the CPU (and every interrupt) for one to
+ * two seconds, so callers only erase while the diagnostics are idle.
+ */
+
+#ifndef SRC_UTIL_INC_NV_STORE_H_
+#define SRC_UTIL_INC_NV_STORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines */
+#define NVSTORE_ADDRESS ((uint32_t) 0x08060000)
+#define NVSTORE_SIZE    ((uint32_t) (128 * 1024))
+
+/* Functions */
+extern bool NvStore_Read(uint32_t offset, void* data, uint32_t length);
+extern bool NvStore_Write(uint32_t offset, const void* data, uint32_t length);
+extern bool NvStore_Erase(void);
+
+#endif /* SRC_UTIL_INC_NV_STORE_H_ */
@@ -0,0 +1,30 @@
+/*
+ * time_us.h
+ *
+ *  Created on: Jul 24, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Microsecond time base on TIM5 (32-bit, free running at 1 MHz).
+ *
+ * Channel 1 of the timer provides a one-shot compare event used to pace
+ * ISO-TP consecutive frames below the 1 ms RTOS tick.
+ */
+
+#ifndef SRC_UTIL_INC_TIME_US_H_
+#define SRC_UTIL_INC_TIME_US_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Defines */
+
+/* Same preemption priority as CAN1_TX_IRQn, the two ISRs share CanTp state */
+#define TIMEUS_IRQ_PRIORITY ((uint32_t) 7)
+
+/* Functions */
+extern bool TimeUs_Init(void);
+extern void TimeUs_StartOneShot(uint32_t us, void (*callback)(void));
+extern void TimeUs_Cancel(void);
+extern void TimeUs_IRQHandler(void);
+
+#endif /* SRC_UTIL_INC_TIME_US_H_ */
@@ -0,0 +1,128 @@
+/*
+ * block_pool.c
+ *
+ *  Created on: Jul 28, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <stddef.h>
+#include "../Inc/block_pool.h"
+
+
+bool BlockPool_Init(BlockPool_t* pool, uint8_t* mem, uint16_t* runs, uint32_t blockSize, uint32_t blockCount){
+	if(pool == NULL || mem == NULL || runs == NULL) return false;
+	if(blockSize == 0 || blockCount == 0 || blockCount >= BLOCK_POOL_CONT) return false;
+
+	pool->mem = mem;
+	pool->runs = runs;
+	pool->blockSize = blockSize;
+	pool->blockCount = blockCount;
+	pool->freeCount = blockCount;
+
+	for(uint32_t i = 0; i < blockCount; i++){
+		runs[i] = 0;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Allocates enough contiguous blocks to hold size bytes (first fit).
+ *
+ * @return Start of the run, or NULL if no run is large enough.
+ */
+uint8_t* BlockPool_Alloc(BlockPool_t* pool, uint32_t size){
+	if(pool == NULL || size == 0) return NULL;
+
+	const uint32_t need = (size + pool->blockSize - 1) / pool->blockSize;
+	uint32_t start = 0;
+	uint32_t len = 0;
+
+	if(need > pool->freeCount) return NULL;
+
+	for(uint32_t i = 0; i < pool->blockCount; i++){
+		if(pool->runs[i] != 0){
+			len = 0;
+			continue;
+		}
+
+		if(len == 0) start = i;
+		if(++len == need){
+			pool->runs[start] = (uint16_t)need;
+			for(uint32_t j = start + 1; j < start + need; j++){
+				pool->runs[j] = BLOCK_POOL_CONT;
+			}
+			pool->freeCount -= need;
+
+			return &pool->mem[start * pool->blockSize];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Returns a run obtained from BlockPool_Alloc().
+ *
+ * Pointers that are not the start of a run are ignored.
+ */
+void BlockPool_Free(BlockPool_t* pool, uint8_t* ptr){
+	const uint32_t count = BlockPool_RunLength(pool, ptr);
+
+	if(count == 0) return;
+
+	const uint32_t start = (uint32_t)(ptr - pool->mem) / pool->blockSize;
+
+	for(uint32_t i = start; i < start + count; i++){
+		pool->runs[i] = 0;
+	}
+	pool->freeCount += count;
+}
+
+/**
+ * @brief Number of blocks in the run starting at ptr, 0 if ptr is not an allocated run.
+ */
+uint32_t BlockPool_RunLength(const BlockPool_t* pool, const uint8_t* ptr){
+	if(pool == NULL || ptr == NULL || ptr < pool->mem) return 0;
+
+	const uint32_t offset = (uint32_t)(ptr - pool->mem);
+	const uint32_t start = offset / pool->blockSize;
+
+	if(offset % pool->blockSize != 0 || start >= pool->blockCount) return 0;
+
+	const uint32_t count = pool->runs[start];
+	if(count == BLOCK_POOL_CONT) return 0;
+
+	return count;
+}
+
+/**
+ * @brief Consistency check of the bookkeeping (debug / test builds).
+ *
+ * Every run must be followed by exactly its continuation blocks, no
+ * continuation block may stand alone and freeCount must match.
+ */
+bool BlockPool_Check(const BlockPool_t* pool){
+	uint32_t freeBlocks = 0;
+	uint32_t i = 0;
+
+	if(pool == NULL) return false;
+
+	while(i < pool->blockCount){
+		const uint32_t count = pool->runs[i];
+
+		if(count == 0){
+			freeBlocks++;
+			i++;
+			continue;
+		}
+		if(count == BLOCK_POOL_CONT || i + count > pool->blockCount) return false;
+
+		for(uint32_t j = i + 1; j < i + count; j++){
+			if(pool->runs[j] != BLOCK_POOL_CONT) return false;
+		}
+		i += count;
+	}
+
+	return freeBlocks == pool->freeCount;
+}
@@ -0,0 +1,61 @@
+/*
+ * nv_store.c
+ *
+ *  Created on: Aug 17, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "../Inc/nv_store.h"
+
+/* Defines */
+#define NVSTORE_SECTOR FLASH_SECTOR_7
+
+
+bool NvStore_Read(uint32_t offset, void* data, uint32_t length){
+	if(data == NULL || offset > NVSTORE_SIZE || length > NVSTORE_SIZE - offset) return false;
+
+	memcpy(data, (const void*)(uintptr_t)(NVSTORE_ADDRESS + offset), length);
+
+	return true;
+}
+
+bool NvStore_Write(uint32_t offset, const void* data, uint32_t length){
+	const uint8_t* const src = (const uint8_t*)data;
+	bool ok = true;
+
+	if(data == NULL || offset > NVSTORE_SIZE || length > NVSTORE_SIZE - offset) return false;
+	if((offset & 3u) != 0 || (length & 3u) != 0) return false;
+
+	if(HAL_FLASH_Unlock() != HAL_OK) return false;
+
+	for(uint32_t i = 0; i < length && ok; i += 4){
+		uint32_t word;
+
+		memcpy(&word, &src[i], sizeof(word));
+		ok = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, NVSTORE_ADDRESS + offset + i, word) == HAL_OK;
+	}
+
+	(void)HAL_FLASH_Lock();
+
+	return ok;
+}
+
+bool NvStore_Erase(void){
+	FLASH_EraseInitTypeDef erase;
+	uint32_t sectorError;
+	bool ok;
+
+	erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	erase.Banks = FLASH_BANK_1;
+	erase.Sector = NVSTORE_SECTOR;
+	erase.NbSectors = 1;
+	erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+	if(HAL_FLASH_Unlock() != HAL_OK) return false;
+	ok = HAL_FLASHEx_Erase(&erase, &sectorError) == HAL_OK;
+	(void)HAL_FLASH_Lock();
+
+	return ok;
+}
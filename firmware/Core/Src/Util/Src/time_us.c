@@ -0,0 +1,99 @@
+/*
+ * time_us.c
+ *
+ *  Created on: Jul 24, 2025
+ *      Author: Josu Alexandru
+ */
+
+#include "stm32f4xx_hal.h"
+#include "../Inc/time_us.h"
+
+/* Variables */
+static TIM_HandleTypeDef htim5;
+static void (*volatile oneShotCallback)(void);
+/* One-shot requested with a delay that already elapsed */
+static volatile bool oneShotForced;
+
+
+/**
+ * @brief Starts TIM5 as a free running 1 MHz counter.
+ *
+ * Must be called after the system clock is configured.
+ */
+bool TimeUs_Init(void){
+	RCC_ClkInitTypeDef clkconfig;
+	uint32_t timClock;
+	uint32_t flashLatency;
+
+	__HAL_RCC_TIM5_CLK_ENABLE();
+
+	/* Timers on APB1 run at twice PCLK1 when APB1 is divided */
+	HAL_RCC_GetClockConfig(&clkconfig, &flashLatency);
+	timClock = HAL_RCC_GetPCLK1Freq();
+	if(clkconfig.APB1CLKDivider != RCC_HCLK_DIV1){
+		timClock *= 2;
+	}
+
+	htim5.Instance = TIM5;
+	htim5.Init.Prescaler = (timClock / 1000000U) - 1U;
+	htim5.Init.CounterMode = TIM_COUNTERMODE_UP;
+	htim5.Init.Period = 0xFFFFFFFFU;
+	htim5.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	htim5.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if(HAL_TIM_Base_Init(&htim5) != HAL_OK){
+		return false;
+	}
+
+	HAL_NVIC_SetPriority(TIM5_IRQn, TIMEUS_IRQ_PRIORITY, 0);
+	HAL_NVIC_EnableIRQ(TIM5_IRQn);
+
+	return HAL_TIM_Base_Start(&htim5) == HAL_OK;
+}
+
+/**
+ * @brief Calls callback from the TIM5 ISR after us microseconds.
+ *
+ * A new call replaces a pending one-shot. A delay of 0 (or one that
+ * elapses while arming) pends the interrupt right away.
+ */
+void TimeUs_StartOneShot(uint32_t us, void (*callback)(void)){
+	oneShotCallback = callback;
+
+	if(us == 0){
+		oneShotForced = true;
+		HAL_NVIC_SetPendingIRQ(TIM5_IRQn);
+		return;
+	}
+
+	const uint32_t compare = __HAL_TIM_GET_COUNTER(&htim5) + us;
+	__HAL_TIM_SET_COMPARE(&htim5, TIM_CHANNEL_1, compare);
+	__HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_CC1);
+	__HAL_TIM_ENABLE_IT(&htim5, TIM_IT_CC1);
+
+	/* The counter may have passed the compare value already */
+	if((int32_t)(__HAL_TIM_GET_COUNTER(&htim5) - compare) >= 0){
+		oneShotForced = true;
+		HAL_NVIC_SetPendingIRQ(TIM5_IRQn);
+	}
+}
+
+void TimeUs_Cancel(void){
+	__HAL_TIM_DISABLE_IT(&htim5, TIM_IT_CC1);
+	__HAL_TIM_CLEAR_FLAG(&htim5, TIM_FLAG_CC1);
+	oneShotForced = false;
+}
+
+void TimeUs_IRQHandler(void){
+	bool fire = oneShotForced;
+
+	if(__HAL_TIM_GET_FLAG(&htim5, TIM_FLAG_CC1) != RESET && __HAL_TIM_GET_IT_SOURCE(&htim5, TIM_IT_CC1) != RESET){
+		fire = true;
+	}
+	if(!fire) return;
+
+	TimeUs_Cancel();
+
+	if(oneShotCallback != NULL){
+		oneShotCallback();
+	}
+}
@@ -25,6 +25,9 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "can_drv.h"
+#include "Diag/Inc/diag.h"
+#include "Com/Host/Inc/host_if.h"
 
 /* USER CODE END Includes */
 
@@ -45,6 +48,13 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
+/* Definitions for diagTask: CAN frames, ISO-TP channels and UDS client */
+osThreadId_t diagTaskHandle;
+const osThreadAttr_t diagTask_attributes = {
+  .name = "diagTask",
+  .stack_size = 512 * 4,
+  .priority = (osPriority_t) osPriorityAboveNormal,
+};
 
 /* USER CODE END Variables */
 /* Definitions for defaultTask */
@@ -58,6 +68,7 @@ const osThreadAttr_t defaultTask_attributes = {
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN FunctionPrototypes */
 void Task_Prepare_Request(void* arg);
+void Task_Diag(void* arg);
 /* USER CODE END FunctionPrototypes */
 
 void StartDefaultTask(void *argument);
@@ -97,6 +108,11 @@ void MX_FREERTOS_Init(void) {
 
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
+  diagTaskHandle = osThreadNew(Task_Diag, NULL, &diagTask_attributes);
+  /* Both CAN ISRs and USB reception wake the diagnostic task */
+  canRxTaskHandle = (TaskHandle_t)diagTaskHandle;
+  canTxTaskHandle = (TaskHandle_t)diagTaskHandle;
+  hostRxTaskHandle = (TaskHandle_t)diagTaskHandle;
 
   // xTaskCreate(Task_Prepare_Request,  "PrepareRequest",  64, NULL, osPriorityHigh7, NULL);
   // xTaskCreate(Task_Process_Request,  "ProcessRequest",  64, NULL, osPriorityHigh6, NULL);
@@ -145,6 +161,18 @@ void Task_Process_Request(void* arg){
 }
 
 
+void Task_Diag(void* arg){
+	if(!Diag_Init()){
+		Error_Handler();
+	}
+
+	for(;;){
+		/* Woken by a CAN Rx / Tx complete, or the protocol timer tick */
+		(void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DIAG_MAIN_PERIOD));
+		Diag_MainFunction((uint32_t)xTaskGetTickCount());
+	}
+}
+
 void Task_Process_Response(void* arg){
 	// wait notify from CAN ISR
 	// get CAN msg
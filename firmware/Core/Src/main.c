@@ -25,7 +25,9 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-
+#include "Util/Inc/time_us.h"
+#include "Com/Host/Inc/host_if.h"
+#include "can_if.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -86,6 +88,11 @@ int main(void)
 
   /* USER CODE BEGIN SysInit */
   SystemCoreClockUpdate();
+  /* CAN buffers must exist before MX_CAN1_Init() enables the CAN interrupts */
+  if (!CanIf_Init())
+  {
+    Error_Handler();
+  }
 
   /* USER CODE END SysInit */
 
@@ -93,6 +100,11 @@ int main(void)
   MX_GPIO_Init();
   MX_CAN1_Init();
   /* USER CODE BEGIN 2 */
+  if (!TimeUs_Init())
+  {
+    Error_Handler();
+  }
+  HostIf_Init();
 
   /* USER CODE END 2 */
 
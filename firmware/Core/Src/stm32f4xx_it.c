@@ -22,6 +22,7 @@
 #include "stm32f4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "Util/Inc/time_us.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -218,5 +219,12 @@ void OTG_FS_IRQHandler(void)
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles TIM5 global interrupt (microsecond time base).
+  */
+void TIM5_IRQHandler(void)
+{
+  TimeUs_IRQHandler();
+}
 
 /* USER CODE END 1 */
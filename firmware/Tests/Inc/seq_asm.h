@@ -0,0 +1,165 @@
+/*
+ * seq_asm.h
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Host-side assembler for the sequence bytecode of uds_seq.h.
+ *
+ * One function per instruction appends its encoding to a SeqAsm_t.
+ * Backward targets are taken from SeqAsm_Here(); a forward BR or LOOP is
+ * emitted with any address and fixed up with SeqAsm_Patch() once the
+ * label is known, using the position the branch function returned.
+ * Running out of room sets overflow instead of writing past the buffer.
+ */
+
+#ifndef TESTS_INC_SEQ_ASM_H_
+#define TESTS_INC_SEQ_ASM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../../Core/Src/Uds/Inc/uds_seq.h"
+
+/* Structures */
+typedef struct{
+	uint8_t code[UDS_SEQ_CODE_MAX];
+	uint16_t length;
+	bool overflow;
+}SeqAsm_t;
+
+/* Functions */
+static inline void SeqAsm_Init(SeqAsm_t* a){
+	a->length = 0;
+	a->overflow = false;
+}
+
+static inline uint16_t SeqAsm_Here(const SeqAsm_t* a){
+	return a->length;
+}
+
+static inline void SeqAsm_U8(SeqAsm_t* a, uint8_t value){
+	if(a->length >= UDS_SEQ_CODE_MAX){
+		a->overflow = true;
+		return;
+	}
+	a->code[a->length++] = value;
+}
+
+static inline void SeqAsm_U16(SeqAsm_t* a, uint16_t value){
+	SeqAsm_U8(a, (uint8_t)value);
+	SeqAsm_U8(a, (uint8_t)(value >> 8));
+}
+
+static inline void SeqAsm_U32(SeqAsm_t* a, uint32_t value){
+	SeqAsm_U16(a, (uint16_t)value);
+	SeqAsm_U16(a, (uint16_t)(value >> 16));
+}
+
+static inline void SeqAsm_End(SeqAsm_t* a){
+	SeqAsm_U8(a, UDS_SEQ_OP_END);
+}
+
+static inline void SeqAsm_Target(SeqAsm_t* a, uint32_t txId, uint32_t rxId){
+	SeqAsm_U8(a, UDS_SEQ_OP_TARGET);
+	SeqAsm_U32(a, txId);
+	SeqAsm_U32(a, rxId);
+}
+
+static inline void SeqAsm_Send(SeqAsm_t* a, const uint8_t* data, uint8_t length){
+	SeqAsm_U8(a, UDS_SEQ_OP_SEND);
+	SeqAsm_U8(a, length);
+	for(uint8_t i = 0; i < length; i++){
+		SeqAsm_U8(a, data[i]);
+	}
+}
+
+static inline void SeqAsm_Wait(SeqAsm_t* a, uint8_t r){
+	SeqAsm_U8(a, UDS_SEQ_OP_WAIT);
+	SeqAsm_U8(a, r);
+}
+
+static inline void SeqAsm_Len(SeqAsm_t* a, uint8_t r){
+	SeqAsm_U8(a, UDS_SEQ_OP_LEN);
+	SeqAsm_U8(a, r);
+}
+
+static inline void SeqAsm_Load(SeqAsm_t* a, uint8_t r, uint16_t offset, uint8_t size){
+	SeqAsm_U8(a, UDS_SEQ_OP_LOAD);
+	SeqAsm_U8(a, r);
+	SeqAsm_U16(a, offset);
+	SeqAsm_U8(a, size);
+}
+
+static inline void SeqAsm_Set(SeqAsm_t* a, uint8_t r, int32_t imm){
+	SeqAsm_U8(a, UDS_SEQ_OP_SET);
+	SeqAsm_U8(a, r);
+	SeqAsm_U32(a, (uint32_t)imm);
+}
+
+static inline void SeqAsm_Add(SeqAsm_t* a, uint8_t r, int32_t imm){
+	SeqAsm_U8(a, UDS_SEQ_OP_ADD);
+	SeqAsm_U8(a, r);
+	SeqAsm_U32(a, (uint32_t)imm);
+}
+
+static inline void SeqAsm_Cmp(SeqAsm_t* a, uint8_t r, int32_t imm){
+	SeqAsm_U8(a, UDS_SEQ_OP_CMP);
+	SeqAsm_U8(a, r);
+	SeqAsm_U32(a, (uint32_t)imm);
+}
+
+/* Returns the position of the address for SeqAsm_Patch() */
+static inline uint16_t SeqAsm_Br(SeqAsm_t* a, UdsSeq_CondTypeDef cond, uint16_t addr){
+	uint16_t at;
+
+	SeqAsm_U8(a, UDS_SEQ_OP_BR);
+	SeqAsm_U8(a, (uint8_t)cond);
+	at = a->length;
+	SeqAsm_U16(a, addr);
+
+	return at;
+}
+
+static inline uint16_t SeqAsm_Loop(SeqAsm_t* a, uint8_t r, uint16_t addr){
+	uint16_t at;
+
+	SeqAsm_U8(a, UDS_SEQ_OP_LOOP);
+	SeqAsm_U8(a, r);
+	at = a->length;
+	SeqAsm_U16(a, addr);
+
+	return at;
+}
+
+static inline void SeqAsm_Delay(SeqAsm_t* a, uint16_t ms){
+	SeqAsm_U8(a, UDS_SEQ_OP_DELAY);
+	SeqAsm_U16(a, ms);
+}
+
+static inline void SeqAsm_Store(SeqAsm_t* a, uint16_t offset, uint16_t length){
+	SeqAsm_U8(a, UDS_SEQ_OP_STORE);
+	SeqAsm_U16(a, offset);
+	SeqAsm_U16(a, length);
+}
+
+static inline void SeqAsm_StoreReg(SeqAsm_t* a, uint8_t r){
+	SeqAsm_U8(a, UDS_SEQ_OP_STOREREG);
+	SeqAsm_U8(a, r);
+}
+
+static inline void SeqAsm_Emit(SeqAsm_t* a, uint8_t tag){
+	SeqAsm_U8(a, UDS_SEQ_OP_EMIT);
+	SeqAsm_U8(a, tag);
+}
+
+/* Points the branch whose address is at position at to addr */
+static inline void SeqAsm_Patch(SeqAsm_t* a, uint16_t at, uint16_t addr){
+	if((uint32_t)at + 2 > a->length){
+		a->overflow = true;
+		return;
+	}
+	a->code[at] = (uint8_t)addr;
+	a->code[at + 1] = (uint8_t)(addr >> 8);
+}
+
+#endif /* TESTS_INC_SEQ_ASM_H_ */
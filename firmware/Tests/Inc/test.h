@@ -0,0 +1,43 @@
+/*
+ * test.h
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Minimal assertions for the host tests.
+ *
+ * Every test program is one translation unit: TEST_RUN() runs a case,
+ * TEST_CHECK() records a failure and goes on, Test_Result() is returned
+ * from main() so ctest sees the outcome.
+ */
+
+#ifndef TESTS_INC_TEST_H_
+#define TESTS_INC_TEST_H_
+
+#include <stdio.h>
+
+/* Variables */
+static unsigned testFailures;
+static unsigned testCases;
+
+/* Defines */
+#define TEST_CHECK(cond) do{ \
+		if(!(cond)){ \
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			testFailures++; \
+		} \
+	}while(0)
+
+#define TEST_RUN(fn) do{ \
+		const unsigned before = testFailures; \
+		fn(); \
+		testCases++; \
+		printf("%-48s %s\n", #fn, (testFailures == before) ? "ok" : "FAILED"); \
+	}while(0)
+
+static inline int Test_Result(void){
+	printf("%u cases, %u failed checks\n", testCases, testFailures);
+	return (testFailures == 0) ? 0 : 1;
+}
+
+#endif /* TESTS_INC_TEST_H_ */
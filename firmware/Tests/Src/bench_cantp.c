@@ -0,0 +1,151 @@
+/*
+ * bench_cantp.c
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief ISO-TP throughput on the host, messages/s per payload size.
+ *
+ * Two channels are looped back to each other: every frame one of them
+ * queues is handed to the other one right away, BS = 0 and STmin = 0. So
+ * the figures are the protocol cost on the host CPU, segmentation,
+ * reassembly into the pool and flow control. CAN bus time is not included.
+ *
+ *   bench_cantp [seconds per size]
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "../../Core/Src/Com/CanTp/Inc/cantp_ch.h"
+
+/* Defines */
+#define BENCH_ID_A       ((uint32_t) 0x7E0)
+#define BENCH_ID_B       ((uint32_t) 0x7E8)
+#define BENCH_QUEUE_SIZE ((uint32_t) 256)
+#define BENCH_MSG_MAX    ((uint32_t) 16000)
+/* Messages sent between two clock reads */
+#define BENCH_BATCH      ((uint32_t) 256)
+
+/* Structures */
+typedef struct{
+	uint32_t id;
+	uint8_t data[CANTP_CAN_DL];
+	uint8_t dlc;
+}Bench_Frame_t;
+
+/* Variables */
+static Bench_Frame_t queue[BENCH_QUEUE_SIZE];
+static uint32_t queueCount;
+static uint64_t frames;
+static bool received;
+static bool confirmed;
+static uint8_t message[BENCH_MSG_MAX];
+static const uint32_t benchSizes[] = { 7, 62, 255, 1024, 4095, 16000 };
+
+
+/* Private functions */
+
+static bool Bench_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc){
+	if(queueCount >= BENCH_QUEUE_SIZE) return false;
+
+	queue[queueCount].id = id;
+	queue[queueCount].dlc = dlc;
+	memcpy(queue[queueCount].data, data, dlc);
+	queueCount++;
+	frames++;
+
+	return true;
+}
+
+static void Bench_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length){
+	(void)link;
+	(void)length;
+
+	received = result == CANTP_N_OK && data != NULL;
+}
+
+static void Bench_TxConfirmation(CanTp_Link_t* link, CanTp_ResultTypeDef result){
+	(void)link;
+
+	confirmed = result == CANTP_N_OK;
+}
+
+static double Bench_Seconds(void){
+	struct timespec ts;
+
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Sends one message from a to b and delivers frames until both ends are done */
+static bool Bench_Message(CanTp_Link_t* a, uint32_t length, uint32_t now){
+	received = false;
+	confirmed = false;
+	if(CanTp_Transmit(a, message, length, now) != CANTP_OK) return false;
+
+	while(!(received && confirmed)){
+		const uint32_t count = queueCount;
+
+		if(count == 0) return false;
+		queueCount = 0;
+		/* Frames queued while delivering go to the next round */
+		for(uint32_t i = 0; i < count; i++){
+			const Bench_Frame_t f = queue[i];
+
+			(void)CanTpCh_RxFrame(f.id, f.data, f.dlc, now);
+		}
+		CanTpCh_MainFunction(now);
+	}
+
+	return true;
+}
+
+
+int main(int argc, char** argv){
+	const double seconds = (argc > 1) ? atof(argv[1]) : 0.5;
+	CanTp_Link_t* a;
+	CanTp_Link_t* b;
+
+	for(uint32_t i = 0; i < BENCH_MSG_MAX; i++){
+		message[i] = (uint8_t)i;
+	}
+
+	if(!CanTpCh_Init(Bench_SendFrame)) return 1;
+	CanTpCh_SetFlowControl(0, 0);
+	a = CanTpCh_Open(BENCH_ID_A, BENCH_ID_B, NULL, Bench_TxConfirmation, NULL);
+	b = CanTpCh_Open(BENCH_ID_B, BENCH_ID_A, Bench_RxIndication, NULL, NULL);
+	if(a == NULL || b == NULL) return 1;
+
+	printf("%8s %12s %12s %10s\n", "payload", "messages/s", "MB/s", "frames");
+	for(uint32_t s = 0; s < sizeof(benchSizes) / sizeof(benchSizes[0]); s++){
+		const uint32_t length = benchSizes[s];
+		const double start = Bench_Seconds();
+		double elapsed;
+		uint64_t messages = 0;
+		uint32_t now = 0;
+
+		frames = 0;
+		do{
+			for(uint32_t n = 0; n < BENCH_BATCH; n++){
+				if(!Bench_Message(a, length, now)){
+					printf("%8u transfer failed\n", (unsigned)length);
+					return 1;
+				}
+			}
+			messages += BENCH_BATCH;
+			/* Keep the ms clock moving so no timer is ever close */
+			now++;
+			elapsed = Bench_Seconds() - start;
+		}while(elapsed < seconds);
+
+		printf("%8u %12.0f %12.2f %10.1f\n", (unsigned)length, (double)messages / elapsed,
+				(double)messages * length / elapsed / 1e6, (double)frames / (double)messages);
+	}
+
+	return 0;
+}
@@ -0,0 +1,303 @@
+/*
+ * fuzz_cantp.c
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Randomized frame sequences against the ISO-TP channels.
+ *
+ * LLVMFuzzerTestOneInput() decodes its input as a list of operations on
+ * FUZZ_CHANNELS channels: raw SF / FF / CF / FC bytes, well-formed CFs
+ * with any SN, duplicated and truncated frames, time jumps, transmissions,
+ * a CAN queue that fills up, BS / STmin changes, receivers on hold and
+ * hardware pacer ticks.
+ * After every operation the links, the channels and the block pool must
+ * pass their consistency checks. Once the input is used up no more frames
+ * arrive, and every link must reach idle within the worst-case timeouts
+ * with the whole pool returned.
+ *
+ * Built with -fsanitize=fuzzer (clang) it is a libFuzzer target; otherwise
+ * main() replays pseudo-random inputs from a seed.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "../../Core/Src/Com/CanTp/Inc/cantp_ch.h"
+
+/* Defines */
+#define FUZZ_CHANNELS   ((uint8_t) 4)
+#define FUZZ_TX_BASE    ((uint32_t) 0x7E0)
+#define FUZZ_RX_BASE    ((uint32_t) 0x7E8)
+/* Frames the simulated CAN controller takes between two operations */
+#define FUZZ_QUEUE_SIZE ((uint32_t) 3)
+#define FUZZ_MSG_MAX    ((uint32_t) 1024)
+/* Time without input after which every link must be idle (ms) */
+#define FUZZ_DRAIN_MS   ((uint32_t) 60000)
+#define FUZZ_DRAIN_STEP ((uint32_t) 200)
+
+/* Variables */
+static CanTp_Link_t* links[FUZZ_CHANNELS];
+static uint8_t txMessages[FUZZ_CHANNELS][FUZZ_MSG_MAX];
+static uint32_t queued;
+/* Link holding the simulated pacer and whether its timer is armed */
+static CanTp_Link_t* paced;
+static bool timerArmed;
+/* The streaming channel refuses data while set */
+static bool streamFull;
+
+
+/* Private functions */
+
+static void Fuzz_Fail(const char* what, uint32_t step){
+	fprintf(stderr, "invariant violated: %s (operation %u)\n", what, (unsigned)step);
+	abort();
+}
+
+static bool Fuzz_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc){
+	(void)id;
+	(void)data;
+
+	if(dlc == 0 || dlc > CANTP_CAN_DL) Fuzz_Fail("frame length", 0);
+	if(queued >= FUZZ_QUEUE_SIZE) return false;
+	queued++;
+
+	return true;
+}
+
+static void Fuzz_RxIndication(CanTp_Link_t* link, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length){
+	volatile uint8_t sum = 0;
+
+	(void)link;
+
+	/* Touch the whole buffer so the sanitizers see a bad length */
+	if(result == CANTP_N_OK && data != NULL){
+		for(uint32_t i = 0; i < length; i++){
+			sum ^= data[i];
+		}
+	}
+}
+
+static bool Fuzz_RxStream(CanTp_Link_t* link, uint32_t offset, const uint8_t* data, uint32_t len){
+	volatile uint8_t sum = 0;
+
+	if(streamFull) return false;
+	if(offset + len > link->rx.length) Fuzz_Fail("stream beyond FF_DL", 0);
+	for(uint32_t i = 0; i < len; i++){
+		sum ^= data[i];
+	}
+
+	return true;
+}
+
+static void Fuzz_StartTimer(CanTp_Link_t* link, uint32_t us){
+	(void)us;
+
+	if(link != paced) Fuzz_Fail("timer armed by a link without the pacer", 0);
+	timerArmed = true;
+}
+
+/* Single pacer like CanTpHw_Attach / CanTpHw_Detach */
+static bool Fuzz_PacerAttach(CanTp_Link_t* link){
+	if(paced != NULL) return false;
+
+	paced = link;
+	timerArmed = false;
+	link->SendFrameIsr = Fuzz_SendFrame;
+	link->StartTimer = Fuzz_StartTimer;
+
+	return true;
+}
+
+static void Fuzz_PacerDetach(CanTp_Link_t* link){
+	if(link != paced) return;
+
+	link->SendFrameIsr = NULL;
+	link->StartTimer = NULL;
+	paced = NULL;
+	timerArmed = false;
+}
+
+/* Timer expiry: the pacing ISR sends the next CF(s) */
+static void Fuzz_PacerTick(uint32_t now){
+	if(paced == NULL || !timerArmed) return;
+
+	timerArmed = false;
+	CanTp_TxIsr(paced, now);
+	if(paced != NULL && paced->tx.state == CANTP_TX_SEND){
+		timerArmed = true;
+	}
+}
+
+static void Fuzz_Check(uint32_t step){
+	for(uint8_t i = 0; i < FUZZ_CHANNELS; i++){
+		if(!CanTp_CheckLink(links[i])) Fuzz_Fail("CanTp_CheckLink", step);
+	}
+	/* Also runs BlockPool_Check() on the reassembly pool and accounts for every block in use */
+	if(!CanTpCh_Check()) Fuzz_Fail("CanTpCh_Check", step);
+}
+
+
+int LLVMFuzzerTestOneInput(const uint8_t* input, size_t size){
+	uint8_t last[CANTP_CAN_DL] = { 0 };
+	uint8_t lastDlc = 1;
+	uint32_t lastId = FUZZ_RX_BASE;
+	uint32_t now = 0;
+	uint32_t step = 0;
+	size_t pos = 0;
+
+	queued = 0;
+	paced = NULL;
+	timerArmed = false;
+	streamFull = false;
+	(void)CanTpCh_Init(Fuzz_SendFrame);
+	CanTpCh_SetFlowControl(CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN);
+	CanTpCh_SetPacer(Fuzz_PacerAttach, Fuzz_PacerDetach);
+	for(uint8_t i = 0; i < FUZZ_CHANNELS; i++){
+		links[i] = CanTpCh_Open(FUZZ_TX_BASE + i, FUZZ_RX_BASE + i, Fuzz_RxIndication, NULL, NULL);
+		if(links[i] == NULL) Fuzz_Fail("open", 0);
+	}
+	/* The last channel streams instead of reassembling */
+	links[FUZZ_CHANNELS - 1]->RxStream = Fuzz_RxStream;
+
+	while(pos + 2 <= size){
+		const uint8_t op = input[pos++];
+		const uint8_t arg = input[pos++];
+		const uint8_t ch = arg % FUZZ_CHANNELS;
+		uint8_t frame[CANTP_CAN_DL];
+
+		switch(op & 0x0F){
+		case 0: case 1: case 2: case 3:
+			/* Raw frame: any PCI, any length */
+			memset(frame, 0, sizeof(frame));
+			lastDlc = (uint8_t)(1 + ((arg >> 2) & 0x07));
+			for(uint8_t i = 0; i < lastDlc && pos < size; i++){
+				frame[i] = input[pos++];
+			}
+			lastId = FUZZ_RX_BASE + ch;
+			memcpy(last, frame, sizeof(last));
+			(void)CanTpCh_RxFrame(lastId, frame, lastDlc, now);
+			break;
+		case 4: case 5:
+			/* Full CF with the SN of the argument, in or out of order */
+			frame[0] = (uint8_t)(CANTP_PCI_CF | (arg >> 4));
+			memset(&frame[1], arg, CANTP_CAN_DL - 1);
+			(void)CanTpCh_RxFrame(FUZZ_RX_BASE + ch, frame, CANTP_CAN_DL, now);
+			break;
+		case 6:
+			/* The previous frame again */
+			(void)CanTpCh_RxFrame(lastId, last, lastDlc, now);
+			break;
+		case 7:
+			/* The previous frame cut short */
+			(void)CanTpCh_RxFrame(lastId, last, (uint8_t)(1 + arg % lastDlc), now);
+			break;
+		case 8:
+			/* Well-formed FC with random BS / STmin and flow status */
+			frame[0] = (uint8_t)(CANTP_PCI_FC | ((arg & 0x03) == 3 ? 0x0F : (arg & 0x03)));
+			frame[1] = (pos < size) ? input[pos++] : 0;
+			frame[2] = (pos < size) ? input[pos++] : 0;
+			(void)CanTpCh_RxFrame(FUZZ_RX_BASE + ch, frame, 3, now);
+			break;
+		case 9:
+			now += arg;
+			break;
+		case 10:
+			now += (uint32_t)arg * 50;
+			break;
+		case 11:
+			(void)CanTp_Transmit(links[ch], txMessages[ch], 1 + (uint32_t)arg * 4, now);
+			break;
+		case 12:
+			/* The CAN controller frees its mailboxes */
+			queued = 0;
+			break;
+		case 13:
+			CanTpCh_SetFlowControl(arg >> 4, (arg & 0x08) ? 0xF3 : (arg & 0x07));
+			break;
+		case 14:
+			Fuzz_PacerTick(now);
+			break;
+		default:
+			/* Receivers not ready: streaming sink full, link on hold */
+			streamFull = (arg & 0x01) != 0;
+			CanTp_SetRxHold(links[ch], (arg & 0x02) != 0);
+			break;
+		}
+
+		/* Most of the time the controller drains between two task passes */
+		if((op & 0x80) == 0){
+			queued = 0;
+		}
+		CanTpCh_MainFunction(now);
+		Fuzz_Check(step);
+		step++;
+	}
+
+	/* No more input: every link has to finish on its own */
+	streamFull = false;
+	for(uint8_t i = 0; i < FUZZ_CHANNELS; i++){
+		CanTp_SetRxHold(links[i], false);
+	}
+	for(uint32_t t = 0; t < FUZZ_DRAIN_MS; t += FUZZ_DRAIN_STEP){
+		now += FUZZ_DRAIN_STEP;
+		queued = 0;
+		Fuzz_PacerTick(now);
+		CanTpCh_MainFunction(now);
+		Fuzz_Check(step);
+	}
+	for(uint8_t i = 0; i < FUZZ_CHANNELS; i++){
+		if(links[i]->tx.state != CANTP_TX_IDLE || links[i]->rx.state != CANTP_RX_IDLE) Fuzz_Fail("link not idle", step);
+	}
+	if(paced != NULL) Fuzz_Fail("pacer not released", step);
+	if(CanTpCh_PoolFreeBytes() != CANTP_POOL_BLOCK_SIZE * CANTP_POOL_BLOCK_COUNT) Fuzz_Fail("pool blocks leaked", step);
+
+	for(uint8_t i = 0; i < FUZZ_CHANNELS; i++){
+		CanTpCh_Close(links[i]);
+	}
+
+	return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+/* xorshift32, so a seed gives the same inputs with any libc */
+static uint32_t Fuzz_Random(uint32_t* state){
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+/**
+ * Replays pseudo-random inputs: fuzz_cantp [seed] [inputs]
+ */
+int main(int argc, char** argv){
+	static uint8_t input[4096];
+	uint32_t state = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : 1;
+	const uint32_t count = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : 1000;
+
+	if(state == 0) state = 1;
+
+	for(uint32_t n = 0; n < count; n++){
+		const size_t size = Fuzz_Random(&state) % sizeof(input);
+
+		for(size_t i = 0; i < size; i++){
+			input[i] = (uint8_t)Fuzz_Random(&state);
+			/* Bias towards valid PCIs and short time steps */
+			if((Fuzz_Random(&state) & 0x03) == 0){
+				input[i] &= 0x3F;
+			}
+		}
+		(void)LLVMFuzzerTestOneInput(input, size);
+	}
+	printf("%u inputs, no invariant violated\n", (unsigned)count);
+
+	return 0;
+}
+#endif
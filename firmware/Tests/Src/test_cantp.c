@@ -0,0 +1,793 @@
+/*
+ * test_cantp.c
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief ISO 15765-2 conformance of the CanTp link against a simulated peer.
+ *
+ * The link under test sends on TEST_TX_ID and receives on TEST_RX_ID. The
+ * peer is the test itself: every frame the link queues is captured, checked
+ * byte by byte, and answered with hand-built SF / FF / CF / FC frames. Time
+ * only moves when a test says so.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../Inc/test.h"
+#include "../../Core/Src/Com/CanTp/Inc/cantp.h"
+
+/* Defines */
+#define TEST_TX_ID      ((uint32_t) 0x7E0)
+#define TEST_RX_ID      ((uint32_t) 0x7E8)
+#define PEER_QUEUE_SIZE ((uint32_t) 64)
+#define TEST_MSG_MAX    ((uint32_t) 5000)
+
+/* Structures */
+typedef struct{
+	uint32_t id;
+	uint8_t data[CANTP_CAN_DL];
+	uint8_t dlc;
+}Peer_Frame_t;
+
+typedef struct{
+	/* Frames queued by the link, oldest first */
+	Peer_Frame_t frames[PEER_QUEUE_SIZE];
+	uint32_t head;
+	uint32_t count;
+	/* The CAN queue refuses frames (N_As / N_Ar) */
+	bool busy;
+	/* Indications and confirmations seen */
+	uint32_t rxCount;
+	CanTp_ResultTypeDef rxResult;
+	uint32_t rxLength;
+	uint8_t* rxData;
+	uint32_t txCount;
+	CanTp_ResultTypeDef txResult;
+}Peer_t;
+
+/* Variables */
+static CanTp_Link_t link;
+static Peer_t peer;
+static uint8_t rxBuffer[TEST_MSG_MAX];
+static uint8_t message[TEST_MSG_MAX];
+
+
+/* Private functions */
+
+static bool Peer_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc){
+	if(peer.busy || peer.head + peer.count >= PEER_QUEUE_SIZE) return false;
+
+	Peer_Frame_t* const f = &peer.frames[peer.head + peer.count++];
+
+	f->id = id;
+	f->dlc = dlc;
+	memcpy(f->data, data, dlc);
+
+	return true;
+}
+
+static void Peer_RxIndication(CanTp_Link_t* l, CanTp_ResultTypeDef result, uint8_t* data, uint32_t length){
+	(void)l;
+
+	peer.rxCount++;
+	peer.rxResult = result;
+	peer.rxData = data;
+	peer.rxLength = length;
+}
+
+static void Peer_TxConfirmation(CanTp_Link_t* l, CanTp_ResultTypeDef result){
+	(void)l;
+
+	peer.txCount++;
+	peer.txResult = result;
+}
+
+static uint8_t* Peer_NoBuffer(CanTp_Link_t* l, uint32_t length){
+	(void)l;
+	(void)length;
+
+	return NULL;
+}
+
+/* Takes the oldest frame sent by the link; false if there is none */
+static bool Peer_Pop(Peer_Frame_t* f){
+	if(peer.count == 0) return false;
+
+	*f = peer.frames[peer.head++];
+	if(--peer.count == 0){
+		peer.head = 0;
+	}
+
+	return true;
+}
+
+static void Peer_Inject(const uint8_t* data, uint8_t dlc, uint32_t now){
+	uint8_t frame[CANTP_CAN_DL];
+
+	memset(frame, CANTP_PADDING_BYTE, sizeof(frame));
+	memcpy(frame, data, dlc);
+	CanTp_RxFrame(&link, frame, dlc, now);
+}
+
+static void Peer_SendFc(uint8_t fs, uint8_t bs, uint8_t stMin, uint32_t now){
+	const uint8_t fc[3] = { (uint8_t)(CANTP_PCI_FC | fs), bs, stMin };
+
+	Peer_Inject(fc, sizeof(fc), now);
+}
+
+/* Checks the next frame is a FC with the given flow status and parameters */
+static bool Peer_ExpectFc(uint8_t fs, uint8_t bs, uint8_t stMin){
+	Peer_Frame_t f;
+
+	if(!Peer_Pop(&f)) return false;
+
+	return f.id == TEST_TX_ID && f.dlc == CANTP_CAN_DL && f.data[0] == (CANTP_PCI_FC | fs)
+			&& f.data[1] == bs && f.data[2] == stMin;
+}
+
+/* Checks the next frame is the CF with the given SN carrying message[offset..] */
+static bool Peer_ExpectCf(uint8_t sn, uint32_t offset, uint32_t length){
+	Peer_Frame_t f;
+	uint32_t chunk = length - offset;
+
+	if(chunk > 7) chunk = 7;
+	if(!Peer_Pop(&f)) return false;
+	if(f.id != TEST_TX_ID || f.dlc != CANTP_CAN_DL || f.data[0] != (CANTP_PCI_CF | sn)) return false;
+	for(uint32_t i = 1 + chunk; i < CANTP_CAN_DL; i++){
+		if(f.data[i] != CANTP_PADDING_BYTE) return false;
+	}
+
+	return memcmp(&f.data[1], &message[offset], chunk) == 0;
+}
+
+/* Sends the CFs of message[offset..length) starting at sn; returns the next SN */
+static uint8_t Peer_SendCfs(uint8_t sn, uint32_t offset, uint32_t length, uint32_t count, uint32_t now){
+	uint8_t frame[CANTP_CAN_DL];
+
+	for(uint32_t i = 0; i < count && offset < length; i++){
+		uint32_t chunk = length - offset;
+
+		if(chunk > 7) chunk = 7;
+		frame[0] = CANTP_PCI_CF | sn;
+		memcpy(&frame[1], &message[offset], chunk);
+		Peer_Inject(frame, (uint8_t)(1 + chunk), now);
+		offset += chunk;
+		sn = (sn + 1) & 0x0F;
+	}
+
+	return sn;
+}
+
+static void Test_Setup(void){
+	memset(&peer, 0, sizeof(peer));
+	for(uint32_t i = 0; i < TEST_MSG_MAX; i++){
+		message[i] = (uint8_t)(i * 7 + 3);
+	}
+	memset(rxBuffer, 0, sizeof(rxBuffer));
+
+	(void)CanTp_Init(&link, TEST_TX_ID, TEST_RX_ID, Peer_SendFrame);
+	link.RxIndication = Peer_RxIndication;
+	link.TxConfirmation = Peer_TxConfirmation;
+	(void)CanTp_SetRxBuffer(&link, rxBuffer, sizeof(rxBuffer));
+}
+
+/* Starts a reception of length bytes with a 12-bit FF */
+static void Peer_SendFf(uint32_t length, uint32_t now){
+	uint8_t ff[CANTP_CAN_DL];
+
+	ff[0] = CANTP_PCI_FF | (uint8_t)(length >> 8);
+	ff[1] = (uint8_t)length;
+	memcpy(&ff[2], message, 6);
+	Peer_Inject(ff, CANTP_CAN_DL, now);
+}
+
+
+/* Test cases: single frames */
+
+static void Test_SfTransmit(void){
+	Peer_Frame_t f;
+
+	Test_Setup();
+	TEST_CHECK(CanTp_Transmit(&link, message, 5, 0) == CANTP_OK);
+
+	/* Padded to 8 bytes and confirmed before CanTp_Transmit() returns */
+	TEST_CHECK(Peer_Pop(&f));
+	TEST_CHECK(f.id == TEST_TX_ID && f.dlc == CANTP_CAN_DL && f.data[0] == 0x05);
+	TEST_CHECK(memcmp(&f.data[1], message, 5) == 0);
+	TEST_CHECK(f.data[6] == CANTP_PADDING_BYTE && f.data[7] == CANTP_PADDING_BYTE);
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_OK);
+	TEST_CHECK(link.tx.state == CANTP_TX_IDLE);
+	TEST_CHECK(!Peer_Pop(&f));
+}
+
+static void Test_SfReceive(void){
+	const uint8_t sf[] = { 0x07, 1, 2, 3, 4, 5, 6, 7 };
+
+	Test_Setup();
+	Peer_Inject(sf, sizeof(sf), 0);
+
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_OK);
+	TEST_CHECK(peer.rxLength == 7 && peer.rxData == rxBuffer);
+	TEST_CHECK(memcmp(rxBuffer, &sf[1], 7) == 0);
+	TEST_CHECK(link.rx.state == CANTP_RX_IDLE);
+}
+
+static void Test_SfInvalidLength(void){
+	const uint8_t zero[] = { 0x00, 1, 2 };
+	/* SF_DL 5 in a 4 byte frame */
+	const uint8_t shortFrame[] = { 0x05, 1, 2, 3 };
+	uint8_t frame[CANTP_CAN_DL] = { 0x08, 1, 2, 3, 4, 5, 6, 7 };
+
+	Test_Setup();
+	CanTp_RxFrame(&link, zero, sizeof(zero), 0);
+	CanTp_RxFrame(&link, shortFrame, sizeof(shortFrame), 0);
+	/* SF_DL above 7 on classic CAN */
+	CanTp_RxFrame(&link, frame, sizeof(frame), 0);
+
+	TEST_CHECK(peer.rxCount == 0);
+	TEST_CHECK(peer.count == 0);
+}
+
+
+/* Test cases: segmented messages */
+
+static void Test_FfCfTransmit(void){
+	const uint32_t length = 300;
+	Peer_Frame_t f;
+	uint32_t offset = 6;
+	uint8_t sn = 1;
+
+	Test_Setup();
+	TEST_CHECK(CanTp_Transmit(&link, message, length, 0) == CANTP_OK);
+
+	TEST_CHECK(Peer_Pop(&f));
+	TEST_CHECK(f.data[0] == (CANTP_PCI_FF | 0x01) && f.data[1] == 0x2C);
+	TEST_CHECK(memcmp(&f.data[2], message, 6) == 0);
+	TEST_CHECK(link.tx.state == CANTP_TX_WAIT_FC);
+
+	/* BS = 0, STmin = 0: the whole message in one go, SN wrapping 0xF -> 0x0 */
+	Peer_SendFc(CANTP_FS_CTS, 0, 0, 1);
+	while(offset < length && peer.count > 0){
+		TEST_CHECK(Peer_ExpectCf(sn, offset, length));
+		offset += 7;
+		sn = (sn + 1) & 0x0F;
+	}
+	TEST_CHECK(offset >= length);
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_OK);
+}
+
+static void Test_FfCfReceive(void){
+	const uint32_t length = 300;
+
+	Test_Setup();
+	link.blockSize = 0;
+	link.stMin = 0x0A;
+	Peer_SendFf(length, 0);
+
+	TEST_CHECK(link.rx.state == CANTP_RX_WAIT_CF);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_CTS, 0, 0x0A));
+
+	(void)Peer_SendCfs(1, 6, length, 100, 1);
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_OK && peer.rxLength == length);
+	TEST_CHECK(memcmp(rxBuffer, message, length) == 0);
+	/* No FC beyond the first one with BS = 0 */
+	TEST_CHECK(peer.count == 0);
+}
+
+static void Test_FfTruncatedIgnored(void){
+	const uint8_t ff[] = { 0x10, 0x14, 1, 2, 3, 4, 5 };
+	/* FF_DL that fits a SF is not a valid FF */
+	const uint8_t small[] = { 0x10, 0x07, 1, 2, 3, 4, 5, 6 };
+
+	Test_Setup();
+	CanTp_RxFrame(&link, ff, sizeof(ff), 0);
+	CanTp_RxFrame(&link, small, sizeof(small), 0);
+
+	TEST_CHECK(link.rx.state == CANTP_RX_IDLE);
+	TEST_CHECK(peer.count == 0 && peer.rxCount == 0);
+}
+
+static void Test_WrongSequenceNumber(void){
+	Test_Setup();
+	Peer_SendFf(100, 0);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_CTS, CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN));
+
+	(void)Peer_SendCfs(2, 6, 100, 1, 1);
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_WRONG_SN);
+	TEST_CHECK(link.rx.state == CANTP_RX_IDLE);
+}
+
+static void Test_UnexpectedSfDuringReception(void){
+	const uint8_t sf[] = { 0x02, 0xAA, 0xBB };
+
+	Test_Setup();
+	Peer_SendFf(100, 0);
+	(void)Peer_SendCfs(1, 6, 100, 2, 1);
+	Peer_Inject(sf, sizeof(sf), 2);
+
+	/* The reception in progress is dropped, the new SF is delivered */
+	TEST_CHECK(peer.rxCount == 2 && peer.rxResult == CANTP_N_OK && peer.rxLength == 2);
+	TEST_CHECK(rxBuffer[0] == 0xAA && rxBuffer[1] == 0xBB);
+}
+
+static void Test_UnexpectedCfIgnored(void){
+	Test_Setup();
+	(void)Peer_SendCfs(1, 0, 7, 1, 0);
+
+	TEST_CHECK(peer.rxCount == 0 && link.rx.state == CANTP_RX_IDLE);
+}
+
+
+/* Test cases: block size and separation time */
+
+static void Test_BlockSizeTransmit(void){
+	const uint32_t length = 6 + 7 * 5;
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, length, 0);
+	(void)Peer_Pop(&f);
+
+	/* Two CFs per block, then wait for the next FC */
+	Peer_SendFc(CANTP_FS_CTS, 2, 0, 1);
+	TEST_CHECK(Peer_ExpectCf(1, 6, length));
+	TEST_CHECK(Peer_ExpectCf(2, 13, length));
+	TEST_CHECK(peer.count == 0 && link.tx.state == CANTP_TX_WAIT_FC);
+	CanTp_MainFunction(&link, 2);
+	TEST_CHECK(peer.count == 0);
+
+	Peer_SendFc(CANTP_FS_CTS, 2, 0, 3);
+	TEST_CHECK(Peer_ExpectCf(3, 20, length));
+	TEST_CHECK(Peer_ExpectCf(4, 27, length));
+	TEST_CHECK(link.tx.state == CANTP_TX_WAIT_FC);
+
+	/* The last block may be shorter than BS */
+	Peer_SendFc(CANTP_FS_CTS, 2, 0, 4);
+	TEST_CHECK(Peer_ExpectCf(5, 34, length));
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_OK);
+}
+
+static void Test_BlockSizeReceive(void){
+	const uint32_t length = 6 + 7 * 5;
+	uint8_t sn;
+
+	Test_Setup();
+	link.blockSize = 2;
+	Peer_SendFf(length, 0);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_CTS, 2, CANTP_RX_STMIN));
+
+	sn = Peer_SendCfs(1, 6, length, 2, 1);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_CTS, 2, CANTP_RX_STMIN));
+	sn = Peer_SendCfs(sn, 20, length, 2, 2);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_CTS, 2, CANTP_RX_STMIN));
+	(void)Peer_SendCfs(sn, 34, length, 1, 3);
+
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_OK);
+	TEST_CHECK(memcmp(rxBuffer, message, length) == 0);
+	TEST_CHECK(peer.count == 0);
+}
+
+static void Test_StMinTransmit(void){
+	const uint32_t length = 6 + 7 * 3;
+	Peer_Frame_t f;
+	uint32_t now = 10;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, length, now);
+	(void)Peer_Pop(&f);
+
+	/* The first CF goes out with the FC, the next ones STmin apart */
+	Peer_SendFc(CANTP_FS_CTS, 0, 5, now);
+	TEST_CHECK(Peer_ExpectCf(1, 6, length));
+	TEST_CHECK(peer.count == 0);
+
+	/* 5 ms rounded up to whole ticks plus one */
+	for(uint32_t t = 1; t <= 5; t++){
+		CanTp_MainFunction(&link, now + t);
+	}
+	TEST_CHECK(peer.count == 0);
+	CanTp_MainFunction(&link, now + 6);
+	TEST_CHECK(Peer_ExpectCf(2, 13, length));
+	TEST_CHECK(peer.count == 0);
+
+	CanTp_MainFunction(&link, now + 12);
+	TEST_CHECK(Peer_ExpectCf(3, 20, length));
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_OK);
+}
+
+static void Test_StMinMicroseconds(void){
+	const uint32_t length = 6 + 7 * 2;
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, length, 0);
+	(void)Peer_Pop(&f);
+
+	/* 500 us is one tick, plus one */
+	Peer_SendFc(CANTP_FS_CTS, 0, 0xF5, 0);
+	TEST_CHECK(Peer_ExpectCf(1, 6, length));
+	CanTp_MainFunction(&link, 1);
+	TEST_CHECK(peer.count == 0);
+	CanTp_MainFunction(&link, 2);
+	TEST_CHECK(Peer_ExpectCf(2, 13, length));
+}
+
+static void Test_StMinEncoding(void){
+	TEST_CHECK(CanTp_StMinToUs(0x00) == 0);
+	TEST_CHECK(CanTp_StMinToUs(0x7F) == 127000);
+	TEST_CHECK(CanTp_StMinToUs(0xF1) == 100);
+	TEST_CHECK(CanTp_StMinToUs(0xF9) == 900);
+	/* Reserved values count as 127 ms */
+	TEST_CHECK(CanTp_StMinToUs(0x80) == 127000);
+	TEST_CHECK(CanTp_StMinToUs(0xF0) == 127000);
+	TEST_CHECK(CanTp_StMinToUs(0xFA) == 127000);
+}
+
+
+/* Test cases: flow status */
+
+static void Test_FcWaitTransmit(void){
+	const uint32_t length = 20;
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, length, 0);
+	(void)Peer_Pop(&f);
+
+	/* Each FC.WAIT restarts N_Bs */
+	Peer_SendFc(CANTP_FS_WAIT, 0, 0, 900);
+	CanTp_MainFunction(&link, 1500);
+	TEST_CHECK(link.tx.state == CANTP_TX_WAIT_FC && peer.txCount == 0);
+
+	Peer_SendFc(CANTP_FS_CTS, 0, 0, 1600);
+	TEST_CHECK(Peer_ExpectCf(1, 6, length));
+	TEST_CHECK(Peer_ExpectCf(2, 13, length));
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_OK);
+}
+
+static void Test_FcWaitOverrun(void){
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, 20, 0);
+	(void)Peer_Pop(&f);
+
+	for(uint8_t i = 0; i < CANTP_WFT_MAX; i++){
+		Peer_SendFc(CANTP_FS_WAIT, 0, 0, i);
+	}
+	TEST_CHECK(peer.txCount == 0);
+	Peer_SendFc(CANTP_FS_WAIT, 0, 0, CANTP_WFT_MAX);
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_WFT_OVRN);
+	TEST_CHECK(link.tx.state == CANTP_TX_IDLE);
+}
+
+static void Test_FcOverflowTransmit(void){
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, 20, 0);
+	(void)Peer_Pop(&f);
+	Peer_SendFc(CANTP_FS_OVFLW, 0, 0, 1);
+
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_BUFFER_OVFLW);
+	TEST_CHECK(peer.count == 0);
+}
+
+static void Test_FcInvalidStatus(void){
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, 20, 0);
+	(void)Peer_Pop(&f);
+	Peer_SendFc(0x05, 0, 0, 1);
+
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_INVALID_FS);
+}
+
+static void Test_FcUnexpectedIgnored(void){
+	Test_Setup();
+	Peer_SendFc(CANTP_FS_CTS, 0, 0, 0);
+
+	TEST_CHECK(peer.txCount == 0 && peer.count == 0 && link.tx.state == CANTP_TX_IDLE);
+}
+
+static void Test_FcOverflowReceive(void){
+	uint8_t small[16];
+
+	Test_Setup();
+	(void)CanTp_SetRxBuffer(&link, small, sizeof(small));
+	Peer_SendFf(100, 0);
+
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_OVFLW, 0, 0));
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_BUFFER_OVFLW);
+	TEST_CHECK(link.rx.state == CANTP_RX_IDLE);
+}
+
+static void Test_RxHold(void){
+	const uint32_t length = 20;
+
+	Test_Setup();
+	CanTp_SetRxHold(&link, true);
+	Peer_SendFf(length, 0);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_WAIT, CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN));
+
+	/* FC.WAIT repeated every N_Br while on hold, CFs meanwhile are ignored */
+	CanTp_MainFunction(&link, CANTP_N_BR_WAIT - 1);
+	TEST_CHECK(peer.count == 0);
+	CanTp_MainFunction(&link, CANTP_N_BR_WAIT);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_WAIT, CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN));
+
+	CanTp_SetRxHold(&link, false);
+	CanTp_MainFunction(&link, CANTP_N_BR_WAIT + 1);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_CTS, CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN));
+
+	(void)Peer_SendCfs(1, 6, length, 2, CANTP_N_BR_WAIT + 2);
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_OK);
+	TEST_CHECK(memcmp(rxBuffer, message, length) == 0);
+}
+
+static void Test_RxHoldOverrun(void){
+	uint32_t now = 0;
+
+	Test_Setup();
+	CanTp_SetRxHold(&link, true);
+	Peer_SendFf(20, now);
+
+	for(uint8_t i = 1; i < CANTP_WFT_MAX; i++){
+		now += CANTP_N_BR_WAIT;
+		CanTp_MainFunction(&link, now);
+	}
+	TEST_CHECK(peer.count == CANTP_WFT_MAX && peer.rxCount == 0);
+
+	now += CANTP_N_BR_WAIT;
+	CanTp_MainFunction(&link, now);
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_WFT_OVRN);
+	TEST_CHECK(peer.count == CANTP_WFT_MAX);
+}
+
+static void Test_DeferredBufferOverflow(void){
+	Test_Setup();
+	(void)CanTp_SetRxBuffer(&link, NULL, 0);
+	link.RxBufferRequest = Peer_NoBuffer;
+
+	/* No buffer yet: FC.WAIT until CANTP_WFT_MAX, then FC.OVFLW */
+	Peer_SendFf(100, 0);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_WAIT, CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN));
+	for(uint32_t i = 1; i <= CANTP_WFT_MAX; i++){
+		CanTp_MainFunction(&link, i * CANTP_N_BR_WAIT);
+	}
+	for(uint32_t i = 1; i < CANTP_WFT_MAX; i++){
+		TEST_CHECK(Peer_ExpectFc(CANTP_FS_WAIT, CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN));
+	}
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_OVFLW, 0, 0));
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_BUFFER_OVFLW);
+}
+
+static void Test_DeferredTooLarge(void){
+	const uint32_t length = CANTP_POOL_BLOCK_SIZE * CANTP_POOL_BLOCK_COUNT + 1;
+	const uint8_t ff[] = { 0x10, 0x00, (uint8_t)(length >> 24), (uint8_t)(length >> 16),
+			(uint8_t)(length >> 8), (uint8_t)length, 1, 2 };
+
+	Test_Setup();
+	(void)CanTp_SetRxBuffer(&link, NULL, 0);
+	link.RxBufferRequest = Peer_NoBuffer;
+
+	/* Larger than the reassembly pool: no FC.WAIT, FC.OVFLW right away */
+	Peer_Inject(ff, sizeof(ff), 0);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_OVFLW, 0, 0));
+	TEST_CHECK(peer.count == 0);
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_BUFFER_OVFLW);
+	TEST_CHECK(link.rx.state == CANTP_RX_IDLE && !link.rx.deferred);
+}
+
+
+/* Test cases: timeouts */
+
+static void Test_TimeoutAs(void){
+	Test_Setup();
+	peer.busy = true;
+	TEST_CHECK(CanTp_Transmit(&link, message, 5, 0) == CANTP_OK);
+	TEST_CHECK(link.tx.state == CANTP_TX_SEND);
+
+	CanTp_MainFunction(&link, CANTP_N_AS_TIMEOUT - 1);
+	TEST_CHECK(peer.txCount == 0);
+	CanTp_MainFunction(&link, CANTP_N_AS_TIMEOUT);
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_TIMEOUT_A);
+	TEST_CHECK(link.tx.state == CANTP_TX_IDLE);
+}
+
+static void Test_TimeoutAsRecovered(void){
+	Peer_Frame_t f;
+
+	Test_Setup();
+	peer.busy = true;
+	(void)CanTp_Transmit(&link, message, 5, 0);
+	CanTp_MainFunction(&link, CANTP_N_AS_TIMEOUT / 2);
+
+	/* The queue frees up before N_As */
+	peer.busy = false;
+	CanTp_MainFunction(&link, CANTP_N_AS_TIMEOUT / 2 + 1);
+	TEST_CHECK(Peer_Pop(&f) && f.data[0] == 0x05);
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_OK);
+}
+
+static void Test_TimeoutBs(void){
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, 20, 100);
+	(void)Peer_Pop(&f);
+
+	CanTp_MainFunction(&link, 100 + CANTP_N_BS_TIMEOUT - 1);
+	TEST_CHECK(peer.txCount == 0);
+	CanTp_MainFunction(&link, 100 + CANTP_N_BS_TIMEOUT);
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_TIMEOUT_BS);
+}
+
+static void Test_TimeoutBsBetweenBlocks(void){
+	const uint32_t length = 6 + 7 * 4;
+	Peer_Frame_t f;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, length, 0);
+	(void)Peer_Pop(&f);
+	Peer_SendFc(CANTP_FS_CTS, 2, 0, 10);
+	(void)Peer_Pop(&f);
+	(void)Peer_Pop(&f);
+
+	CanTp_MainFunction(&link, 10 + CANTP_N_BS_TIMEOUT);
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_TIMEOUT_BS);
+}
+
+static void Test_TimeoutCr(void){
+	const uint32_t length = 100;
+
+	Test_Setup();
+	Peer_SendFf(length, 0);
+	(void)Peer_SendCfs(1, 6, length, 3, 50);
+
+	/* N_Cr restarts with every CF */
+	CanTp_MainFunction(&link, 50 + CANTP_N_CR_TIMEOUT - 1);
+	TEST_CHECK(peer.rxCount == 0);
+	CanTp_MainFunction(&link, 50 + CANTP_N_CR_TIMEOUT);
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_TIMEOUT_CR);
+	TEST_CHECK(peer.rxLength == 6 + 3 * 7);
+	TEST_CHECK(link.rx.state == CANTP_RX_IDLE);
+}
+
+static void Test_TimeoutAr(void){
+	Test_Setup();
+	peer.busy = true;
+	Peer_SendFf(100, 0);
+	TEST_CHECK(link.rx.fcPending);
+
+	CanTp_MainFunction(&link, CANTP_N_AR_TIMEOUT - 1);
+	TEST_CHECK(peer.rxCount == 0);
+	CanTp_MainFunction(&link, CANTP_N_AR_TIMEOUT);
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_TIMEOUT_A);
+}
+
+
+/* Test cases: 32-bit FF_DL escape */
+
+static void Test_EscapeTransmit(void){
+	const uint32_t length = 4096;
+	Peer_Frame_t f;
+	uint32_t offset = 2;
+	uint8_t sn = 1;
+	uint32_t now = 1;
+
+	Test_Setup();
+	(void)CanTp_Transmit(&link, message, length, 0);
+
+	TEST_CHECK(Peer_Pop(&f));
+	TEST_CHECK(f.data[0] == CANTP_PCI_FF && f.data[1] == 0x00);
+	TEST_CHECK(f.data[2] == 0x00 && f.data[3] == 0x00 && f.data[4] == 0x10 && f.data[5] == 0x00);
+	TEST_CHECK(f.data[6] == message[0] && f.data[7] == message[1]);
+
+	/* BS = 8 so the capture queue never fills */
+	Peer_SendFc(CANTP_FS_CTS, 8, 0, now);
+	while(offset < length){
+		if(peer.count == 0){
+			TEST_CHECK(link.tx.state == CANTP_TX_WAIT_FC);
+			if(link.tx.state != CANTP_TX_WAIT_FC) break;
+			Peer_SendFc(CANTP_FS_CTS, 8, 0, ++now);
+			continue;
+		}
+		TEST_CHECK(Peer_ExpectCf(sn, offset, length));
+		offset += 7;
+		sn = (sn + 1) & 0x0F;
+	}
+	TEST_CHECK(peer.txCount == 1 && peer.txResult == CANTP_N_OK);
+}
+
+static void Test_EscapeReceive(void){
+	const uint32_t length = TEST_MSG_MAX;
+	uint8_t ff[CANTP_CAN_DL];
+
+	Test_Setup();
+	ff[0] = CANTP_PCI_FF;
+	ff[1] = 0;
+	ff[2] = (uint8_t)(length >> 24);
+	ff[3] = (uint8_t)(length >> 16);
+	ff[4] = (uint8_t)(length >> 8);
+	ff[5] = (uint8_t)length;
+	ff[6] = message[0];
+	ff[7] = message[1];
+	Peer_Inject(ff, CANTP_CAN_DL, 0);
+
+	TEST_CHECK(link.rx.length == length);
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_CTS, CANTP_RX_BLOCK_SIZE, CANTP_RX_STMIN));
+	(void)Peer_SendCfs(1, 2, length, length, 1);
+
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_OK && peer.rxLength == length);
+	TEST_CHECK(memcmp(rxBuffer, message, length) == 0);
+}
+
+static void Test_EscapeShortIgnored(void){
+	/* The escape is only valid for FF_DL above 4095 */
+	const uint8_t ff[] = { 0x10, 0x00, 0x00, 0x00, 0x0F, 0xFF, 1, 2 };
+
+	Test_Setup();
+	Peer_Inject(ff, sizeof(ff), 0);
+
+	TEST_CHECK(link.rx.state == CANTP_RX_IDLE && peer.count == 0);
+}
+
+static void Test_EscapeOverflow(void){
+	/* 70000 bytes do not fit the 5000 byte buffer */
+	const uint8_t ff[] = { 0x10, 0x00, 0x00, 0x01, 0x11, 0x70, 1, 2 };
+
+	Test_Setup();
+	Peer_Inject(ff, sizeof(ff), 0);
+
+	TEST_CHECK(Peer_ExpectFc(CANTP_FS_OVFLW, 0, 0));
+	TEST_CHECK(peer.rxCount == 1 && peer.rxResult == CANTP_N_BUFFER_OVFLW);
+}
+
+
+int main(void){
+	TEST_RUN(Test_SfTransmit);
+	TEST_RUN(Test_SfReceive);
+	TEST_RUN(Test_SfInvalidLength);
+
+	TEST_RUN(Test_FfCfTransmit);
+	TEST_RUN(Test_FfCfReceive);
+	TEST_RUN(Test_FfTruncatedIgnored);
+	TEST_RUN(Test_WrongSequenceNumber);
+	TEST_RUN(Test_UnexpectedSfDuringReception);
+	TEST_RUN(Test_UnexpectedCfIgnored);
+
+	TEST_RUN(Test_BlockSizeTransmit);
+	TEST_RUN(Test_BlockSizeReceive);
+	TEST_RUN(Test_StMinTransmit);
+	TEST_RUN(Test_StMinMicroseconds);
+	TEST_RUN(Test_StMinEncoding);
+
+	TEST_RUN(Test_FcWaitTransmit);
+	TEST_RUN(Test_FcWaitOverrun);
+	TEST_RUN(Test_FcOverflowTransmit);
+	TEST_RUN(Test_FcInvalidStatus);
+	TEST_RUN(Test_FcUnexpectedIgnored);
+	TEST_RUN(Test_FcOverflowReceive);
+	TEST_RUN(Test_RxHold);
+	TEST_RUN(Test_RxHoldOverrun);
+	TEST_RUN(Test_DeferredBufferOverflow);
+	TEST_RUN(Test_DeferredTooLarge);
+
+	TEST_RUN(Test_TimeoutAs);
+	TEST_RUN(Test_TimeoutAsRecovered);
+	TEST_RUN(Test_TimeoutBs);
+	TEST_RUN(Test_TimeoutBsBetweenBlocks);
+	TEST_RUN(Test_TimeoutCr);
+	TEST_RUN(Test_TimeoutAr);
+
+	TEST_RUN(Test_EscapeTransmit);
+	TEST_RUN(Test_EscapeReceive);
+	TEST_RUN(Test_EscapeShortIgnored);
+	TEST_RUN(Test_EscapeOverflow);
+
+	return Test_Result();
+}
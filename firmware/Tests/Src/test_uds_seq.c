@@ -0,0 +1,628 @@
+/*
+ * test_uds_seq.c
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Sequence executor against the simulated ECU.
+ *
+ * Programs are built with the assembler of seq_asm.h and run by uds_seq
+ * through the real client (uds_services, CanTp channels). The ECU is
+ * uds_server with its example database. Both ends share one emulated bus:
+ * every frame queued by either side is delivered on the next millisecond,
+ * then the tasks run in the order of Diag_MainFunction(). IDs nobody
+ * answers on stand for an ECU that is not there. A few cases drive the
+ * client directly, without a program.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../Inc/test.h"
+#include "../Inc/seq_asm.h"
+#include "../../Core/Src/Com/CanTp/Inc/cantp_ch.h"
+#include "../../Core/Src/Uds/Inc/uds_server.h"
+
+/* Defines */
+#define ECU_TX_ID        ((uint32_t) 0x7E0)
+#define ECU_RX_ID        ((uint32_t) 0x7E8)
+#define ABSENT_TX_ID     ((uint32_t) 0x7E1)
+#define ABSENT_RX_ID     ((uint32_t) 0x7E9)
+#define BUS_QUEUE_SIZE   ((uint32_t) 256)
+#define TEST_EMITS_MAX   ((uint8_t) 8)
+#define TEST_RUN_MAX_MS  ((uint32_t) 2000)
+
+/* Structures */
+typedef struct{
+	uint32_t id;
+	uint8_t data[CANTP_CAN_DL];
+	uint8_t dlc;
+}Bus_Frame_t;
+
+typedef struct{
+	uint8_t tag;
+	uint8_t data[UDS_SEQ_OUT_MAX];
+	uint16_t length;
+}Test_Emit_t;
+
+/* Variables */
+static Bus_Frame_t bus[BUS_QUEUE_SIZE];
+static uint32_t busCount;
+static uint32_t now;
+static SeqAsm_t a;
+static Test_Emit_t emits[TEST_EMITS_MAX];
+static uint8_t emitCount;
+/* EMITs the sink refuses before it takes one */
+static uint8_t sinkRefuse;
+static UdsSeq_Report_t report;
+static uint8_t reports;
+static Uds_Response_t clientRsp;
+static uint8_t clientRsps;
+/* Last ECU response to a functional request, with its first byte */
+static Uds_Response_t functionalRsp;
+static uint8_t functionalSid;
+static uint8_t functionalRsps;
+
+static const uint8_t vin[] = { 'W', 'V', 'W', 'Z', 'Z', 'Z', '1', 'J', 'Z', 'X', 'W', '0', '0', '0', '0', '0', '1' };
+
+
+/* Private functions */
+
+static bool Bus_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc){
+	if(busCount >= BUS_QUEUE_SIZE) return false;
+
+	bus[busCount].id = id;
+	bus[busCount].dlc = dlc;
+	memcpy(bus[busCount].data, data, dlc);
+	busCount++;
+
+	return true;
+}
+
+/* One millisecond: frames sent in the previous one arrive, then the tasks run */
+static void Bus_Tick(void){
+	Bus_Frame_t frames[BUS_QUEUE_SIZE];
+	const uint32_t count = busCount;
+
+	memcpy(frames, bus, count * sizeof(bus[0]));
+	busCount = 0;
+
+	Uds_SetTime(now);
+	for(uint32_t i = 0; i < count; i++){
+		if(UdsServer_RxFrame(frames[i].id, frames[i].data, frames[i].dlc, now)) continue;
+		(void)CanTpCh_RxFrame(frames[i].id, frames[i].data, frames[i].dlc, now);
+	}
+	CanTpCh_MainFunction(now);
+	Uds_MainFunction(now);
+	UdsServer_MainFunction(now);
+	UdsSeq_MainFunction(now);
+	now++;
+}
+
+static bool Test_Sink(uint8_t tag, const uint8_t* data, uint16_t len, void* context){
+	(void)context;
+
+	if(sinkRefuse > 0){
+		sinkRefuse--;
+		return false;
+	}
+	if(emitCount >= TEST_EMITS_MAX) return false;
+
+	emits[emitCount].tag = tag;
+	emits[emitCount].length = len;
+	memcpy(emits[emitCount].data, data, len);
+	emitCount++;
+
+	return true;
+}
+
+static void Test_Done(const UdsSeq_Report_t* r, void* context){
+	(void)context;
+
+	report = *r;
+	reports++;
+}
+
+static void Test_Client(const Uds_Response_t* rsp, void* context){
+	(void)context;
+
+	clientRsp = *rsp;
+	clientRsps++;
+}
+
+static void Test_FunctionalSink(const Uds_Response_t* rsp, void* context){
+	(void)context;
+
+	functionalRsp = *rsp;
+	functionalSid = rsp->data[0];
+	functionalRsps++;
+}
+
+static void Test_Setup(void){
+	const UdsServer_Config_t config = { .rxId = ECU_TX_ID, .txId = ECU_RX_ID, .functionalId = 0, .db = &udsServerDb };
+
+	busCount = 0;
+	now = 1000;
+	emitCount = 0;
+	sinkRefuse = 0;
+	reports = 0;
+	memset(&report, 0, sizeof(report));
+	clientRsps = 0;
+	functionalRsps = 0;
+
+	(void)CanTpCh_Init(Bus_SendFrame);
+	TEST_CHECK(Uds_Init());
+	UdsServer_Stop();
+	UdsServer_Init(Bus_SendFrame, NULL);
+	TEST_CHECK(UdsServer_Start(&config, now) == UDS_OK);
+	UdsSeq_Init();
+
+	SeqAsm_Init(&a);
+}
+
+/* Loads and starts the assembled program, runs the bus until it ends */
+static bool Test_Run(void){
+	uint16_t errorPc = 0xFFFF;
+
+	if(a.overflow || UdsSeq_Load(a.code, a.length, &errorPc) != UDS_OK) return false;
+	if(UdsSeq_Start(Test_Sink, Test_Done, NULL, now) != UDS_OK) return false;
+
+	for(uint32_t t = 0; t < TEST_RUN_MAX_MS && reports == 0; t++){
+		Bus_Tick();
+	}
+
+	return reports == 1;
+}
+
+static bool Test_Reg(const uint8_t* p, int32_t value){
+	return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24)) == value;
+}
+
+/* Load check: false if the program is accepted or the error is reported elsewhere */
+static bool Test_Rejected(const uint8_t* code, uint16_t length, uint16_t pc){
+	uint16_t errorPc = 0xFFFF;
+
+	return UdsSeq_Load(code, length, &errorPc) == UDS_NOT_OK && errorPc == pc;
+}
+
+
+/* Programs running to their end */
+
+static void Test_ReadLoop(void){
+	const uint8_t readVin[] = { SID_READ_DATA_BY_ID, 0xF1, 0x90 };
+	const uint8_t countDtc[] = { SID_READ_DTC_INFO, REPORT_NUMBER_OF_DTC_BY_STATUS_MASK, 0xFF };
+	uint16_t loop;
+	uint16_t fail;
+	uint16_t end;
+
+	Test_Setup();
+	SeqAsm_Target(&a, ECU_TX_ID, ECU_RX_ID);
+	SeqAsm_Set(&a, 1, 3);
+	loop = SeqAsm_Here(&a);
+	SeqAsm_Send(&a, readVin, sizeof(readVin));
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_Cmp(&a, 0, UDS_RESULT_POSITIVE);
+	fail = SeqAsm_Br(&a, UDS_SEQ_NE, 0);
+	/* VIN after 62 F1 90, then the loop counter */
+	SeqAsm_Store(&a, 3, sizeof(vin));
+	SeqAsm_StoreReg(&a, 1);
+	SeqAsm_Emit(&a, 1);
+	(void)SeqAsm_Loop(&a, 1, loop);
+	SeqAsm_Send(&a, countDtc, sizeof(countDtc));
+	SeqAsm_Wait(&a, 0);
+	/* 59 01 availability format count:2 */
+	SeqAsm_Load(&a, 2, 4, 2);
+	SeqAsm_StoreReg(&a, 2);
+	SeqAsm_Emit(&a, 2);
+	end = SeqAsm_Here(&a);
+	SeqAsm_End(&a);
+	SeqAsm_Patch(&a, fail, SeqAsm_Here(&a));
+	SeqAsm_StoreReg(&a, 0);
+	SeqAsm_Emit(&a, 0xEE);
+	SeqAsm_End(&a);
+
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_DONE && report.fault == UDS_SEQ_FAULT_NONE && report.pc == end);
+	TEST_CHECK(report.requests == 4);
+	TEST_CHECK(emitCount == 4);
+	for(uint8_t i = 0; i < 3 && i < emitCount; i++){
+		TEST_CHECK(emits[i].tag == 1 && emits[i].length == sizeof(vin) + 4);
+		TEST_CHECK(memcmp(emits[i].data, vin, sizeof(vin)) == 0);
+		TEST_CHECK(Test_Reg(&emits[i].data[sizeof(vin)], 3 - i));
+	}
+	TEST_CHECK(emitCount < 4 || (emits[3].tag == 2 && emits[3].length == 4 && Test_Reg(emits[3].data, 3)));
+}
+
+static void Test_SessionBranch(void){
+	const uint8_t extended[] = { SID_DIAGNOSTIC_SESSION_CONTROL, EXTENDED_DIAGNOSTIC_SESSION };
+	const uint8_t readSession[] = { SID_READ_DATA_BY_ID, 0xF1, 0x86 };
+	uint16_t ok;
+
+	Test_Setup();
+	SeqAsm_Target(&a, ECU_TX_ID, ECU_RX_ID);
+	SeqAsm_Send(&a, extended, sizeof(extended));
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_Send(&a, readSession, sizeof(readSession));
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_Load(&a, 1, 3, 1);
+	SeqAsm_Cmp(&a, 1, EXTENDED_DIAGNOSTIC_SESSION);
+	ok = SeqAsm_Br(&a, UDS_SEQ_EQ, 0);
+	SeqAsm_Emit(&a, 0xEE);
+	SeqAsm_End(&a);
+	SeqAsm_Patch(&a, ok, SeqAsm_Here(&a));
+	SeqAsm_Emit(&a, 0x03);
+	SeqAsm_End(&a);
+
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_DONE);
+	TEST_CHECK(emitCount == 1 && emits[0].tag == 0x03 && emits[0].length == 0);
+	/* The client tracked the session from the response */
+	TEST_CHECK(Uds_GetSession(ECU_TX_ID) == EXTENDED_DIAGNOSTIC_SESSION);
+}
+
+static void Test_NegativeResponse(void){
+	const uint8_t unknownDid[] = { SID_READ_DATA_BY_ID, 0x12, 0x34 };
+
+	Test_Setup();
+	SeqAsm_Target(&a, ECU_TX_ID, ECU_RX_ID);
+	SeqAsm_Send(&a, unknownDid, sizeof(unknownDid));
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_Len(&a, 1);
+	/* 7F 22 NRC */
+	SeqAsm_Load(&a, 2, 2, 1);
+	SeqAsm_StoreReg(&a, 0);
+	SeqAsm_StoreReg(&a, 1);
+	SeqAsm_StoreReg(&a, 2);
+	SeqAsm_Emit(&a, 0x7F);
+	SeqAsm_End(&a);
+
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_DONE);
+	TEST_CHECK(emitCount == 1 && emits[0].length == 12);
+	TEST_CHECK(Test_Reg(&emits[0].data[0], UDS_RESULT_NEGATIVE));
+	TEST_CHECK(Test_Reg(&emits[0].data[4], 3));
+	TEST_CHECK(Test_Reg(&emits[0].data[8], NRC_REQUEST_OUT_OF_RANGE));
+}
+
+static void Test_ResponsePending(void){
+	const uint8_t reset[] = { SID_ECU_RESET, HARD_RESET };
+	const uint8_t rsp[] = { 0x51, HARD_RESET };
+
+	/* The example database answers the reset after 100 ms, with NRC 0x78 first */
+	Test_Setup();
+	SeqAsm_Target(&a, ECU_TX_ID, ECU_RX_ID);
+	SeqAsm_Send(&a, reset, sizeof(reset));
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_Store(&a, 0, sizeof(rsp));
+	SeqAsm_Emit(&a, 1);
+	SeqAsm_End(&a);
+
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_DONE && report.duration >= 100);
+	TEST_CHECK(emitCount == 1 && emits[0].length == sizeof(rsp) && memcmp(emits[0].data, rsp, sizeof(rsp)) == 0);
+}
+
+static void Test_Timeout(void){
+	const uint8_t tp[] = { SID_TESTER_PRESENT, 0x00 };
+
+	Test_Setup();
+	SeqAsm_Target(&a, ABSENT_TX_ID, ABSENT_RX_ID);
+	SeqAsm_Send(&a, tp, sizeof(tp));
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_Len(&a, 1);
+	SeqAsm_StoreReg(&a, 0);
+	SeqAsm_StoreReg(&a, 1);
+	SeqAsm_Emit(&a, 1);
+	SeqAsm_End(&a);
+
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_DONE && report.duration >= UDS_P2_CLIENT);
+	TEST_CHECK(emitCount == 1 && Test_Reg(&emits[0].data[0], UDS_RESULT_TIMEOUT) && Test_Reg(&emits[0].data[4], 0));
+}
+
+static void Test_Delay(void){
+	Test_Setup();
+	SeqAsm_Delay(&a, 50);
+	SeqAsm_End(&a);
+
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_DONE && report.duration == 50 && report.steps == 1);
+}
+
+static void Test_SinkRefuses(void){
+	Test_Setup();
+	SeqAsm_Set(&a, 0, 0x11223344);
+	SeqAsm_StoreReg(&a, 0);
+	SeqAsm_Emit(&a, 9);
+	SeqAsm_End(&a);
+
+	/* The EMIT is retried on the next passes */
+	sinkRefuse = 2;
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_DONE && report.steps == 3 && report.duration == 2);
+	TEST_CHECK(emitCount == 1 && emits[0].tag == 9 && emits[0].length == 4 && Test_Reg(emits[0].data, 0x11223344));
+}
+
+
+/* Load checks */
+
+static void Test_LoadRejected(void){
+	const uint8_t unknownOp[] = { UDS_SEQ_OP_SET, 0, 0, 0, 0, 0, 0x0F };
+	const uint8_t badReg[] = { UDS_SEQ_OP_SET, UDS_SEQ_REGS, 0, 0, 0, 0, UDS_SEQ_OP_END };
+	const uint8_t midBranch[] = { UDS_SEQ_OP_SET, 0, 0, 0, 0, 0, UDS_SEQ_OP_BR, UDS_SEQ_ALWAYS, 1, 0 };
+	const uint8_t farBranch[] = { UDS_SEQ_OP_LOOP, 0, 100, 0, UDS_SEQ_OP_END };
+	const uint8_t badCond[] = { UDS_SEQ_OP_BR, UDS_SEQ_LE + 1, 0, 0 };
+	const uint8_t cutSend[] = { UDS_SEQ_OP_END, UDS_SEQ_OP_SEND, 5, SID_TESTER_PRESENT };
+	const uint8_t emptySend[] = { UDS_SEQ_OP_SEND, 0, UDS_SEQ_OP_END };
+	const uint8_t loadSize[] = { UDS_SEQ_OP_END, UDS_SEQ_OP_LOAD, 0, 0, 0, 5 };
+	const uint8_t cutOperand[] = { UDS_SEQ_OP_END, UDS_SEQ_OP_DELAY, 10 };
+
+	Test_Setup();
+	TEST_CHECK(Test_Rejected(unknownOp, sizeof(unknownOp), 6));
+	TEST_CHECK(Test_Rejected(badReg, sizeof(badReg), 0));
+	TEST_CHECK(Test_Rejected(midBranch, sizeof(midBranch), 6));
+	TEST_CHECK(Test_Rejected(farBranch, sizeof(farBranch), 0));
+	TEST_CHECK(Test_Rejected(badCond, sizeof(badCond), 0));
+	TEST_CHECK(Test_Rejected(cutSend, sizeof(cutSend), 1));
+	TEST_CHECK(Test_Rejected(emptySend, sizeof(emptySend), 0));
+	TEST_CHECK(Test_Rejected(loadSize, sizeof(loadSize), 1));
+	TEST_CHECK(Test_Rejected(cutOperand, sizeof(cutOperand), 1));
+	TEST_CHECK(UdsSeq_Load(unknownOp, 0, NULL) == UDS_NOT_OK);
+	TEST_CHECK(UdsSeq_Load(a.code, UDS_SEQ_CODE_MAX + 1, NULL) == UDS_NOT_OK);
+
+	/* Nothing valid loaded */
+	TEST_CHECK(UdsSeq_Start(Test_Sink, Test_Done, NULL, now) == UDS_NOT_OK);
+
+	/* A running program cannot be replaced */
+	SeqAsm_Delay(&a, 10);
+	SeqAsm_End(&a);
+	TEST_CHECK(UdsSeq_Load(a.code, a.length, NULL) == UDS_OK);
+	TEST_CHECK(UdsSeq_Start(Test_Sink, Test_Done, NULL, now) == UDS_OK);
+	Bus_Tick();
+	TEST_CHECK(UdsSeq_Load(a.code, a.length, NULL) == UDS_BUSY);
+	TEST_CHECK(UdsSeq_Start(Test_Sink, Test_Done, NULL, now) == UDS_BUSY);
+	for(uint8_t t = 0; t < 10; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(reports == 1 && report.result == UDS_SEQ_DONE);
+}
+
+static void Test_AssemblerOverflow(void){
+	const uint8_t tp[] = { SID_TESTER_PRESENT, 0x00 };
+
+	SeqAsm_Init(&a);
+	while(!a.overflow){
+		SeqAsm_Send(&a, tp, sizeof(tp));
+	}
+	TEST_CHECK(a.length == UDS_SEQ_CODE_MAX);
+	TEST_CHECK(!Test_Run());
+}
+
+
+/* Run time faults */
+
+static void Test_FaultRange(void){
+	const uint8_t tp[] = { SID_TESTER_PRESENT, 0x00 };
+	uint16_t pc;
+
+	/* No response yet */
+	Test_Setup();
+	SeqAsm_Load(&a, 0, 0, 1);
+	SeqAsm_End(&a);
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_FAULT && report.fault == UDS_SEQ_FAULT_RANGE && report.pc == 0);
+
+	/* 7E 00 is two bytes long */
+	Test_Setup();
+	SeqAsm_Target(&a, ECU_TX_ID, ECU_RX_ID);
+	SeqAsm_Send(&a, tp, sizeof(tp));
+	SeqAsm_Wait(&a, 0);
+	pc = SeqAsm_Here(&a);
+	SeqAsm_Store(&a, 1, 2);
+	SeqAsm_End(&a);
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_FAULT && report.fault == UDS_SEQ_FAULT_RANGE && report.pc == pc);
+	TEST_CHECK(report.requests == 1);
+}
+
+static void Test_FaultOutput(void){
+	uint16_t loop;
+
+	/* UDS_SEQ_OUT_MAX / 4 registers fit, the next one does not */
+	Test_Setup();
+	SeqAsm_Set(&a, 1, UDS_SEQ_OUT_MAX / 4 + 1);
+	loop = SeqAsm_Here(&a);
+	SeqAsm_StoreReg(&a, 1);
+	(void)SeqAsm_Loop(&a, 1, loop);
+	SeqAsm_End(&a);
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_FAULT && report.fault == UDS_SEQ_FAULT_OUTPUT && report.pc == loop);
+	TEST_CHECK(report.steps == 1 + 2 * (UDS_SEQ_OUT_MAX / 4));
+}
+
+static void Test_FaultState(void){
+	const uint8_t tp[] = { SID_TESTER_PRESENT, 0x00 };
+	uint16_t pc;
+
+	/* WAIT without a request */
+	Test_Setup();
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_End(&a);
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_FAULT && report.fault == UDS_SEQ_FAULT_STATE && report.pc == 0);
+
+	/* A second SEND before the response was taken */
+	Test_Setup();
+	SeqAsm_Target(&a, ECU_TX_ID, ECU_RX_ID);
+	SeqAsm_Send(&a, tp, sizeof(tp));
+	pc = SeqAsm_Here(&a);
+	SeqAsm_Send(&a, tp, sizeof(tp));
+	SeqAsm_End(&a);
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_FAULT && report.fault == UDS_SEQ_FAULT_STATE && report.pc == pc);
+}
+
+static void Test_FaultRequest(void){
+	const uint8_t tooShort[] = { SID_DIAGNOSTIC_SESSION_CONTROL };
+	uint16_t pc;
+
+	/* Refused by the service table of the client */
+	Test_Setup();
+	SeqAsm_Target(&a, ECU_TX_ID, ECU_RX_ID);
+	pc = SeqAsm_Here(&a);
+	SeqAsm_Send(&a, tooShort, sizeof(tooShort));
+	SeqAsm_End(&a);
+	TEST_CHECK(Test_Run());
+	TEST_CHECK(report.result == UDS_SEQ_FAULT && report.fault == UDS_SEQ_FAULT_REQUEST && report.pc == pc);
+	TEST_CHECK(report.requests == 0);
+}
+
+static void Test_StepBudget(void){
+	uint16_t loop;
+
+	/* An endless loop only takes its steps per pass */
+	Test_Setup();
+	loop = SeqAsm_Here(&a);
+	(void)SeqAsm_Br(&a, UDS_SEQ_ALWAYS, loop);
+	TEST_CHECK(UdsSeq_Load(a.code, a.length, NULL) == UDS_OK);
+	TEST_CHECK(UdsSeq_Start(Test_Sink, Test_Done, NULL, now) == UDS_OK);
+	Bus_Tick();
+	Bus_Tick();
+	TEST_CHECK(UdsSeq_IsRunning() && reports == 0);
+
+	UdsSeq_Stop();
+	TEST_CHECK(!UdsSeq_IsRunning() && reports == 1);
+	TEST_CHECK(report.result == UDS_SEQ_STOPPED && report.steps == 2 * UDS_SEQ_STEPS_PER_PASS);
+}
+
+static void Test_StopOutstanding(void){
+	const uint8_t tp[] = { SID_TESTER_PRESENT, 0x00 };
+
+	/* Stopped while waiting: no new program until the request is over */
+	Test_Setup();
+	SeqAsm_Target(&a, ABSENT_TX_ID, ABSENT_RX_ID);
+	SeqAsm_Send(&a, tp, sizeof(tp));
+	SeqAsm_Wait(&a, 0);
+	SeqAsm_End(&a);
+	TEST_CHECK(UdsSeq_Load(a.code, a.length, NULL) == UDS_OK);
+	TEST_CHECK(UdsSeq_Start(Test_Sink, Test_Done, NULL, now) == UDS_OK);
+	Bus_Tick();
+	UdsSeq_Stop();
+	TEST_CHECK(reports == 1 && report.result == UDS_SEQ_STOPPED && report.requests == 1);
+	TEST_CHECK(UdsSeq_Load(a.code, a.length, NULL) == UDS_BUSY);
+	TEST_CHECK(UdsSeq_Start(Test_Sink, Test_Done, NULL, now) == UDS_BUSY);
+
+	for(uint32_t t = 0; t < 2 * UDS_P2_CLIENT; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(reports == 1);
+	TEST_CHECK(UdsSeq_Load(a.code, a.length, NULL) == UDS_OK);
+}
+
+
+/* The client without a program */
+static void Test_ClientNoSyncCallback(void){
+	const uint8_t tp[] = { SID_TESTER_PRESENT, SUPPRESS_POS_RSP_MSG_INDICATION_BIT };
+
+	/* Confirmed by ISO-TP at once, reported on the next pass */
+	Test_Setup();
+	TEST_CHECK(Uds_Request(ECU_TX_ID, ECU_RX_ID, tp, sizeof(tp), Test_Client, NULL, now) == UDS_OK);
+	TEST_CHECK(clientRsps == 0);
+	Bus_Tick();
+	TEST_CHECK(clientRsps == 1 && clientRsp.result == UDS_RESULT_POSITIVE);
+}
+
+static void Test_ClientChannelWait(void){
+	const uint8_t readVin[] = { SID_READ_DATA_BY_ID, 0xF1, 0x90 };
+	CanTp_Link_t* held;
+
+	/* ID pair held by another module: queued until it is released */
+	Test_Setup();
+	held = CanTpCh_Open(ECU_TX_ID, ECU_RX_ID, NULL, NULL, NULL);
+	TEST_CHECK(held != NULL);
+	TEST_CHECK(Uds_Request(ECU_TX_ID, ECU_RX_ID, readVin, sizeof(readVin), Test_Client, NULL, now) == UDS_OK);
+	for(uint32_t t = 0; t < 100; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(clientRsps == 0 && Uds_OutstandingCount() == 1);
+	CanTpCh_Close(held);
+	for(uint32_t t = 0; t < 100 && clientRsps == 0; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(clientRsps == 1 && clientRsp.result == UDS_RESULT_POSITIVE);
+
+	/* Never released: fails once the wait is over */
+	Test_Setup();
+	held = CanTpCh_Open(ECU_TX_ID, ECU_RX_ID, NULL, NULL, NULL);
+	TEST_CHECK(Uds_Request(ECU_TX_ID, ECU_RX_ID, readVin, sizeof(readVin), Test_Client, NULL, now) == UDS_OK);
+	for(uint32_t t = 0; t <= UDS_CLIENT_LINK_WAIT && clientRsps == 0; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(clientRsps == 1 && clientRsp.result == UDS_RESULT_TX_ERROR);
+	CanTpCh_Close(held);
+}
+
+static void Test_ClientFunctional(void){
+	const UdsServer_Config_t config = { .rxId = ECU_TX_ID, .txId = ECU_RX_ID, .functionalId = BROADCAST_REQUEST_ID, .db = &udsServerDb };
+	const uint8_t readVin[] = { SID_READ_DATA_BY_ID, 0xF1, 0x90 };
+	const uint8_t tp[] = { SID_TESTER_PRESENT, 0x00 };
+	uint32_t start;
+
+	/* Multi-frame answer on the client's channel of the ECU, window of P2 */
+	Test_Setup();
+	UdsServer_Stop();
+	TEST_CHECK(UdsServer_Start(&config, now) == UDS_OK);
+	start = now;
+	TEST_CHECK(Uds_RequestFunctional(readVin, sizeof(readVin), Test_FunctionalSink, Test_Client, NULL, now) == UDS_OK);
+	/* Queued after it: waits for the window to close */
+	TEST_CHECK(Uds_Request(ECU_TX_ID, ECU_RX_ID, tp, sizeof(tp), Test_Client, NULL, now) == UDS_OK);
+	for(uint32_t t = 0; t < 2 * UDS_P2_CLIENT && clientRsps == 0; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(functionalRsps == 1 && functionalRsp.result == UDS_RESULT_POSITIVE && functionalSid == 0x62);
+	TEST_CHECK(functionalRsp.txId == ECU_TX_ID && functionalRsp.rxId == ECU_RX_ID && functionalRsp.length == 3 + sizeof(vin));
+	TEST_CHECK(clientRsps == 1 && clientRsp.txId == BROADCAST_REQUEST_ID && clientRsp.result == UDS_RESULT_POSITIVE);
+	TEST_CHECK(now - start >= UDS_P2_CLIENT);
+	for(uint32_t t = 0; t < 100 && clientRsps == 1; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(clientRsps == 2 && clientRsp.txId == ECU_TX_ID && clientRsp.result == UDS_RESULT_POSITIVE);
+
+	/* Queued behind a physical request, no ECU listens functionally */
+	Test_Setup();
+	TEST_CHECK(Uds_Request(ECU_TX_ID, ECU_RX_ID, readVin, sizeof(readVin), Test_Client, NULL, now) == UDS_OK);
+	TEST_CHECK(Uds_RequestFunctional(tp, sizeof(tp), Test_FunctionalSink, Test_Client, NULL, now) == UDS_OK);
+	for(uint32_t t = 0; t < 4 * UDS_P2_CLIENT && clientRsps < 2; t++){
+		Bus_Tick();
+	}
+	TEST_CHECK(clientRsps == 2 && clientRsp.txId == BROADCAST_REQUEST_ID && clientRsp.result == UDS_RESULT_TIMEOUT);
+	TEST_CHECK(functionalRsps == 0);
+	TEST_CHECK(Uds_RequestFunctional(tp, sizeof(tp), NULL, NULL, NULL, now) == UDS_NOT_OK);
+}
+
+
+int main(void){
+	TEST_RUN(Test_ReadLoop);
+	TEST_RUN(Test_SessionBranch);
+	TEST_RUN(Test_NegativeResponse);
+	TEST_RUN(Test_ResponsePending);
+	TEST_RUN(Test_Timeout);
+	TEST_RUN(Test_Delay);
+	TEST_RUN(Test_SinkRefuses);
+
+	TEST_RUN(Test_LoadRejected);
+	TEST_RUN(Test_AssemblerOverflow);
+
+	TEST_RUN(Test_FaultRange);
+	TEST_RUN(Test_FaultOutput);
+	TEST_RUN(Test_FaultState);
+	TEST_RUN(Test_FaultRequest);
+	TEST_RUN(Test_StepBudget);
+	TEST_RUN(Test_StopOutstanding);
+
+	TEST_RUN(Test_ClientNoSyncCallback);
+	TEST_RUN(Test_ClientChannelWait);
+	TEST_RUN(Test_ClientFunctional);
+
+	return Test_Result();
+}
@@ -0,0 +1,492 @@
+/*
+ * test_uds_server.c
+ *
+ *  Created on: Aug 19, 2025
+ *      Author: Josu Alexandru
+ *
+ * @brief Simulated ECU against a hand-driven client.
+ *
+ * The server sends through a captured frame queue and registers its IDs
+ * with a recording filter, in place of CanIf. The client is the test
+ * itself: requests go in as single frames, responses are reassembled from
+ * the captured frames (a FF is answered with FC CTS, BS = 0). Positive
+ * responses are also checked with the parser of the client's dispatch
+ * table, so both ends agree on the formats.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "../Inc/test.h"
+#include "../../Core/Src/Uds/Inc/uds_server.h"
+#include "../../Core/Src/Uds/Inc/uds_dispatch.h"
+
+/* Defines */
+#define TEST_RX_ID         ((uint32_t) 0x7E0)
+#define TEST_TX_ID         ((uint32_t) 0x7E8)
+#define TEST_FUNCTIONAL_ID ((uint32_t) BROADCAST_REQUEST_ID)
+#define CLIENT_QUEUE_SIZE  ((uint32_t) 256)
+#define CLIENT_FILTERS     ((uint8_t) 4)
+
+/* Structures */
+typedef struct{
+	uint32_t id;
+	uint8_t data[CANTP_CAN_DL];
+	uint8_t dlc;
+}Client_Frame_t;
+
+typedef struct{
+	/* Frames queued by the server, oldest first */
+	Client_Frame_t frames[CLIENT_QUEUE_SIZE];
+	uint32_t head;
+	uint32_t count;
+	/* IDs the server has registered; the filter refuses once full */
+	uint32_t filters[CLIENT_FILTERS];
+	uint8_t filterCount;
+	uint8_t filterLimit;
+	/* Last reassembled response */
+	uint8_t rsp[UDS_SERVER_RESPONSE_MAX];
+	uint32_t rspLength;
+}Client_t;
+
+/* Variables */
+static Client_t client;
+
+/* TesterPresent with a delay inside P2 and ReadDTCInformation with one
+ * that needs several NRC 0x78 */
+static const UdsServer_Delay_t testDelays[] = {
+	{ SID_TESTER_PRESENT,  30 },
+	{ SID_READ_DTC_INFO,   5000 }
+};
+
+static UdsServer_Db_t testDb;
+
+
+/* Private functions */
+
+static bool Client_SendFrame(uint32_t id, const uint8_t* data, uint8_t dlc){
+	if(client.head + client.count >= CLIENT_QUEUE_SIZE) return false;
+
+	Client_Frame_t* const f = &client.frames[client.head + client.count++];
+
+	f->id = id;
+	f->dlc = dlc;
+	memcpy(f->data, data, dlc);
+
+	return true;
+}
+
+static bool Client_Filter(uint32_t id, bool enable){
+	if(enable){
+		if(client.filterCount >= client.filterLimit) return false;
+		client.filters[client.filterCount++] = id;
+		return true;
+	}
+
+	for(uint8_t i = 0; i < client.filterCount; i++){
+		if(client.filters[i] == id){
+			client.filters[i] = client.filters[--client.filterCount];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool Client_Registered(uint32_t id){
+	for(uint8_t i = 0; i < client.filterCount; i++){
+		if(client.filters[i] == id) return true;
+	}
+
+	return false;
+}
+
+/* Takes the oldest frame sent by the server; false if there is none */
+static bool Client_Pop(Client_Frame_t* f){
+	if(client.count == 0) return false;
+
+	*f = client.frames[client.head++];
+	if(--client.count == 0){
+		client.head = 0;
+	}
+
+	return true;
+}
+
+static void Client_Request(uint32_t id, const uint8_t* req, uint8_t length, uint32_t now){
+	uint8_t frame[CANTP_CAN_DL];
+
+	memset(frame, CANTP_PADDING_BYTE, sizeof(frame));
+	frame[0] = (uint8_t)(CANTP_PCI_SF | length);
+	memcpy(&frame[1], req, length);
+	(void)UdsServer_RxFrame(id, frame, CANTP_CAN_DL, now);
+}
+
+/* Reassembles the next response into client.rsp; false if nothing was sent */
+static bool Client_Response(uint32_t now){
+	Client_Frame_t f;
+	uint32_t offset;
+	uint8_t sn = 1;
+
+	client.rspLength = 0;
+	if(!Client_Pop(&f) || f.id != TEST_TX_ID) return false;
+
+	if((f.data[0] & 0xF0) == CANTP_PCI_SF){
+		client.rspLength = f.data[0] & 0x0F;
+		memcpy(client.rsp, &f.data[1], client.rspLength);
+		return true;
+	}
+	if((f.data[0] & 0xF0) != CANTP_PCI_FF) return false;
+
+	client.rspLength = ((uint32_t)(f.data[0] & 0x0F) << 8) | f.data[1];
+	memcpy(client.rsp, &f.data[2], 6);
+	offset = 6;
+
+	{
+		uint8_t fc[CANTP_CAN_DL];
+
+		memset(fc, CANTP_PADDING_BYTE, sizeof(fc));
+		fc[0] = CANTP_PCI_FC;
+		fc[1] = 0;
+		fc[2] = 0;
+		(void)UdsServer_RxFrame(TEST_RX_ID, fc, CANTP_CAN_DL, now);
+	}
+
+	/* STmin 0: the CFs go out on the next passes */
+	for(uint32_t pass = 0; offset < client.rspLength && pass < 1000; pass++){
+		UdsServer_MainFunction(now);
+		while(offset < client.rspLength && Client_Pop(&f)){
+			uint32_t chunk = client.rspLength - offset;
+
+			if(f.data[0] != (CANTP_PCI_CF | sn)) return false;
+			if(chunk > 7) chunk = 7;
+			memcpy(&client.rsp[offset], &f.data[1], chunk);
+			offset += chunk;
+			sn = (uint8_t)((sn + 1) & 0x0F);
+		}
+	}
+
+	return offset >= client.rspLength;
+}
+
+/* Sends a request and checks the response is exactly the expected bytes */
+static bool Client_Expect(uint32_t id, const uint8_t* req, uint8_t reqLen, const uint8_t* rsp, uint32_t rspLen, uint32_t now){
+	Client_Request(id, req, reqLen, now);
+	if(!Client_Response(now)) return false;
+
+	return client.rspLength == rspLen && memcmp(client.rsp, rsp, rspLen) == 0;
+}
+
+static bool Client_ExpectNrc(uint32_t id, const uint8_t* req, uint8_t reqLen, uint8_t nrc, uint32_t now){
+	const uint8_t rsp[3] = { SID_NEGATIVE_RESPONSE, req[0], nrc };
+
+	return Client_Expect(id, req, reqLen, rsp, sizeof(rsp), now);
+}
+
+/* Checks the last response with the parser of the client's dispatch table */
+static bool Client_Parses(const uint8_t* req, uint32_t reqLen){
+	const Uds_Service_t* const svc = Uds_GetService(req[0]);
+
+	if(client.rspLength < svc->rspMinLen || client.rsp[0] != (uint8_t)(req[0] + POSITIVE_RESPONSE_OFFSET)) return false;
+
+	return svc->parser == NULL || svc->parser(req, reqLen, client.rsp, client.rspLength);
+}
+
+static uint8_t Client_Session(uint32_t now){
+	const uint8_t req[] = { SID_READ_DATA_BY_ID, 0xF1, 0x86 };
+
+	Client_Request(TEST_RX_ID, req, sizeof(req), now);
+	if(!Client_Response(now) || client.rspLength != 4 || client.rsp[0] != 0x62) return 0;
+
+	return client.rsp[3];
+}
+
+static void Test_Setup(const UdsServer_Db_t* db){
+	const UdsServer_Config_t config = {
+		.rxId = TEST_RX_ID,
+		.txId = TEST_TX_ID,
+		.functionalId = TEST_FUNCTIONAL_ID,
+		.db = db
+	};
+
+	UdsServer_Stop();
+	memset(&client, 0, sizeof(client));
+	client.filterLimit = CLIENT_FILTERS;
+	UdsServer_Init(Client_SendFrame, Client_Filter);
+	TEST_CHECK(UdsServer_Start(&config, 0) == UDS_OK);
+}
+
+
+/* Start / Stop and the filters */
+
+static void Test_StartStop(void){
+	UdsServer_Config_t config = { .rxId = TEST_RX_ID, .txId = TEST_TX_ID, .functionalId = TEST_FUNCTIONAL_ID, .db = &udsServerDb };
+
+	Test_Setup(&udsServerDb);
+	TEST_CHECK(UdsServer_IsRunning());
+	TEST_CHECK(client.filterCount == 2 && Client_Registered(TEST_RX_ID) && Client_Registered(TEST_FUNCTIONAL_ID));
+	TEST_CHECK(UdsServer_Start(&config, 0) == UDS_BUSY);
+
+	/* Frames for other IDs are left to the caller */
+	{
+		const uint8_t frame[] = { 0x02, SID_TESTER_PRESENT, 0x00 };
+
+		TEST_CHECK(!UdsServer_RxFrame(0x123, frame, sizeof(frame), 0));
+		TEST_CHECK(client.count == 0);
+	}
+
+	UdsServer_Stop();
+	TEST_CHECK(!UdsServer_IsRunning());
+	TEST_CHECK(client.filterCount == 0);
+
+	/* Bad configurations */
+	config.txId = TEST_RX_ID;
+	TEST_CHECK(UdsServer_Start(&config, 0) == UDS_NOT_OK);
+	config.txId = TEST_TX_ID;
+	config.db = NULL;
+	TEST_CHECK(UdsServer_Start(&config, 0) == UDS_NOT_OK);
+	config.db = &udsServerDb;
+
+	/* No filter left for the functional ID: the physical one is released */
+	client.filterLimit = 1;
+	TEST_CHECK(UdsServer_Start(&config, 0) == UDS_NOT_OK);
+	TEST_CHECK(client.filterCount == 0 && !UdsServer_IsRunning());
+}
+
+static void Test_DispatchTable(void){
+	TEST_CHECK(Uds_DispatchCheck());
+	TEST_CHECK(Uds_FindDid(DID_VEHICLE_INDENTIFICATION_NUMBER) != NULL);
+	TEST_CHECK(Uds_FindDid(0x1234) == NULL);
+	TEST_CHECK(Uds_HasSubFunction(Uds_GetService(SID_DIAGNOSTIC_SESSION_CONTROL), 0x83));
+	TEST_CHECK(!Uds_HasSubFunction(Uds_GetService(SID_ECU_RESET), 0x04));
+}
+
+
+/* Sessions */
+
+static void Test_SessionControl(void){
+	const uint8_t req[] = { SID_DIAGNOSTIC_SESSION_CONTROL, EXTENDED_DIAGNOSTIC_SESSION };
+	const uint8_t rsp[] = { 0x50, EXTENDED_DIAGNOSTIC_SESSION, 0x00, 0x32, 0x01, 0xF4 };
+
+	Test_Setup(&udsServerDb);
+	TEST_CHECK(Client_Session(0) == DEFAULT_SESSION);
+	TEST_CHECK(Client_Expect(TEST_RX_ID, req, sizeof(req), rsp, sizeof(rsp), 0));
+	TEST_CHECK(Client_Parses(req, sizeof(req)));
+	TEST_CHECK(Client_Session(0) == EXTENDED_DIAGNOSTIC_SESSION);
+}
+
+static void Test_SessionS3(void){
+	const uint8_t req[] = { SID_DIAGNOSTIC_SESSION_CONTROL, EXTENDED_DIAGNOSTIC_SESSION };
+	const uint8_t tp[] = { SID_TESTER_PRESENT, SUPPRESS_POS_RSP_MSG_INDICATION_BIT };
+
+	Test_Setup(&udsServerDb);
+	Client_Request(TEST_RX_ID, req, sizeof(req), 0);
+	TEST_CHECK(Client_Response(0));
+
+	/* TesterPresent (suppressed) keeps the session */
+	Client_Request(TEST_FUNCTIONAL_ID, tp, sizeof(tp), UDS_SERVER_S3 - 1);
+	TEST_CHECK(client.count == 0);
+	UdsServer_MainFunction(2 * UDS_SERVER_S3 - 2);
+	TEST_CHECK(Client_Session(2 * UDS_SERVER_S3 - 2) == EXTENDED_DIAGNOSTIC_SESSION);
+
+	/* Then S3 runs out */
+	UdsServer_MainFunction(3 * UDS_SERVER_S3 - 2);
+	TEST_CHECK(Client_Session(3 * UDS_SERVER_S3 - 2) == DEFAULT_SESSION);
+}
+
+static void Test_SessionSuppressed(void){
+	const uint8_t req[] = { SID_DIAGNOSTIC_SESSION_CONTROL, EXTENDED_DIAGNOSTIC_SESSION | SUPPRESS_POS_RSP_MSG_INDICATION_BIT };
+	const uint8_t bad[] = { SID_DIAGNOSTIC_SESSION_CONTROL, 0x05 | SUPPRESS_POS_RSP_MSG_INDICATION_BIT };
+
+	Test_Setup(&udsServerDb);
+	Client_Request(TEST_RX_ID, req, sizeof(req), 0);
+	TEST_CHECK(client.count == 0);
+	TEST_CHECK(Client_Session(0) == EXTENDED_DIAGNOSTIC_SESSION);
+
+	/* The bit does not suppress negative responses */
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, bad, sizeof(bad), NRC_SUB_FUNCTION_NOT_SUPPORTED, 0));
+}
+
+static void Test_EcuResetDefaultSession(void){
+	const uint8_t req[] = { SID_DIAGNOSTIC_SESSION_CONTROL, PROGRAMMING_SESSION };
+	const uint8_t reset[] = { SID_ECU_RESET, SOFT_RESET };
+
+	Test_Setup(&testDb);
+	Client_Request(TEST_RX_ID, req, sizeof(req), 0);
+	TEST_CHECK(Client_Response(0));
+	TEST_CHECK(Client_Session(0) == PROGRAMMING_SESSION);
+
+	/* testDb has no delay for the reset */
+	Client_Request(TEST_RX_ID, reset, sizeof(reset), 0);
+	TEST_CHECK(Client_Response(0) && client.rspLength == 2 && Client_Parses(reset, sizeof(reset)));
+	TEST_CHECK(Client_Session(0) == DEFAULT_SESSION);
+}
+
+
+/* Negative responses */
+
+static void Test_NegativeResponses(void){
+	const uint8_t unknownSid[] = { 0x31, 0x01, 0x02, 0x03 };
+	const uint8_t resetType[] = { SID_ECU_RESET, 0x04 };
+	const uint8_t dscLength[] = { SID_DIAGNOSTIC_SESSION_CONTROL, EXTENDED_DIAGNOSTIC_SESSION, 0x00 };
+	const uint8_t dscShort[] = { SID_DIAGNOSTIC_SESSION_CONTROL };
+	const uint8_t rdbiOdd[] = { SID_READ_DATA_BY_ID, 0xF1 };
+	const uint8_t rdbiUnknown[] = { SID_READ_DATA_BY_ID, 0x12, 0x34 };
+	const uint8_t dtcType[] = { SID_READ_DTC_INFO, 0x42 };
+
+	/* testDb answers the reset at once; negative responses are delayed like positive ones */
+	Test_Setup(&testDb);
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, unknownSid, sizeof(unknownSid), NRC_SERVICE_NOT_SUPPORTED, 0));
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, resetType, sizeof(resetType), NRC_SUB_FUNCTION_NOT_SUPPORTED, 0));
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, dscLength, sizeof(dscLength), NRC_INCORRECT_MESSAGE_LENGTH, 0));
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, dscShort, sizeof(dscShort), NRC_INCORRECT_MESSAGE_LENGTH, 0));
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, rdbiOdd, sizeof(rdbiOdd), NRC_INCORRECT_MESSAGE_LENGTH, 0));
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, rdbiUnknown, sizeof(rdbiUnknown), NRC_REQUEST_OUT_OF_RANGE, 0));
+
+	/* ... but testDb delays ReadDTCInformation */
+	Test_Setup(&udsServerDb);
+	TEST_CHECK(Client_ExpectNrc(TEST_RX_ID, dtcType, sizeof(dtcType), NRC_SUB_FUNCTION_NOT_SUPPORTED, 0));
+}
+
+static void Test_FunctionalSuppression(void){
+	const uint8_t unknownSid[] = { 0x31, 0x01, 0x02, 0x03 };
+	const uint8_t rdbiUnknown[] = { SID_READ_DATA_BY_ID, 0x12, 0x34 };
+	const uint8_t tpLength[] = { SID_TESTER_PRESENT, 0x00, 0x00 };
+	const uint8_t session[] = { SID_DIAGNOSTIC_SESSION_CONTROL, EXTENDED_DIAGNOSTIC_SESSION };
+
+	Test_Setup(&udsServerDb);
+
+	/* "Not supported" NRCs are not sent for functional requests */
+	Client_Request(TEST_FUNCTIONAL_ID, unknownSid, sizeof(unknownSid), 0);
+	Client_Request(TEST_FUNCTIONAL_ID, rdbiUnknown, sizeof(rdbiUnknown), 0);
+	TEST_CHECK(client.count == 0);
+
+	/* Others are */
+	TEST_CHECK(Client_ExpectNrc(TEST_FUNCTIONAL_ID, tpLength, sizeof(tpLength), NRC_INCORRECT_MESSAGE_LENGTH, 0));
+
+	/* Positive responses go out on the physical response ID */
+	Client_Request(TEST_FUNCTIONAL_ID, session, sizeof(session), 0);
+	TEST_CHECK(Client_Response(0) && client.rsp[0] == 0x50);
+
+	/* Functional multi-frame requests are ignored */
+	{
+		const uint8_t ff[CANTP_CAN_DL] = { 0x10, 0x08, SID_READ_DATA_BY_ID, 0xF1, 0x90, 0xF1, 0x97, 0xF1 };
+
+		TEST_CHECK(UdsServer_RxFrame(TEST_FUNCTIONAL_ID, ff, sizeof(ff), 0));
+		TEST_CHECK(client.count == 0);
+	}
+}
+
+
+/* Data */
+
+static void Test_ReadDataMultiFrame(void){
+	const uint8_t req[] = { SID_READ_DATA_BY_ID, 0xF1, 0x90, 0x12, 0x34, 0xF1, 0x97 };
+	const uint8_t rsp[] = { 0x62, 0xF1, 0x90, 'W', 'V', 'W', 'Z', 'Z', 'Z', '1', 'J', 'Z', 'X', 'W', '0', '0', '0', '0', '0', '1',
+			0xF1, 0x97, 'S', 'I', 'M', 'E', 'C', 'U' };
+
+	Test_Setup(&udsServerDb);
+
+	/* Unsupported DIDs of a multi-DID request are left out */
+	TEST_CHECK(Client_Expect(TEST_RX_ID, req, sizeof(req), rsp, sizeof(rsp), 0));
+	TEST_CHECK(Client_Parses(req, sizeof(req)));
+}
+
+static void Test_ReadDtc(void){
+	const uint8_t count[] = { SID_READ_DTC_INFO, REPORT_NUMBER_OF_DTC_BY_STATUS_MASK, 0x04 };
+	const uint8_t countRsp[] = { 0x59, REPORT_NUMBER_OF_DTC_BY_STATUS_MASK, 0xFF, 0x01, 0x00, 0x02 };
+	const uint8_t confirmed[] = { SID_READ_DTC_INFO, REPORT_DTC_BY_STATUS_MASK, 0x08 };
+	const uint8_t confirmedRsp[] = { 0x59, REPORT_DTC_BY_STATUS_MASK, 0xFF, 0x03, 0x01, 0x00, 0x2F };
+
+	Test_Setup(&udsServerDb);
+	TEST_CHECK(Client_Expect(TEST_RX_ID, count, sizeof(count), countRsp, sizeof(countRsp), 0));
+	TEST_CHECK(Client_Parses(count, sizeof(count)));
+	TEST_CHECK(Client_Expect(TEST_RX_ID, confirmed, sizeof(confirmed), confirmedRsp, sizeof(confirmedRsp), 0));
+}
+
+
+/* Delays and NRC 0x78 */
+
+static void Test_DelayWithinP2(void){
+	const uint8_t req[] = { SID_TESTER_PRESENT, 0x00 };
+
+	Test_Setup(&testDb);
+	Client_Request(TEST_RX_ID, req, sizeof(req), 100);
+	UdsServer_MainFunction(129);
+	TEST_CHECK(client.count == 0);
+	UdsServer_MainFunction(130);
+	TEST_CHECK(Client_Response(130) && Client_Parses(req, sizeof(req)));
+}
+
+static void Test_ResponsePending(void){
+	const uint8_t reset[] = { SID_ECU_RESET, HARD_RESET };
+	const uint8_t rsp[] = { 0x51, HARD_RESET };
+	const uint8_t pending[] = { SID_NEGATIVE_RESPONSE, SID_ECU_RESET, NRC_RESPONSE_PENDING };
+
+	/* The example database delays the reset by 100 ms > P2 */
+	Test_Setup(&udsServerDb);
+	Client_Request(TEST_RX_ID, reset, sizeof(reset), 0);
+	TEST_CHECK(Client_Response(0) && client.rspLength == 3 && memcmp(client.rsp, pending, 3) == 0);
+	UdsServer_MainFunction(99);
+	TEST_CHECK(client.count == 0);
+	UdsServer_MainFunction(100);
+	TEST_CHECK(Client_Response(100) && client.rspLength == 2 && memcmp(client.rsp, rsp, 2) == 0);
+}
+
+static void Test_ResponsePendingRepeated(void){
+	const uint8_t req[] = { SID_READ_DTC_INFO, REPORT_SUPPORTED_DTC };
+	const uint8_t other[] = { SID_DIAGNOSTIC_SESSION_CONTROL, DEFAULT_SESSION };
+	uint32_t pendings = 0;
+
+	Test_Setup(&testDb);
+	Client_Request(TEST_RX_ID, req, sizeof(req), 0);
+
+	/* 0x78 at once and every UDS_SERVER_PENDING_PERIOD until the 5 s delay ends */
+	for(uint32_t now = 0; now < 5000; now += 10){
+		UdsServer_MainFunction(now);
+		while(client.count != 0){
+			TEST_CHECK(Client_Response(now) && client.rspLength == 3 && client.rsp[2] == NRC_RESPONSE_PENDING);
+			TEST_CHECK(now % UDS_SERVER_PENDING_PERIOD == 0);
+			pendings++;
+		}
+		/* Requests while one is being answered are dropped */
+		if(now == 1000){
+			Client_Request(TEST_RX_ID, other, sizeof(other), now);
+			TEST_CHECK(client.count == 0);
+		}
+	}
+	TEST_CHECK(pendings == 3);
+
+	UdsServer_MainFunction(5000);
+	TEST_CHECK(Client_Response(5000) && client.rspLength == 3 + 4 * 3);
+	TEST_CHECK(Client_Parses(req, sizeof(req)));
+
+	/* Idle again */
+	TEST_CHECK(Client_Session(5000) == DEFAULT_SESSION);
+}
+
+
+int main(void){
+	testDb = udsServerDb;
+	testDb.delays = testDelays;
+	testDb.delayCount = (uint8_t)(sizeof(testDelays) / sizeof(testDelays[0]));
+
+	TEST_RUN(Test_StartStop);
+	TEST_RUN(Test_DispatchTable);
+
+	TEST_RUN(Test_SessionControl);
+	TEST_RUN(Test_SessionS3);
+	TEST_RUN(Test_SessionSuppressed);
+	TEST_RUN(Test_EcuResetDefaultSession);
+
+	TEST_RUN(Test_NegativeResponses);
+	TEST_RUN(Test_FunctionalSuppression);
+	TEST_RUN(Test_ReadDataMultiFrame);
+	TEST_RUN(Test_ReadDtc);
+
+	TEST_RUN(Test_DelayWithinP2);
+	TEST_RUN(Test_ResponsePending);
+	TEST_RUN(Test_ResponsePendingRepeated);
+
+	return Test_Result();
+}
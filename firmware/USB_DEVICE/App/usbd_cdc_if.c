@@ -22,6 +22,7 @@
 #include "usbd_cdc_if.h"
 
 /* USER CODE BEGIN INCLUDE */
+#include "../../Core/Src/Com/Host/Inc/host_if.h"
 
 /* USER CODE END INCLUDE */
 
@@ -262,10 +263,10 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
 {
   /* USER CODE BEGIN 6 */
   USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  USBD_CDC_ReceivePacket(&hUsbDeviceFS);
-
-  // memcpy
-  // give notify
+  /* Left un-armed while the command ring is full, the host is NAKed meanwhile */
+  if(HostIf_RxPacket(Buf, *Len)){
+    USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  }
 
   return (USBD_OK);
   /* USER CODE END 6 */
@@ -315,12 +316,24 @@ static int8_t CDC_TransmitCplt_FS(uint8_t *Buf, uint32_t *Len, uint8_t epnum)
   UNUSED(Buf);
   UNUSED(Len);
   UNUSED(epnum);
+  HostIf_TxComplete();
   /* USER CODE END 13 */
   return result;
 }
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/**
+  * @brief  CDC_ReceiveNext_FS
+  *         Re-arms the OUT endpoint that CDC_Receive_FS left un-armed
+  *         because the host command ring was full.
+  * @retval Result of the operation: USBD_OK if all operations are OK else USBD_FAIL
+  */
+uint8_t CDC_ReceiveNext_FS(void)
+{
+  return USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+}
+
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
 /**